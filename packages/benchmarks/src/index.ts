@@ -12,6 +12,15 @@ import { writeFileSync } from "node:fs"
 import { afterAll, bench, describe } from "vitest"
 import { DurableStream } from "@durable-streams/client"
 
+export {
+  defaultLoadScenarios,
+  runLoadBenchmarks,
+  type LoadBenchmarkOptions,
+  type LoadReport,
+  type LoadScenario,
+  type ScenarioResult,
+} from "./load"
+
 export interface BenchmarkOptions {
   /** Base URL of the server to benchmark */
   baseUrl: string
@@ -0,0 +1,679 @@
+/**
+ * Server-side load benchmarks for Durable Streams server implementations.
+ *
+ * Unlike the vitest suite in index.ts, which measures single-client latency
+ * through the client library, these drive a server the way production
+ * traffic does: many streams with concurrent appenders, large numbers of
+ * live tailers on one hot stream, catch-up reads of large streams, reads
+ * through fork chains and pipelined idempotent producers.
+ *
+ * Requests go through fetch directly, so client overhead stays small next to
+ * the server's even with tens of thousands of tailers. Each scenario reports
+ * throughput and latency percentiles; memory is sampled over the whole run,
+ * for the server when its pid is given (Linux) and always for this process.
+ */
+
+import { readFileSync, writeFileSync } from "node:fs"
+import { DurableStream, IdempotentProducer } from "@durable-streams/client"
+
+export interface LoadBenchmarkOptions {
+  /** Base URL of the server to benchmark */
+  baseUrl: string
+  /** Environment name (e.g., "caddy", "node") */
+  environment?: string
+  /** Path prefix for benchmark streams (default `/v1/stream/load-bench`) */
+  streamPrefix?: string
+  /** Pid of a local server process, to sample its RSS */
+  serverPid?: number
+  /** How often to sample memory (default 1000ms) */
+  sampleIntervalMs?: number
+  /** Where to write the JSON report (default `load-benchmark-results.json`) */
+  outputFile?: string
+  /** Scenarios to run, in order */
+  scenarios: Array<LoadScenario>
+}
+
+export type LoadScenario =
+  | ({ type: `many-streams` } & ManyStreamsConfig)
+  | ({ type: `fan-out` } & FanOutConfig)
+  | ({ type: `catch-up` } & CatchUpConfig)
+  | ({ type: `fork-chain` } & ForkChainConfig)
+  | ({ type: `idempotent-producer` } & IdempotentProducerConfig)
+
+export interface ManyStreamsConfig {
+  streams: number
+  appendersPerStream: number
+  messageBytes: number
+  durationMs: number
+}
+
+export interface FanOutConfig {
+  tailers: number
+  mode: `long-poll` | `sse`
+  /** Appends to the hot stream, one every appendIntervalMs */
+  messages: number
+  appendIntervalMs: number
+}
+
+export interface CatchUpConfig {
+  /** Size the stream is seeded to before reading */
+  totalBytes: number
+  /** Size of each seeding append */
+  appendBytes: number
+  /** Concurrent readers, each reading the whole stream */
+  readers: number
+}
+
+export interface ForkChainConfig {
+  /** Number of forks stacked on the base stream */
+  depth: number
+  messagesPerLevel: number
+  messageBytes: number
+  /** Full reads of the deepest fork */
+  reads: number
+}
+
+export interface IdempotentProducerConfig {
+  producers: number
+  messagesPerProducer: number
+  messageBytes: number
+  maxInFlight?: number
+  lingerMs?: number
+}
+
+export interface LatencySummary {
+  count: number
+  mean: number
+  p50: number
+  p99: number
+  p999: number
+  max: number
+  unit: `ms`
+}
+
+export interface ScenarioResult {
+  name: string
+  config: Record<string, unknown>
+  durationMs: number
+  /** Operations per second, keyed by operation */
+  throughput: Record<string, number>
+  /** Latency per operation */
+  latency: Record<string, LatencySummary>
+  errors: number
+}
+
+export interface MemorySample {
+  /** Milliseconds since the run started */
+  t: number
+  serverRssBytes?: number
+  clientRssBytes: number
+}
+
+export interface LoadReport {
+  environment: string
+  baseUrl: string
+  timestamp: string
+  scenarios: Array<ScenarioResult>
+  memory: Array<MemorySample>
+}
+
+/**
+ * Collects latency samples for one operation.
+ */
+class LatencyRecorder {
+  private samples: Array<number> = []
+
+  record(ms: number): void {
+    this.samples.push(ms)
+  }
+
+  get count(): number {
+    return this.samples.length
+  }
+
+  summary(): LatencySummary {
+    const sorted = Float64Array.from(this.samples).sort()
+    const at = (q: number) =>
+      sorted.length === 0
+        ? 0
+        : sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * q))]!
+    let sum = 0
+    for (const v of sorted) sum += v
+    return {
+      count: sorted.length,
+      mean: sorted.length === 0 ? 0 : sum / sorted.length,
+      p50: at(0.5),
+      p99: at(0.99),
+      p999: at(0.999),
+      max: sorted.length === 0 ? 0 : sorted[sorted.length - 1]!,
+      unit: `ms`,
+    }
+  }
+}
+
+function readServerRss(pid: number): number | undefined {
+  try {
+    const status = readFileSync(`/proc/${pid}/status`, `utf-8`)
+    const match = /^VmRSS:\s+(\d+)\s+kB$/m.exec(status)
+    return match ? Number(match[1]) * 1024 : undefined
+  } catch {
+    return undefined
+  }
+}
+
+function startMemorySampler(
+  serverPid: number | undefined,
+  intervalMs: number
+): { stop: () => Array<MemorySample> } {
+  const start = performance.now()
+  const samples: Array<MemorySample> = []
+  const sample = () => {
+    samples.push({
+      t: Math.round(performance.now() - start),
+      serverRssBytes:
+        serverPid !== undefined ? readServerRss(serverPid) : undefined,
+      clientRssBytes: process.memoryUsage().rss,
+    })
+  }
+  sample()
+  const timer = setInterval(sample, intervalMs)
+  return {
+    stop: () => {
+      clearInterval(timer)
+      sample()
+      return samples
+    },
+  }
+}
+
+const sleep = (ms: number) => new Promise((resolve) => setTimeout(resolve, ms))
+
+async function createStream(
+  url: string,
+  contentType: string,
+  headers: Record<string, string> = {}
+): Promise<void> {
+  const res = await fetch(url, {
+    method: `PUT`,
+    headers: { "content-type": contentType, ...headers },
+  })
+  await res.arrayBuffer()
+  if (!res.ok) {
+    throw new Error(`failed to create ${url}: ${res.status}`)
+  }
+}
+
+async function appendTo(
+  url: string,
+  body: Uint8Array | string,
+  contentType: string
+): Promise<string> {
+  const res = await fetch(url, {
+    method: `POST`,
+    headers: { "content-type": contentType },
+    body,
+  })
+  await res.arrayBuffer()
+  if (!res.ok) {
+    throw new Error(`append to ${url} failed: ${res.status}`)
+  }
+  return res.headers.get(`stream-next-offset`) ?? ``
+}
+
+/**
+ * Read a stream from offset to its tail, returning the bytes read.
+ */
+async function readToTail(
+  url: string,
+  requests: LatencyRecorder,
+  offset = `-1`
+): Promise<number> {
+  let bytes = 0
+  for (;;) {
+    const start = performance.now()
+    const res = await fetch(`${url}?offset=${encodeURIComponent(offset)}`)
+    const body = await res.arrayBuffer()
+    requests.record(performance.now() - start)
+    if (!res.ok) {
+      throw new Error(`read of ${url} failed: ${res.status}`)
+    }
+    bytes += body.byteLength
+    offset = res.headers.get(`stream-next-offset`) ?? offset
+    if (res.headers.get(`stream-up-to-date`) === `true`) return bytes
+  }
+}
+
+async function runManyStreams(
+  urlFor: (name: string) => string,
+  config: ManyStreamsConfig
+): Promise<ScenarioResult> {
+  const contentType = `application/octet-stream`
+  const urls = Array.from({ length: config.streams }, (_, i) =>
+    urlFor(`many-${i}`)
+  )
+  await Promise.all(urls.map((url) => createStream(url, contentType)))
+
+  const message = new Uint8Array(config.messageBytes).fill(42)
+  const appends = new LatencyRecorder()
+  let errors = 0
+  const start = performance.now()
+  const deadline = start + config.durationMs
+
+  await Promise.all(
+    urls.flatMap((url) =>
+      Array.from({ length: config.appendersPerStream }, async () => {
+        while (performance.now() < deadline) {
+          const t0 = performance.now()
+          try {
+            await appendTo(url, message, contentType)
+            appends.record(performance.now() - t0)
+          } catch {
+            errors++
+          }
+        }
+      })
+    )
+  )
+
+  const durationMs = performance.now() - start
+  return {
+    name: `many-streams`,
+    config: { ...config },
+    durationMs,
+    throughput: {
+      appends: appends.count / (durationMs / 1000),
+      bytes: (appends.count * config.messageBytes) / (durationMs / 1000),
+    },
+    latency: { append: appends.summary() },
+    errors,
+  }
+}
+
+/**
+ * Parse the messages out of a JSON-mode read body or SSE data payload.
+ */
+function parseMessages(text: string): Array<{ t: number }> {
+  if (text.length === 0) return []
+  const value = JSON.parse(text) as unknown
+  return Array.isArray(value) ? value : [value as { t: number }]
+}
+
+async function tailLongPoll(
+  url: string,
+  offset: string,
+  expected: number,
+  delivery: LatencyRecorder,
+  signal: AbortSignal
+): Promise<void> {
+  let received = 0
+  while (received < expected && !signal.aborted) {
+    const res = await fetch(
+      `${url}?offset=${encodeURIComponent(offset)}&live=long-poll`,
+      { signal }
+    )
+    const text = await res.text()
+    offset = res.headers.get(`stream-next-offset`) ?? offset
+    if (res.status !== 200) continue
+    const now = Date.now()
+    for (const message of parseMessages(text)) {
+      delivery.record(now - message.t)
+      received++
+    }
+  }
+}
+
+async function tailSSE(
+  url: string,
+  offset: string,
+  expected: number,
+  delivery: LatencyRecorder,
+  signal: AbortSignal
+): Promise<void> {
+  let received = 0
+  while (received < expected && !signal.aborted) {
+    const res = await fetch(
+      `${url}?offset=${encodeURIComponent(offset)}&live=sse`,
+      { signal }
+    )
+    if (!res.body) return
+    const reader = res.body.getReader()
+    const decoder = new TextDecoder()
+    let buffer = ``
+    for (;;) {
+      const { done, value } = await reader.read()
+      if (done) break
+      buffer += decoder.decode(value, { stream: true })
+      let end
+      while ((end = buffer.indexOf(`\n\n`)) >= 0) {
+        const event = buffer.slice(0, end)
+        buffer = buffer.slice(end + 2)
+        const lines = event.split(`\n`)
+        const type = lines
+          .find((line) => line.startsWith(`event:`))
+          ?.slice(6)
+          .trim()
+        const data = lines
+          .filter((line) => line.startsWith(`data:`))
+          .map((line) => line.slice(5).trimStart())
+          .join(`\n`)
+        if (type === `control`) {
+          const control = JSON.parse(data) as { streamNextOffset?: string }
+          offset = control.streamNextOffset ?? offset
+        } else if (type === `data`) {
+          const now = Date.now()
+          for (const message of parseMessages(data)) {
+            delivery.record(now - message.t)
+            received++
+          }
+        }
+      }
+      if (received >= expected) {
+        await reader.cancel()
+        break
+      }
+    }
+  }
+}
+
+async function runFanOut(
+  urlFor: (name: string) => string,
+  config: FanOutConfig
+): Promise<ScenarioResult> {
+  const contentType = `application/json`
+  const url = urlFor(`fan-out`)
+  await createStream(url, contentType)
+  const head = await fetch(url, { method: `HEAD` })
+  const offset = head.headers.get(`stream-next-offset`) ?? `-1`
+
+  const delivery = new LatencyRecorder()
+  const appends = new LatencyRecorder()
+  const abort = new AbortController()
+  let errors = 0
+  const tail = config.mode === `sse` ? tailSSE : tailLongPoll
+  const tailers = Array.from({ length: config.tailers }, () =>
+    tail(url, offset, config.messages, delivery, abort.signal).catch(() => {
+      if (!abort.signal.aborted) errors++
+    })
+  )
+
+  // Let the tailers connect before the first append
+  await sleep(Math.min(5000, 100 + config.tailers / 10))
+
+  const start = performance.now()
+  for (let i = 0; i < config.messages; i++) {
+    const t0 = performance.now()
+    try {
+      await appendTo(url, JSON.stringify({ t: Date.now(), i }), contentType)
+      appends.record(performance.now() - t0)
+    } catch {
+      errors++
+    }
+    await sleep(config.appendIntervalMs)
+  }
+
+  // Give stragglers a bounded time to drain, then stop them
+  const drained = Promise.all(tailers)
+  await Promise.race([drained, sleep(10_000)])
+  abort.abort()
+  await drained
+
+  const durationMs = performance.now() - start
+  return {
+    name: `fan-out (${config.mode})`,
+    config: { ...config },
+    durationMs,
+    throughput: {
+      deliveries: delivery.count / (durationMs / 1000),
+    },
+    latency: { delivery: delivery.summary(), append: appends.summary() },
+    errors,
+  }
+}
+
+async function runCatchUp(
+  urlFor: (name: string) => string,
+  config: CatchUpConfig
+): Promise<ScenarioResult> {
+  const contentType = `application/octet-stream`
+  const url = urlFor(`catch-up`)
+  await createStream(url, contentType)
+
+  const chunk = new Uint8Array(config.appendBytes).fill(42)
+  const seedStart = performance.now()
+  for (let written = 0; written < config.totalBytes; ) {
+    await appendTo(url, chunk, contentType)
+    written += chunk.length
+  }
+  const seedMs = performance.now() - seedStart
+
+  const requests = new LatencyRecorder()
+  let errors = 0
+  let bytes = 0
+  const start = performance.now()
+  await Promise.all(
+    Array.from({ length: config.readers }, async () => {
+      try {
+        bytes += await readToTail(url, requests)
+      } catch {
+        errors++
+      }
+    })
+  )
+
+  const durationMs = performance.now() - start
+  return {
+    name: `catch-up`,
+    config: { ...config, seedMs },
+    durationMs,
+    throughput: {
+      requests: requests.count / (durationMs / 1000),
+      bytes: bytes / (durationMs / 1000),
+    },
+    latency: { request: requests.summary() },
+    errors,
+  }
+}
+
+async function runForkChain(
+  urlFor: (name: string) => string,
+  pathFor: (name: string) => string,
+  config: ForkChainConfig
+): Promise<ScenarioResult> {
+  const contentType = `application/octet-stream`
+  const message = new Uint8Array(config.messageBytes).fill(42)
+
+  let source = `fork-0`
+  await createStream(urlFor(source), contentType)
+  for (let level = 0; level <= config.depth; level++) {
+    if (level > 0) {
+      const fork = `fork-${level}`
+      await createStream(urlFor(fork), contentType, {
+        "Stream-Forked-From": pathFor(source),
+      })
+      source = fork
+    }
+    for (let i = 0; i < config.messagesPerLevel; i++) {
+      await appendTo(urlFor(source), message, contentType)
+    }
+  }
+
+  const requests = new LatencyRecorder()
+  const reads = new LatencyRecorder()
+  let errors = 0
+  const start = performance.now()
+  for (let i = 0; i < config.reads; i++) {
+    const t0 = performance.now()
+    try {
+      await readToTail(urlFor(source), requests)
+      reads.record(performance.now() - t0)
+    } catch {
+      errors++
+    }
+  }
+
+  const durationMs = performance.now() - start
+  return {
+    name: `fork-chain`,
+    config: { ...config },
+    durationMs,
+    throughput: { reads: reads.count / (durationMs / 1000) },
+    latency: { read: reads.summary(), request: requests.summary() },
+    errors,
+  }
+}
+
+async function runIdempotentProducer(
+  urlFor: (name: string) => string,
+  config: IdempotentProducerConfig
+): Promise<ScenarioResult> {
+  const contentType = `application/octet-stream`
+  const message = new Uint8Array(config.messageBytes).fill(42)
+  const flushes = new LatencyRecorder()
+  let errors = 0
+
+  const producers = await Promise.all(
+    Array.from({ length: config.producers }, async (_, i) => {
+      const stream = await DurableStream.create({
+        url: urlFor(`producer-${i}`),
+        contentType,
+      })
+      return new IdempotentProducer(stream, `load-bench-${i}`, {
+        maxInFlight: config.maxInFlight,
+        lingerMs: config.lingerMs,
+        onError: () => {
+          errors++
+        },
+      })
+    })
+  )
+
+  const start = performance.now()
+  await Promise.all(
+    producers.map(async (producer) => {
+      for (let i = 0; i < config.messagesPerProducer; i++) {
+        producer.append(message)
+      }
+      const t0 = performance.now()
+      await producer.flush()
+      flushes.record(performance.now() - t0)
+      await producer.close()
+    })
+  )
+
+  const durationMs = performance.now() - start
+  const total = config.producers * config.messagesPerProducer
+  return {
+    name: `idempotent-producer`,
+    config: { ...config },
+    durationMs,
+    throughput: {
+      messages: total / (durationMs / 1000),
+      bytes: (total * config.messageBytes) / (durationMs / 1000),
+    },
+    latency: { flush: flushes.summary() },
+    errors,
+  }
+}
+
+/**
+ * Run the given load scenarios against a server and write a JSON report.
+ */
+export async function runLoadBenchmarks(
+  options: LoadBenchmarkOptions
+): Promise<LoadReport> {
+  const {
+    baseUrl,
+    environment = `unknown`,
+    streamPrefix = `/v1/stream/load-bench`,
+    outputFile = `load-benchmark-results.json`,
+  } = options
+  const runId = `${Date.now()}-${Math.random().toString(36).slice(2, 8)}`
+  const pathFor = (name: string) => `${streamPrefix}/${runId}/${name}`
+  const urlFor = (name: string) => `${baseUrl}${pathFor(name)}`
+
+  const sampler = startMemorySampler(
+    options.serverPid,
+    options.sampleIntervalMs ?? 1000
+  )
+  const scenarios: Array<ScenarioResult> = []
+  let report: LoadReport
+  try {
+    for (const scenario of options.scenarios) {
+      switch (scenario.type) {
+        case `many-streams`:
+          scenarios.push(await runManyStreams(urlFor, scenario))
+          break
+        case `fan-out`:
+          scenarios.push(await runFanOut(urlFor, scenario))
+          break
+        case `catch-up`:
+          scenarios.push(await runCatchUp(urlFor, scenario))
+          break
+        case `fork-chain`:
+          scenarios.push(await runForkChain(urlFor, pathFor, scenario))
+          break
+        case `idempotent-producer`:
+          scenarios.push(await runIdempotentProducer(urlFor, scenario))
+          break
+      }
+    }
+  } finally {
+    report = {
+      environment,
+      baseUrl,
+      timestamp: new Date().toISOString(),
+      scenarios,
+      memory: sampler.stop(),
+    }
+    writeFileSync(outputFile, JSON.stringify(report, null, 2), `utf-8`)
+  }
+
+  return report
+}
+
+/**
+ * A scenario set covering each regime once, sized for a single machine.
+ */
+export const defaultLoadScenarios: Array<LoadScenario> = [
+  {
+    type: `many-streams`,
+    streams: 100,
+    appendersPerStream: 4,
+    messageBytes: 256,
+    durationMs: 10_000,
+  },
+  {
+    type: `fan-out`,
+    mode: `long-poll`,
+    tailers: 10_000,
+    messages: 50,
+    appendIntervalMs: 100,
+  },
+  {
+    type: `fan-out`,
+    mode: `sse`,
+    tailers: 10_000,
+    messages: 50,
+    appendIntervalMs: 100,
+  },
+  {
+    type: `catch-up`,
+    totalBytes: 1024 * 1024 * 1024,
+    appendBytes: 1024 * 1024,
+    readers: 4,
+  },
+  {
+    type: `fork-chain`,
+    depth: 8,
+    messagesPerLevel: 1000,
+    messageBytes: 256,
+    reads: 20,
+  },
+  {
+    type: `idempotent-producer`,
+    producers: 50,
+    messagesPerProducer: 10_000,
+    messageBytes: 256,
+    maxInFlight: 5,
+  },
+]
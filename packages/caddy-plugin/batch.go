@@ -0,0 +1,245 @@
+package durablestreams
+
+import (
+	"encoding/base64"
+	"encoding/json"
+	"errors"
+	"net/http"
+	"strings"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+	"go.uber.org/zap"
+)
+
+// Batched appends write to many streams in one request:
+//
+//	POST {base}/__ds/batch
+//	{"appends": [
+//	  {"path": "/a", "contentType": "application/json", "data": [{"n": 1}]},
+//	  {"path": "/b", "contentType": "text/plain", "data": "hello", "close": true},
+//	  {"path": "/c", "contentType": "application/octet-stream", "data": "/wA=", "encoding": "base64"}
+//	]}
+//
+// JSON streams take data as a JSON value, flattened like an append body;
+// other streams take a string, base64-encoded when encoding is "base64".
+// Entries are validated and applied in order like single appends, including
+// Stream-Seq and idempotent producer checks, and the response waits for one
+// durable commit covering every accepted entry.
+//
+// Entries succeed or fail independently. The response is 200 with a result
+// per entry, in request order, whose status is what a single append would
+// have returned (with the headers it would have set as fields).
+// Close-only entries are not supported.
+//
+// Entry paths are full stream paths and must lie under {base}, so a batch
+// only reaches streams its route could append to directly.
+const batchPath = "/__ds/batch"
+
+// batchMaxAppends bounds the entries of one request
+const batchMaxAppends = 1024
+
+// isBatchPath reports whether path addresses the batched append endpoint
+func isBatchPath(path string) bool {
+	return strings.HasSuffix(path, batchPath)
+}
+
+// streamInScope reports whether a stream path named in the body of a request
+// to an endpoint mounted under prefix (the request path minus the endpoint)
+// is one the request's route could address itself: below prefix, without dot
+// segments, and not an endpoint. Caddy route matching only sees the request
+// path, so anything else would let a client step outside its route.
+func streamInScope(prefix, path string) bool {
+	if !strings.HasPrefix(path, prefix+"/") {
+		return false
+	}
+	for _, segment := range strings.Split(path[1:], "/") {
+		if segment == "." || segment == ".." {
+			return false
+		}
+	}
+	return !isBatchPath(path) && !isMultiplexPath(path) && !isReplicationPath(path)
+}
+
+type batchRequest struct {
+	Appends []batchAppend `json:"appends"`
+}
+
+// batchAppend is one entry of a batched append request
+type batchAppend struct {
+	Path          string          `json:"path"`
+	ContentType   string          `json:"contentType"`
+	Data          json.RawMessage `json:"data"`
+	Encoding      string          `json:"encoding,omitempty"`
+	Seq           string          `json:"seq,omitempty"`
+	Close         bool            `json:"close,omitempty"`
+	ProducerId    string          `json:"producerId,omitempty"`
+	ProducerEpoch *int64          `json:"producerEpoch,omitempty"`
+	ProducerSeq   *int64          `json:"producerSeq,omitempty"`
+}
+
+// batchResult is the outcome of one entry of a batched append
+type batchResult struct {
+	Path          string `json:"path"`
+	Status        int    `json:"status"`
+	NextOffset    string `json:"streamNextOffset,omitempty"`
+	Closed        bool   `json:"streamClosed,omitempty"`
+	ProducerEpoch *int64 `json:"producerEpoch,omitempty"`
+	ProducerSeq   *int64 `json:"producerSeq,omitempty"`
+	ExpectedSeq   *int64 `json:"producerExpectedSeq,omitempty"`
+	ReceivedSeq   *int64 `json:"producerReceivedSeq,omitempty"`
+	Error         string `json:"error,omitempty"`
+}
+
+// handleBatch handles POST requests to the batched append endpoint
+func (h *Handler) handleBatch(w http.ResponseWriter, r *http.Request) error {
+	if r.Method != http.MethodPost {
+		w.Header().Set("Allow", http.MethodPost)
+		return newHTTPError(http.StatusMethodNotAllowed, "batched appends use POST")
+	}
+
+	var req batchRequest
+	if err := json.NewDecoder(r.Body).Decode(&req); err != nil {
+		return newHTTPError(http.StatusBadRequest, "invalid batch request body")
+	}
+	if len(req.Appends) == 0 {
+		return newHTTPError(http.StatusBadRequest, "no appends in batch")
+	}
+	if len(req.Appends) > batchMaxAppends {
+		return newHTTPError(http.StatusBadRequest, "too many appends in batch")
+	}
+
+	results := make([]batchResult, len(req.Appends))
+	entries := make([]store.BatchEntry, 0, len(req.Appends))
+	// index of each entry's result
+	slots := make([]int, 0, len(req.Appends))
+	prefix := strings.TrimSuffix(r.URL.Path, batchPath)
+	for i, a := range req.Appends {
+		results[i].Path = a.Path
+		entry, err := parseBatchAppend(prefix, a)
+		if err != nil {
+			results[i].Status = http.StatusBadRequest
+			results[i].Error = err.Error()
+			continue
+		}
+		entries = append(entries, entry)
+		slots = append(slots, i)
+	}
+
+	batch := store.AppendBatch(h.store, entries)
+	for j := range batch {
+		br := &batch[j]
+		res := &results[slots[j]]
+		opts := entries[j].Opts
+		if br.Err != nil {
+			status, message, ok := appendErrorStatus(br.Err)
+			if !ok {
+				h.logger.Error("batched append failed", zap.String("path", res.Path), zap.Error(br.Err))
+				status, message = http.StatusInternalServerError, "internal server error"
+			}
+			res.Status, res.Error = status, message
+			switch {
+			case errors.Is(br.Err, store.ErrStreamClosed):
+				res.Closed = true
+				res.NextOffset = br.Result.Offset.String()
+			case errors.Is(br.Err, store.ErrStaleEpoch):
+				res.NextOffset = br.Result.Offset.String()
+				res.ProducerEpoch = &br.Result.CurrentEpoch
+			case errors.Is(br.Err, store.ErrProducerSeqGap):
+				res.NextOffset = br.Result.Offset.String()
+				res.ExpectedSeq = &br.Result.ExpectedSeq
+				res.ReceivedSeq = &br.Result.ReceivedSeq
+			}
+			continue
+		}
+
+		res.NextOffset = br.Result.Offset.String()
+		res.Closed = br.Result.StreamClosed
+		if opts.ProducerEpoch != nil {
+			res.ProducerEpoch = opts.ProducerEpoch
+			res.ProducerSeq = &br.Result.LastSeq
+		}
+		if br.Result.ProducerResult == store.ProducerResultDuplicate {
+			res.Status = http.StatusNoContent
+			continue
+		}
+
+		if h.webhookManager != nil {
+			h.webhookManager.OnStreamAppend(res.Path)
+		}
+		if opts.ProducerId != "" {
+			res.Status = http.StatusOK
+		} else {
+			res.Status = http.StatusNoContent
+		}
+	}
+
+	w.Header().Set("Content-Type", "application/json")
+	w.Header().Set("Cache-Control", "no-store")
+	return json.NewEncoder(w).Encode(struct {
+		Results []batchResult `json:"results"`
+	}{results})
+}
+
+// parseBatchAppend validates a batch entry as handleAppend validates a
+// request, decoding its data. prefix is the route prefix the batch was sent
+// under.
+func parseBatchAppend(prefix string, a batchAppend) (store.BatchEntry, error) {
+	if !streamInScope(prefix, a.Path) {
+		return store.BatchEntry{}, errors.New("invalid stream path")
+	}
+
+	hasProducer := a.ProducerId != "" || a.ProducerEpoch != nil || a.ProducerSeq != nil
+	hasAllProducer := a.ProducerId != "" && a.ProducerEpoch != nil && a.ProducerSeq != nil
+	if hasProducer && !hasAllProducer {
+		return store.BatchEntry{}, errors.New("all producer fields (producerId, producerEpoch, producerSeq) must be provided together")
+	}
+	if hasAllProducer && (*a.ProducerEpoch < 0 || *a.ProducerSeq < 0) {
+		return store.BatchEntry{}, errors.New("producerEpoch and producerSeq must be non-negative integers")
+	}
+
+	if a.ContentType == "" {
+		return store.BatchEntry{}, errors.New("contentType is required")
+	}
+	if len(a.Data) == 0 || string(a.Data) == "null" {
+		return store.BatchEntry{}, errors.New("empty data not allowed")
+	}
+
+	data := []byte(a.Data)
+	if !store.IsJSONContentType(a.ContentType) {
+		var s string
+		if err := json.Unmarshal(a.Data, &s); err != nil {
+			return store.BatchEntry{}, errors.New("data must be a string for non-JSON streams")
+		}
+		data = []byte(s)
+		switch a.Encoding {
+		case "":
+		case "base64":
+			decoded, err := base64.StdEncoding.DecodeString(s)
+			if err != nil {
+				return store.BatchEntry{}, errors.New("invalid base64 data")
+			}
+			data = decoded
+		default:
+			return store.BatchEntry{}, errors.New("invalid encoding")
+		}
+		if len(data) == 0 {
+			return store.BatchEntry{}, errors.New("empty data not allowed")
+		}
+	}
+
+	entry := store.BatchEntry{
+		Path: a.Path,
+		Data: data,
+		Opts: store.AppendOptions{
+			Seq:         a.Seq,
+			ContentType: a.ContentType,
+			Close:       a.Close,
+		},
+	}
+	if hasAllProducer {
+		entry.Opts.ProducerId = a.ProducerId
+		entry.Opts.ProducerEpoch = a.ProducerEpoch
+		entry.Opts.ProducerSeq = a.ProducerSeq
+	}
+	return entry, nil
+}
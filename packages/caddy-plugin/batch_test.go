@@ -0,0 +1,159 @@
+package durablestreams
+
+import (
+	"encoding/json"
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"testing"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+)
+
+func postBatch(t *testing.T, h *Handler, body string) []batchResult {
+	t.Helper()
+	rec := httptest.NewRecorder()
+	req := httptest.NewRequest(http.MethodPost, batchPath, strings.NewReader(body))
+	if err := h.handleBatch(rec, req); err != nil {
+		t.Fatalf("handleBatch failed: %v", err)
+	}
+	if rec.Code != http.StatusOK {
+		t.Fatalf("expected 200, got %d", rec.Code)
+	}
+	var resp struct {
+		Results []batchResult `json:"results"`
+	}
+	if err := json.Unmarshal(rec.Body.Bytes(), &resp); err != nil {
+		t.Fatalf("invalid batch response %q: %v", rec.Body.String(), err)
+	}
+	return resp.Results
+}
+
+func TestBatch_AppendsAcrossStreams(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	h.store.Create("/json", store.CreateOptions{ContentType: "application/json"})
+	h.store.Create("/text", store.CreateOptions{ContentType: "text/plain"})
+	h.store.Create("/bin", store.CreateOptions{ContentType: "application/octet-stream"})
+
+	results := postBatch(t, h, `{"appends":[
+		{"path":"/json","contentType":"application/json","data":[{"n":1},{"n":2}]},
+		{"path":"/text","contentType":"text/plain","data":"hello","close":true},
+		{"path":"/bin","contentType":"application/octet-stream","data":"/wA=","encoding":"base64"},
+		{"path":"/missing","contentType":"text/plain","data":"x"},
+		{"path":"/text","contentType":"text/plain","data":"late"},
+		{"path":"/bin","contentType":"text/plain","data":"x"},
+		{"path":"/bin","contentType":"application/octet-stream","data":""}]}`)
+	if len(results) != 7 {
+		t.Fatalf("expected a result per entry, got %+v", results)
+	}
+
+	for i, want := range []int{
+		http.StatusNoContent, http.StatusNoContent, http.StatusNoContent,
+		http.StatusNotFound, http.StatusConflict, http.StatusConflict, http.StatusBadRequest,
+	} {
+		if results[i].Status != want {
+			t.Errorf("entry %d: expected status %d, got %+v", i, want, results[i])
+		}
+	}
+	if !results[1].Closed || !results[4].Closed {
+		t.Errorf("expected the closed stream to be reported, got %+v and %+v", results[1], results[4])
+	}
+
+	msgs, _, _ := h.store.Read("/json", store.ZeroOffset)
+	if len(msgs) != 2 || string(msgs[1].Data) != `{"n":2}` {
+		t.Errorf("expected the JSON array flattened into messages, got %v", msgs)
+	}
+	if results[0].NextOffset != msgs[1].Offset.String() {
+		t.Errorf("expected next offset %s, got %s", msgs[1].Offset, results[0].NextOffset)
+	}
+	msgs, _, _ = h.store.Read("/bin", store.ZeroOffset)
+	if len(msgs) != 1 || string(msgs[0].Data) != "\xff\x00" {
+		t.Errorf("expected decoded binary data, got %v", msgs)
+	}
+}
+
+func TestBatch_IdempotentProducers(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	h.store.Create("/a", store.CreateOptions{ContentType: "text/plain"})
+
+	results := postBatch(t, h, `{"appends":[
+		{"path":"/a","contentType":"text/plain","data":"one","producerId":"p","producerEpoch":0,"producerSeq":0},
+		{"path":"/a","contentType":"text/plain","data":"one","producerId":"p","producerEpoch":0,"producerSeq":0},
+		{"path":"/a","contentType":"text/plain","data":"three","producerId":"p","producerEpoch":0,"producerSeq":2},
+		{"path":"/a","contentType":"text/plain","data":"x","producerId":"p"}]}`)
+
+	if r := results[0]; r.Status != http.StatusOK || r.ProducerSeq == nil || *r.ProducerSeq != 0 {
+		t.Errorf("expected the first write accepted, got %+v", r)
+	}
+	if r := results[1]; r.Status != http.StatusNoContent {
+		t.Errorf("expected a duplicate, got %+v", r)
+	}
+	if r := results[2]; r.Status != http.StatusConflict || r.ExpectedSeq == nil || *r.ExpectedSeq != 1 || *r.ReceivedSeq != 2 {
+		t.Errorf("expected a sequence gap, got %+v", r)
+	}
+	if r := results[3]; r.Status != http.StatusBadRequest {
+		t.Errorf("expected partial producer fields to be rejected, got %+v", r)
+	}
+
+	msgs, _, _ := h.store.Read("/a", store.ZeroOffset)
+	if len(msgs) != 1 {
+		t.Errorf("expected one message, got %d", len(msgs))
+	}
+}
+
+func TestBatch_RejectsInvalidRequests(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	for name, req := range map[string]*http.Request{
+		"get":     httptest.NewRequest(http.MethodGet, batchPath, nil),
+		"no body": httptest.NewRequest(http.MethodPost, batchPath, strings.NewReader(``)),
+		"empty":   httptest.NewRequest(http.MethodPost, batchPath, strings.NewReader(`{"appends":[]}`)),
+	} {
+		if err := h.handleBatch(httptest.NewRecorder(), req); err == nil {
+			t.Errorf("%s: expected an error", name)
+		}
+	}
+}
+
+func TestBatch_ScopesEntriesToRoutePrefix(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	h.store.Create("/v1/stream/a", store.CreateOptions{ContentType: "text/plain"})
+	h.store.Create("/admin/a", store.CreateOptions{ContentType: "text/plain"})
+
+	rec := httptest.NewRecorder()
+	req := httptest.NewRequest(http.MethodPost, "/v1/stream"+batchPath, strings.NewReader(`{"appends":[
+		{"path":"/v1/stream/a","contentType":"text/plain","data":"in"},
+		{"path":"/admin/a","contentType":"text/plain","data":"out"},
+		{"path":"/v1/stream/../../admin/a","contentType":"text/plain","data":"out"},
+		{"path":"/v1/streamx/a","contentType":"text/plain","data":"out"},
+		{"path":"/v1/stream/x/__ds/batch","contentType":"text/plain","data":"out"}]}`))
+	if err := h.handleBatch(rec, req); err != nil {
+		t.Fatalf("handleBatch failed: %v", err)
+	}
+	var resp struct {
+		Results []batchResult `json:"results"`
+	}
+	if err := json.Unmarshal(rec.Body.Bytes(), &resp); err != nil {
+		t.Fatalf("invalid batch response %q: %v", rec.Body.String(), err)
+	}
+
+	for i, r := range resp.Results {
+		want := http.StatusBadRequest
+		if i == 0 {
+			want = http.StatusNoContent
+		}
+		if r.Status != want {
+			t.Errorf("entry %d: expected status %d, got %+v", i, want, r)
+		}
+	}
+	if msgs, _, _ := h.store.Read("/admin/a", store.ZeroOffset); len(msgs) != 0 {
+		t.Errorf("expected no appends outside the route, got %v", msgs)
+	}
+}
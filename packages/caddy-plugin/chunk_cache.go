@@ -0,0 +1,173 @@
+package durablestreams
+
+import (
+	"bytes"
+	"compress/gzip"
+	"container/list"
+	"strconv"
+	"strings"
+	"sync"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+)
+
+const (
+	// DefaultCompressedCacheBytes is the default memory budget for
+	// precompressed historical chunks
+	DefaultCompressedCacheBytes = 32 * 1024 * 1024
+
+	// compressMinSize is the smallest body worth compressing
+	compressMinSize = 1024
+)
+
+// Historical reads (responses short of the tail) never change: the same
+// stream, start offset and read limits always yield the same chunk. Such
+// chunks are gzip-compressed once and kept in chunkCache, so repeated
+// catch-up reads and CDN misses cost neither a segment read nor compression.
+
+// chunkKey identifies one historical chunk of one stream instance
+type chunkKey struct {
+	path      string
+	createdAt int64 // Distinguishes a stream from one recreated at its path
+	start     store.Offset
+	end       store.Offset
+}
+
+type chunkEntry struct {
+	key  chunkKey
+	body []byte
+}
+
+// chunkCache is a byte-bounded LRU of compressed chunks
+type chunkCache struct {
+	budget int64
+
+	mu      sync.Mutex
+	used    int64
+	lru     list.List // of *chunkEntry, most recently used first
+	entries map[chunkKey]*list.Element
+	perPath map[string]map[chunkKey]*list.Element // Entries by stream path
+}
+
+// newChunkCache returns a cache with the given budget (0 = default), or nil
+// if budget is negative (disabled).
+func newChunkCache(budget int64) *chunkCache {
+	if budget < 0 {
+		return nil
+	}
+	if budget == 0 {
+		budget = DefaultCompressedCacheBytes
+	}
+	return &chunkCache{
+		budget:  budget,
+		entries: make(map[chunkKey]*list.Element),
+		perPath: make(map[string]map[chunkKey]*list.Element),
+	}
+}
+
+func (c *chunkCache) get(key chunkKey) ([]byte, bool) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	elem, ok := c.entries[key]
+	if !ok {
+		return nil, false
+	}
+	c.lru.MoveToFront(elem)
+	return elem.Value.(*chunkEntry).body, true
+}
+
+func (c *chunkCache) add(key chunkKey, body []byte) {
+	if int64(len(body)) > c.budget {
+		return
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if _, ok := c.entries[key]; ok {
+		return
+	}
+	elem := c.lru.PushFront(&chunkEntry{key: key, body: body})
+	c.entries[key] = elem
+	keys := c.perPath[key.path]
+	if keys == nil {
+		keys = make(map[chunkKey]*list.Element)
+		c.perPath[key.path] = keys
+	}
+	keys[key] = elem
+	c.used += int64(len(body))
+
+	for c.used > c.budget {
+		c.removeLocked(c.lru.Back())
+	}
+}
+
+// dropPath removes all chunks of the stream at path
+func (c *chunkCache) dropPath(path string) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	for _, elem := range c.perPath[path] {
+		c.removeLocked(elem)
+	}
+}
+
+func (c *chunkCache) removeLocked(elem *list.Element) {
+	entry := c.lru.Remove(elem).(*chunkEntry)
+	delete(c.entries, entry.key)
+	keys := c.perPath[entry.key.path]
+	delete(keys, entry.key)
+	if len(keys) == 0 {
+		delete(c.perPath, entry.key.path)
+	}
+	c.used -= int64(len(entry.body))
+}
+
+var gzipWriters = sync.Pool{
+	New: func() any { return gzip.NewWriter(nil) },
+}
+
+// gzipBody compresses body, or returns nil if that does not make it smaller
+func gzipBody(body []byte) []byte {
+	var buf bytes.Buffer
+	buf.Grow(len(body) / 4)
+
+	zw := gzipWriters.Get().(*gzip.Writer)
+	defer gzipWriters.Put(zw)
+	zw.Reset(&buf)
+	if _, err := zw.Write(body); err != nil {
+		return nil
+	}
+	if err := zw.Close(); err != nil {
+		return nil
+	}
+	if buf.Len() >= len(body) {
+		return nil
+	}
+	return buf.Bytes()
+}
+
+// acceptsGzip reports whether an Accept-Encoding header admits gzip
+func acceptsGzip(header string) bool {
+	accepted := false
+	for _, part := range strings.Split(header, ",") {
+		name, params, _ := strings.Cut(strings.TrimSpace(part), ";")
+		name = strings.ToLower(strings.TrimSpace(name))
+		if name != "gzip" && name != "*" {
+			continue
+		}
+
+		ok := true
+		for _, param := range strings.Split(params, ";") {
+			k, v, _ := strings.Cut(strings.TrimSpace(param), "=")
+			if strings.EqualFold(k, "q") {
+				q, err := strconv.ParseFloat(v, 64)
+				ok = err == nil && q > 0
+			}
+		}
+		if name == "gzip" {
+			// An explicit gzip entry overrides the wildcard
+			return ok
+		}
+		accepted = accepted || ok
+	}
+	return accepted
+}
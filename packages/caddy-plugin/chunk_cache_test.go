@@ -0,0 +1,177 @@
+package durablestreams
+
+import (
+	"bytes"
+	"compress/gzip"
+	"fmt"
+	"io"
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"testing"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+)
+
+func TestAcceptsGzip(t *testing.T) {
+	cases := map[string]bool{
+		"":                        false,
+		"gzip":                    true,
+		"br, gzip, deflate":       true,
+		"GZIP;q=0.5":              true,
+		"gzip;q=0":                false,
+		"*":                       true,
+		"*;q=0":                   false,
+		"identity":                false,
+		"*, gzip;q=0":             false,
+		"deflate, br;q=1.0, zstd": false,
+	}
+	for header, want := range cases {
+		if got := acceptsGzip(header); got != want {
+			t.Errorf("acceptsGzip(%q) = %v, want %v", header, got, want)
+		}
+	}
+}
+
+func TestChunkCache_EvictsToBudget(t *testing.T) {
+	c := newChunkCache(10)
+	c.add(chunkKey{path: "/a", end: store.Offset{ByteOffset: 1}}, make([]byte, 4))
+	c.add(chunkKey{path: "/a", end: store.Offset{ByteOffset: 2}}, make([]byte, 4))
+	c.add(chunkKey{path: "/b", end: store.Offset{ByteOffset: 3}}, make([]byte, 4))
+
+	if _, ok := c.get(chunkKey{path: "/a", end: store.Offset{ByteOffset: 1}}); ok {
+		t.Error("expected the least recently used chunk to be evicted")
+	}
+	if c.used != 8 {
+		t.Errorf("expected 8 bytes in use, got %d", c.used)
+	}
+
+	c.dropPath("/a")
+	if _, ok := c.get(chunkKey{path: "/a", end: store.Offset{ByteOffset: 2}}); ok {
+		t.Error("expected dropPath to remove the stream's chunks")
+	}
+	if _, ok := c.get(chunkKey{path: "/b", end: store.Offset{ByteOffset: 3}}); !ok {
+		t.Error("expected other streams' chunks to be kept")
+	}
+}
+
+func TestChunkCache_DropPathKeepsOtherStreams(t *testing.T) {
+	c := newChunkCache(1024)
+	for i := uint64(1); i <= 3; i++ {
+		c.add(chunkKey{path: "/a", end: store.Offset{ByteOffset: i}}, make([]byte, 4))
+		c.add(chunkKey{path: "/b", end: store.Offset{ByteOffset: i}}, make([]byte, 4))
+	}
+
+	c.dropPath("/a")
+	for i := uint64(1); i <= 3; i++ {
+		if _, ok := c.get(chunkKey{path: "/a", end: store.Offset{ByteOffset: i}}); ok {
+			t.Errorf("expected chunk %d of the dropped stream to be removed", i)
+		}
+		if _, ok := c.get(chunkKey{path: "/b", end: store.Offset{ByteOffset: i}}); !ok {
+			t.Errorf("expected chunk %d of the other stream to survive", i)
+		}
+	}
+	if c.used != 12 || c.lru.Len() != 3 || len(c.perPath["/b"]) != 3 {
+		t.Errorf("expected 3 chunks / 12 bytes of /b left, got %d chunks / %d bytes", c.lru.Len(), c.used)
+	}
+	if _, ok := c.perPath["/a"]; ok {
+		t.Error("expected the dropped stream's index to be released")
+	}
+
+	// Evicting the last chunk of a stream releases its index too
+	c.budget = 4
+	c.add(chunkKey{path: "/c", end: store.Offset{ByteOffset: 1}}, make([]byte, 4))
+	if _, ok := c.perPath["/b"]; ok || len(c.perPath["/c"]) != 1 {
+		t.Errorf("expected only /c indexed after eviction, got %v", c.perPath)
+	}
+}
+
+func TestHandleRead_ServesHistoricalChunksGzipped(t *testing.T) {
+	h := &Handler{
+		MaxReadBytes: 4096,
+		store:        store.NewMemoryStore(),
+		chunkCache:   newChunkCache(0),
+	}
+	defer h.store.Close()
+
+	if _, _, err := h.store.Create("/s", store.CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("create failed: %v", err)
+	}
+	for i := 0; i < 20; i++ {
+		msg := fmt.Sprintf("message-%02d %s", i, strings.Repeat("x", 1000))
+		if _, err := h.store.Append("/s", []byte(msg), store.AppendOptions{}); err != nil {
+			t.Fatalf("append failed: %v", err)
+		}
+	}
+
+	read := func(headers map[string]string) *httptest.ResponseRecorder {
+		t.Helper()
+		req := httptest.NewRequest(http.MethodGet, "/s?offset=-1", nil)
+		for k, v := range headers {
+			req.Header.Set(k, v)
+		}
+		rec := httptest.NewRecorder()
+		if err := h.handleRead(rec, req, "/s"); err != nil {
+			t.Fatalf("read failed: %v", err)
+		}
+		return rec
+	}
+
+	plain := read(nil)
+	if plain.Header().Get("Content-Encoding") != "" {
+		t.Fatalf("expected an identity response without Accept-Encoding")
+	}
+	if plain.Header().Get(HeaderStreamUpToDate) != "" {
+		t.Fatalf("expected a historical chunk short of the tail")
+	}
+
+	for i := 0; i < 2; i++ {
+		rec := read(map[string]string{"Accept-Encoding": "gzip"})
+		if rec.Header().Get("Content-Encoding") != "gzip" {
+			t.Fatalf("request %d: expected a gzip response, got headers %v", i, rec.Header())
+		}
+		if rec.Header().Get("Vary") != "Accept-Encoding" {
+			t.Errorf("expected Vary: Accept-Encoding, got %q", rec.Header().Get("Vary"))
+		}
+		if rec.Header().Get("ETag") == plain.Header().Get("ETag") {
+			t.Errorf("expected the gzip ETag to differ from the identity one")
+		}
+		zr, err := gzip.NewReader(rec.Body)
+		if err != nil {
+			t.Fatalf("invalid gzip body: %v", err)
+		}
+		body, err := io.ReadAll(zr)
+		if err != nil {
+			t.Fatalf("failed to decompress: %v", err)
+		}
+		if !bytes.Equal(body, plain.Body.Bytes()) {
+			t.Errorf("decompressed body differs from the identity response")
+		}
+	}
+	if len(h.chunkCache.entries) != 1 {
+		t.Errorf("expected one cached chunk, got %d", len(h.chunkCache.entries))
+	}
+
+	gzipETag := read(map[string]string{"Accept-Encoding": "gzip"}).Header().Get("ETag")
+	if rec := read(map[string]string{"Accept-Encoding": "gzip", "If-None-Match": gzipETag}); rec.Code != http.StatusNotModified {
+		t.Errorf("expected 304 for the gzip ETag, got %d", rec.Code)
+	}
+
+	// The tail chunk is still growing and is left to the client's encoding
+	tail := fmt.Sprintf("/s?offset=%s", plain.Header().Get(HeaderStreamNextOffset))
+	for tail != "" {
+		req := httptest.NewRequest(http.MethodGet, tail, nil)
+		req.Header.Set("Accept-Encoding", "gzip")
+		rec := httptest.NewRecorder()
+		if err := h.handleRead(rec, req, "/s"); err != nil {
+			t.Fatalf("read failed: %v", err)
+		}
+		if rec.Header().Get(HeaderStreamUpToDate) == "true" {
+			if rec.Header().Get("Content-Encoding") != "" {
+				t.Errorf("expected the up-to-date chunk uncompressed")
+			}
+			break
+		}
+		tail = fmt.Sprintf("/s?offset=%s", rec.Header().Get(HeaderStreamNextOffset))
+	}
+}
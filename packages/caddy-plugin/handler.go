@@ -1,9 +1,8 @@
 package durablestreams
 
 import (
+	"bytes"
 	"context"
-	"encoding/base64"
-	"encoding/json"
 	"errors"
 	"fmt"
 	"io"
@@ -14,6 +13,7 @@ import (
 	"time"
 
 	"github.com/caddyserver/caddy/v2/modules/caddyhttp"
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/metrics"
 	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
 	"go.uber.org/zap"
 )
@@ -50,10 +50,16 @@ var sseLineTerminators = regexp.MustCompile(`\r\n|\r|\n`)
 
 // ServeHTTP implements caddyhttp.MiddlewareHandler
 func (h *Handler) ServeHTTP(w http.ResponseWriter, r *http.Request, next caddyhttp.Handler) error {
+	// Followers forward writes to the leader, whose response is passed on
+	if h.follower != nil && h.follower.forwards(r) {
+		h.follower.proxy.ServeHTTP(w, r)
+		return nil
+	}
+
 	// Set CORS headers
 	w.Header().Set("Access-Control-Allow-Origin", "*")
 	w.Header().Set("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, HEAD, OPTIONS")
-	w.Header().Set("Access-Control-Allow-Headers", "Content-Type, Stream-Seq, Stream-TTL, Stream-Expires-At, Stream-Closed, If-None-Match, Producer-Id, Producer-Epoch, Producer-Seq, Stream-Forked-From, Stream-Fork-Offset, Stream-Fork-Sub-Offset, Authorization")
+	w.Header().Set("Access-Control-Allow-Headers", "Content-Type, Stream-Seq, Stream-TTL, Stream-Expires-At, Stream-Closed, If-None-Match, Content-Encoding, Producer-Id, Producer-Epoch, Producer-Seq, Stream-Forked-From, Stream-Fork-Offset, Stream-Fork-Sub-Offset, Authorization")
 	w.Header().Set("Access-Control-Expose-Headers", "Stream-Next-Offset, Stream-Cursor, Stream-Up-To-Date, Stream-Closed, ETag, Location, Producer-Epoch, Producer-Seq, Producer-Expected-Seq, Producer-Received-Seq")
 
 	// Browser security headers (Protocol Section 10.7)
@@ -73,6 +79,27 @@ func (h *Handler) ServeHTTP(w http.ResponseWriter, r *http.Request, next caddyht
 		}
 	}
 
+	if isBatchPath(r.URL.Path) {
+		if err := h.handleBatch(w, r); err != nil {
+			h.writeError(w, err)
+		}
+		return nil
+	}
+
+	if isMultiplexPath(r.URL.Path) {
+		if err := h.handleMultiplex(w, r); err != nil {
+			h.writeError(w, err)
+		}
+		return nil
+	}
+
+	if isReplicationPath(r.URL.Path) {
+		if err := h.handleReplication(w, r); err != nil {
+			h.writeError(w, err)
+		}
+		return nil
+	}
+
 	// Extract stream path from URL
 	streamPath := r.URL.Path
 
@@ -408,16 +435,28 @@ func (h *Handler) handleRead(w http.ResponseWriter, r *http.Request, path string
 		return nil
 	}
 
-	// Read messages
-	messages, _, err := h.store.Read(path, effectiveOffset)
+	// Read messages, bounded to one chunk. A partial chunk leaves nextOffset
+	// short of the tail, so the response omits Stream-Up-To-Date.
+	// Chunks from a store that supports it are left in the segment files and
+	// copied straight to the response (JSON ones framed as an array on the way).
+	var messages []store.Message
+	var raw *store.RawChunk
+	if rawReader, ok := h.store.(store.RawReader); ok {
+		raw, err = rawReader.ReadRaw(path, effectiveOffset, h.readLimits())
+	} else {
+		messages, _, err = h.store.ReadWithLimits(path, effectiveOffset, h.readLimits())
+	}
 	if err != nil {
 		return err
 	}
+	hasData := len(messages) > 0 || (raw != nil && raw.Len() > 0)
 
 	// Calculate next offset
 	nextOffset := effectiveOffset
 	if len(messages) > 0 {
 		nextOffset = messages[len(messages)-1].Offset
+	} else if raw != nil && raw.Len() > 0 {
+		nextOffset = raw.NextOffset
 	} else {
 		// No new messages, use current offset from metadata
 		nextOffset = meta.CurrentOffset
@@ -426,7 +465,7 @@ func (h *Handler) handleRead(w http.ResponseWriter, r *http.Request, path string
 	// Handle long-poll mode - wait if no messages and either:
 	// 1. Client used offset=now (wants to wait for future data)
 	// 2. Client is caught up (at the tail)
-	shouldWait := liveMode == "long-poll" && len(messages) == 0 && (isNowOffset || effectiveOffset.Equal(meta.CurrentOffset))
+	shouldWait := liveMode == "long-poll" && !hasData && (isNowOffset || effectiveOffset.Equal(meta.CurrentOffset))
 	if shouldWait {
 		// If stream is closed and client is at tail, return immediately (don't wait)
 		if meta.Closed {
@@ -446,7 +485,9 @@ func (h *Handler) handleRead(w http.ResponseWriter, r *http.Request, path string
 
 		var timedOut bool
 		var streamClosed bool
-		messages, timedOut, streamClosed, err = h.store.WaitForMessages(ctx, path, effectiveOffset, timeout)
+		metrics.LongPolls.Inc()
+		messages, timedOut, streamClosed, err = h.store.WaitForMessages(ctx, path, effectiveOffset, timeout, h.readLimits())
+		metrics.LongPolls.Dec()
 		if err != nil {
 			if errors.Is(err, context.Canceled) || errors.Is(err, context.DeadlineExceeded) {
 				// Timeout or client disconnect - return 204 with current offset
@@ -492,7 +533,8 @@ func (h *Handler) handleRead(w http.ResponseWriter, r *http.Request, path string
 		}
 
 		// Got new messages - update nextOffset
-		if len(messages) > 0 {
+		hasData = len(messages) > 0
+		if hasData {
 			nextOffset = messages[len(messages)-1].Offset
 		}
 	}
@@ -522,34 +564,120 @@ func (h *Handler) handleRead(w http.ResponseWriter, r *http.Request, path string
 		w.Header().Set(HeaderStreamCursor, responseCursor)
 	}
 
-	// Set ETag for caching
-	w.Header().Set("ETag", fmt.Sprintf(`"%s"`, nextOffset.String()))
+	// Historical chunks are immutable, so their gzip encoding is computed
+	// once and served from the chunk cache
+	var compressed []byte
+	if !upToDate && hasData && h.chunkCache != nil {
+		w.Header().Add("Vary", "Accept-Encoding")
+		if acceptsGzip(r.Header.Get("Accept-Encoding")) {
+			key := chunkKey{path: path, createdAt: meta.CreatedAt.UnixNano(), start: effectiveOffset, end: nextOffset}
+			compressed, err = h.compressedChunk(key, raw, messages, meta.ContentType)
+			if err != nil {
+				return err
+			}
+		}
+	}
+
+	// Set ETag for caching. Each encoding is a distinct representation.
+	etag := fmt.Sprintf(`"%s"`, nextOffset.String())
+	gzipETag := fmt.Sprintf(`"%s:gzip"`, nextOffset.String())
+	if compressed != nil {
+		w.Header().Set("ETag", gzipETag)
+	} else {
+		w.Header().Set("ETag", etag)
+	}
 
 	// Set caching headers for historical reads
-	if !upToDate && len(messages) > 0 {
+	if !upToDate && hasData {
 		w.Header().Set("Cache-Control", "public, max-age=60, stale-while-revalidate=300")
 	}
 
-	// Check If-None-Match for 304
+	// Check If-None-Match for 304. Either encoding's ETag validates the
+	// cached copy, since both carry the same chunk.
 	if ifNoneMatch := r.Header.Get("If-None-Match"); ifNoneMatch != "" {
-		expectedETag := fmt.Sprintf(`"%s"`, nextOffset.String())
-		if ifNoneMatch == expectedETag {
+		if ifNoneMatch == etag || ifNoneMatch == gzipETag {
 			w.WriteHeader(http.StatusNotModified)
 			return nil
 		}
 	}
 
+	if compressed != nil {
+		w.Header().Set("Content-Encoding", "gzip")
+		w.Header().Set("Content-Length", strconv.Itoa(len(compressed)))
+		w.WriteHeader(http.StatusOK)
+		writeStart := time.Now()
+		n, _ := w.Write(compressed)
+		metrics.Since(metrics.ReadWrite, writeStart)
+		metrics.BytesServedGzip.Add(float64(n))
+		return nil
+	}
+
+	// Copy a raw chunk from the segment files. With Content-Length set the
+	// response is not chunked, so large payloads can go out via sendfile.
+	// Segment reads happen during the copy, so they count as the write.
+	if raw != nil && raw.Len() > 0 {
+		w.Header().Set("Content-Length", strconv.FormatInt(raw.Size, 10))
+		w.WriteHeader(http.StatusOK)
+		writeStart := time.Now()
+		n, _ := raw.WriteTo(w)
+		metrics.Since(metrics.ReadWrite, writeStart)
+		metrics.BytesServedIdentity.Add(float64(n))
+		return nil
+	}
+
 	// Format and write response
+	formatStart := time.Now()
 	body, err := h.formatResponse(path, messages, meta.ContentType)
 	if err != nil {
 		return err
 	}
+	writeStart := time.Now()
+	metrics.ReadFormat.Observe(writeStart.Sub(formatStart).Seconds())
 
 	w.WriteHeader(http.StatusOK)
-	w.Write(body)
+	n, _ := w.Write(body)
+	metrics.Since(metrics.ReadWrite, writeStart)
+	metrics.BytesServedIdentity.Add(float64(n))
 	return nil
 }
 
+// compressedChunk returns the gzip encoding of a historical chunk, from the
+// chunk cache when possible. It returns nil if the chunk is too small or
+// does not compress.
+func (h *Handler) compressedChunk(key chunkKey, raw *store.RawChunk, messages []store.Message, contentType string) ([]byte, error) {
+	if body, ok := h.chunkCache.get(key); ok {
+		return body, nil
+	}
+
+	var body []byte
+	if raw != nil && raw.Len() > 0 {
+		if raw.Size < compressMinSize {
+			return nil, nil
+		}
+		var buf bytes.Buffer
+		buf.Grow(int(raw.Size))
+		if _, err := raw.WriteTo(&buf); err != nil {
+			return nil, err
+		}
+		body = buf.Bytes()
+	} else {
+		var err error
+		body, err = h.formatResponse(key.path, messages, contentType)
+		if err != nil {
+			return nil, err
+		}
+	}
+	if len(body) < compressMinSize {
+		return nil, nil
+	}
+
+	compressed := gzipBody(body)
+	if compressed != nil {
+		h.chunkCache.add(key, compressed)
+	}
+	return compressed, nil
+}
+
 // Cursor epoch: October 9, 2024 00:00:00 UTC
 var cursorEpoch = time.Date(2024, 10, 9, 0, 0, 0, 0, time.UTC)
 
@@ -627,12 +755,29 @@ func (h *Handler) handleSSE(w http.ResponseWriter, r *http.Request, path string,
 	w.WriteHeader(http.StatusOK)
 	flusher.Flush()
 
+	metrics.SSEConnections.Inc()
+	defer metrics.SSEConnections.Dec()
+
 	ctx := r.Context()
 	reconnectTimer := time.NewTimer(time.Duration(h.SSEReconnectInterval))
 	defer reconnectTimer.Stop()
 
-	currentOffset := offset
-	sentInitialControl := false
+	conn := &sseConn{
+		w:         w,
+		flusher:   flusher,
+		cursor:    cursor,
+		useBase64: useBase64,
+		offset:    offset,
+	}
+
+	// Join the stream's hub before catching up, so anything appended while
+	// we read the backlog either lands in this read or arrives as a frame
+	sub := h.sseHubs.subscribe(h, path, meta.ContentType, useBase64, nil)
+	defer func() { h.sseHubs.unsubscribe(sub) }()
+
+	if done, err := h.sseCatchUp(path, meta.ContentType, conn); done || err != nil {
+		return err
+	}
 
 	for {
 		select {
@@ -641,134 +786,162 @@ func (h *Handler) handleSSE(w http.ResponseWriter, r *http.Request, path string,
 		case <-reconnectTimer.C:
 			// Close connection to allow CDN collapsing
 			return nil
-		default:
-			// Read any available messages
-			messages, upToDate, err := h.store.Read(path, currentOffset)
-			if err != nil {
+		case <-sub.lagged:
+			// Frames were dropped while this connection was slow: read what
+			// it missed from the store
+			if done, err := h.sseCatchUp(path, meta.ContentType, conn); done || err != nil {
 				return err
 			}
-
-			// Re-fetch current metadata to check closed state
-			currentMeta, _ := h.store.Get(path)
-			streamIsClosed := currentMeta != nil && currentMeta.Closed
-
-			if len(messages) > 0 {
-				// Send data event
-				body, _ := h.formatResponse(path, messages, meta.ContentType)
-				fmt.Fprintf(w, "event: data\n")
-
-				if useBase64 {
-					// Base64 encode the binary data for SSE delivery (Protocol Section 5.7)
-					encoded := base64.StdEncoding.EncodeToString(body)
-					fmt.Fprintf(w, "data:%s\n", encoded)
-				} else {
-					// Split on all SSE-valid line terminators (CRLF, CR, LF) to prevent injection
-					// Note: Per SSE spec, we don't add a space after "data:" because clients
-					// strip exactly one leading space. Adding one would cause data starting
-					// with spaces to lose an extra space character.
-					for _, line := range sseLineTerminators.Split(string(body), -1) {
-						fmt.Fprintf(w, "data:%s\n", line)
-					}
-				}
-				fmt.Fprintf(w, "\n")
-
-				// Update current offset
-				currentOffset = messages[len(messages)-1].Offset
-
-				// Check if client is now at tail of closed stream
-				clientAtTail := currentMeta != nil && currentOffset.Equal(currentMeta.CurrentOffset)
-
-				// Build control event
-				control := map[string]interface{}{
-					"streamNextOffset": currentOffset.String(),
+		case frame, ok := <-sub.frames:
+			if !ok {
+				// The hub stopped: the store has the final word on whether
+				// the stream closed, went away, or should get a new hub
+				h.sseHubs.unsubscribe(sub)
+				sub = h.sseHubs.subscribe(h, path, meta.ContentType, useBase64, nil)
+				if done, err := h.sseCatchUp(path, meta.ContentType, conn); done || err != nil {
+					return err
 				}
+				continue
+			}
+			if done, err := h.sseDeliver(path, meta.ContentType, conn, frame); done || err != nil {
+				return err
+			}
+		}
+	}
+}
 
-				if streamIsClosed && clientAtTail {
-					// Final control event - stream is closed
-					// streamCursor is omitted when streamClosed is true per protocol
-					// upToDate is implied by streamClosed per protocol
-					control["streamClosed"] = true
-				} else {
-					// Normal control event - include cursor
-					control["streamCursor"] = generateResponseCursor(cursor)
-					if upToDate {
-						control["upToDate"] = true
-					}
-				}
+// sseConn is the per-stream state of an SSE response
+type sseConn struct {
+	w           http.ResponseWriter
+	flusher     http.Flusher
+	cursor      string
+	useBase64   bool
+	offset      store.Offset // Offset after the last data event sent
+	sentControl bool
+
+	// stream is the path tagged on the control events of a multiplexed
+	// response, which flushes once per batch of events rather than per
+	// write. Empty for a single-stream response.
+	stream       string
+	dataEncoding string // Encoding named in multiplexed control events
+}
 
-				controlJSON, _ := json.Marshal(control)
-				fmt.Fprintf(w, "event: control\n")
-				fmt.Fprintf(w, "data:%s\n\n", controlJSON)
+// write sends encoded events and flushes them
+func (c *sseConn) write(events ...[]byte) {
+	for _, event := range events {
+		c.w.Write(event)
+	}
+	if c.stream == "" {
+		c.flusher.Flush()
+	}
+	c.sentControl = true
+}
 
-				flusher.Flush()
-				sentInitialControl = true
+// control encodes a control event for this connection
+func (c *sseConn) control(nextOffset store.Offset, upToDate, closed bool) []byte {
+	if c.stream != "" {
+		return encodeMultiplexControl(c.stream, nextOffset, upToDate, closed, c.dataEncoding)
+	}
+	cursor := ""
+	if !closed {
+		cursor = generateResponseCursor(c.cursor)
+	}
+	return encodeSSEControl(nextOffset, cursor, upToDate, closed)
+}
 
-				// Close SSE connection after sending streamClosed
-				if streamIsClosed && clientAtTail {
-					return nil
-				}
-			} else if !sentInitialControl {
-				// Send initial control event even for empty stream
-				// Check if stream is already closed and client is at tail
-				clientAtTail := currentMeta != nil && offset.Equal(currentMeta.CurrentOffset)
+// writeFrame sends a hub frame that starts at c.offset
+func (c *sseConn) writeFrame(frame *sseFrame) {
+	if frame.data != nil {
+		c.w.Write(frame.data)
+	}
+	if c.stream != "" {
+		c.write(c.control(frame.end, frame.upToDate, frame.closed))
+	} else {
+		c.write(frame.control(c.cursor))
+	}
+	c.offset = frame.end
+}
 
-				control := map[string]interface{}{
-					"streamNextOffset": currentMeta.CurrentOffset.String(),
-				}
+// sseDeliver sends a hub frame, or catches up from the store if the frame
+// doesn't line up with what c has sent. Returns done once the final
+// streamClosed control event has been sent.
+func (h *Handler) sseDeliver(path, contentType string, c *sseConn, frame *sseFrame) (bool, error) {
+	switch {
+	case frame.start.Equal(c.offset):
+		c.writeFrame(frame)
+		return frame.closed, nil
+	case frame.end.LessThanOrEqual(c.offset):
+		// Already delivered by a direct read
+		return false, nil
+	default:
+		// The frame doesn't line up with what this connection has sent;
+		// read the difference directly
+		return h.sseCatchUp(path, contentType, c)
+	}
+}
 
-				if streamIsClosed && clientAtTail {
-					// Stream already closed at tail - send final control and exit
-					control["streamClosed"] = true
-				} else {
-					// Normal initial control
-					control["streamCursor"] = generateResponseCursor(cursor)
-					control["upToDate"] = true
-				}
+// sseCatchUp sends everything from c.offset to the current tail with direct
+// store reads. Returns done once the final streamClosed control event has
+// been sent.
+func (h *Handler) sseCatchUp(path, contentType string, c *sseConn) (bool, error) {
+	for {
+		// Read any available messages
+		messages, upToDate, err := h.store.ReadWithLimits(path, c.offset, h.readLimits())
+		if err != nil {
+			return false, err
+		}
 
-				controlJSON, _ := json.Marshal(control)
-				fmt.Fprintf(w, "event: control\n")
-				fmt.Fprintf(w, "data:%s\n\n", controlJSON)
+		// Re-fetch current metadata to check closed state
+		currentMeta, _ := h.store.Get(path)
+		if currentMeta == nil {
+			return false, nil
+		}
+		streamIsClosed := currentMeta.Closed
 
-				flusher.Flush()
-				sentInitialControl = true
+		if len(messages) > 0 {
+			// Send data event
+			body, _ := h.formatResponse(path, messages, contentType)
+			c.offset = messages[len(messages)-1].Offset
+
+			// Check if client is now at tail of closed stream
+			// streamCursor is omitted when streamClosed is true per protocol
+			// upToDate is implied by streamClosed per protocol
+			final := streamIsClosed && c.offset.Equal(currentMeta.CurrentOffset)
+			c.write(
+				encodeSSEData(body, c.useBase64),
+				c.control(c.offset, upToDate, final),
+			)
+
+			// Close SSE connection after sending streamClosed
+			if final {
+				return true, nil
+			}
 
-				// Close connection if stream is closed
-				if streamIsClosed && clientAtTail {
-					return nil
-				}
-			} else if streamIsClosed {
-				// Initial control was already sent and the stream has since been
-				// closed with no further data to deliver (e.g. a close-only
-				// request). Emit the final control event with streamClosed and
-				// close the connection. (Data appended atomically with a close is
-				// handled by the len(messages) > 0 branch above on this same
-				// iteration.)
-				clientAtTail := currentMeta != nil && currentOffset.Equal(currentMeta.CurrentOffset)
-				if clientAtTail {
-					control := map[string]interface{}{
-						"streamNextOffset": currentOffset.String(),
-						"streamClosed":     true,
-					}
-					controlJSON, _ := json.Marshal(control)
-					fmt.Fprintf(w, "event: control\n")
-					fmt.Fprintf(w, "data:%s\n\n", controlJSON)
-					flusher.Flush()
-					return nil
-				}
+			// A partial chunk means more data is already available: read the
+			// next chunk right away
+			if !upToDate {
+				continue
 			}
+			return false, nil
+		}
+
+		clientAtTail := c.offset.Equal(currentMeta.CurrentOffset)
+		if !c.sentControl {
+			// Send initial control event even for empty stream. If the stream
+			// is already closed at the client's offset this is the final one.
+			final := streamIsClosed && clientAtTail
+			c.write(c.control(currentMeta.CurrentOffset, true, final))
+			return final, nil
+		}
 
-			// Wait for more data or stream closure, then loop back to the top
-			// of the loop. We deliberately do NOT emit the closing control event
-			// here: if the stream was closed with a final append, that data must
-			// be drained by the Read at the top of the next iteration and sent as
-			// a data event before the closing control event. Emitting it here
-			// (with the stale currentOffset) would silently drop the final append
-			// for a live reader that was caught up at the tail.
-			timeout := 100 * time.Millisecond
-			waitCtx, cancel := context.WithTimeout(ctx, timeout)
-			h.store.WaitForMessages(waitCtx, path, currentOffset, timeout)
-			cancel()
+		if streamIsClosed && clientAtTail {
+			// Initial control was already sent and the stream has since been
+			// closed with no further data to deliver (e.g. a close-only
+			// request). Emit the final control event and close the connection.
+			c.write(c.control(c.offset, false, true))
+			return true, nil
 		}
+		return false, nil
 	}
 }
 
@@ -793,9 +966,16 @@ func (h *Handler) handleAppend(w http.ResponseWriter, r *http.Request, path stri
 	// Check for Content-Type header
 	contentType := r.Header.Get("Content-Type")
 
-	// Read body
-	body, err := io.ReadAll(r.Body)
+	// Read body, inflating it if the client compressed it
+	body, err := readRequestBody(r)
 	if err != nil {
+		switch {
+		case errors.Is(err, errUnsupportedEncoding):
+			w.Header().Set("Accept-Encoding", "gzip")
+			return newHTTPError(http.StatusUnsupportedMediaType, "unsupported Content-Encoding: only gzip is accepted")
+		case errors.Is(err, errInflatedTooLarge):
+			return newHTTPError(http.StatusRequestEntityTooLarge, "inflated body too large")
+		}
 		return newHTTPError(http.StatusBadRequest, "failed to read body")
 	}
 
@@ -922,46 +1102,26 @@ func (h *Handler) handleAppend(w http.ResponseWriter, r *http.Request, path stri
 
 	result, err := h.store.Append(path, body, opts)
 	if err != nil {
-		if errors.Is(err, store.ErrStreamClosed) {
+		status, message, ok := appendErrorStatus(err)
+		if !ok {
+			return err
+		}
+		switch {
+		case errors.Is(err, store.ErrStreamClosed):
 			w.Header().Set(HeaderStreamClosed, "true")
 			w.Header().Set(HeaderStreamNextOffset, result.Offset.String())
-			http.Error(w, "stream is closed", http.StatusConflict)
-			return nil
-		}
-		if errors.Is(err, store.ErrSequenceConflict) {
-			return newHTTPError(http.StatusConflict, "sequence number conflict")
-		}
-		if errors.Is(err, store.ErrContentTypeMismatch) {
-			return newHTTPError(http.StatusConflict, "content type mismatch")
-		}
-		if errors.Is(err, store.ErrInvalidJSON) {
-			return newHTTPError(http.StatusBadRequest, "invalid JSON")
-		}
-		if errors.Is(err, store.ErrEmptyJSONArray) {
-			return newHTTPError(http.StatusBadRequest, "empty JSON array not allowed")
-		}
-		if errors.Is(err, store.ErrPartialProducer) {
-			return newHTTPError(http.StatusBadRequest, "all producer headers (Producer-Id, Producer-Epoch, Producer-Seq) must be provided together")
-		}
-		if errors.Is(err, store.ErrStaleEpoch) {
+		case errors.Is(err, store.ErrStaleEpoch):
 			// 403 Forbidden - stale epoch (zombie fencing)
 			w.Header().Set(HeaderStreamNextOffset, result.Offset.String())
 			w.Header().Set(HeaderProducerEpoch, strconv.FormatInt(result.CurrentEpoch, 10))
-			http.Error(w, "producer epoch is stale", http.StatusForbidden)
-			return nil
-		}
-		if errors.Is(err, store.ErrInvalidEpochSeq) {
-			return newHTTPError(http.StatusBadRequest, "new epoch must start at sequence 0")
-		}
-		if errors.Is(err, store.ErrProducerSeqGap) {
+		case errors.Is(err, store.ErrProducerSeqGap):
 			// 409 Conflict - sequence gap
 			w.Header().Set(HeaderStreamNextOffset, result.Offset.String())
 			w.Header().Set(HeaderProducerExpectedSeq, strconv.FormatInt(result.ExpectedSeq, 10))
 			w.Header().Set(HeaderProducerReceivedSeq, strconv.FormatInt(result.ReceivedSeq, 10))
-			http.Error(w, "producer sequence gap detected", http.StatusConflict)
-			return nil
 		}
-		return err
+		http.Error(w, message, status)
+		return nil
 	}
 
 	w.Header().Set(HeaderStreamNextOffset, result.Offset.String())
@@ -999,9 +1159,44 @@ func (h *Handler) handleAppend(w http.ResponseWriter, r *http.Request, path stri
 	return nil
 }
 
+// appendErrorStatus maps an Append error to its response status and
+// message. ok is false for errors that are not the client's doing.
+func appendErrorStatus(err error) (status int, message string, ok bool) {
+	switch {
+	case errors.Is(err, store.ErrStreamNotFound):
+		return http.StatusNotFound, "stream not found", true
+	case errors.Is(err, store.ErrStreamSoftDeleted):
+		return http.StatusGone, "stream has been deleted", true
+	case errors.Is(err, store.ErrStreamClosed):
+		return http.StatusConflict, "stream is closed", true
+	case errors.Is(err, store.ErrSequenceConflict):
+		return http.StatusConflict, "sequence number conflict", true
+	case errors.Is(err, store.ErrContentTypeMismatch):
+		return http.StatusConflict, "content type mismatch", true
+	case errors.Is(err, store.ErrInvalidJSON):
+		return http.StatusBadRequest, "invalid JSON", true
+	case errors.Is(err, store.ErrEmptyJSONArray):
+		return http.StatusBadRequest, "empty JSON array not allowed", true
+	case errors.Is(err, store.ErrPartialProducer):
+		return http.StatusBadRequest, "all producer headers (Producer-Id, Producer-Epoch, Producer-Seq) must be provided together", true
+	case errors.Is(err, store.ErrStaleEpoch):
+		return http.StatusForbidden, "producer epoch is stale", true
+	case errors.Is(err, store.ErrInvalidEpochSeq):
+		return http.StatusBadRequest, "new epoch must start at sequence 0", true
+	case errors.Is(err, store.ErrProducerSeqGap):
+		return http.StatusConflict, "producer sequence gap detected", true
+	}
+	return 0, "", false
+}
+
 // handleDelete handles DELETE requests to delete a stream
 func (h *Handler) handleDelete(w http.ResponseWriter, r *http.Request, path string) error {
 	err := h.store.Delete(path)
+	if h.chunkCache != nil {
+		// Recreated streams already miss these chunks (see chunkKey);
+		// drop them now rather than waiting for eviction
+		h.chunkCache.dropPath(path)
+	}
 	if err != nil {
 		if errors.Is(err, store.ErrStreamNotFound) {
 			return newHTTPError(http.StatusNotFound, "stream not found")
@@ -1021,6 +1216,14 @@ func (h *Handler) handleDelete(w http.ResponseWriter, r *http.Request, path stri
 	return nil
 }
 
+// readLimits returns the per-response read chunk limits
+func (h *Handler) readLimits() store.ReadLimits {
+	return store.ReadLimits{
+		MaxBytes:    h.MaxReadBytes,
+		MaxMessages: h.MaxReadMessages,
+	}
+}
+
 // formatResponse formats messages based on content type
 func (h *Handler) formatResponse(path string, messages []store.Message, contentType string) ([]byte, error) {
 	if store.IsJSONContentType(contentType) {
@@ -0,0 +1,174 @@
+package durablestreams
+
+import (
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/caddyserver/caddy/v2"
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/metrics"
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+	"github.com/prometheus/client_golang/prometheus"
+	"github.com/prometheus/client_golang/prometheus/testutil"
+)
+
+func TestHandler_LongPollReadsWithinLimits(t *testing.T) {
+	h := newSSETestHandler()
+	h.LongPollTimeout = caddy.Duration(5 * time.Second)
+	h.MaxReadMessages = 2
+	defer h.store.Close()
+
+	if _, _, err := h.store.Create("/s", store.CreateOptions{ContentType: "application/json"}); err != nil {
+		t.Fatalf("create failed: %v", err)
+	}
+	tail, _ := h.store.GetCurrentOffset("/s")
+
+	rec := httptest.NewRecorder()
+	req := httptest.NewRequest(http.MethodGet, "/s?live=long-poll&offset="+tail.String(), nil)
+	done := make(chan error, 1)
+	go func() { done <- h.handleRead(rec, req, "/s") }()
+
+	// One append of a backlog larger than the chunk budget, landing while
+	// the poll waits or before it first reads
+	time.Sleep(20 * time.Millisecond)
+	if _, err := h.store.Append("/s", []byte(`[1,2,3,4,5]`), store.AppendOptions{}); err != nil {
+		t.Fatalf("append failed: %v", err)
+	}
+
+	select {
+	case err := <-done:
+		if err != nil {
+			t.Fatalf("handleRead failed: %v", err)
+		}
+	case <-time.After(5 * time.Second):
+		t.Fatal("long-poll not woken by an append")
+	}
+
+	if got := rec.Body.String(); got != `[1,2]` {
+		t.Errorf("expected the first 2 messages, got %q", got)
+	}
+	if rec.Header().Get(HeaderStreamUpToDate) != "" {
+		t.Error("expected a partial chunk not to be up to date")
+	}
+
+	messages, _, _ := h.store.ReadWithLimits("/s", tail, store.ReadLimits{MaxMessages: 2})
+	if got, want := rec.Header().Get(HeaderStreamNextOffset), messages[1].Offset.String(); got != want {
+		t.Errorf("expected next offset %s, got %s", want, got)
+	}
+}
+
+// histogramSamples returns the sample count of the series of histogram name
+// labelled value
+func histogramSamples(t *testing.T, reg *prometheus.Registry, name, value string) uint64 {
+	t.Helper()
+	families, err := reg.Gather()
+	if err != nil {
+		t.Fatalf("gather failed: %v", err)
+	}
+	for _, family := range families {
+		if family.GetName() != name {
+			continue
+		}
+		for _, m := range family.GetMetric() {
+			for _, label := range m.GetLabel() {
+				if label.GetValue() == value {
+					return m.GetHistogram().GetSampleCount()
+				}
+			}
+		}
+	}
+	t.Fatalf("no %s series labelled %s", name, value)
+	return 0
+}
+
+func TestHandler_RecordsAppendAndReadMetrics(t *testing.T) {
+	reg := prometheus.NewRegistry()
+	if err := metrics.Register(reg); err != nil {
+		t.Fatal(err)
+	}
+	fs, err := store.NewFileStore(store.FileStoreConfig{DataDir: t.TempDir()})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer fs.Close()
+	h := &Handler{
+		LongPollTimeout: caddy.Duration(5 * time.Second),
+		MaxReadBytes:    DefaultMaxReadBytes,
+		store:           fs,
+	}
+	if _, _, err := h.store.Create("/s", store.CreateOptions{ContentType: "application/json"}); err != nil {
+		t.Fatalf("create failed: %v", err)
+	}
+
+	// The metrics are process-wide, so each check is against a baseline
+	const appendStages = "durable_streams_append_stage_duration_seconds"
+	const readStages = "durable_streams_read_stage_duration_seconds"
+	stages := map[string][]string{
+		appendStages: {"validate", "json", "segment_write", "fsync_wait", "notify"},
+		readStages:   {"write"}, // Raw chunks are copied unformatted
+	}
+	samples := func() map[string]uint64 {
+		counts := make(map[string]uint64)
+		for name, values := range stages {
+			for _, value := range values {
+				counts[name+"/"+value] = histogramSamples(t, reg, name, value)
+			}
+		}
+		return counts
+	}
+	before := samples()
+	hitsBefore := testutil.ToFloat64(metrics.TailCacheHits)
+	bytesBefore := testutil.ToFloat64(metrics.BytesServedIdentity)
+
+	appendJSON := func(body string) {
+		t.Helper()
+		req := httptest.NewRequest(http.MethodPost, "/s", strings.NewReader(body))
+		req.Header.Set("Content-Type", "application/json")
+		if err := h.handleAppend(httptest.NewRecorder(), req, "/s"); err != nil {
+			t.Fatalf("append failed: %v", err)
+		}
+	}
+	appendJSON(`[1,2,3]`)
+
+	read := httptest.NewRecorder()
+	if err := h.handleRead(read, httptest.NewRequest(http.MethodGet, "/s?offset=-1", nil), "/s"); err != nil {
+		t.Fatalf("read failed: %v", err)
+	}
+
+	after := samples()
+	for series, count := range before {
+		if after[series] != count+1 {
+			t.Errorf("%s: expected 1 new sample, got %d", series, after[series]-count)
+		}
+	}
+	if got := testutil.ToFloat64(metrics.TailCacheHits) - hitsBefore; got != 1 {
+		t.Errorf("expected the read served by the tail cache, got %v hits", got)
+	}
+	if got := testutil.ToFloat64(metrics.BytesServedIdentity) - bytesBefore; got != float64(read.Body.Len()) {
+		t.Errorf("expected %d bytes served, got %v", read.Body.Len(), got)
+	}
+	if testutil.ToFloat64(metrics.OpenWriters) < 1 {
+		t.Error("expected the stream's segment writer counted as open")
+	}
+
+	// A long-poll counts as an active wait until an append wakes it
+	waitsBefore := testutil.ToFloat64(metrics.LongPolls)
+	tail, _ := h.store.GetCurrentOffset("/s")
+	done := make(chan error, 1)
+	go func() {
+		req := httptest.NewRequest(http.MethodGet, "/s?live=long-poll&offset="+tail.String(), nil)
+		done <- h.handleRead(httptest.NewRecorder(), req, "/s")
+	}()
+	waitFor(t, "the long-poll to be counted", func() bool {
+		return testutil.ToFloat64(metrics.LongPolls) == waitsBefore+1
+	})
+	appendJSON(`[4]`)
+	if err := <-done; err != nil {
+		t.Fatalf("long-poll failed: %v", err)
+	}
+	if got := testutil.ToFloat64(metrics.LongPolls); got != waitsBefore {
+		t.Errorf("expected the woken long-poll released, got %v waiting", got-waitsBefore)
+	}
+}
@@ -0,0 +1,128 @@
+// Package metrics defines the Prometheus metrics of the durable streams
+// handler and its stores.
+//
+// The metrics are process-wide, like Caddy's own HTTP metrics: every handler
+// and store instance records into the same collectors, and Register exposes
+// them on a registry (normally Caddy's, served by its metrics endpoint).
+// Stage observers are resolved once at init so recording a sample on the hot
+// path costs no label lookup or allocation.
+package metrics
+
+import (
+	"errors"
+	"time"
+
+	"github.com/prometheus/client_golang/prometheus"
+)
+
+const namespace = "durable_streams"
+
+// stageBuckets span 10µs to ~5s, the range between a cached read and a slow
+// fsync
+var stageBuckets = prometheus.ExponentialBuckets(0.00001, 2.5, 15)
+
+var (
+	appendStages = prometheus.NewHistogramVec(prometheus.HistogramOpts{
+		Namespace: namespace,
+		Name:      "append_stage_duration_seconds",
+		Help:      "Time spent in each stage of an append.",
+		Buckets:   stageBuckets,
+	}, []string{"stage"})
+
+	readStages = prometheus.NewHistogramVec(prometheus.HistogramOpts{
+		Namespace: namespace,
+		Name:      "read_stage_duration_seconds",
+		Help:      "Time spent in each stage of a read.",
+		Buckets:   stageBuckets,
+	}, []string{"stage"})
+
+	openHandles = prometheus.NewGaugeVec(prometheus.GaugeOpts{
+		Namespace: namespace,
+		Name:      "open_file_handles",
+		Help:      "Segment file handles held open by the writer and reader pools.",
+	}, []string{"pool"})
+
+	activeWaits = prometheus.NewGaugeVec(prometheus.GaugeOpts{
+		Namespace: namespace,
+		Name:      "active_live_readers",
+		Help:      "Readers currently waiting for new data, by live mode.",
+	}, []string{"mode"})
+
+	tailCacheLookups = prometheus.NewCounterVec(prometheus.CounterOpts{
+		Namespace: namespace,
+		Name:      "tail_cache_lookups_total",
+		Help:      "Reads looked up in the file store's tail cache, by result.",
+	}, []string{"result"})
+
+	tierOps = prometheus.NewCounterVec(prometheus.CounterOpts{
+		Namespace: namespace,
+		Name:      "tier_operations_total",
+		Help:      "Tiered storage operations of the file store, by kind.",
+	}, []string{"op"})
+
+	bytesServed = prometheus.NewCounterVec(prometheus.CounterOpts{
+		Namespace: namespace,
+		Name:      "bytes_served_total",
+		Help:      "Response body bytes written by reads, by encoding.",
+	}, []string{"encoding"})
+)
+
+// Append stages
+var (
+	AppendValidate     = appendStages.WithLabelValues("validate")
+	AppendJSON         = appendStages.WithLabelValues("json")
+	AppendSegmentWrite = appendStages.WithLabelValues("segment_write")
+	AppendFsyncWait    = appendStages.WithLabelValues("fsync_wait")
+	AppendBboltUpdate  = appendStages.WithLabelValues("bbolt_update")
+	AppendNotify       = appendStages.WithLabelValues("notify")
+)
+
+// Read stages
+var (
+	ReadSegment = readStages.WithLabelValues("segment_read")
+	ReadFormat  = readStages.WithLabelValues("format")
+	ReadWrite   = readStages.WithLabelValues("write")
+)
+
+// Gauges and counters
+var (
+	OpenWriters = openHandles.WithLabelValues("writer")
+	OpenReaders = openHandles.WithLabelValues("reader")
+
+	LongPolls               = activeWaits.WithLabelValues("long-poll")
+	SSEConnections          = activeWaits.WithLabelValues("sse")
+	MultiplexLongPolls      = activeWaits.WithLabelValues("multiplex-long-poll")
+	MultiplexSSEConnections = activeWaits.WithLabelValues("multiplex-sse")
+
+	TailCacheHits   = tailCacheLookups.WithLabelValues("hit")
+	TailCacheMisses = tailCacheLookups.WithLabelValues("miss")
+
+	TierUploads   = tierOps.WithLabelValues("upload")
+	TierEvictions = tierOps.WithLabelValues("evict")
+	TierFetches   = tierOps.WithLabelValues("fetch")
+	TierCacheHits = tierOps.WithLabelValues("cache_hit")
+
+	BytesServedIdentity = bytesServed.WithLabelValues("identity")
+	BytesServedGzip     = bytesServed.WithLabelValues("gzip")
+)
+
+// Since records the time elapsed since start on o
+func Since(o prometheus.Observer, start time.Time) {
+	o.Observe(time.Since(start).Seconds())
+}
+
+// Register adds all metrics to reg. Collectors already registered there, as
+// on a config reload, are left in place.
+func Register(reg prometheus.Registerer) error {
+	for _, c := range []prometheus.Collector{
+		appendStages, readStages, openHandles, activeWaits, tailCacheLookups, tierOps, bytesServed,
+	} {
+		if err := reg.Register(c); err != nil {
+			var already prometheus.AlreadyRegisteredError
+			if !errors.As(err, &already) {
+				return err
+			}
+		}
+	}
+	return nil
+}
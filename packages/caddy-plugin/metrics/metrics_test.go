@@ -0,0 +1,18 @@
+package metrics
+
+import (
+	"testing"
+
+	"github.com/prometheus/client_golang/prometheus"
+)
+
+func TestRegister_ToleratesReload(t *testing.T) {
+	reg := prometheus.NewRegistry()
+	if err := Register(reg); err != nil {
+		t.Fatal(err)
+	}
+	// A config reload provisions the handler again against the same registry
+	if err := Register(reg); err != nil {
+		t.Fatalf("second Register: %v", err)
+	}
+}
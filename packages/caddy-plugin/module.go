@@ -8,11 +8,15 @@ import (
 	"github.com/caddyserver/caddy/v2/caddyconfig/caddyfile"
 	"github.com/caddyserver/caddy/v2/caddyconfig/httpcaddyfile"
 	"github.com/caddyserver/caddy/v2/modules/caddyhttp"
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/metrics"
 	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
 	"github.com/durable-streams/durable-streams/packages/caddy-plugin/webhook"
 	"go.uber.org/zap"
 )
 
+// DefaultMaxReadBytes is the default per-response read chunk size
+const DefaultMaxReadBytes = 4 * 1024 * 1024
+
 func init() {
 	caddy.RegisterModule(Handler{})
 	httpcaddyfile.RegisterHandlerDirective("durable_streams", parseCaddyfile)
@@ -33,6 +37,61 @@ type Handler struct {
 	// SSEReconnectInterval is how often SSE connections should reconnect
 	SSEReconnectInterval caddy.Duration `json:"sse_reconnect_interval,omitempty"`
 
+	// GroupCommitDelay is how long the file store holds a commit window open
+	// to batch appends into one fsync. Zero adds no latency; appends arriving
+	// during an in-flight fsync still share the next one.
+	GroupCommitDelay caddy.Duration `json:"group_commit_delay,omitempty"`
+
+	// GroupCommitMaxBatch is the maximum number of appends acked by a single
+	// group commit. Reaching it closes the commit window early.
+	GroupCommitMaxBatch int `json:"group_commit_max_batch,omitempty"`
+
+	// MaxReadBytes caps the message payload bytes returned by one catch-up
+	// read or SSE data event. Larger reads return a partial chunk without
+	// Stream-Up-To-Date and the client continues from Stream-Next-Offset.
+	// Defaults to DefaultMaxReadBytes; -1 disables the limit.
+	MaxReadBytes int `json:"max_read_bytes,omitempty"`
+
+	// MaxReadMessages caps the number of messages returned by one read.
+	// Zero (the default) means no message-count limit.
+	MaxReadMessages int `json:"max_read_messages,omitempty"`
+
+	// SegmentMaxBytes is the size at which a stream rolls to a new segment
+	// file. Defaults to store.DefaultSegmentMaxBytes; -1 disables size-based
+	// rotation.
+	SegmentMaxBytes int64 `json:"segment_max_bytes,omitempty"`
+
+	// SegmentMaxAge rolls a stream to a new segment file on the first append
+	// after its active segment reaches this age. Zero (the default) disables
+	// age-based rotation.
+	SegmentMaxAge caddy.Duration `json:"segment_max_age,omitempty"`
+
+	// TailCacheBytes is the memory budget of the file store's tail cache,
+	// which keeps each stream's newest messages in memory so live readers are
+	// served without disk reads. Defaults to store.DefaultTailCacheBytes;
+	// -1 disables the cache.
+	TailCacheBytes int64 `json:"tail_cache_bytes,omitempty"`
+
+	// MetadataFlushInterval is how long buffered stream offsets may wait
+	// before being written to the metadata store. Producer state, Stream-Seq
+	// and closure are always written before the append is acknowledged.
+	// Defaults to store.DefaultMetadataFlushInterval.
+	MetadataFlushInterval caddy.Duration `json:"metadata_flush_interval,omitempty"`
+
+	// CompressedCacheBytes is the memory budget for gzip-compressed
+	// historical read chunks. Chunks behind the tail never change, so each is
+	// compressed once for all clients. Defaults to
+	// DefaultCompressedCacheBytes; -1 disables precompression.
+	CompressedCacheBytes int64 `json:"compressed_cache_bytes,omitempty"`
+
+	// Tier offloads the file store's sealed segments to object storage,
+	// keeping only recently read ones on local disk. Unset = all local.
+	Tier *TierConfig `json:"tier,omitempty"`
+
+	// Replication makes the handler a replication leader, or a follower of
+	// one (see replication.go). Unset = standalone.
+	Replication *ReplicationConfig `json:"replication,omitempty"`
+
 	// WebhookCallbackURL is the base URL for webhook callback endpoints.
 	// If set, enables the webhook subscription system.
 	WebhookCallbackURL string `json:"webhook_callback_url,omitempty"`
@@ -41,6 +100,70 @@ type Handler struct {
 	logger         *zap.Logger
 	webhookManager *webhook.Manager
 	webhookRoutes  *webhook.Routes
+	sseHubs        *sseHubs
+	chunkCache     *chunkCache
+
+	replicationToken string           // set on leaders
+	follower         *replicaFollower // set on followers
+}
+
+// ReplicationConfig configures leader/follower replication. Both roles need
+// a data_dir. A leader accepts followers presenting Token; a follower
+// replicates every stream of Leader and forwards writes to it.
+type ReplicationConfig struct {
+	// Token authenticates followers. May use {env.*} placeholders.
+	Token string `json:"token,omitempty"`
+
+	// Leader is the base URL of the leader's durable_streams route, e.g.
+	// http://leader:4437/v1/stream. Set on followers only.
+	Leader string `json:"leader,omitempty"`
+}
+
+// TierConfig configures tiered storage: the object store sealed segments are
+// uploaded to, either a directory or an S3-compatible bucket, and the local
+// disk budget. Offloaded segments are read back in MaxReadBytes ranges.
+type TierConfig struct {
+	// Dir stores objects as files under a directory (e.g. a network mount)
+	Dir string `json:"dir,omitempty"`
+
+	// S3 settings for AWS S3 or any S3-compatible service (GCS with HMAC
+	// keys, MinIO, R2). Credentials may use {env.*} placeholders.
+	S3Endpoint        string `json:"s3_endpoint,omitempty"`
+	S3Bucket          string `json:"s3_bucket,omitempty"`
+	S3Region          string `json:"s3_region,omitempty"`
+	S3Prefix          string `json:"s3_prefix,omitempty"`
+	S3AccessKeyID     string `json:"s3_access_key_id,omitempty"`
+	S3SecretAccessKey string `json:"s3_secret_access_key,omitempty"`
+
+	// LocalBytes is the local disk budget for uploaded segments and cached
+	// ranges. Defaults to store.DefaultTierLocalBytes.
+	LocalBytes int64 `json:"local_bytes,omitempty"`
+}
+
+// objectStore builds the configured object store
+func (t *TierConfig) objectStore() (store.ObjectStore, error) {
+	repl := caddy.NewReplacer()
+	switch {
+	case t.Dir != "" && t.S3Endpoint != "":
+		return nil, fmt.Errorf("tier: dir and s3_endpoint are mutually exclusive")
+	case t.Dir != "":
+		return &store.DirObjectStore{Root: t.Dir}, nil
+	case t.S3Endpoint != "" && t.S3Bucket != "":
+		region := t.S3Region
+		if region == "" {
+			region = "us-east-1"
+		}
+		return &store.S3ObjectStore{
+			Endpoint:        t.S3Endpoint,
+			Bucket:          t.S3Bucket,
+			Region:          region,
+			Prefix:          t.S3Prefix,
+			AccessKeyID:     repl.ReplaceAll(t.S3AccessKeyID, ""),
+			SecretAccessKey: repl.ReplaceAll(t.S3SecretAccessKey, ""),
+		}, nil
+	default:
+		return nil, fmt.Errorf("tier: dir or s3_endpoint and s3_bucket are required")
+	}
 }
 
 // CaddyModule returns the Caddy module information
@@ -65,6 +188,16 @@ func (h *Handler) Provision(ctx caddy.Context) error {
 	if h.SSEReconnectInterval == 0 {
 		h.SSEReconnectInterval = caddy.Duration(60 * time.Second)
 	}
+	if h.MaxReadBytes == 0 {
+		h.MaxReadBytes = DefaultMaxReadBytes
+	}
+
+	if err := metrics.Register(ctx.GetMetricsRegistry()); err != nil {
+		return fmt.Errorf("failed to register metrics: %w", err)
+	}
+
+	h.sseHubs = newSSEHubs()
+	h.chunkCache = newChunkCache(h.CompressedCacheBytes)
 
 	// Initialize store
 	if h.DataDir == "" {
@@ -72,20 +205,46 @@ func (h *Handler) Provision(ctx caddy.Context) error {
 		h.store = store.NewMemoryStore()
 		h.logger.Info("using in-memory store (no data_dir configured)")
 	} else {
-		// Use file-backed store
-		if err := store.RecoverStoreWithEvents(h.DataDir, func(event store.RecoveryEvent) {
-			h.logger.Warn("truncated corrupt segment tail during recovery",
-				zap.String("stream", event.StreamPath),
-				zap.String("segment", event.SegmentPath),
-				zap.Uint64("original_size", event.OriginalSize),
-				zap.Uint64("recovered_size", event.RecoveredSize),
-				zap.Uint64("discarded_bytes", event.DiscardedBytes))
-		}); err != nil {
-			return fmt.Errorf("failed to recover store: %w", err)
+		// Use file-backed store. Stream tails are verified in the background
+		// as the store starts serving; repairs are logged as they happen.
+		var objects store.ObjectStore
+		var tierLocalBytes int64
+		if h.Tier != nil {
+			var err error
+			if objects, err = h.Tier.objectStore(); err != nil {
+				return err
+			}
+			tierLocalBytes = h.Tier.LocalBytes
 		}
 		fileStore, err := store.NewFileStore(store.FileStoreConfig{
-			DataDir:        h.DataDir,
-			MaxFileHandles: h.MaxFileHandles,
+			DataDir:               h.DataDir,
+			MaxFileHandles:        h.MaxFileHandles,
+			GroupCommitDelay:      time.Duration(h.GroupCommitDelay),
+			GroupCommitMaxBatch:   h.GroupCommitMaxBatch,
+			SegmentMaxBytes:       h.SegmentMaxBytes,
+			SegmentMaxAge:         time.Duration(h.SegmentMaxAge),
+			TailCacheBytes:        h.TailCacheBytes,
+			MetadataFlushInterval: time.Duration(h.MetadataFlushInterval),
+			Objects:               objects,
+			TierLocalBytes:        tierLocalBytes,
+			TierBlockBytes:        int64(max(h.MaxReadBytes, 0)),
+			OnTierError: func(err error) {
+				h.logger.Error("tiered storage upload failed", zap.Error(err))
+			},
+			OnRecovery: func(event store.RecoveryEvent) {
+				if event.Err != nil {
+					h.logger.Error("failed to verify stream during recovery",
+						zap.String("stream", event.StreamPath),
+						zap.Error(event.Err))
+					return
+				}
+				h.logger.Warn("truncated corrupt segment tail during recovery",
+					zap.String("stream", event.StreamPath),
+					zap.String("segment", event.SegmentPath),
+					zap.Uint64("original_size", event.OriginalSize),
+					zap.Uint64("recovered_size", event.RecoveredSize),
+					zap.Uint64("discarded_bytes", event.DiscardedBytes))
+			},
 		})
 		if err != nil {
 			return fmt.Errorf("failed to initialize file store: %w", err)
@@ -109,6 +268,42 @@ func (h *Handler) Provision(ctx caddy.Context) error {
 		h.logger.Info("webhook subscriptions enabled", zap.String("callback_url", h.WebhookCallbackURL))
 	}
 
+	if h.Replication != nil {
+		if err := h.provisionReplication(); err != nil {
+			return err
+		}
+	}
+
+	return nil
+}
+
+// provisionReplication sets the handler up as a replication leader or
+// follower
+func (h *Handler) provisionReplication() error {
+	token := caddy.NewReplacer().ReplaceAll(h.Replication.Token, "")
+	if token == "" {
+		return fmt.Errorf("replication: token is required")
+	}
+	if h.Replication.Leader == "" {
+		if _, ok := h.store.(store.ChangeFeed); !ok {
+			return fmt.Errorf("replication: leaders require data_dir")
+		}
+		h.replicationToken = token
+		h.logger.Info("accepting replication followers")
+		return nil
+	}
+
+	replica, ok := h.store.(store.Replica)
+	if !ok {
+		return fmt.Errorf("replication: followers require data_dir")
+	}
+	follower, err := newReplicaFollower(h.Replication.Leader, token, replica, h.logger)
+	if err != nil {
+		return err
+	}
+	h.follower = follower
+	h.follower.start()
+	h.logger.Info("replicating from leader", zap.String("leader", h.Replication.Leader))
 	return nil
 }
 
@@ -122,6 +317,9 @@ func (h *Handler) Cleanup() error {
 	if h.webhookManager != nil {
 		h.webhookManager.Shutdown()
 	}
+	if h.follower != nil {
+		h.follower.stop()
+	}
 	if h.store != nil {
 		return h.store.Close()
 	}
@@ -135,6 +333,28 @@ func (h *Handler) Cleanup() error {
 //	    max_file_handles 100
 //	    long_poll_timeout 30s
 //	    sse_reconnect_interval 60s
+//	    group_commit_delay 2ms
+//	    group_commit_max_batch 1024
+//	    max_read_bytes 4194304
+//	    max_read_messages 1000
+//	    segment_max_bytes 268435456
+//	    segment_max_age 24h
+//	    tail_cache_bytes 67108864
+//	    metadata_flush_interval 1s
+//	    compressed_cache_bytes 33554432
+//	    tier {
+//	        s3_endpoint https://s3.us-east-1.amazonaws.com
+//	        s3_bucket my-bucket
+//	        s3_region us-east-1
+//	        s3_prefix durable-streams/
+//	        s3_access_key_id {env.AWS_ACCESS_KEY_ID}
+//	        s3_secret_access_key {env.AWS_SECRET_ACCESS_KEY}
+//	        local_bytes 107374182400
+//	    }
+//	    replication {
+//	        token {env.DS_REPLICATION_TOKEN}
+//	        leader http://leader:4437/v1/stream
+//	    }
 //	}
 func (h *Handler) UnmarshalCaddyfile(d *caddyfile.Dispenser) error {
 	for d.Next() {
@@ -174,6 +394,104 @@ func (h *Handler) UnmarshalCaddyfile(d *caddyfile.Dispenser) error {
 					return d.Errf("invalid duration: %v", err)
 				}
 				h.SSEReconnectInterval = caddy.Duration(dur)
+			case "group_commit_delay":
+				var val string
+				if !d.Args(&val) {
+					return d.ArgErr()
+				}
+				dur, err := caddy.ParseDuration(val)
+				if err != nil {
+					return d.Errf("invalid duration: %v", err)
+				}
+				h.GroupCommitDelay = caddy.Duration(dur)
+			case "group_commit_max_batch":
+				var val string
+				if !d.Args(&val) {
+					return d.ArgErr()
+				}
+				var err error
+				h.GroupCommitMaxBatch, err = parseIntArg(val)
+				if err != nil {
+					return d.Errf("invalid group_commit_max_batch: %v", err)
+				}
+			case "max_read_bytes":
+				var val string
+				if !d.Args(&val) {
+					return d.ArgErr()
+				}
+				var err error
+				h.MaxReadBytes, err = parseIntArg(val)
+				if err != nil {
+					return d.Errf("invalid max_read_bytes: %v", err)
+				}
+			case "max_read_messages":
+				var val string
+				if !d.Args(&val) {
+					return d.ArgErr()
+				}
+				var err error
+				h.MaxReadMessages, err = parseIntArg(val)
+				if err != nil {
+					return d.Errf("invalid max_read_messages: %v", err)
+				}
+			case "segment_max_bytes":
+				var val string
+				if !d.Args(&val) {
+					return d.ArgErr()
+				}
+				n, err := parseIntArg(val)
+				if err != nil {
+					return d.Errf("invalid segment_max_bytes: %v", err)
+				}
+				h.SegmentMaxBytes = int64(n)
+			case "segment_max_age":
+				var val string
+				if !d.Args(&val) {
+					return d.ArgErr()
+				}
+				dur, err := caddy.ParseDuration(val)
+				if err != nil {
+					return d.Errf("invalid duration: %v", err)
+				}
+				h.SegmentMaxAge = caddy.Duration(dur)
+			case "tail_cache_bytes":
+				var val string
+				if !d.Args(&val) {
+					return d.ArgErr()
+				}
+				n, err := parseIntArg(val)
+				if err != nil {
+					return d.Errf("invalid tail_cache_bytes: %v", err)
+				}
+				h.TailCacheBytes = int64(n)
+			case "metadata_flush_interval":
+				var val string
+				if !d.Args(&val) {
+					return d.ArgErr()
+				}
+				dur, err := caddy.ParseDuration(val)
+				if err != nil {
+					return d.Errf("invalid duration: %v", err)
+				}
+				h.MetadataFlushInterval = caddy.Duration(dur)
+			case "compressed_cache_bytes":
+				var val string
+				if !d.Args(&val) {
+					return d.ArgErr()
+				}
+				n, err := parseIntArg(val)
+				if err != nil {
+					return d.Errf("invalid compressed_cache_bytes: %v", err)
+				}
+				h.CompressedCacheBytes = int64(n)
+			case "tier":
+				if err := h.unmarshalTier(d); err != nil {
+					return err
+				}
+			case "replication":
+				if err := h.unmarshalReplication(d); err != nil {
+					return err
+				}
 			case "webhook_callback_url":
 				if !d.Args(&h.WebhookCallbackURL) {
 					return d.ArgErr()
@@ -186,6 +504,67 @@ func (h *Handler) UnmarshalCaddyfile(d *caddyfile.Dispenser) error {
 	return nil
 }
 
+// unmarshalTier parses the tier block
+func (h *Handler) unmarshalTier(d *caddyfile.Dispenser) error {
+	h.Tier = &TierConfig{}
+	for nesting := d.Nesting(); d.NextBlock(nesting); {
+		var target *string
+		switch d.Val() {
+		case "dir":
+			target = &h.Tier.Dir
+		case "s3_endpoint":
+			target = &h.Tier.S3Endpoint
+		case "s3_bucket":
+			target = &h.Tier.S3Bucket
+		case "s3_region":
+			target = &h.Tier.S3Region
+		case "s3_prefix":
+			target = &h.Tier.S3Prefix
+		case "s3_access_key_id":
+			target = &h.Tier.S3AccessKeyID
+		case "s3_secret_access_key":
+			target = &h.Tier.S3SecretAccessKey
+		case "local_bytes":
+			var val string
+			if !d.Args(&val) {
+				return d.ArgErr()
+			}
+			n, err := parseIntArg(val)
+			if err != nil {
+				return d.Errf("invalid local_bytes: %v", err)
+			}
+			h.Tier.LocalBytes = int64(n)
+			continue
+		default:
+			return d.Errf("unknown tier subdirective: %s", d.Val())
+		}
+		if !d.Args(target) {
+			return d.ArgErr()
+		}
+	}
+	return nil
+}
+
+// unmarshalReplication parses the replication block
+func (h *Handler) unmarshalReplication(d *caddyfile.Dispenser) error {
+	h.Replication = &ReplicationConfig{}
+	for nesting := d.Nesting(); d.NextBlock(nesting); {
+		var target *string
+		switch d.Val() {
+		case "token":
+			target = &h.Replication.Token
+		case "leader":
+			target = &h.Replication.Leader
+		default:
+			return d.Errf("unknown replication subdirective: %s", d.Val())
+		}
+		if !d.Args(target) {
+			return d.ArgErr()
+		}
+	}
+	return nil
+}
+
 func parseCaddyfile(h httpcaddyfile.Helper) (caddyhttp.MiddlewareHandler, error) {
 	var handler Handler
 	err := handler.UnmarshalCaddyfile(h.Dispenser)
@@ -0,0 +1,520 @@
+package durablestreams
+
+import (
+	"encoding/base64"
+	"encoding/json"
+	"errors"
+	"io"
+	"net/http"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/metrics"
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+	"go.uber.org/zap"
+)
+
+// Multiplexed reads follow many streams over one request:
+//
+//	POST {base}/__ds/multiplex[?live=long-poll|sse]
+//	{"streams": [{"path": "/a", "offset": "-1"}, {"path": "/b", "offset": "now"}]}
+//
+// Without live the response is a JSON object with one entry per stream. With
+// live=long-poll it holds only the streams that have data, closed, failed or
+// had offset=now resolved, once at least one has (204 on timeout). With
+// live=sse each stream's data events are followed by a control event naming
+// the stream, so events of different streams interleave on one connection.
+//
+// The entries and SSE control events are multiplexEvent objects. Their
+// dataEncoding says how the stream's data is carried: "json" (an array of
+// messages), "text", or "base64" for binary streams. A stream that fails gets
+// a status and error instead, and is dropped from the response.
+//
+// Stream paths must lie under {base}, as for batched appends, so a request
+// only follows streams its route could read directly.
+const multiplexPath = "/__ds/multiplex"
+
+const (
+	// multiplexMaxStreams bounds the streams followed by one request
+	multiplexMaxStreams = 1024
+
+	// multiplexMaxRequestBytes bounds the request body
+	multiplexMaxRequestBytes = 1 << 20
+)
+
+// isMultiplexPath reports whether path addresses the multiplexed read
+// endpoint, which may be mounted under a route prefix like the JWKS route
+func isMultiplexPath(path string) bool {
+	return strings.HasSuffix(path, multiplexPath)
+}
+
+type multiplexRequest struct {
+	Streams []struct {
+		Path   string `json:"path"`
+		Offset string `json:"offset"`
+	} `json:"streams"`
+}
+
+// multiplexEvent is a long-poll response entry or an SSE control event
+type multiplexEvent struct {
+	Stream       string          `json:"stream"`
+	Data         json.RawMessage `json:"data,omitempty"`
+	DataEncoding string          `json:"dataEncoding,omitempty"`
+	NextOffset   string          `json:"streamNextOffset,omitempty"`
+	UpToDate     bool            `json:"upToDate,omitempty"`
+	Closed       bool            `json:"streamClosed,omitempty"`
+	Status       int             `json:"status,omitempty"`
+	Error        string          `json:"error,omitempty"`
+}
+
+// multiplexStream is one stream followed by a multiplexed read
+type multiplexStream struct {
+	path   string
+	offset store.Offset
+}
+
+// handleMultiplex handles POST requests to the multiplexed read endpoint
+func (h *Handler) handleMultiplex(w http.ResponseWriter, r *http.Request) error {
+	if r.Method != http.MethodPost {
+		w.Header().Set("Allow", http.MethodPost)
+		return newHTTPError(http.StatusMethodNotAllowed, "multiplexed reads use POST")
+	}
+
+	liveMode := r.URL.Query().Get("live")
+	if liveMode != "" && liveMode != "long-poll" && liveMode != "sse" {
+		return newHTTPError(http.StatusBadRequest, "invalid live mode")
+	}
+
+	var req multiplexRequest
+	if err := json.NewDecoder(io.LimitReader(r.Body, multiplexMaxRequestBytes)).Decode(&req); err != nil {
+		return newHTTPError(http.StatusBadRequest, "invalid multiplex request body")
+	}
+	if len(req.Streams) == 0 {
+		return newHTTPError(http.StatusBadRequest, "no streams requested")
+	}
+	if len(req.Streams) > multiplexMaxStreams {
+		return newHTTPError(http.StatusBadRequest, "too many streams requested")
+	}
+
+	streams := make([]*multiplexStream, 0, len(req.Streams))
+	seen := make(map[string]struct{}, len(req.Streams))
+	prefix := strings.TrimSuffix(r.URL.Path, multiplexPath)
+	for _, rs := range req.Streams {
+		if !streamInScope(prefix, rs.Path) {
+			return newHTTPError(http.StatusBadRequest, "invalid stream path")
+		}
+		if _, dup := seen[rs.Path]; dup {
+			return newHTTPError(http.StatusBadRequest, "duplicate stream path")
+		}
+		seen[rs.Path] = struct{}{}
+		if rs.Offset == "" && liveMode != "" {
+			return newHTTPError(http.StatusBadRequest, "offset required for live modes")
+		}
+		offset, err := store.ParseOffset(rs.Offset)
+		if err != nil {
+			return newHTTPError(http.StatusBadRequest, "invalid offset")
+		}
+		streams = append(streams, &multiplexStream{path: rs.Path, offset: offset})
+	}
+
+	if liveMode == "sse" {
+		return h.handleMultiplexSSE(w, r, streams)
+	}
+	return h.handleMultiplexPoll(w, r, streams, liveMode == "long-poll")
+}
+
+// multiplexDataEncoding returns how a stream's data is carried in a
+// multiplexed response, following the SSE rule for binary content types
+func multiplexDataEncoding(contentType string) string {
+	if store.IsJSONContentType(contentType) {
+		return "json"
+	}
+	if strings.HasPrefix(strings.ToLower(store.ExtractMediaType(contentType)), "text/") {
+		return "text"
+	}
+	return "base64"
+}
+
+// multiplexError turns a per-stream read error into the stream's final
+// event. Errors that are not about the stream are returned as is.
+func (h *Handler) multiplexError(path string, err error) (*multiplexEvent, error) {
+	switch {
+	case errors.Is(err, store.ErrStreamNotFound):
+		return &multiplexEvent{Stream: path, Status: http.StatusNotFound, Error: "stream not found"}, nil
+	case errors.Is(err, store.ErrStreamSoftDeleted):
+		return &multiplexEvent{Stream: path, Status: http.StatusGone, Error: "stream has been deleted"}, nil
+	}
+	return nil, err
+}
+
+// handleMultiplexPoll serves catch-up and long-poll multiplexed reads
+func (h *Handler) handleMultiplexPoll(w http.ResponseWriter, r *http.Request, streams []*multiplexStream, live bool) error {
+	// Watch before reading, so an append landing after a stream's read still
+	// marks it for a re-read
+	var (
+		mu    sync.Mutex
+		dirty = make(map[string]struct{})
+		wake  = make(chan struct{}, 1)
+	)
+	if live {
+		watcher, ok := h.store.(store.StreamWatcher)
+		if !ok {
+			return newHTTPError(http.StatusNotImplemented, "multiplexed long-poll not supported by this store")
+		}
+		paths := make([]string, len(streams))
+		for i, s := range streams {
+			paths[i] = s.path
+		}
+		stop := watcher.Watch(paths, func(path string) {
+			mu.Lock()
+			dirty[path] = struct{}{}
+			mu.Unlock()
+			select {
+			case wake <- struct{}{}:
+			default:
+			}
+		})
+		defer stop()
+	}
+
+	budget := newMultiplexBudget(h.MaxReadBytes)
+	var events []*multiplexEvent
+	for _, s := range streams {
+		ev, err := h.multiplexRead(s, live, budget)
+		if err != nil {
+			return err
+		}
+		if ev != nil {
+			events = append(events, ev)
+		}
+	}
+
+	if live && len(events) == 0 {
+		metrics.MultiplexLongPolls.Inc()
+		defer metrics.MultiplexLongPolls.Dec()
+
+		byPath := make(map[string]*multiplexStream, len(streams))
+		for _, s := range streams {
+			byPath[s.path] = s
+		}
+		timer := time.NewTimer(time.Duration(h.LongPollTimeout))
+		defer timer.Stop()
+
+	wait:
+		for len(events) == 0 {
+			select {
+			case <-r.Context().Done():
+				break wait
+			case <-timer.C:
+				break wait
+			case <-wake:
+			}
+
+			mu.Lock()
+			changed := make([]string, 0, len(dirty))
+			for path := range dirty {
+				changed = append(changed, path)
+			}
+			clear(dirty)
+			mu.Unlock()
+
+			for _, path := range changed {
+				ev, err := h.multiplexRead(byPath[path], true, budget)
+				if err != nil {
+					return err
+				}
+				if ev != nil {
+					events = append(events, ev)
+				}
+			}
+		}
+	}
+
+	w.Header().Set("Cache-Control", "no-store")
+	if len(events) == 0 {
+		w.WriteHeader(http.StatusNoContent)
+		return nil
+	}
+
+	formatStart := time.Now()
+	body, err := json.Marshal(struct {
+		Streams []*multiplexEvent `json:"streams"`
+	}{events})
+	if err != nil {
+		return err
+	}
+	writeStart := time.Now()
+	metrics.ReadFormat.Observe(writeStart.Sub(formatStart).Seconds())
+
+	w.Header().Set("Content-Type", "application/json")
+	w.WriteHeader(http.StatusOK)
+	n, _ := w.Write(body)
+	metrics.Since(metrics.ReadWrite, writeStart)
+	metrics.BytesServedIdentity.Add(float64(n))
+	return nil
+}
+
+// multiplexBudget caps the data bytes of one multiplexed long-poll response
+// at a single read chunk, so following many streams doesn't multiply the
+// response size. Streams past the budget are read again on the next request.
+type multiplexBudget struct {
+	remaining int
+	unlimited bool
+}
+
+func newMultiplexBudget(maxBytes int) *multiplexBudget {
+	return &multiplexBudget{remaining: maxBytes, unlimited: maxBytes <= 0}
+}
+
+func (b *multiplexBudget) spent() bool {
+	return !b.unlimited && b.remaining <= 0
+}
+
+func (b *multiplexBudget) spend(n int) {
+	b.remaining -= n
+}
+
+// multiplexRead reads the next chunk of s into its response entry. In
+// long-poll mode it returns nil if the stream has nothing to report.
+func (h *Handler) multiplexRead(s *multiplexStream, live bool, budget *multiplexBudget) (*multiplexEvent, error) {
+	meta, err := h.store.Get(s.path)
+	if err != nil {
+		return h.multiplexError(s.path, err)
+	}
+
+	resolved := false
+	if s.offset.IsNow() {
+		s.offset = meta.CurrentOffset
+		resolved = true
+	}
+
+	if budget.spent() {
+		if !live {
+			// Report the stream as behind so the client reads it again
+			return &multiplexEvent{Stream: s.path, NextOffset: s.offset.String()}, nil
+		}
+		return nil, nil
+	}
+
+	messages, _, err := h.store.ReadWithLimits(s.path, s.offset, h.readLimits())
+	if err != nil {
+		return h.multiplexError(s.path, err)
+	}
+	if len(messages) > 0 {
+		s.offset = messages[len(messages)-1].Offset
+	}
+
+	currentMeta, err := h.store.Get(s.path)
+	if err != nil {
+		return h.multiplexError(s.path, err)
+	}
+	upToDate := s.offset.Equal(currentMeta.CurrentOffset)
+	closed := currentMeta.Closed && upToDate
+
+	if live && len(messages) == 0 && !closed && !resolved {
+		return nil, nil
+	}
+
+	ev := &multiplexEvent{
+		Stream:       s.path,
+		DataEncoding: multiplexDataEncoding(meta.ContentType),
+		NextOffset:   s.offset.String(),
+		UpToDate:     upToDate && !closed,
+		Closed:       closed,
+	}
+	if len(messages) > 0 {
+		body, err := h.formatResponse(s.path, messages, meta.ContentType)
+		if err != nil {
+			return nil, err
+		}
+		budget.spend(len(body))
+		switch ev.DataEncoding {
+		case "json":
+			ev.Data = body
+		case "text":
+			ev.Data, _ = json.Marshal(string(body))
+		default:
+			ev.Data, _ = json.Marshal(base64.StdEncoding.EncodeToString(body))
+		}
+	}
+	return ev, nil
+}
+
+// encodeMultiplexControl encodes the control event following a stream's
+// data in a multiplexed SSE response
+func encodeMultiplexControl(path string, nextOffset store.Offset, upToDate, closed bool, dataEncoding string) []byte {
+	return encodeMultiplexEvent(&multiplexEvent{
+		Stream:       path,
+		DataEncoding: dataEncoding,
+		NextOffset:   nextOffset.String(),
+		UpToDate:     upToDate && !closed,
+		Closed:       closed,
+	})
+}
+
+func encodeMultiplexEvent(ev *multiplexEvent) []byte {
+	eventJSON, _ := json.Marshal(ev)
+	buf := make([]byte, 0, len(eventJSON)+24)
+	buf = append(buf, "event: control\ndata:"...)
+	buf = append(buf, eventJSON...)
+	return append(buf, "\n\n"...)
+}
+
+// multiplexConn is one stream of a multiplexed SSE response
+type multiplexConn struct {
+	conn        *sseConn
+	contentType string
+	sub         *sseSubscriber
+	done        bool // The stream's part of the response has ended
+}
+
+// handleMultiplexSSE serves a multiplexed SSE read. Every stream is followed
+// through its broadcast hub; the hubs share one wake channel, so a single
+// goroutine serves the whole connection.
+func (h *Handler) handleMultiplexSSE(w http.ResponseWriter, r *http.Request, streams []*multiplexStream) error {
+	flusher, ok := w.(http.Flusher)
+	if !ok {
+		return newHTTPError(http.StatusInternalServerError, "streaming not supported")
+	}
+
+	w.Header().Set("Content-Type", "text/event-stream")
+	w.Header().Set("Cache-Control", "no-cache")
+	w.Header().Set("Connection", "keep-alive")
+	w.Header().Set("X-Accel-Buffering", "no")
+	w.WriteHeader(http.StatusOK)
+	flusher.Flush()
+
+	metrics.MultiplexSSEConnections.Inc()
+	defer metrics.MultiplexSSEConnections.Dec()
+
+	wake := make(chan struct{}, 1)
+	active := make([]*multiplexConn, 0, len(streams))
+	defer func() {
+		for _, mc := range active {
+			if !mc.done {
+				h.sseHubs.unsubscribe(mc.sub)
+			}
+		}
+	}()
+
+	// finish ends a stream's part of the response, sending its error event
+	// if it failed. Only errors unrelated to the stream end the response.
+	finish := func(mc *multiplexConn, path string, err error) error {
+		if mc != nil {
+			mc.done = true
+			h.sseHubs.unsubscribe(mc.sub)
+		}
+		if err == nil {
+			return nil
+		}
+		ev, err := h.multiplexError(path, err)
+		if err != nil {
+			return err
+		}
+		w.Write(encodeMultiplexEvent(ev))
+		return nil
+	}
+
+	for _, s := range streams {
+		meta, err := h.store.Get(s.path)
+		if err != nil {
+			if err := finish(nil, s.path, err); err != nil {
+				h.logger.Error("multiplexed SSE read failed", zap.String("path", s.path), zap.Error(err))
+				return nil
+			}
+			continue
+		}
+		offset := s.offset
+		if offset.IsNow() {
+			offset = meta.CurrentOffset
+		}
+		dataEncoding := multiplexDataEncoding(meta.ContentType)
+		useBase64 := dataEncoding == "base64"
+		mc := &multiplexConn{
+			conn: &sseConn{
+				w:            w,
+				flusher:      flusher,
+				useBase64:    useBase64,
+				offset:       offset,
+				stream:       s.path,
+				dataEncoding: dataEncoding,
+			},
+			contentType: meta.ContentType,
+			sub:         h.sseHubs.subscribe(h, s.path, meta.ContentType, useBase64, wake),
+		}
+		if done, err := h.sseCatchUp(s.path, meta.ContentType, mc.conn); done || err != nil {
+			if err := finish(mc, s.path, err); err != nil {
+				h.logger.Error("multiplexed SSE read failed", zap.String("path", s.path), zap.Error(err))
+				return nil
+			}
+			continue
+		}
+		active = append(active, mc)
+	}
+	flusher.Flush()
+
+	ctx := r.Context()
+	reconnectTimer := time.NewTimer(time.Duration(h.SSEReconnectInterval))
+	defer reconnectTimer.Stop()
+
+	for len(active) > 0 {
+		select {
+		case <-ctx.Done():
+			return nil
+		case <-reconnectTimer.C:
+			// Close connection so the client reconnects with fresh offsets
+			return nil
+		case <-wake:
+		}
+
+		ended := 0
+		for _, mc := range active {
+			if done, err := h.multiplexDrain(mc, wake); done || err != nil {
+				ended++
+				if err := finish(mc, mc.conn.stream, err); err != nil {
+					h.logger.Error("multiplexed SSE read failed", zap.String("path", mc.conn.stream), zap.Error(err))
+					return nil
+				}
+			}
+		}
+		if ended > 0 {
+			kept := active[:0]
+			for _, mc := range active {
+				if !mc.done {
+					kept = append(kept, mc)
+				}
+			}
+			clear(active[len(kept):])
+			active = kept
+		}
+		flusher.Flush()
+	}
+	return nil
+}
+
+// multiplexDrain delivers everything mc's hub has queued for it, without
+// blocking. Returns done once the stream's final control event was sent.
+func (h *Handler) multiplexDrain(mc *multiplexConn, wake chan struct{}) (bool, error) {
+	path := mc.conn.stream
+	for {
+		select {
+		case <-mc.sub.lagged:
+			if done, err := h.sseCatchUp(path, mc.contentType, mc.conn); done || err != nil {
+				return done, err
+			}
+		case frame, ok := <-mc.sub.frames:
+			if !ok {
+				// The hub stopped; rejoin and let the store decide what's next
+				h.sseHubs.unsubscribe(mc.sub)
+				mc.sub = h.sseHubs.subscribe(h, path, mc.contentType, mc.conn.useBase64, wake)
+				return h.sseCatchUp(path, mc.contentType, mc.conn)
+			}
+			if done, err := h.sseDeliver(path, mc.contentType, mc.conn, frame); done || err != nil {
+				return done, err
+			}
+		default:
+			return false, nil
+		}
+	}
+}
@@ -0,0 +1,235 @@
+package durablestreams
+
+import (
+	"encoding/json"
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/caddyserver/caddy/v2"
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+)
+
+func newMultiplexRequest(live, body string) *http.Request {
+	target := multiplexPath
+	if live != "" {
+		target += "?live=" + live
+	}
+	return httptest.NewRequest(http.MethodPost, target, strings.NewReader(body))
+}
+
+func decodeMultiplexEvents(t *testing.T, body []byte) map[string]multiplexEvent {
+	t.Helper()
+	var resp struct {
+		Streams []multiplexEvent `json:"streams"`
+	}
+	if err := json.Unmarshal(body, &resp); err != nil {
+		t.Fatalf("invalid multiplex response %q: %v", body, err)
+	}
+	events := make(map[string]multiplexEvent)
+	for _, ev := range resp.Streams {
+		events[ev.Stream] = ev
+	}
+	return events
+}
+
+func TestMultiplex_CatchUpReportsEveryStream(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	h.store.Create("/json", store.CreateOptions{ContentType: "application/json"})
+	h.store.Append("/json", []byte(`{"n":1}`), store.AppendOptions{})
+	h.store.Create("/text", store.CreateOptions{ContentType: "text/plain"})
+	h.store.Create("/bin", store.CreateOptions{ContentType: "application/octet-stream"})
+	h.store.Append("/bin", []byte{0xff, 0x00}, store.AppendOptions{})
+
+	rec := httptest.NewRecorder()
+	req := newMultiplexRequest("", `{"streams":[
+		{"path":"/json","offset":"-1"},
+		{"path":"/text","offset":"-1"},
+		{"path":"/bin","offset":"-1"},
+		{"path":"/missing","offset":"-1"}]}`)
+	if err := h.handleMultiplex(rec, req); err != nil {
+		t.Fatalf("handleMultiplex failed: %v", err)
+	}
+	if rec.Code != http.StatusOK {
+		t.Fatalf("expected 200, got %d", rec.Code)
+	}
+
+	events := decodeMultiplexEvents(t, rec.Body.Bytes())
+	if ev := events["/json"]; ev.DataEncoding != "json" || string(ev.Data) != `[{"n":1}]` || !ev.UpToDate {
+		t.Errorf("unexpected JSON stream entry %+v", ev)
+	}
+	if ev := events["/text"]; ev.Data != nil || !ev.UpToDate || ev.NextOffset == "" {
+		t.Errorf("unexpected empty stream entry %+v", ev)
+	}
+	if ev := events["/bin"]; ev.DataEncoding != "base64" || string(ev.Data) != `"/wA="` {
+		t.Errorf("unexpected binary stream entry %+v", ev)
+	}
+	if ev := events["/missing"]; ev.Status != http.StatusNotFound {
+		t.Errorf("expected 404 entry for missing stream, got %+v", ev)
+	}
+}
+
+func TestMultiplex_LongPollWakesOnAnyStream(t *testing.T) {
+	h := newSSETestHandler()
+	h.LongPollTimeout = caddy.Duration(5 * time.Second)
+	defer h.store.Close()
+
+	for _, path := range []string{"/a", "/b", "/c"} {
+		h.store.Create(path, store.CreateOptions{ContentType: "text/plain"})
+	}
+	tail, _ := h.store.GetCurrentOffset("/b")
+
+	rec := httptest.NewRecorder()
+	req := newMultiplexRequest("long-poll", `{"streams":[
+		{"path":"/a","offset":"`+tail.String()+`"},
+		{"path":"/b","offset":"`+tail.String()+`"},
+		{"path":"/c","offset":"`+tail.String()+`"}]}`)
+	done := make(chan error, 1)
+	go func() { done <- h.handleMultiplex(rec, req) }()
+
+	// Appended once the poll is waiting, or before it first reads: either
+	// way the response must carry it
+	time.Sleep(20 * time.Millisecond)
+	h.store.Append("/b", []byte("hello"), store.AppendOptions{})
+
+	select {
+	case err := <-done:
+		if err != nil {
+			t.Fatalf("handleMultiplex failed: %v", err)
+		}
+	case <-time.After(5 * time.Second):
+		t.Fatal("long-poll not woken by an append")
+	}
+
+	events := decodeMultiplexEvents(t, rec.Body.Bytes())
+	if len(events) != 1 {
+		t.Fatalf("expected only the appended stream, got %v", events)
+	}
+	if ev := events["/b"]; string(ev.Data) != `"hello"` || !ev.UpToDate {
+		t.Errorf("unexpected entry %+v", ev)
+	}
+}
+
+func TestMultiplex_LongPollTimesOut(t *testing.T) {
+	h := newSSETestHandler()
+	h.LongPollTimeout = caddy.Duration(20 * time.Millisecond)
+	defer h.store.Close()
+
+	h.store.Create("/a", store.CreateOptions{ContentType: "text/plain"})
+	tail, _ := h.store.GetCurrentOffset("/a")
+
+	rec := httptest.NewRecorder()
+	req := newMultiplexRequest("long-poll", `{"streams":[{"path":"/a","offset":"`+tail.String()+`"}]}`)
+	if err := h.handleMultiplex(rec, req); err != nil {
+		t.Fatalf("handleMultiplex failed: %v", err)
+	}
+	if rec.Code != http.StatusNoContent {
+		t.Errorf("expected 204 on timeout, got %d", rec.Code)
+	}
+}
+
+func TestMultiplex_SSEInterleavesStreams(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	h.store.Create("/a", store.CreateOptions{ContentType: "text/plain"})
+	h.store.Append("/a", []byte("a-backlog"), store.AppendOptions{})
+	h.store.Create("/b", store.CreateOptions{ContentType: "text/plain"})
+
+	rec := &sseRecorder{header: make(http.Header)}
+	req := newMultiplexRequest("sse", `{"streams":[
+		{"path":"/a","offset":"-1"},
+		{"path":"/b","offset":"now"},
+		{"path":"/gone","offset":"-1"}]}`)
+	done := make(chan error, 1)
+	go func() { done <- h.handleMultiplex(rec, req) }()
+
+	waitFor(t, "initial controls", func() bool {
+		body := rec.String()
+		return strings.Contains(body, `"stream":"/a"`) && strings.Contains(body, `"stream":"/b"`)
+	})
+	if body := rec.String(); !strings.Contains(body, "data:a-backlog\n") ||
+		!strings.Contains(body, `{"stream":"/gone","status":404`) {
+		t.Errorf("expected backlog and an error for the missing stream, got %q", body)
+	}
+	if got := h.sseHubs.count(); got != 2 {
+		t.Errorf("expected a hub per live stream, got %d", got)
+	}
+
+	h.store.Append("/b", []byte("b-live"), store.AppendOptions{})
+	waitFor(t, "live data on /b", func() bool { return strings.Contains(rec.String(), "data:b-live\n") })
+	h.store.Append("/a", []byte("a-last"), store.AppendOptions{Close: true})
+	h.store.CloseStream("/b")
+
+	select {
+	case err := <-done:
+		if err != nil {
+			t.Fatalf("handleMultiplex failed: %v", err)
+		}
+	case <-time.After(5 * time.Second):
+		t.Fatal("connection should end once every stream is closed")
+	}
+
+	// Each stream's data is followed by its own control event
+	body := rec.String()
+	i := strings.Index(body, "data:b-live\n")
+	if j := strings.Index(body[i:], "event: control\n"); j < 0 || !strings.HasPrefix(body[i+j:], "event: control\ndata:{\"stream\":\"/b\"") {
+		t.Errorf("data not followed by its stream's control event: %q", body)
+	}
+	if strings.Count(body, `"streamClosed":true`) != 2 {
+		t.Errorf("expected both streams to close, got %q", body)
+	}
+	waitFor(t, "hub shutdown", func() bool { return h.sseHubs.count() == 0 })
+}
+
+func TestMultiplex_RejectsInvalidRequests(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	for name, req := range map[string]*http.Request{
+		"get":       httptest.NewRequest(http.MethodGet, multiplexPath, nil),
+		"no body":   newMultiplexRequest("", ``),
+		"empty":     newMultiplexRequest("", `{"streams":[]}`),
+		"duplicate": newMultiplexRequest("", `{"streams":[{"path":"/a"},{"path":"/a"}]}`),
+		"no offset": newMultiplexRequest("sse", `{"streams":[{"path":"/a"}]}`),
+		"bad live":  newMultiplexRequest("poll", `{"streams":[{"path":"/a","offset":"-1"}]}`),
+	} {
+		if err := h.handleMultiplex(httptest.NewRecorder(), req); err == nil {
+			t.Errorf("%s: expected an error", name)
+		}
+	}
+}
+
+func TestMultiplex_ScopesStreamsToRoutePrefix(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	h.store.Create("/v1/stream/a", store.CreateOptions{ContentType: "text/plain"})
+	h.store.Create("/admin/a", store.CreateOptions{ContentType: "text/plain"})
+
+	for name, path := range map[string]string{
+		"outside":     "/admin/a",
+		"dot segment": "/v1/stream/../../admin/a",
+		"sibling":     "/v1/streamx/a",
+	} {
+		req := httptest.NewRequest(http.MethodPost, "/v1/stream"+multiplexPath,
+			strings.NewReader(`{"streams":[{"path":"/v1/stream/a"},{"path":"`+path+`"}]}`))
+		if err := h.handleMultiplex(httptest.NewRecorder(), req); err == nil {
+			t.Errorf("%s: expected an error", name)
+		}
+	}
+
+	rec := httptest.NewRecorder()
+	req := httptest.NewRequest(http.MethodPost, "/v1/stream"+multiplexPath,
+		strings.NewReader(`{"streams":[{"path":"/v1/stream/a"}]}`))
+	if err := h.handleMultiplex(rec, req); err != nil {
+		t.Fatalf("handleMultiplex failed: %v", err)
+	}
+	if _, ok := decodeMultiplexEvents(t, rec.Body.Bytes())["/v1/stream/a"]; !ok {
+		t.Errorf("expected the stream under the route, got %s", rec.Body.String())
+	}
+}
@@ -0,0 +1,601 @@
+package durablestreams
+
+import (
+	"bufio"
+	"bytes"
+	"context"
+	"crypto/subtle"
+	"encoding/json"
+	"errors"
+	"fmt"
+	"io"
+	"net/http"
+	"net/http/httputil"
+	"net/url"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+	"go.uber.org/zap"
+)
+
+// Replication streams a leader's file store to followers, which serve reads
+// from their copy and forward writes to the leader:
+//
+//	POST {base}/__ds/replication
+//	Authorization: Bearer <token>
+//	{"streams": [{"path": "/a", "id": "...", "offset": "..."}]}
+//
+// The body lists the streams the follower has and how far. The response
+// never ends; it is a sequence of events, each a JSON line followed, for
+// stream events, by the payloads of its messages back to back:
+//
+//	{"type":"stream","stream":{...},"messages":[{"offset":"...","size":5}]}
+//	{"type":"delete","path":"/a"}
+//	{"type":"ping"}
+//
+// The leader first brings every stream of the follower up to date (forks
+// after their sources) and deletes the ones it no longer has, then ships
+// each change to a stream as it happens. Messages keep the offsets the
+// leader assigned, so clients may read from any node and resume on another.
+// Replication is asynchronous: a follower may lag the leader briefly.
+const replicationPath = "/__ds/replication"
+
+// replicationContentType is the media type of a replication response
+const replicationContentType = "application/x-durable-streams-replication"
+
+const (
+	// replicationPingInterval is how often an idle leader pings followers
+	replicationPingInterval = 15 * time.Second
+
+	// replicationIdleTimeout is how long a follower waits for any event
+	// before reconnecting
+	replicationIdleTimeout = 3 * replicationPingInterval
+
+	// replicationMaxMessages bounds the messages of one stream event
+	replicationMaxMessages = 4096
+
+	// Reconnect backoff of followers
+	replicationMinBackoff = 500 * time.Millisecond
+	replicationMaxBackoff = 30 * time.Second
+)
+
+// isReplicationPath reports whether path addresses the replication endpoint
+func isReplicationPath(path string) bool {
+	return strings.HasSuffix(path, replicationPath)
+}
+
+type replicationRequest struct {
+	Streams []replicaCursor `json:"streams"`
+}
+
+// replicaCursor is a stream a follower has, as far as it has it
+type replicaCursor struct {
+	Path   string `json:"path"`
+	ID     string `json:"id"`
+	Offset string `json:"offset"`
+}
+
+type replicationEvent struct {
+	Type     string           `json:"type"` // "stream", "delete" or "ping"
+	Path     string           `json:"path,omitempty"`
+	Stream   *replicaStream   `json:"stream,omitempty"`
+	Messages []replicaMessage `json:"messages,omitempty"`
+}
+
+// replicaMessage is the end offset and payload size of a shipped message
+type replicaMessage struct {
+	Offset string `json:"offset"`
+	Size   int    `json:"size"`
+}
+
+// replicaStream is the state of a stream on the leader
+type replicaStream struct {
+	Path                string                          `json:"path"`
+	ID                  string                          `json:"id"`
+	ContentType         string                          `json:"contentType"`
+	Offset              string                          `json:"offset"`
+	CreatedAt           time.Time                       `json:"createdAt"`
+	TTLSeconds          *int64                          `json:"ttlSeconds,omitempty"`
+	ExpiresAt           *time.Time                      `json:"expiresAt,omitempty"`
+	LastSeq             string                          `json:"lastSeq,omitempty"`
+	Producers           map[string]*store.ProducerState `json:"producers,omitempty"`
+	Closed              bool                            `json:"closed,omitempty"`
+	ClosedBy            *store.ClosedByProducer         `json:"closedBy,omitempty"`
+	ForkedFrom          string                          `json:"forkedFrom,omitempty"`
+	ForkOffset          string                          `json:"forkOffset,omitempty"`
+	ForkOffsetRequested string                          `json:"forkOffsetRequested,omitempty"`
+	ForkSubOffset       uint64                          `json:"forkSubOffset,omitempty"`
+	SoftDeleted         bool                            `json:"softDeleted,omitempty"`
+}
+
+func newReplicaStream(info store.StreamInfo) *replicaStream {
+	meta := info.Meta
+	rs := &replicaStream{
+		Path:          meta.Path,
+		ID:            info.ID,
+		ContentType:   meta.ContentType,
+		Offset:        meta.CurrentOffset.String(),
+		CreatedAt:     meta.CreatedAt,
+		TTLSeconds:    meta.TTLSeconds,
+		ExpiresAt:     meta.ExpiresAt,
+		LastSeq:       meta.LastSeq,
+		Producers:     meta.Producers,
+		Closed:        meta.Closed,
+		ClosedBy:      meta.ClosedBy,
+		ForkedFrom:    meta.ForkedFrom,
+		ForkSubOffset: meta.ForkSubOffset,
+		SoftDeleted:   meta.SoftDeleted,
+	}
+	if meta.ForkedFrom != "" {
+		rs.ForkOffset = meta.ForkOffset.String()
+		if meta.ForkOffsetRequested != nil {
+			rs.ForkOffsetRequested = meta.ForkOffsetRequested.String()
+		}
+	}
+	return rs
+}
+
+// info converts a shipped stream back to the leader's StreamInfo
+func (rs *replicaStream) info() (store.StreamInfo, error) {
+	meta := store.StreamMetadata{
+		Path:          rs.Path,
+		ContentType:   rs.ContentType,
+		CreatedAt:     rs.CreatedAt,
+		TTLSeconds:    rs.TTLSeconds,
+		ExpiresAt:     rs.ExpiresAt,
+		LastSeq:       rs.LastSeq,
+		Producers:     rs.Producers,
+		Closed:        rs.Closed,
+		ClosedBy:      rs.ClosedBy,
+		ForkedFrom:    rs.ForkedFrom,
+		ForkSubOffset: rs.ForkSubOffset,
+		SoftDeleted:   rs.SoftDeleted,
+	}
+	var err error
+	if meta.CurrentOffset, err = store.ParseOffset(rs.Offset); err != nil {
+		return store.StreamInfo{}, err
+	}
+	if rs.ForkedFrom != "" {
+		if meta.ForkOffset, err = store.ParseOffset(rs.ForkOffset); err != nil {
+			return store.StreamInfo{}, err
+		}
+	}
+	if rs.ForkOffsetRequested != "" {
+		requested, err := store.ParseOffset(rs.ForkOffsetRequested)
+		if err != nil {
+			return store.StreamInfo{}, err
+		}
+		meta.ForkOffsetRequested = &requested
+	}
+	return store.StreamInfo{Meta: meta, ID: rs.ID}, nil
+}
+
+// handleReplication serves a follower's replication connection
+func (h *Handler) handleReplication(w http.ResponseWriter, r *http.Request) error {
+	if r.Method != http.MethodPost {
+		w.Header().Set("Allow", http.MethodPost)
+		return newHTTPError(http.StatusMethodNotAllowed, "replication uses POST")
+	}
+	if h.replicationToken == "" {
+		return newHTTPError(http.StatusNotFound, "replication is not enabled")
+	}
+	auth := r.Header.Get("Authorization")
+	if subtle.ConstantTimeCompare([]byte(auth), []byte("Bearer "+h.replicationToken)) != 1 {
+		return newHTTPError(http.StatusUnauthorized, "invalid replication token")
+	}
+	feed, ok := h.store.(store.ChangeFeed)
+	if !ok {
+		return newHTTPError(http.StatusNotImplemented, "replication not supported by this store")
+	}
+	flusher, ok := w.(http.Flusher)
+	if !ok {
+		return newHTTPError(http.StatusInternalServerError, "streaming not supported")
+	}
+
+	var req replicationRequest
+	if err := json.NewDecoder(r.Body).Decode(&req); err != nil {
+		return newHTTPError(http.StatusBadRequest, "invalid replication request body")
+	}
+
+	limits := h.readLimits()
+	if limits.MaxMessages <= 0 || limits.MaxMessages > replicationMaxMessages {
+		limits.MaxMessages = replicationMaxMessages
+	}
+	sender := &replicationSender{
+		feed:   feed,
+		w:      bufio.NewWriter(w),
+		limits: limits,
+		sent:   make(map[string]replicaCursorState, len(req.Streams)),
+	}
+	for _, c := range req.Streams {
+		offset, err := store.ParseOffset(c.Offset)
+		if err != nil || offset.IsNow() {
+			return newHTTPError(http.StatusBadRequest, "invalid offset")
+		}
+		sender.sent[c.Path] = replicaCursorState{id: c.ID, offset: offset}
+	}
+
+	// Watch before listing, so a change made during the first sync still
+	// marks its stream for another pass
+	var (
+		mu    sync.Mutex
+		dirty = make(map[string]struct{})
+		wake  = make(chan struct{}, 1)
+	)
+	markDirty := func(path string) {
+		mu.Lock()
+		dirty[path] = struct{}{}
+		mu.Unlock()
+		select {
+		case wake <- struct{}{}:
+		default:
+		}
+	}
+	stop := feed.WatchAll(markDirty)
+	defer stop()
+	for _, info := range feed.Streams() {
+		markDirty(info.Meta.Path)
+	}
+	for path := range sender.sent {
+		markDirty(path)
+	}
+
+	w.Header().Set("Content-Type", replicationContentType)
+	w.Header().Set("Cache-Control", "no-store")
+	w.Header().Set("X-Accel-Buffering", "no")
+	w.WriteHeader(http.StatusOK)
+	flusher.Flush()
+
+	ping := time.NewTicker(replicationPingInterval)
+	defer ping.Stop()
+
+	ctx := r.Context()
+	for {
+		mu.Lock()
+		paths := make([]string, 0, len(dirty))
+		for path := range dirty {
+			paths = append(paths, path)
+		}
+		clear(dirty)
+		mu.Unlock()
+
+		for _, path := range paths {
+			more, err := sender.sync(path, 0)
+			if err != nil {
+				h.logger.Debug("replication connection ended", zap.String("path", path), zap.Error(err))
+				return nil
+			}
+			if more {
+				markDirty(path)
+			}
+		}
+		if len(paths) > 0 {
+			if err := sender.w.Flush(); err != nil {
+				return nil
+			}
+			flusher.Flush()
+		}
+
+		select {
+		case <-ctx.Done():
+			return nil
+		case <-wake:
+		case <-ping.C:
+			if err := sender.write(replicationEvent{Type: "ping"}, nil); err != nil {
+				return nil
+			}
+			if err := sender.w.Flush(); err != nil {
+				return nil
+			}
+			flusher.Flush()
+		}
+	}
+}
+
+// replicaCursorState is how far the leader has shipped a stream
+type replicaCursorState struct {
+	id     string
+	offset store.Offset
+}
+
+// replicationSender writes the events of one replication connection
+type replicationSender struct {
+	feed   store.ChangeFeed
+	w      *bufio.Writer
+	limits store.ReadLimits
+	sent   map[string]replicaCursorState
+}
+
+// replicationMaxForkDepth bounds the fork chain synced ahead of a new fork
+const replicationMaxForkDepth = 64
+
+// sync ships one chunk of a stream's changes since it was last shipped, or
+// its deletion. more reports whether the stream has further changes to ship.
+// A fork's source is shipped first in full, so the follower can create it.
+func (s *replicationSender) sync(path string, depth int) (more bool, err error) {
+	c, known := s.sent[path]
+	offset := store.ZeroOffset
+	if known {
+		offset = c.offset
+	}
+	info, messages, err := s.feed.ReadChanges(path, offset, s.limits)
+	if errors.Is(err, store.ErrStreamNotFound) {
+		if !known {
+			return false, nil
+		}
+		delete(s.sent, path)
+		return false, s.write(replicationEvent{Type: "delete", Path: path}, nil)
+	}
+	if err != nil {
+		return false, err
+	}
+	if known && info.ID != c.id {
+		// Recreated since the follower's copy was made: ship it anew
+		delete(s.sent, path)
+		return true, nil
+	}
+
+	if !known && info.Meta.ForkedFrom != "" && depth < replicationMaxForkDepth {
+		for {
+			more, err := s.sync(info.Meta.ForkedFrom, depth+1)
+			if err != nil {
+				return false, err
+			}
+			if !more {
+				break
+			}
+		}
+	}
+
+	next := info.Meta.CurrentOffset
+	if len(messages) > 0 {
+		next = messages[len(messages)-1].Offset
+	}
+	ev := replicationEvent{Type: "stream", Stream: newReplicaStream(info)}
+	if len(messages) > 0 {
+		ev.Messages = make([]replicaMessage, len(messages))
+		for i, msg := range messages {
+			ev.Messages[i] = replicaMessage{Offset: msg.Offset.String(), Size: len(msg.Data)}
+		}
+	}
+	if err := s.write(ev, messages); err != nil {
+		return false, err
+	}
+	s.sent[path] = replicaCursorState{id: info.ID, offset: next}
+	return !next.Equal(info.Meta.CurrentOffset), nil
+}
+
+// write writes an event line and the payloads of its messages
+func (s *replicationSender) write(ev replicationEvent, messages []store.Message) error {
+	line, err := json.Marshal(ev)
+	if err != nil {
+		return err
+	}
+	s.w.Write(line)
+	s.w.WriteByte('\n')
+	for _, msg := range messages {
+		s.w.Write(msg.Data)
+	}
+	// bufio.Writer keeps the first write error
+	_, err = s.w.Write(nil)
+	return err
+}
+
+// replicaFollower keeps a Replica store in sync with a leader and forwards
+// writes to it
+type replicaFollower struct {
+	endpoint string // the leader's replication endpoint
+	token    string
+	store    store.Replica
+	logger   *zap.Logger
+	client   *http.Client
+	proxy    *httputil.ReverseProxy
+
+	cancel context.CancelFunc
+	done   chan struct{}
+}
+
+// newReplicaFollower returns a follower of the durable_streams route at the
+// base URL leader
+func newReplicaFollower(leader, token string, replica store.Replica, logger *zap.Logger) (*replicaFollower, error) {
+	u, err := url.Parse(leader)
+	if err != nil || (u.Scheme != "http" && u.Scheme != "https") || u.Host == "" {
+		return nil, fmt.Errorf("replication: invalid leader URL %q", leader)
+	}
+
+	// Stream paths are the same on every node: writes go to the leader's
+	// origin unchanged
+	origin := &url.URL{Scheme: u.Scheme, Host: u.Host}
+	proxy := httputil.NewSingleHostReverseProxy(origin)
+	direct := proxy.Director
+	proxy.Director = func(r *http.Request) {
+		direct(r)
+		r.Host = origin.Host
+	}
+	proxy.ErrorHandler = func(w http.ResponseWriter, r *http.Request, err error) {
+		logger.Warn("failed to forward write to replication leader", zap.String("path", r.URL.Path), zap.Error(err))
+		http.Error(w, "replication leader unavailable", http.StatusBadGateway)
+	}
+
+	return &replicaFollower{
+		endpoint: strings.TrimRight(leader, "/") + replicationPath,
+		token:    token,
+		store:    replica,
+		logger:   logger,
+		client:   &http.Client{},
+		proxy:    proxy,
+		done:     make(chan struct{}),
+	}, nil
+}
+
+// forwards reports whether r is a write the leader must serve
+func (f *replicaFollower) forwards(r *http.Request) bool {
+	switch r.Method {
+	case http.MethodPut, http.MethodDelete:
+		return true
+	case http.MethodPost:
+		// Multiplexed reads are served locally like any other read
+		return !isMultiplexPath(r.URL.Path)
+	default:
+		return false
+	}
+}
+
+// start begins replicating in the background
+func (f *replicaFollower) start() {
+	ctx, cancel := context.WithCancel(context.Background())
+	f.cancel = cancel
+	go f.run(ctx)
+}
+
+// stop ends replication and waits for the follower to finish
+func (f *replicaFollower) stop() {
+	f.cancel()
+	<-f.done
+}
+
+func (f *replicaFollower) run(ctx context.Context) {
+	defer close(f.done)
+
+	backoff := replicationMinBackoff
+	for {
+		connected, err := f.follow(ctx)
+		if ctx.Err() != nil {
+			return
+		}
+		if connected {
+			backoff = replicationMinBackoff
+		}
+		f.logger.Warn("replication from leader interrupted",
+			zap.String("leader", f.endpoint),
+			zap.Duration("retry_in", backoff),
+			zap.Error(err))
+
+		select {
+		case <-ctx.Done():
+			return
+		case <-time.After(backoff):
+		}
+		backoff = min(backoff*2, replicationMaxBackoff)
+	}
+}
+
+// follow runs one replication connection until it fails. connected reports
+// whether the leader accepted it.
+func (f *replicaFollower) follow(ctx context.Context) (connected bool, err error) {
+	ctx, cancel := context.WithCancel(ctx)
+	defer cancel()
+
+	var body replicationRequest
+	for _, info := range f.store.Streams() {
+		body.Streams = append(body.Streams, replicaCursor{
+			Path:   info.Meta.Path,
+			ID:     info.ID,
+			Offset: info.Meta.CurrentOffset.String(),
+		})
+	}
+	encoded, err := json.Marshal(body)
+	if err != nil {
+		return false, err
+	}
+	req, err := http.NewRequestWithContext(ctx, http.MethodPost, f.endpoint, bytes.NewReader(encoded))
+	if err != nil {
+		return false, err
+	}
+	req.Header.Set("Content-Type", "application/json")
+	req.Header.Set("Authorization", "Bearer "+f.token)
+
+	resp, err := f.client.Do(req)
+	if err != nil {
+		return false, err
+	}
+	defer resp.Body.Close()
+	if resp.StatusCode != http.StatusOK {
+		msg, _ := io.ReadAll(io.LimitReader(resp.Body, 1024))
+		return false, fmt.Errorf("leader refused replication: %s: %s", resp.Status, strings.TrimSpace(string(msg)))
+	}
+
+	// A leader that goes quiet past its pings is reconnected to
+	watchdog := time.AfterFunc(replicationIdleTimeout, cancel)
+	defer watchdog.Stop()
+
+	r := bufio.NewReader(resp.Body)
+	for {
+		line, err := r.ReadBytes('\n')
+		if err != nil {
+			return true, err
+		}
+		watchdog.Reset(replicationIdleTimeout)
+
+		var ev replicationEvent
+		if err := json.Unmarshal(line, &ev); err != nil {
+			return true, fmt.Errorf("invalid replication event: %w", err)
+		}
+		switch ev.Type {
+		case "stream":
+			if err := f.applyStream(r, ev); err != nil {
+				if errors.Is(err, store.ErrReplicaDiverged) {
+					return true, f.dropDiverged(ev.Stream.Path, err)
+				}
+				return true, err
+			}
+		case "delete":
+			err := f.store.ReplicateDelete(ev.Path)
+			if err != nil && !errors.Is(err, store.ErrStreamNotFound) {
+				return true, fmt.Errorf("failed to delete %s: %w", ev.Path, err)
+			}
+		case "ping":
+		default:
+			return true, fmt.Errorf("unknown replication event %q", ev.Type)
+		}
+	}
+}
+
+// dropDiverged deletes the local copy of a stream that no longer lines up
+// with the leader's. The next connection no longer lists it, so the leader
+// ships it anew from the start rather than from the diverged cursor.
+func (f *replicaFollower) dropDiverged(path string, cause error) error {
+	if err := f.store.ReplicateDelete(path); err != nil && !errors.Is(err, store.ErrStreamNotFound) {
+		return fmt.Errorf("failed to drop diverged copy of %s: %w", path, err)
+	}
+	return fmt.Errorf("dropped diverged copy of %s to resync it: %w", path, cause)
+}
+
+// applyStream reads the payloads of a stream event and replicates it
+func (f *replicaFollower) applyStream(r io.Reader, ev replicationEvent) error {
+	if ev.Stream == nil {
+		return errors.New("stream event without a stream")
+	}
+	info, err := ev.Stream.info()
+	if err != nil {
+		return fmt.Errorf("invalid replicated stream %s: %w", ev.Stream.Path, err)
+	}
+
+	total := 0
+	for _, m := range ev.Messages {
+		if m.Size < 0 {
+			return fmt.Errorf("invalid message size %d", m.Size)
+		}
+		total += m.Size
+	}
+	payloads := make([]byte, total)
+	if _, err := io.ReadFull(r, payloads); err != nil {
+		return err
+	}
+	messages := make([]store.Message, len(ev.Messages))
+	for i, m := range ev.Messages {
+		offset, err := store.ParseOffset(m.Offset)
+		if err != nil {
+			return fmt.Errorf("invalid message offset %q", m.Offset)
+		}
+		messages[i] = store.Message{Data: payloads[:m.Size:m.Size], Offset: offset}
+		payloads = payloads[m.Size:]
+	}
+
+	if err := f.store.Replicate(info, messages); err != nil {
+		return fmt.Errorf("failed to replicate %s: %w", info.Meta.Path, err)
+	}
+	return nil
+}
@@ -0,0 +1,184 @@
+package durablestreams
+
+import (
+	"io"
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/caddyserver/caddy/v2"
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+	"go.uber.org/zap"
+)
+
+func newReplicationTestHandler(t *testing.T) *Handler {
+	t.Helper()
+	fs, err := store.NewFileStore(store.FileStoreConfig{DataDir: t.TempDir(), SegmentMaxBytes: 64})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	return &Handler{
+		SSEReconnectInterval: caddy.Duration(time.Minute),
+		LongPollTimeout:      caddy.Duration(time.Second),
+		MaxReadBytes:         DefaultMaxReadBytes,
+		store:                fs,
+		logger:               zap.NewNop(),
+		sseHubs:              newSSEHubs(),
+	}
+}
+
+func serveTestHandler(h *Handler) *httptest.Server {
+	return httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		h.ServeHTTP(w, r, nil)
+	}))
+}
+
+func doRequest(t *testing.T, method, url, contentType, body string) *http.Response {
+	t.Helper()
+	req, _ := http.NewRequest(method, url, strings.NewReader(body))
+	if contentType != "" {
+		req.Header.Set("Content-Type", contentType)
+	}
+	resp, err := http.DefaultClient.Do(req)
+	if err != nil {
+		t.Fatalf("%s %s failed: %v", method, url, err)
+	}
+	return resp
+}
+
+func TestReplication_FollowerServesLeaderStreams(t *testing.T) {
+	leader := newReplicationTestHandler(t)
+	leader.replicationToken = "secret"
+	defer leader.store.Close()
+	leaderServer := serveTestHandler(leader)
+	defer leaderServer.Close()
+
+	follower := newReplicationTestHandler(t)
+	defer follower.store.Close()
+	var err error
+	follower.follower, err = newReplicaFollower(leaderServer.URL, "secret", follower.store.(store.Replica), zap.NewNop())
+	if err != nil {
+		t.Fatalf("newReplicaFollower failed: %v", err)
+	}
+	followerServer := serveTestHandler(follower)
+	defer followerServer.Close()
+
+	// Streams created before the follower connects are synced on connect
+	leader.store.Create("/old", store.CreateOptions{ContentType: "text/plain"})
+	leader.store.Append("/old", []byte("before"), store.AppendOptions{})
+	follower.follower.start()
+	defer follower.follower.stop()
+
+	// Writes sent to the follower are served by the leader
+	resp := doRequest(t, http.MethodPut, followerServer.URL+"/s", "text/plain", "")
+	resp.Body.Close()
+	if resp.StatusCode != http.StatusCreated {
+		t.Fatalf("expected 201 from the forwarded create, got %d", resp.StatusCode)
+	}
+	var tail string
+	for i := 0; i < 10; i++ {
+		resp := doRequest(t, http.MethodPost, followerServer.URL+"/s", "text/plain", "message-"+string(rune('0'+i)))
+		resp.Body.Close()
+		if resp.StatusCode != http.StatusNoContent {
+			t.Fatalf("expected 204 from the forwarded append, got %d", resp.StatusCode)
+		}
+		tail = resp.Header.Get(HeaderStreamNextOffset)
+	}
+	if !leader.store.Has("/s") {
+		t.Fatal("expected the stream on the leader")
+	}
+
+	// Reads are served from the follower's copy, at the leader's offsets
+	waitFor(t, "replicated tail", func() bool {
+		offset, err := follower.store.GetCurrentOffset("/s")
+		return err == nil && offset.String() == tail
+	})
+	resp = doRequest(t, http.MethodGet, followerServer.URL+"/s?offset=-1", "", "")
+	body, _ := io.ReadAll(resp.Body)
+	resp.Body.Close()
+	if string(body) != "message-0message-1message-2message-3message-4message-5message-6message-7message-8message-9" {
+		t.Errorf("unexpected follower read %q", body)
+	}
+	if got := resp.Header.Get(HeaderStreamNextOffset); got != tail {
+		t.Errorf("expected next offset %s, got %s", tail, got)
+	}
+	msgs, _, err := follower.store.Read("/old", store.ZeroOffset)
+	if err != nil || len(msgs) != 1 || string(msgs[0].Data) != "before" {
+		t.Errorf("expected the existing stream synced, got %v (%v)", msgs, err)
+	}
+
+	// Deletes reach followers too
+	resp = doRequest(t, http.MethodDelete, followerServer.URL+"/s", "", "")
+	resp.Body.Close()
+	waitFor(t, "replicated delete", func() bool { return !follower.store.Has("/s") })
+}
+
+func TestReplication_FollowerResyncsDivergedStream(t *testing.T) {
+	leader := newReplicationTestHandler(t)
+	leader.replicationToken = "secret"
+	defer leader.store.Close()
+	leaderServer := serveTestHandler(leader)
+	defer leaderServer.Close()
+
+	follower := newReplicationTestHandler(t)
+	defer follower.store.Close()
+	replica := follower.store.(store.Replica)
+	startFollower := func() *replicaFollower {
+		f, err := newReplicaFollower(leaderServer.URL, "secret", replica, zap.NewNop())
+		if err != nil {
+			t.Fatalf("newReplicaFollower failed: %v", err)
+		}
+		f.start()
+		return f
+	}
+
+	leader.store.Create("/s", store.CreateOptions{ContentType: "text/plain"})
+	leader.store.Append("/s", []byte("first"), store.AppendOptions{})
+	tail, _ := leader.store.GetCurrentOffset("/s")
+	f := startFollower()
+	waitFor(t, "initial sync", func() bool {
+		offset, err := follower.store.GetCurrentOffset("/s")
+		return err == nil && offset.Equal(tail)
+	})
+	f.stop()
+
+	// The follower's copy keeps the leader's ID but gets ahead of it with
+	// data the leader never had
+	if _, err := follower.store.Append("/s", []byte("follower-only"), store.AppendOptions{}); err != nil {
+		t.Fatalf("append failed: %v", err)
+	}
+	leader.store.Append("/s", []byte("second"), store.AppendOptions{})
+	tail, _ = leader.store.GetCurrentOffset("/s")
+
+	f = startFollower()
+	defer f.stop()
+	waitFor(t, "resync", func() bool {
+		offset, err := follower.store.GetCurrentOffset("/s")
+		return err == nil && offset.Equal(tail)
+	})
+	msgs, _, err := follower.store.Read("/s", store.ZeroOffset)
+	if err != nil || len(msgs) != 2 || string(msgs[0].Data) != "first" || string(msgs[1].Data) != "second" {
+		t.Errorf("expected the leader's copy, got %v (%v)", msgs, err)
+	}
+}
+
+func TestReplication_RequiresToken(t *testing.T) {
+	leader := newReplicationTestHandler(t)
+	defer leader.store.Close()
+
+	for token, want := range map[string]int{
+		"":       http.StatusNotFound, // replication disabled
+		"secret": http.StatusUnauthorized,
+	} {
+		leader.replicationToken = token
+		req := httptest.NewRequest(http.MethodPost, replicationPath, strings.NewReader(`{"streams":[]}`))
+		req.Header.Set("Authorization", "Bearer wrong")
+		rec := httptest.NewRecorder()
+		leader.ServeHTTP(rec, req, nil)
+		if rec.Code != want {
+			t.Errorf("token %q: expected %d, got %d", token, want, rec.Code)
+		}
+	}
+}
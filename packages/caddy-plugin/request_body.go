@@ -0,0 +1,45 @@
+package durablestreams
+
+import (
+	"compress/gzip"
+	"errors"
+	"io"
+	"net/http"
+	"strings"
+)
+
+// maxInflatedBodyBytes bounds a compressed request body once inflated
+const maxInflatedBodyBytes = 64 * 1024 * 1024
+
+var (
+	errUnsupportedEncoding = errors.New("unsupported content encoding")
+	errInflatedTooLarge    = errors.New("inflated body too large")
+)
+
+// readRequestBody reads a request body, inflating it if the client sent it
+// gzip-compressed. Other content codings yield errUnsupportedEncoding, and
+// bodies that inflate past maxInflatedBodyBytes errInflatedTooLarge.
+func readRequestBody(r *http.Request) ([]byte, error) {
+	encoding := strings.ToLower(strings.TrimSpace(r.Header.Get("Content-Encoding")))
+	switch encoding {
+	case "", "identity":
+		return io.ReadAll(r.Body)
+	case "gzip", "x-gzip":
+	default:
+		return nil, errUnsupportedEncoding
+	}
+
+	zr, err := gzip.NewReader(r.Body)
+	if err != nil {
+		return nil, err
+	}
+	defer zr.Close()
+	body, err := io.ReadAll(io.LimitReader(zr, maxInflatedBodyBytes+1))
+	if err != nil {
+		return nil, err
+	}
+	if len(body) > maxInflatedBodyBytes {
+		return nil, errInflatedTooLarge
+	}
+	return body, nil
+}
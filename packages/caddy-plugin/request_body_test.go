@@ -0,0 +1,88 @@
+package durablestreams
+
+import (
+	"bytes"
+	"compress/gzip"
+	"errors"
+	"io"
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"testing"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+)
+
+func TestHandleAppend_InflatesGzipBodies(t *testing.T) {
+	h := &Handler{store: store.NewMemoryStore()}
+	defer h.store.Close()
+	if _, _, err := h.store.Create("/s", store.CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("create failed: %v", err)
+	}
+
+	appendBody := func(encoding string, body []byte) error {
+		t.Helper()
+		req := httptest.NewRequest(http.MethodPost, "/s", bytes.NewReader(body))
+		req.Header.Set("Content-Type", "text/plain")
+		req.Header.Set("Content-Encoding", encoding)
+		return h.handleAppend(httptest.NewRecorder(), req, "/s")
+	}
+
+	payload := strings.Repeat("hello ", 500)
+	var buf bytes.Buffer
+	zw := gzip.NewWriter(&buf)
+	zw.Write([]byte(payload))
+	zw.Close()
+	if err := appendBody("gzip", buf.Bytes()); err != nil {
+		t.Fatalf("gzip append failed: %v", err)
+	}
+	msgs, _, err := h.store.Read("/s", store.ZeroOffset)
+	if err != nil || len(msgs) != 1 || string(msgs[0].Data) != payload {
+		t.Fatalf("expected the inflated payload stored, got %v (%v)", msgs, err)
+	}
+
+	for encoding, want := range map[string]int{
+		"br":   http.StatusUnsupportedMediaType,
+		"gzip": http.StatusBadRequest, // not actually gzip
+	} {
+		var httpErr *httpError
+		if err := appendBody(encoding, []byte("data")); !errors.As(err, &httpErr) || httpErr.status != want {
+			t.Errorf("%s: expected status %d, got %v", encoding, want, err)
+		}
+	}
+}
+
+func TestHandleAppend_RejectsBodiesInflatingPastCap(t *testing.T) {
+	h := &Handler{store: store.NewMemoryStore()}
+	defer h.store.Close()
+	if _, _, err := h.store.Create("/s", store.CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("create failed: %v", err)
+	}
+
+	// A small gzip body that inflates one byte past the cap
+	var buf bytes.Buffer
+	zw := gzip.NewWriter(&buf)
+	if _, err := io.CopyN(zw, zeroReader{}, maxInflatedBodyBytes+1); err != nil {
+		t.Fatalf("compress failed: %v", err)
+	}
+	zw.Close()
+
+	req := httptest.NewRequest(http.MethodPost, "/s", &buf)
+	req.Header.Set("Content-Type", "text/plain")
+	req.Header.Set("Content-Encoding", "gzip")
+	var httpErr *httpError
+	if err := h.handleAppend(httptest.NewRecorder(), req, "/s"); !errors.As(err, &httpErr) || httpErr.status != http.StatusRequestEntityTooLarge {
+		t.Fatalf("expected status %d, got %v", http.StatusRequestEntityTooLarge, err)
+	}
+
+	if msgs, _, _ := h.store.Read("/s", store.ZeroOffset); len(msgs) != 0 {
+		t.Errorf("expected nothing appended, got %d messages", len(msgs))
+	}
+}
+
+type zeroReader struct{}
+
+func (zeroReader) Read(p []byte) (int, error) {
+	clear(p)
+	return len(p), nil
+}
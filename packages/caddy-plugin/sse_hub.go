@@ -0,0 +1,326 @@
+package durablestreams
+
+import (
+	"bytes"
+	"context"
+	"encoding/base64"
+	"encoding/json"
+	"sync"
+	"time"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+)
+
+const (
+	// sseSubscriberBuffer is how many frames a live SSE connection may fall
+	// behind its hub before it is switched to reading from the store itself
+	sseSubscriberBuffer = 64
+
+	// sseHubWaitTimeout bounds each hub wait on the store. Appends wake the
+	// hub immediately; the timeout only re-arms an idle wait.
+	sseHubWaitTimeout = 30 * time.Second
+)
+
+// sseFrame is one chunk of a stream encoded once for every live subscriber.
+type sseFrame struct {
+	start    store.Offset // Offset the chunk was read from
+	end      store.Offset // Offset after the chunk (streamNextOffset)
+	data     []byte       // Encoded "event: data" block, nil for control-only frames
+	upToDate bool         // Chunk reaches the tail of the stream
+	closed   bool         // Stream is closed at end; this is the final frame
+
+	// Control events carry a cursor derived from each client's own cursor,
+	// so they are encoded lazily and shared between clients that sent the
+	// same one.
+	controlsMu sync.Mutex
+	controls   map[string][]byte
+}
+
+// control returns the encoded control event for a client that sent cursor
+func (f *sseFrame) control(cursor string) []byte {
+	if f.closed {
+		// streamCursor is omitted from the final control event
+		f.controlsMu.Lock()
+		defer f.controlsMu.Unlock()
+		if f.controls == nil {
+			f.controls = map[string][]byte{"": encodeSSEControl(f.end, "", false, true)}
+		}
+		return f.controls[""]
+	}
+
+	f.controlsMu.Lock()
+	defer f.controlsMu.Unlock()
+	if encoded, ok := f.controls[cursor]; ok {
+		return encoded
+	}
+	if f.controls == nil {
+		f.controls = make(map[string][]byte)
+	}
+	encoded := encodeSSEControl(f.end, generateResponseCursor(cursor), f.upToDate, false)
+	f.controls[cursor] = encoded
+	return encoded
+}
+
+// encodeSSEData encodes a response body as an SSE data event
+func encodeSSEData(body []byte, useBase64 bool) []byte {
+	var buf bytes.Buffer
+	buf.WriteString("event: data\n")
+
+	if useBase64 {
+		// Base64 encode the binary data for SSE delivery (Protocol Section 5.7)
+		buf.Grow(base64.StdEncoding.EncodedLen(len(body)) + 8)
+		buf.WriteString("data:")
+		buf.WriteString(base64.StdEncoding.EncodeToString(body))
+		buf.WriteString("\n")
+	} else {
+		// Split on all SSE-valid line terminators (CRLF, CR, LF) to prevent injection
+		// Note: Per SSE spec, we don't add a space after "data:" because clients
+		// strip exactly one leading space. Adding one would cause data starting
+		// with spaces to lose an extra space character.
+		for _, line := range sseLineTerminators.Split(string(body), -1) {
+			buf.WriteString("data:")
+			buf.WriteString(line)
+			buf.WriteString("\n")
+		}
+	}
+	buf.WriteString("\n")
+	return buf.Bytes()
+}
+
+// encodeSSEControl encodes an SSE control event. streamCursor and upToDate
+// are omitted when closed is set, as the final control event implies them.
+func encodeSSEControl(nextOffset store.Offset, cursor string, upToDate, closed bool) []byte {
+	control := map[string]interface{}{
+		"streamNextOffset": nextOffset.String(),
+	}
+	if closed {
+		control["streamClosed"] = true
+	} else {
+		control["streamCursor"] = cursor
+		if upToDate {
+			control["upToDate"] = true
+		}
+	}
+
+	controlJSON, _ := json.Marshal(control)
+	var buf bytes.Buffer
+	buf.Grow(len(controlJSON) + 24)
+	buf.WriteString("event: control\n")
+	buf.WriteString("data:")
+	buf.Write(controlJSON)
+	buf.WriteString("\n\n")
+	return buf.Bytes()
+}
+
+// sseSubscriber is one live SSE connection attached to a hub.
+type sseSubscriber struct {
+	hub *sseHub
+
+	// frames receives the hub's frames in order. It is closed when the hub stops.
+	frames chan *sseFrame
+
+	// lagged is signalled when a frame had to be dropped because frames was
+	// full. The connection then re-reads from the store at its own pace.
+	lagged chan struct{}
+
+	// wake, if set, is signalled after every frame, lag or stop, so a
+	// multiplexed connection can poll all of its subscribers from one select.
+	// It is shared by the connection's subscribers.
+	wake chan struct{}
+}
+
+// signal pokes the subscriber's wake channel without blocking
+func (sub *sseSubscriber) signal() {
+	if sub.wake != nil {
+		select {
+		case sub.wake <- struct{}{}:
+		default:
+		}
+	}
+}
+
+type sseHubKey struct {
+	path        string
+	contentType string
+}
+
+// sseHub fans one stream out to all of its live SSE connections. A single
+// goroutine waits on the store, reads each new chunk once and encodes it
+// once; connections only copy the shared frame to their socket.
+//
+// Frames are delivered with non-blocking sends, so a slow connection never
+// holds up the hub or its peers. Connections line frames up against their own
+// offset and fall back to a direct store read on any gap, which also covers
+// dropped frames and the catch-up race when joining.
+type sseHub struct {
+	key       sseHubKey
+	useBase64 bool
+	hubs      *sseHubs
+	ctx       context.Context
+	cancel    context.CancelFunc
+
+	mu      sync.Mutex
+	subs    map[*sseSubscriber]struct{}
+	stopped bool
+}
+
+// sseHubs is the registry of running hubs, keyed by stream path and content
+// type (a stream recreated with another content type gets a fresh hub).
+type sseHubs struct {
+	mu   sync.Mutex
+	hubs map[sseHubKey]*sseHub
+}
+
+func newSSEHubs() *sseHubs {
+	return &sseHubs{hubs: make(map[sseHubKey]*sseHub)}
+}
+
+// subscribe attaches a new subscriber to the hub for path, starting the hub
+// at the current tail if none is running. wake is the subscriber's wake
+// channel, nil for a single-stream connection.
+func (r *sseHubs) subscribe(h *Handler, path, contentType string, useBase64 bool, wake chan struct{}) *sseSubscriber {
+	sub := &sseSubscriber{
+		frames: make(chan *sseFrame, sseSubscriberBuffer),
+		lagged: make(chan struct{}, 1),
+		wake:   wake,
+	}
+	key := sseHubKey{path: path, contentType: contentType}
+
+	r.mu.Lock()
+	defer r.mu.Unlock()
+
+	if hub, ok := r.hubs[key]; ok {
+		hub.mu.Lock()
+		if !hub.stopped && hub.ctx.Err() == nil {
+			sub.hub = hub
+			hub.subs[sub] = struct{}{}
+			hub.mu.Unlock()
+			return sub
+		}
+		hub.mu.Unlock()
+	}
+
+	start, err := h.store.GetCurrentOffset(path)
+	if err != nil {
+		// No hub to join; the caller's own reads will surface the error
+		close(sub.frames)
+		return sub
+	}
+
+	ctx, cancel := context.WithCancel(context.Background())
+	hub := &sseHub{
+		key:       key,
+		useBase64: useBase64,
+		hubs:      r,
+		ctx:       ctx,
+		cancel:    cancel,
+		subs:      map[*sseSubscriber]struct{}{sub: {}},
+	}
+	sub.hub = hub
+	r.hubs[key] = hub
+	go hub.run(h, start)
+	return sub
+}
+
+// unsubscribe detaches sub. The hub stops once its last subscriber leaves.
+func (r *sseHubs) unsubscribe(sub *sseSubscriber) {
+	hub := sub.hub
+	if hub == nil {
+		return
+	}
+	hub.mu.Lock()
+	delete(hub.subs, sub)
+	if len(hub.subs) == 0 {
+		hub.cancel()
+	}
+	hub.mu.Unlock()
+}
+
+// count returns the number of running hubs
+func (r *sseHubs) count() int {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return len(r.hubs)
+}
+
+// run is the hub's read loop
+func (hub *sseHub) run(h *Handler, offset store.Offset) {
+	defer hub.stop()
+
+	path := hub.key.path
+	for {
+		messages, _, closed, err := h.store.WaitForMessages(hub.ctx, path, offset, sseHubWaitTimeout, h.readLimits())
+		if hub.ctx.Err() != nil || err != nil {
+			// No subscribers left, or the stream is gone. Subscribers find
+			// out which from the store once their channel is closed.
+			return
+		}
+
+		if len(messages) == 0 {
+			if closed {
+				hub.broadcast(&sseFrame{start: offset, end: offset, closed: true})
+				return
+			}
+			continue
+		}
+
+		// A burst larger than one chunk was read up to the chunk limits and
+		// is broadcast over several frames
+
+		body, _ := h.formatResponse(path, messages, hub.key.contentType)
+		frame := &sseFrame{
+			start: offset,
+			end:   messages[len(messages)-1].Offset,
+			data:  encodeSSEData(body, hub.useBase64),
+		}
+		if meta, err := h.store.Get(path); err == nil && frame.end.Equal(meta.CurrentOffset) {
+			frame.upToDate = true
+			frame.closed = meta.Closed
+		}
+
+		hub.broadcast(frame)
+		if frame.closed {
+			return
+		}
+		offset = frame.end
+	}
+}
+
+// broadcast hands frame to every subscriber without blocking
+func (hub *sseHub) broadcast(frame *sseFrame) {
+	hub.mu.Lock()
+	defer hub.mu.Unlock()
+	for sub := range hub.subs {
+		select {
+		case sub.frames <- frame:
+		default:
+			select {
+			case sub.lagged <- struct{}{}:
+			default:
+			}
+		}
+		sub.signal()
+	}
+}
+
+// stop removes the hub from the registry and closes its subscribers' frame
+// channels so they resynchronise from the store.
+func (hub *sseHub) stop() {
+	hub.cancel()
+
+	r := hub.hubs
+	r.mu.Lock()
+	if r.hubs[hub.key] == hub {
+		delete(r.hubs, hub.key)
+	}
+	r.mu.Unlock()
+
+	hub.mu.Lock()
+	hub.stopped = true
+	for sub := range hub.subs {
+		close(sub.frames)
+		sub.signal()
+	}
+	hub.subs = nil
+	hub.mu.Unlock()
+}
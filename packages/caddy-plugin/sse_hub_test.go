@@ -0,0 +1,192 @@
+package durablestreams
+
+import (
+	"bytes"
+	"context"
+	"net/http"
+	"net/http/httptest"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+
+	"github.com/caddyserver/caddy/v2"
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/store"
+)
+
+// sseRecorder is a flushable ResponseWriter safe to read while the handler writes
+type sseRecorder struct {
+	mu     sync.Mutex
+	header http.Header
+	body   bytes.Buffer
+}
+
+func (r *sseRecorder) Header() http.Header { return r.header }
+func (r *sseRecorder) WriteHeader(int)     {}
+func (r *sseRecorder) Flush()              {}
+
+func (r *sseRecorder) Write(p []byte) (int, error) {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return r.body.Write(p)
+}
+
+func (r *sseRecorder) String() string {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return r.body.String()
+}
+
+func newSSETestHandler() *Handler {
+	return &Handler{
+		SSEReconnectInterval: caddy.Duration(time.Minute),
+		MaxReadBytes:         DefaultMaxReadBytes,
+		store:                store.NewMemoryStore(),
+		sseHubs:              newSSEHubs(),
+	}
+}
+
+func waitFor(t *testing.T, what string, cond func() bool) {
+	t.Helper()
+	deadline := time.Now().Add(5 * time.Second)
+	for !cond() {
+		if time.Now().After(deadline) {
+			t.Fatalf("timed out waiting for %s", what)
+		}
+		time.Sleep(5 * time.Millisecond)
+	}
+}
+
+func TestSSEHub_FansOutToAllConnections(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	if _, _, err := h.store.Create("/s", store.CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("create failed: %v", err)
+	}
+	if _, err := h.store.Append("/s", []byte("backlog"), store.AppendOptions{}); err != nil {
+		t.Fatalf("append failed: %v", err)
+	}
+
+	const conns = 3
+	ctx, cancel := context.WithCancel(context.Background())
+	recorders := make([]*sseRecorder, conns)
+	var wg sync.WaitGroup
+	for i := range recorders {
+		rec := &sseRecorder{header: make(http.Header)}
+		recorders[i] = rec
+		req := httptest.NewRequest(http.MethodGet, "/s?live=sse&offset=-1", nil).WithContext(ctx)
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			if err := h.handleSSE(rec, req, "/s", store.ZeroOffset, "", false); err != nil {
+				t.Errorf("handleSSE failed: %v", err)
+			}
+		}()
+	}
+
+	for _, rec := range recorders {
+		waitFor(t, "backlog", func() bool { return strings.Contains(rec.String(), "data:backlog\n") })
+	}
+	if got := h.sseHubs.count(); got != 1 {
+		t.Errorf("expected one hub for the stream, got %d", got)
+	}
+
+	for _, msg := range []string{"one", "two", "three"} {
+		if _, err := h.store.Append("/s", []byte(msg), store.AppendOptions{}); err != nil {
+			t.Fatalf("append failed: %v", err)
+		}
+	}
+	for _, rec := range recorders {
+		waitFor(t, "live data", func() bool {
+			body := rec.String()
+			return strings.Count(body, "event: data\n") >= 2 && strings.Contains(body, "three")
+		})
+		body := rec.String()
+		if i, j := strings.Index(body, "one"), strings.Index(body, "three"); i < 0 || j < i {
+			t.Errorf("live data out of order: %q", body)
+		}
+	}
+
+	cancel()
+	wg.Wait()
+	waitFor(t, "hub shutdown", func() bool { return h.sseHubs.count() == 0 })
+}
+
+func TestSSEHub_ClosedStreamEndsConnections(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	if _, _, err := h.store.Create("/s", store.CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("create failed: %v", err)
+	}
+
+	rec := &sseRecorder{header: make(http.Header)}
+	req := httptest.NewRequest(http.MethodGet, "/s?live=sse&offset=-1", nil)
+	done := make(chan error, 1)
+	go func() {
+		done <- h.handleSSE(rec, req, "/s", store.ZeroOffset, "", false)
+	}()
+
+	waitFor(t, "initial control", func() bool { return strings.Contains(rec.String(), `"upToDate":true`) })
+	if _, err := h.store.Append("/s", []byte("last"), store.AppendOptions{Close: true}); err != nil {
+		t.Fatalf("append failed: %v", err)
+	}
+
+	select {
+	case err := <-done:
+		if err != nil {
+			t.Fatalf("handleSSE failed: %v", err)
+		}
+	case <-time.After(5 * time.Second):
+		t.Fatal("connection should end once the stream is closed")
+	}
+
+	body := rec.String()
+	if !strings.Contains(body, "data:last\n") || !strings.Contains(body, `"streamClosed":true`) {
+		t.Errorf("expected final data and streamClosed, got %q", body)
+	}
+	waitFor(t, "hub shutdown", func() bool { return h.sseHubs.count() == 0 })
+}
+
+func TestSSEHub_SlowSubscriberDoesNotBlockHub(t *testing.T) {
+	h := newSSETestHandler()
+	defer h.store.Close()
+
+	if _, _, err := h.store.Create("/s", store.CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("create failed: %v", err)
+	}
+
+	sub := h.sseHubs.subscribe(h, "/s", "text/plain", false, nil)
+	defer h.sseHubs.unsubscribe(sub)
+
+	// Nobody drains sub: fill its buffer, then overflow it
+	for i := 0; i <= sseSubscriberBuffer; i++ {
+		if _, err := h.store.Append("/s", []byte("x"), store.AppendOptions{}); err != nil {
+			t.Fatalf("append failed: %v", err)
+		}
+		want := i + 1
+		waitFor(t, "broadcast", func() bool {
+			return len(sub.frames) == want || len(sub.lagged) == 1
+		})
+	}
+	waitFor(t, "lag signal", func() bool { return len(sub.lagged) == 1 })
+
+	// The hub keeps serving other connections meanwhile
+	other := h.sseHubs.subscribe(h, "/s", "text/plain", false, nil)
+	defer h.sseHubs.unsubscribe(other)
+	if other.hub != sub.hub {
+		t.Fatal("expected both subscribers on the same hub")
+	}
+	if _, err := h.store.Append("/s", []byte("y"), store.AppendOptions{}); err != nil {
+		t.Fatalf("append failed: %v", err)
+	}
+	select {
+	case frame := <-other.frames:
+		if !bytes.Contains(frame.data, []byte("data:y\n")) {
+			t.Errorf("unexpected frame %q", frame.data)
+		}
+	case <-time.After(5 * time.Second):
+		t.Fatal("hub blocked on a slow subscriber")
+	}
+}
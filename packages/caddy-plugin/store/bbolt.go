@@ -405,6 +405,88 @@ func (s *BboltMetadataStore) UpdateAppendState(path string, offset Offset, lastS
 	})
 }
 
+// AppendStateUpdate is the pending append state of one stream, applied by
+// ApplyAppendStates. Fields mirror UpdateAppendState; Producers holds every
+// producer whose state changed.
+type AppendStateUpdate struct {
+	Path          string
+	DirectoryName string // Stream instance the update belongs to
+	Offset        Offset
+	LastSeq       string
+	Producers     map[string]*ProducerState
+	Closed        bool
+	ClosedBy      *ClosedByProducer
+}
+
+// ApplyAppendStates applies a batch of append state updates in a single
+// transaction. Updates for streams that no longer exist, or whose path now
+// belongs to a different stream instance, are skipped.
+func (s *BboltMetadataStore) ApplyAppendStates(updates []*AppendStateUpdate) error {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+
+	if s.closed {
+		return fmt.Errorf("store is closed")
+	}
+
+	return s.db.Update(func(tx *bbolt.Tx) error {
+		b := tx.Bucket(metadataBucket)
+
+		for _, u := range updates {
+			data := b.Get([]byte(u.Path))
+			if data == nil {
+				continue
+			}
+
+			// Make a copy
+			dataCopy := make([]byte, len(data))
+			copy(dataCopy, data)
+
+			var bm bboltMetadata
+			if err := json.Unmarshal(dataCopy, &bm); err != nil {
+				return err
+			}
+			if bm.DirectoryName != u.DirectoryName {
+				continue
+			}
+
+			bm.CurrentOffset = u.Offset.String()
+			if u.LastSeq != "" {
+				bm.LastSeq = u.LastSeq
+			}
+			for producerId, state := range u.Producers {
+				if bm.Producers == nil {
+					bm.Producers = make(map[string]*bboltProducerState)
+				}
+				bm.Producers[producerId] = &bboltProducerState{
+					Epoch:       state.Epoch,
+					LastSeq:     state.LastSeq,
+					LastUpdated: state.LastUpdated,
+				}
+			}
+			if u.Closed {
+				bm.Closed = true
+				if u.ClosedBy != nil {
+					bm.ClosedBy = &bboltClosedByProducer{
+						ProducerId: u.ClosedBy.ProducerId,
+						Epoch:      u.ClosedBy.Epoch,
+						Seq:        u.ClosedBy.Seq,
+					}
+				}
+			}
+
+			newData, err := json.Marshal(bm)
+			if err != nil {
+				return err
+			}
+			if err := b.Put([]byte(u.Path), newData); err != nil {
+				return err
+			}
+		}
+		return nil
+	})
+}
+
 // List returns all stream paths
 func (s *BboltMetadataStore) List() ([]string, error) {
 	s.mu.RLock()
@@ -0,0 +1,187 @@
+package store
+
+import (
+	"context"
+	"fmt"
+	"sync"
+	"testing"
+	"time"
+)
+
+// Store benchmarks, run against both implementations:
+//
+//	go test ./store -run '^$' -bench . -benchmem
+
+const benchMessageBytes = 256
+
+type benchStore struct {
+	name string
+	open func(b *testing.B) Store
+}
+
+var benchStores = []benchStore{
+	{"memory", func(b *testing.B) Store { return NewMemoryStore() }},
+	{"file", func(b *testing.B) Store {
+		s, err := NewFileStore(FileStoreConfig{DataDir: b.TempDir()})
+		if err != nil {
+			b.Fatalf("NewFileStore: %v", err)
+		}
+		return s
+	}},
+}
+
+func runStoreBenchmarks(b *testing.B, fn func(b *testing.B, s Store)) {
+	for _, bs := range benchStores {
+		b.Run(bs.name, func(b *testing.B) {
+			s := bs.open(b)
+			defer s.Close()
+			fn(b, s)
+		})
+	}
+}
+
+func benchCreate(b *testing.B, s Store, path, contentType string) {
+	b.Helper()
+	if _, _, err := s.Create(path, CreateOptions{ContentType: contentType}); err != nil {
+		b.Fatalf("Create: %v", err)
+	}
+}
+
+func benchPayload(contentType string) []byte {
+	if IsJSONContentType(contentType) {
+		return []byte(fmt.Sprintf(`{"type":"bench","payload":"%0*d"}`, benchMessageBytes-32, 0))
+	}
+	return make([]byte, benchMessageBytes)
+}
+
+// benchSeed appends n messages to a new stream at path
+func benchSeed(b *testing.B, s Store, path, contentType string, n int) {
+	b.Helper()
+	benchCreate(b, s, path, contentType)
+	data := benchPayload(contentType)
+	for i := 0; i < n; i++ {
+		if _, err := s.Append(path, data, AppendOptions{}); err != nil {
+			b.Fatalf("Append: %v", err)
+		}
+	}
+}
+
+func BenchmarkStore_Append(b *testing.B) {
+	for _, contentType := range []string{"application/octet-stream", "application/json"} {
+		b.Run(ExtractMediaType(contentType), func(b *testing.B) {
+			runStoreBenchmarks(b, func(b *testing.B, s Store) {
+				benchCreate(b, s, "/bench/append", contentType)
+				data := benchPayload(contentType)
+				b.SetBytes(int64(len(data)))
+				b.ReportAllocs()
+				b.ResetTimer()
+				for i := 0; i < b.N; i++ {
+					if _, err := s.Append("/bench/append", data, AppendOptions{}); err != nil {
+						b.Fatalf("Append: %v", err)
+					}
+				}
+			})
+		})
+	}
+}
+
+func BenchmarkStore_AppendParallel(b *testing.B) {
+	runStoreBenchmarks(b, func(b *testing.B, s Store) {
+		const streams = 16
+		for i := 0; i < streams; i++ {
+			benchCreate(b, s, fmt.Sprintf("/bench/parallel/%d", i), "application/octet-stream")
+		}
+		data := benchPayload("application/octet-stream")
+		var mu sync.Mutex
+		next := 0
+		b.SetBytes(int64(len(data)))
+		b.ReportAllocs()
+		b.ResetTimer()
+		b.RunParallel(func(pb *testing.PB) {
+			mu.Lock()
+			path := fmt.Sprintf("/bench/parallel/%d", next%streams)
+			next++
+			mu.Unlock()
+			for pb.Next() {
+				if _, err := s.Append(path, data, AppendOptions{}); err != nil {
+					b.Errorf("Append: %v", err)
+					return
+				}
+			}
+		})
+	})
+}
+
+// BenchmarkStore_ReadCatchUp reads a 1000-message stream from the beginning
+func BenchmarkStore_ReadCatchUp(b *testing.B) {
+	const messages = 1000
+	runStoreBenchmarks(b, func(b *testing.B, s Store) {
+		benchSeed(b, s, "/bench/catchup", "application/octet-stream", messages)
+		b.SetBytes(messages * benchMessageBytes)
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			msgs, _, err := s.Read("/bench/catchup", ZeroOffset)
+			if err != nil {
+				b.Fatalf("Read: %v", err)
+			}
+			if len(msgs) != messages {
+				b.Fatalf("got %d messages, want %d", len(msgs), messages)
+			}
+		}
+	})
+}
+
+// BenchmarkStore_ReadTail reads the newest message, as a live reader does
+func BenchmarkStore_ReadTail(b *testing.B) {
+	runStoreBenchmarks(b, func(b *testing.B, s Store) {
+		benchSeed(b, s, "/bench/tail", "application/octet-stream", 1000)
+		msgs, _, err := s.Read("/bench/tail", ZeroOffset)
+		if err != nil {
+			b.Fatalf("Read: %v", err)
+		}
+		offset := ZeroOffset
+		if len(msgs) > 1 {
+			offset = msgs[len(msgs)-2].Offset
+		}
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			if _, _, err := s.Read("/bench/tail", offset); err != nil {
+				b.Fatalf("Read: %v", err)
+			}
+		}
+	})
+}
+
+// BenchmarkStore_WaitForMessagesWake measures append-to-wake latency of a
+// long-poll waiter parked at the tail
+func BenchmarkStore_WaitForMessagesWake(b *testing.B) {
+	runStoreBenchmarks(b, func(b *testing.B, s Store) {
+		benchCreate(b, s, "/bench/wait", "application/octet-stream")
+		data := benchPayload("application/octet-stream")
+		ctx := context.Background()
+		b.ReportAllocs()
+		b.ResetTimer()
+		for i := 0; i < b.N; i++ {
+			offset, err := s.GetCurrentOffset("/bench/wait")
+			if err != nil {
+				b.Fatalf("GetCurrentOffset: %v", err)
+			}
+			done := make(chan error, 1)
+			go func() {
+				msgs, timedOut, _, err := s.WaitForMessages(ctx, "/bench/wait", offset, 10*time.Second, ReadLimits{})
+				if err == nil && (timedOut || len(msgs) == 0) {
+					err = fmt.Errorf("woke with no messages (timedOut=%v)", timedOut)
+				}
+				done <- err
+			}()
+			if _, err := s.Append("/bench/wait", data, AppendOptions{}); err != nil {
+				b.Fatalf("Append: %v", err)
+			}
+			if err := <-done; err != nil {
+				b.Fatalf("WaitForMessages: %v", err)
+			}
+		}
+	})
+}
@@ -0,0 +1,68 @@
+package store
+
+import (
+	"container/heap"
+	"sync"
+	"time"
+)
+
+// expiryBatchSize is the number of due streams handled per expiry batch
+const expiryBatchSize = 256
+
+// expiryIndex is a min-heap of stream expiry deadlines, so expired streams
+// are found in O(expired · log n) instead of by scanning every stream.
+//
+// Entries are hints: a deadline is computed when a stream is scheduled, and
+// the sliding TTL window may move it later without updating the heap. A due
+// entry is therefore checked against the stream's current state and
+// rescheduled if the stream was accessed in the meantime. Each entry names
+// the stream instance it was scheduled for, so entries of streams that were
+// deleted or recreated are discarded when they come due.
+type expiryIndex struct {
+	mu    sync.Mutex
+	items expiryHeap
+}
+
+type expiryItem struct {
+	deadline int64 // UnixNano
+	path     string
+	stream   any // The store's entry for the stream at path
+}
+
+// schedule adds a check of stream, at path, for meta's expiry deadline. It
+// does nothing if meta never expires.
+func (x *expiryIndex) schedule(path string, stream any, meta *StreamMetadata) {
+	deadline, ok := meta.expiryDeadline()
+	if !ok {
+		return
+	}
+	x.mu.Lock()
+	defer x.mu.Unlock()
+	heap.Push(&x.items, expiryItem{deadline: deadline.UnixNano(), path: path, stream: stream})
+}
+
+// popDue removes and returns up to max entries whose deadline has passed
+func (x *expiryIndex) popDue(now time.Time, max int) []expiryItem {
+	x.mu.Lock()
+	defer x.mu.Unlock()
+
+	var due []expiryItem
+	for len(due) < max && len(x.items) > 0 && x.items[0].deadline < now.UnixNano() {
+		due = append(due, heap.Pop(&x.items).(expiryItem))
+	}
+	return due
+}
+
+type expiryHeap []expiryItem
+
+func (h expiryHeap) Len() int           { return len(h) }
+func (h expiryHeap) Less(i, j int) bool { return h[i].deadline < h[j].deadline }
+func (h expiryHeap) Swap(i, j int)      { h[i], h[j] = h[j], h[i] }
+func (h *expiryHeap) Push(x any)        { *h = append(*h, x.(expiryItem)) }
+
+func (h *expiryHeap) Pop() any {
+	old := *h
+	item := old[len(old)-1]
+	*h = old[:len(old)-1]
+	return item
+}
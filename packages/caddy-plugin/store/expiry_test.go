@@ -1,6 +1,7 @@
 package store
 
 import (
+	"fmt"
 	"os"
 	"testing"
 	"time"
@@ -346,10 +347,80 @@ func TestFileStore_BackgroundCleanup(t *testing.T) {
 	}
 
 	// Verify the expiring stream was actually removed from cache
-	store.metaCacheMu.RLock()
-	_, inCache := store.metaCache["/expiring"]
-	store.metaCacheMu.RUnlock()
+	inCache := store.streams.get("/expiring") != nil
 	if inCache {
 		t.Error("expired stream should have been removed from cache by cleanup")
 	}
 }
+
+func TestExpiryIndex_PopsDueInDeadlineOrder(t *testing.T) {
+	var x expiryIndex
+	now := time.Now()
+	for i, offset := range []time.Duration{3 * time.Second, -time.Second, -3 * time.Second, -2 * time.Second} {
+		expiresAt := now.Add(offset)
+		x.schedule(fmt.Sprintf("/s%d", i), i, &StreamMetadata{ExpiresAt: &expiresAt})
+	}
+	x.schedule("/never", nil, &StreamMetadata{})
+
+	due := x.popDue(now, 2)
+	if len(due) != 2 || due[0].path != "/s2" || due[1].path != "/s3" {
+		t.Fatalf("expected the two earliest deadlines, got %+v", due)
+	}
+	due = x.popDue(now, 10)
+	if len(due) != 1 || due[0].path != "/s1" {
+		t.Fatalf("expected the remaining due stream, got %+v", due)
+	}
+	if len(x.items) != 1 {
+		t.Errorf("expected only the future deadline to remain, got %d items", len(x.items))
+	}
+}
+
+func TestFileStore_CleanupReschedulesTouchedStreams(t *testing.T) {
+	store, err := NewFileStore(FileStoreConfig{DataDir: t.TempDir()})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer store.Close()
+
+	ttl := int64(1)
+	for _, path := range []string{"/idle", "/active"} {
+		if _, _, err := store.Create(path, CreateOptions{ContentType: "text/plain", TTLSeconds: &ttl}); err != nil {
+			t.Fatalf("Create failed: %v", err)
+		}
+	}
+
+	time.Sleep(600 * time.Millisecond)
+	if _, _, err := store.Read("/active", ZeroOffset); err != nil {
+		t.Fatalf("Read failed: %v", err)
+	}
+	time.Sleep(600 * time.Millisecond)
+
+	store.cleanupExpiredStreams()
+	if store.streams.get("/idle") != nil {
+		t.Error("expected the idle stream to be removed")
+	}
+	if !store.Has("/active") {
+		t.Fatal("expected the recently read stream to survive")
+	}
+	if len(store.expiry.items) != 1 || store.expiry.items[0].path != "/active" {
+		t.Errorf("expected the active stream to be rescheduled, got %+v", store.expiry.items)
+	}
+}
+
+func TestMemoryStore_CreateReclaimsExpiredStreams(t *testing.T) {
+	store := NewMemoryStore()
+	defer store.Close()
+
+	expiresAt := time.Now().Add(50 * time.Millisecond)
+	if _, _, err := store.Create("/expiring", CreateOptions{ContentType: "text/plain", ExpiresAt: &expiresAt}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	time.Sleep(100 * time.Millisecond)
+
+	if _, _, err := store.Create("/other", CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	if _, ok := store.streams["/expiring"]; ok {
+		t.Error("expected the expired stream to be reclaimed without being accessed")
+	}
+}
@@ -4,15 +4,20 @@ import (
 	"bytes"
 	"context"
 	"crypto/rand"
+	"encoding/binary"
 	"encoding/hex"
-	"errors"
 	"fmt"
+	"io"
+	"math"
 	"net/url"
 	"os"
 	"path/filepath"
+	"slices"
 	"strings"
 	"sync"
 	"time"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/metrics"
 )
 
 // FileStore is a file-backed implementation of the Store interface
@@ -20,21 +25,33 @@ type FileStore struct {
 	dataDir    string
 	metaStore  *BboltMetadataStore
 	writerPool *FilePool
+	readerPool *ReaderPool
+	committer  *groupCommitter
+	metaBatch  *metaBatch
 	longPoll   *longPollManager
+	tails      *tailCache // nil when disabled
+	expiry     expiryIndex
+
+	// Tiered storage (nil when no object store is configured)
+	tier        *segmentTier
+	onTierError func(error)
 
-	// Cache of stream metadata for quick access
-	metaCache   map[string]*StreamMetadata
-	dirCache    map[string]string // path -> directory name
-	metaCacheMu sync.RWMutex
+	// Segment rotation thresholds (<= 0 = never on that criterion)
+	segmentMaxBytes int64
+	segmentMaxAge   time.Duration
 
-	// Per-producer locks for serializing validation+append
-	// Key: "{streamPath}:{producerId}"
-	producerLocks   map[string]*sync.Mutex
-	producerLocksMu sync.Mutex
+	// Per-stream state, sharded for lookup. Each stream carries its own lock,
+	// so appends and reads on different streams never contend.
+	streams *streamMap
 
 	// Background cleanup
 	cleanupStop chan struct{}
 	cleanupDone chan struct{}
+
+	// Background startup recovery (see recovery.go)
+	onRecovery   func(RecoveryEvent)
+	recoveryStop chan struct{}
+	recoveryWG   sync.WaitGroup
 }
 
 // FileStoreConfig contains configuration for the file store
@@ -42,6 +59,51 @@ type FileStoreConfig struct {
 	DataDir         string
 	MaxFileHandles  int
 	CleanupInterval time.Duration // Interval for background cleanup (0 = disabled)
+
+	// Group commit: appends are acked once a shared fsync covering them
+	// completes. GroupCommitDelay is how long a commit window stays open to
+	// collect more appends (0 = no added latency; appends that arrive during
+	// an in-flight fsync still share the next one). GroupCommitMaxBatch closes
+	// the window early (0 = DefaultGroupCommitMaxBatch).
+	GroupCommitDelay    time.Duration
+	GroupCommitMaxBatch int
+
+	// Segment rotation: a stream rolls to a new segment file once its active
+	// segment reaches SegmentMaxBytes (0 = DefaultSegmentMaxBytes, negative =
+	// no size limit) or is older than SegmentMaxAge (0 = no age limit).
+	SegmentMaxBytes int64
+	SegmentMaxAge   time.Duration
+
+	// TailCacheBytes is the memory budget for keeping each stream's newest
+	// messages in memory for live readers (0 = DefaultTailCacheBytes,
+	// negative = disabled).
+	TailCacheBytes int64
+
+	// Startup recovery: streams loaded from disk are verified in the
+	// background by RecoveryWorkers goroutines (0 = a default based on
+	// GOMAXPROCS). OnRecovery, if set, is called for every repair and for
+	// streams that could not be verified; calls are serialized.
+	RecoveryWorkers int
+	OnRecovery      func(RecoveryEvent)
+
+	// MetadataFlushInterval bounds how long buffered stream offsets wait
+	// before being written to bbolt (0 = DefaultMetadataFlushInterval,
+	// negative = only when an append needs durable metadata, and on Close).
+	// Producer state, Stream-Seq and closure are always flushed before the
+	// append carrying them is acknowledged.
+	MetadataFlushInterval time.Duration
+
+	// Tiered storage: with Objects set, sealed segments are uploaded to it
+	// in the background, and once uploaded segments and cached ranges exceed
+	// TierLocalBytes on local disk (0 = DefaultTierLocalBytes) the least
+	// recently read are removed. Reads of removed segments fetch
+	// TierBlockBytes ranges (0 = DefaultTierBlockBytes) back into a local
+	// cache. Active segments always stay local. OnTierError, if set, is
+	// called for failed uploads, which are retried.
+	Objects        ObjectStore
+	TierLocalBytes int64
+	TierBlockBytes int64
+	OnTierError    func(error)
 }
 
 // NewFileStore creates a new file-backed store
@@ -67,18 +129,36 @@ func NewFileStore(cfg FileStoreConfig) (*FileStore, error) {
 		maxHandles = 100
 	}
 
+	writerPool := NewFilePool(maxHandles)
+
+	segmentMaxBytes := cfg.SegmentMaxBytes
+	if segmentMaxBytes == 0 {
+		segmentMaxBytes = DefaultSegmentMaxBytes
+	}
+
 	fs := &FileStore{
-		dataDir:    cfg.DataDir,
-		metaStore:  metaStore,
-		writerPool: NewFilePool(maxHandles),
-		longPoll: &longPollManager{
-			waiters: make(map[string][]chan struct{}),
-		},
-		metaCache:     make(map[string]*StreamMetadata),
-		dirCache:      make(map[string]string),
-		producerLocks: make(map[string]*sync.Mutex),
-		cleanupStop:   make(chan struct{}),
-		cleanupDone:   make(chan struct{}),
+		dataDir:         cfg.DataDir,
+		metaStore:       metaStore,
+		writerPool:      writerPool,
+		readerPool:      NewReaderPool(maxHandles),
+		longPoll:        newLongPollManager(),
+		tails:           newTailCache(cfg.TailCacheBytes),
+		segmentMaxBytes: segmentMaxBytes,
+		segmentMaxAge:   cfg.SegmentMaxAge,
+		streams:         newStreamMap(),
+		cleanupStop:     make(chan struct{}),
+		cleanupDone:     make(chan struct{}),
+		onRecovery:      serializeRecoveryEvents(cfg.OnRecovery),
+		recoveryStop:    make(chan struct{}),
+		onTierError:     cfg.OnTierError,
+	}
+
+	if cfg.Objects != nil {
+		fs.tier, err = newSegmentTier(cfg.Objects, cfg.DataDir, cfg.TierLocalBytes, cfg.TierBlockBytes, fs.readerPool)
+		if err != nil {
+			metaStore.Close()
+			return nil, err
+		}
 	}
 
 	// Load existing streams into cache
@@ -87,6 +167,23 @@ func NewFileStore(cfg FileStoreConfig) (*FileStore, error) {
 		return nil, fmt.Errorf("failed to load cache: %w", err)
 	}
 
+	// Verify stream tails in the background; first access waits per stream
+	if err := fs.startRecovery(cfg.RecoveryWorkers); err != nil {
+		metaStore.Close()
+		return nil, err
+	}
+
+	flushInterval := cfg.MetadataFlushInterval
+	if flushInterval == 0 {
+		flushInterval = DefaultMetadataFlushInterval
+	}
+	fs.metaBatch = newMetaBatch(metaStore, flushInterval)
+	fs.committer = newGroupCommitter(writerPool.Sync, fs.metaBatch.flush, cfg.GroupCommitDelay, cfg.GroupCommitMaxBatch)
+
+	if fs.tier != nil {
+		go fs.runUploads()
+	}
+
 	// Start background cleanup if configured
 	if cfg.CleanupInterval > 0 {
 		go fs.backgroundCleanup(cfg.CleanupInterval)
@@ -100,12 +197,45 @@ func NewFileStore(cfg FileStoreConfig) (*FileStore, error) {
 // loadCache loads all stream metadata into the cache
 func (s *FileStore) loadCache() error {
 	return s.metaStore.ForEach(func(meta *StreamMetadata, dirName string) error {
-		s.metaCache[meta.Path] = meta
-		s.dirCache[meta.Path] = dirName
+		segments, err := loadSegments(s.dataDir, dirName, meta)
+		if err != nil {
+			return fmt.Errorf("stream %s: %w", meta.Path, err)
+		}
+		st := newFileStream(meta, dirName, segments)
+		s.streams.set(meta.Path, st)
+		s.expiry.schedule(meta.Path, st, meta)
+		if s.tier != nil {
+			s.registerTiered(st)
+		}
 		return nil
 	})
 }
 
+// lookup returns a stream's entry, or nil if it does not exist. Streams
+// loaded at startup are verified first if recovery has not reached them yet.
+func (s *FileStore) lookup(path string) *fileStream {
+	st := s.streams.get(path)
+	if st != nil {
+		s.awaitRecovery(path, st)
+	}
+	return st
+}
+
+// view returns a snapshot of a stream's metadata and its segment layout.
+// ok is false if the stream does not exist (or was removed concurrently).
+func (s *FileStore) view(path string) (st *fileStream, meta StreamMetadata, layout streamLayout, ok bool) {
+	st = s.lookup(path)
+	if st == nil {
+		return nil, StreamMetadata{}, streamLayout{}, false
+	}
+	st.mu.RLock()
+	defer st.mu.RUnlock()
+	if st.removed {
+		return nil, StreamMetadata{}, streamLayout{}, false
+	}
+	return st, st.snapshot(), st.layout(), true
+}
+
 func (s *FileStore) resolveForkExpiry(opts CreateOptions, sourceMeta StreamMetadata) (*int64, *time.Time) {
 	if opts.TTLSeconds != nil {
 		return opts.TTLSeconds, nil
@@ -126,26 +256,69 @@ func (s *FileStore) resolveForkExpiry(opts CreateOptions, sourceMeta StreamMetad
 
 // Create creates a new stream
 func (s *FileStore) Create(path string, opts CreateOptions) (*StreamMetadata, bool, error) {
-	s.metaCacheMu.Lock()
-	defer s.metaCacheMu.Unlock()
+	// Claim the path with a locked placeholder. Concurrent operations on the
+	// same path block on its lock until creation finishes or fails.
+	st := newFileStream(nil, "", nil)
+	st.mu.Lock()
+
+	for {
+		existing, inserted := s.streams.getOrInsert(path, st)
+		if inserted {
+			break
+		}
+		s.awaitRecovery(path, existing)
+
+		existing.mu.Lock()
+		if existing.removed {
+			// Lost a race with a delete; retry the claim
+			existing.mu.Unlock()
+			continue
+		}
 
-	// Check if stream already exists (and is not expired)
-	if existing, ok := s.metaCache[path]; ok {
 		// If expired, delete it and allow recreation
-		if existing.IsExpired() {
-			if dirName, hasDirName := s.dirCache[path]; hasDirName {
-				s.deleteStreamUnlocked(path, dirName)
-			}
-		} else if existing.SoftDeleted {
+		if existing.isExpired() {
+			s.removeStreamLocked(path, existing)
+			existing.mu.Unlock()
+			s.longPoll.notify(path)
+			continue
+		}
+
+		defer existing.mu.Unlock()
+		if existing.meta.SoftDeleted {
 			// Soft-deleted streams block new creation
 			return nil, false, ErrStreamExists
-		} else if existing.ConfigMatches(opts) {
-			return existing, false, nil
-		} else {
-			return nil, false, ErrConfigMismatch
 		}
+		if existing.meta.ConfigMatches(opts) {
+			meta := existing.snapshot()
+			return &meta, false, nil
+		}
+		return nil, false, ErrConfigMismatch
+	}
+
+	meta, dirName, err := s.createLocked(path, st, opts)
+	if err != nil {
+		st.removed = true
+		s.streams.remove(path, st)
+		st.mu.Unlock()
+		return nil, false, err
 	}
 
+	st.meta = meta
+	st.visible = meta.CurrentOffset
+	st.dirName = dirName
+	st.segments = initialSegments(meta)
+	st.touch()
+	metaCopy := st.snapshot()
+	st.mu.Unlock()
+	s.expiry.schedule(path, st, &metaCopy)
+	s.longPoll.notify(path)
+
+	return &metaCopy, true, nil
+}
+
+// createLocked creates the on-disk state for a new stream claimed by the
+// placeholder st (whose lock the caller holds).
+func (s *FileStore) createLocked(path string, st *fileStream, opts CreateOptions) (*StreamMetadata, string, error) {
 	// Fork creation: validate source stream and resolve fork parameters
 	var forkOffset Offset
 	var sourceContentType string
@@ -154,25 +327,32 @@ func (s *FileStore) Create(path string, opts CreateOptions) (*StreamMetadata, bo
 	isFork := opts.ForkedFrom != ""
 
 	if isFork {
-		sourceMetaEntry, ok := s.metaCache[opts.ForkedFrom]
-		if !ok {
-			return nil, false, ErrStreamNotFound
+		source := s.lookup(opts.ForkedFrom)
+		if source == nil || source == st {
+			return nil, "", ErrStreamNotFound
+		}
+		// Lock order follows the fork chain: child (st) before parent (source)
+		source.mu.Lock()
+		defer source.mu.Unlock()
+
+		if source.removed {
+			return nil, "", ErrStreamNotFound
 		}
-		if sourceMetaEntry.SoftDeleted {
-			return nil, false, ErrStreamSoftDeleted
+		if source.meta.SoftDeleted && opts.replica == nil {
+			return nil, "", ErrStreamSoftDeleted
 		}
-		if sourceMetaEntry.IsExpired() {
-			return nil, false, ErrStreamNotFound
+		if source.isExpired() {
+			return nil, "", ErrStreamNotFound
 		}
 
-		sourceMeta = sourceMetaEntry
+		sourceMeta = source.meta
 		sourceContentType = sourceMeta.ContentType
 
 		// Reject a content-type mismatch up front, before taking a reference on
 		// the source. Doing this after IncrementRefCount would leak a reference
 		// on the failed fork and pin the source in a soft-deleted state forever.
 		if opts.ContentType != "" && !strings.EqualFold(opts.ContentType, sourceContentType) {
-			return nil, false, ErrContentTypeMismatch
+			return nil, "", ErrContentTypeMismatch
 		}
 
 		// Resolve fork offset: use opts.ForkOffset if set, else source's CurrentOffset
@@ -184,7 +364,7 @@ func (s *FileStore) Create(path string, opts CreateOptions) (*StreamMetadata, bo
 
 		// Validate: ZeroOffset <= forkOffset <= source.CurrentOffset
 		if forkOffset.LessThan(ZeroOffset) || sourceMeta.CurrentOffset.LessThan(forkOffset) {
-			return nil, false, ErrInvalidForkOffset
+			return nil, "", ErrInvalidForkOffset
 		}
 
 		// Resolve sub-offset (if any) against the source. For JSON, this
@@ -192,13 +372,9 @@ func (s *FileStore) Create(path string, opts CreateOptions) (*StreamMetadata, bo
 		// fork's metadata then stores no synthetic prefix. For binary, this
 		// returns the prefix bytes to materialize into the fork's segment.
 		if opts.ForkSubOffset != nil && *opts.ForkSubOffset > 0 {
-			sourceDirName, ok := s.dirCache[opts.ForkedFrom]
-			if !ok {
-				return nil, false, ErrStreamNotFound
-			}
-			resolvedOffset, prefixBytes, err := s.resolveForkSubOffset(sourceMeta, sourceDirName, forkOffset, *opts.ForkSubOffset)
+			resolvedOffset, prefixBytes, err := s.resolveForkSubOffset(sourceMeta, source.layout(), forkOffset, *opts.ForkSubOffset)
 			if err != nil {
-				return nil, false, err
+				return nil, "", err
 			}
 			if IsJSONContentType(sourceMeta.ContentType) {
 				forkOffset = resolvedOffset
@@ -209,13 +385,21 @@ func (s *FileStore) Create(path string, opts CreateOptions) (*StreamMetadata, bo
 
 		// Atomically increment source refcount in bbolt
 		if err := s.metaStore.IncrementRefCount(opts.ForkedFrom); err != nil {
-			return nil, false, fmt.Errorf("failed to increment source refcount: %w", err)
+			return nil, "", fmt.Errorf("failed to increment source refcount: %w", err)
 		}
 
-		// Update source's metaCache entry RefCount
+		// Update source's cached RefCount
 		sourceMeta.RefCount++
 	}
 
+	// rollbackFork releases the source reference taken above on failure
+	rollbackFork := func() {
+		if isFork {
+			s.metaStore.DecrementRefCount(opts.ForkedFrom)
+			sourceMeta.RefCount--
+		}
+	}
+
 	// Determine content type: use opts.ContentType, or inherit from source if
 	// fork. A fork content-type mismatch is already rejected above, before the
 	// source refcount is taken.
@@ -228,36 +412,29 @@ func (s *FileStore) Create(path string, opts CreateOptions) (*StreamMetadata, bo
 		}
 	}
 
-	// Generate unique directory name
+	// Generate unique directory name (replicas use their leader's)
 	dirName, err := generateDirectoryName(path)
+	if opts.replica != nil {
+		dirName = opts.replica.ID
+	}
 	if err != nil {
-		if isFork {
-			// Rollback source refcount
-			s.metaStore.DecrementRefCount(opts.ForkedFrom)
-			sourceMeta.RefCount--
-		}
-		return nil, false, fmt.Errorf("failed to generate directory name: %w", err)
+		rollbackFork()
+		return nil, "", fmt.Errorf("failed to generate directory name: %w", err)
 	}
 
 	// Create stream directory
 	streamDir := filepath.Join(s.dataDir, "streams", dirName)
 	if err := os.MkdirAll(streamDir, 0755); err != nil {
-		if isFork {
-			s.metaStore.DecrementRefCount(opts.ForkedFrom)
-			sourceMeta.RefCount--
-		}
-		return nil, false, fmt.Errorf("failed to create stream directory: %w", err)
+		rollbackFork()
+		return nil, "", fmt.Errorf("failed to create stream directory: %w", err)
 	}
 
 	// Create segment file
 	segPath := filepath.Join(streamDir, SegmentFileName)
 	if err := CreateSegmentFile(segPath); err != nil {
 		os.RemoveAll(streamDir)
-		if isFork {
-			s.metaStore.DecrementRefCount(opts.ForkedFrom)
-			sourceMeta.RefCount--
-		}
-		return nil, false, err
+		rollbackFork()
+		return nil, "", err
 	}
 
 	// Initialize metadata
@@ -269,6 +446,9 @@ func (s *FileStore) Create(path string, opts CreateOptions) (*StreamMetadata, bo
 		LastAccessedAt: now,
 		Closed:         opts.Closed, // Support creating stream in closed state
 	}
+	if opts.replica != nil {
+		meta.CreatedAt = opts.replica.Meta.CreatedAt
+	}
 
 	if isFork {
 		forkTTL, forkExpiresAt := s.resolveForkExpiry(opts, *sourceMeta)
@@ -296,23 +476,20 @@ func (s *FileStore) Create(path string, opts CreateOptions) (*StreamMetadata, bo
 			writer, err := NewSegmentWriter(segPath)
 			if err != nil {
 				os.RemoveAll(streamDir)
-				s.metaStore.DecrementRefCount(opts.ForkedFrom)
-				sourceMeta.RefCount--
-				return nil, false, fmt.Errorf("failed to open fork segment for sub-offset materialization: %w", err)
+				rollbackFork()
+				return nil, "", fmt.Errorf("failed to open fork segment for sub-offset materialization: %w", err)
 			}
 			if _, err := writer.WriteMessage(binarySubOffsetPrefix); err != nil {
 				writer.Close()
 				os.RemoveAll(streamDir)
-				s.metaStore.DecrementRefCount(opts.ForkedFrom)
-				sourceMeta.RefCount--
-				return nil, false, fmt.Errorf("failed to materialize sub-offset prefix: %w", err)
+				rollbackFork()
+				return nil, "", fmt.Errorf("failed to materialize sub-offset prefix: %w", err)
 			}
 			if err := writer.Sync(); err != nil {
 				writer.Close()
 				os.RemoveAll(streamDir)
-				s.metaStore.DecrementRefCount(opts.ForkedFrom)
-				sourceMeta.RefCount--
-				return nil, false, fmt.Errorf("failed to sync fork segment: %w", err)
+				rollbackFork()
+				return nil, "", fmt.Errorf("failed to sync fork segment: %w", err)
 			}
 			writer.Close()
 
@@ -327,41 +504,34 @@ func (s *FileStore) Create(path string, opts CreateOptions) (*StreamMetadata, bo
 
 	// Handle initial data
 	if len(opts.InitialData) > 0 {
-		newOffset, err := s.appendToStream(meta, dirName, opts.InitialData, AppendOptions{}, true) // Allow empty arrays on create
+		layout := streamLayout{dirName: dirName, segments: initialSegments(meta)}
+		newOffset, err := s.appendToStream(meta, layout, nil, opts.InitialData, AppendOptions{}, true) // Allow empty arrays on create
+		if err == nil {
+			err = s.committer.commit(segPath)
+		}
 		if err != nil {
+			s.writerPool.Remove(segPath)
 			os.RemoveAll(streamDir)
-			if isFork {
-				s.metaStore.DecrementRefCount(opts.ForkedFrom)
-				sourceMeta.RefCount--
-			}
-			return nil, false, err
+			rollbackFork()
+			return nil, "", err
 		}
 		meta.CurrentOffset = newOffset
 	}
 
 	// Store metadata
 	if err := s.metaStore.Put(meta, dirName); err != nil {
+		s.writerPool.Remove(segPath)
 		os.RemoveAll(streamDir)
-		if isFork {
-			s.metaStore.DecrementRefCount(opts.ForkedFrom)
-			sourceMeta.RefCount--
-		}
-		return nil, false, fmt.Errorf("failed to store metadata: %w", err)
+		rollbackFork()
+		return nil, "", fmt.Errorf("failed to store metadata: %w", err)
 	}
 
-	// Update cache
-	s.metaCache[path] = meta
-	s.dirCache[path] = dirName
-
-	return meta, true, nil
+	return meta, dirName, nil
 }
 
 // Get returns metadata for a stream
 func (s *FileStore) Get(path string) (*StreamMetadata, error) {
-	s.metaCacheMu.RLock()
-	meta, ok := s.metaCache[path]
-	s.metaCacheMu.RUnlock()
-
+	_, meta, _, ok := s.view(path)
 	if !ok {
 		return nil, ErrStreamNotFound
 	}
@@ -377,15 +547,12 @@ func (s *FileStore) Get(path string) (*StreamMetadata, error) {
 	}
 
 	// Return a copy to prevent mutation
-	metaCopy := *meta
-	return &metaCopy, nil
+	return &meta, nil
 }
 
 // Has returns true if the stream exists
 func (s *FileStore) Has(path string) bool {
-	s.metaCacheMu.RLock()
-	meta, ok := s.metaCache[path]
-	s.metaCacheMu.RUnlock()
+	_, meta, _, ok := s.view(path)
 	if !ok {
 		return false
 	}
@@ -399,111 +566,134 @@ func (s *FileStore) Has(path string) bool {
 
 // Delete removes a stream
 func (s *FileStore) Delete(path string) error {
-	s.metaCacheMu.Lock()
-	defer s.metaCacheMu.Unlock()
+	return s.deleteStream(path, false)
+}
 
-	meta, ok := s.metaCache[path]
-	if !ok {
+// deleteStream deletes a stream as Delete does. With replica set, a
+// soft-deleted stream is deleted again instead of being rejected, which
+// removes it once no forks are left.
+func (s *FileStore) deleteStream(path string, replica bool) error {
+	st := s.lookup(path)
+	if st == nil {
+		return ErrStreamNotFound
+	}
+
+	st.mu.Lock()
+	if st.removed {
+		st.mu.Unlock()
 		return ErrStreamNotFound
 	}
 
 	// Already soft-deleted: the stream is gone for direct operations (a
 	// soft-deleted stream returns 410 Gone for GET/HEAD/POST/DELETE).
-	if meta.SoftDeleted {
+	if st.meta.SoftDeleted && !replica {
+		st.mu.Unlock()
 		return ErrStreamSoftDeleted
 	}
 
 	// If there are forks referencing this stream, soft-delete instead
-	if meta.RefCount > 0 {
-		meta.SoftDeleted = true
+	if st.meta.RefCount > 0 {
+		st.meta.SoftDeleted = true
 		// Persist soft-delete to bbolt
 		s.metaStore.SoftDelete(path)
+		st.mu.Unlock()
+		s.longPoll.notify(path)
 		return nil
 	}
 
 	// RefCount == 0: full delete with cascading GC
-	return s.deleteWithCascade(path)
-}
+	forkedFrom := st.meta.ForkedFrom
+	s.removeStreamLocked(path, st)
+	st.mu.Unlock()
 
-// deleteWithCascade fully deletes a stream and cascades to soft-deleted parents
-// whose refcount drops to zero. Caller must hold metaCacheMu.
-func (s *FileStore) deleteWithCascade(path string) error {
-	meta, ok := s.metaCache[path]
-	if !ok {
-		return nil
-	}
+	// Cancel long-poll waiters for this stream
+	s.longPoll.notify(path)
 
-	forkedFrom := meta.ForkedFrom
+	return s.releaseForkSource(forkedFrom)
+}
 
-	// Delete this stream's data
-	dirName := s.dirCache[path]
-	s.deleteStreamUnlocked(path, dirName)
+// releaseForkSource drops a deleted fork's reference on its source and
+// cascades the delete to soft-deleted sources whose refcount drops to zero.
+// Each stream in the chain is locked on its own, child before parent.
+func (s *FileStore) releaseForkSource(path string) error {
+	for path != "" {
+		st := s.lookup(path)
+		if st == nil {
+			return nil
+		}
 
-	// Cancel long-poll waiters for this stream
-	s.longPoll.notify(path)
+		st.mu.Lock()
+		if st.removed {
+			st.mu.Unlock()
+			return nil
+		}
 
-	// If this stream is a fork, decrement the source's refcount
-	if forkedFrom != "" {
-		parentMeta, ok := s.metaCache[forkedFrom]
-		if ok {
-			// Atomically decrement in bbolt
-			newRefCount, softDeleted, err := s.metaStore.DecrementRefCount(forkedFrom)
-			if err != nil {
-				// Log error but continue
-			} else {
-				parentMeta.RefCount = newRefCount
+		// Atomically decrement in bbolt
+		newRefCount, softDeleted, err := s.metaStore.DecrementRefCount(path)
+		if err != nil {
+			// Log error but continue
+			st.mu.Unlock()
+			return nil
+		}
+		st.meta.RefCount = newRefCount
 
-				if parentMeta.RefCount < 0 {
-					parentMeta.RefCount = 0
-					return ErrRefCountUnderflow
-				}
+		if st.meta.RefCount < 0 {
+			st.meta.RefCount = 0
+			st.mu.Unlock()
+			return ErrRefCountUnderflow
+		}
 
-				// If parent refcount hit 0 and parent is soft-deleted, cascade
-				if parentMeta.RefCount == 0 && (softDeleted || parentMeta.SoftDeleted) {
-					return s.deleteWithCascade(forkedFrom)
-				}
-			}
+		// If source refcount hit 0 and source is soft-deleted, cascade
+		if st.meta.RefCount != 0 || !(softDeleted || st.meta.SoftDeleted) {
+			st.mu.Unlock()
+			return nil
 		}
-	}
 
+		next := st.meta.ForkedFrom
+		s.removeStreamLocked(path, st)
+		st.mu.Unlock()
+
+		s.longPoll.notify(path)
+		path = next
+	}
 	return nil
 }
 
-// deleteStreamUnlocked removes a stream without acquiring the lock (caller must hold metaCacheMu)
-func (s *FileStore) deleteStreamUnlocked(path string, dirName string) {
-	// Remove from writer pool
-	segPath := filepath.Join(s.dataDir, "streams", dirName, SegmentFileName)
-	s.writerPool.Remove(segPath)
+// removeStreamLocked removes a stream's data, metadata and map entry.
+// Caller must hold st.mu.
+func (s *FileStore) removeStreamLocked(path string, st *fileStream) {
+	// Remove from writer and reader pools
+	layout := st.layout()
+	segPaths := make([]string, len(layout.segments))
+	var remoteKeys []string
+	for i, seg := range layout.segments {
+		segPaths[i] = layout.path(s.dataDir, i)
+		s.writerPool.Remove(segPaths[i])
+		s.readerPool.Remove(segPaths[i])
+		if seg.Remote {
+			remoteKeys = append(remoteKeys, objectKey(layout.dirName, seg.File))
+		}
+	}
+	if s.tier != nil {
+		s.tier.dropStream(layout.dirName, segPaths, remoteKeys)
+	}
 
 	// Delete from bbolt (ignore errors on expired stream cleanup)
+	s.metaBatch.drop(path)
 	s.metaStore.Delete(path)
 
 	// Remove from cache
-	delete(s.metaCache, path)
-	delete(s.dirCache, path)
+	st.removed = true
+	s.streams.remove(path, st)
+	s.tails.drop(&st.tail)
 
 	// Async delete directory (rename first for safety)
-	streamDir := filepath.Join(s.dataDir, "streams", dirName)
-	deletedDir := filepath.Join(s.dataDir, "streams", ".deleted~"+dirName+"~"+fmt.Sprintf("%d", time.Now().UnixNano()))
+	streamDir := filepath.Join(s.dataDir, "streams", st.dirName)
+	deletedDir := filepath.Join(s.dataDir, "streams", ".deleted~"+st.dirName+"~"+fmt.Sprintf("%d", time.Now().UnixNano()))
 	os.Rename(streamDir, deletedDir)
 	go os.RemoveAll(deletedDir)
 }
 
-// getProducerLock returns a per-producer mutex for serializing validation+append.
-// This prevents race conditions when HTTP requests arrive out-of-order.
-func (s *FileStore) getProducerLock(streamPath, producerId string) *sync.Mutex {
-	key := streamPath + ":" + producerId
-	s.producerLocksMu.Lock()
-	defer s.producerLocksMu.Unlock()
-
-	if mu, ok := s.producerLocks[key]; ok {
-		return mu
-	}
-	mu := &sync.Mutex{}
-	s.producerLocks[key] = mu
-	return mu
-}
-
 // validateProducer validates producer headers and returns the result.
 // It also updates the producer state in the metadata if the append is accepted.
 // Returns (result, updatedState, error) where updatedState is nil if no update needed.
@@ -596,40 +786,136 @@ func (s *FileStore) validateProducer(meta *StreamMetadata, opts AppendOptions) (
 	}, nil, ErrProducerSeqGap
 }
 
-// Append adds data to a stream
+// setProducerState records accepted producer state. The map is replaced
+// rather than mutated so metadata snapshots handed to readers stay immutable.
+func setProducerState(meta *StreamMetadata, producerId string, state *ProducerState) {
+	producers := make(map[string]*ProducerState, len(meta.Producers)+1)
+	for id, existing := range meta.Producers {
+		producers[id] = existing
+	}
+	producers[producerId] = state
+	meta.Producers = producers
+}
+
+// Append adds data to a stream.
+// The segment write happens under the stream lock; the fsync does not. The
+// caller is acked, and readers see the data, once the group commit covering
+// its write is durable.
 func (s *FileStore) Append(path string, data []byte, opts AppendOptions) (AppendResult, error) {
+	st, result, segPath, err := s.appendLocked(path, data, opts)
+	if err != nil || segPath == "" {
+		return result, err
+	}
+
+	// Offsets alone may lag in bbolt (recovery repairs them from the
+	// segment); anything used to reject duplicates must not
+	commit := s.committer.commit
+	if opts.HasAllProducerHeaders() || opts.Seq != "" || opts.Close {
+		commit = s.committer.commitMeta
+	}
+	start := time.Now()
+	err = commit(segPath)
+	metrics.Since(metrics.AppendFsyncWait, start)
+	if err != nil {
+		return AppendResult{}, fmt.Errorf("failed to sync segment: %w", err)
+	}
+	s.publish(path, st, result.Offset)
+	return result, nil
+}
+
+// publish exposes a stream up to offset once the appends ending there are
+// durable, and wakes its long-polls.
+func (s *FileStore) publish(path string, st *fileStream, offset Offset) {
+	st.publish(offset)
+
+	notifyStart := time.Now()
+	s.longPoll.notify(path)
+	metrics.Since(metrics.AppendNotify, notifyStart)
+}
+
+// AppendBatch implements BatchAppender. Entries are written one after the
+// other as by Append, then the written ones share one group commit: a batch
+// costs one fsync per distinct segment and at most one metadata flush.
+func (s *FileStore) AppendBatch(entries []BatchEntry) []BatchResult {
+	results := make([]BatchResult, len(entries))
+	streams := make([]*fileStream, len(entries))
+	var written []int
+	var segPaths []string
+	needMeta := false
+	for i, e := range entries {
+		st, result, segPath, err := s.appendLocked(e.Path, e.Data, e.Opts)
+		results[i] = BatchResult{Result: result, Err: err}
+		if err != nil || segPath == "" {
+			continue
+		}
+		streams[i] = st
+		written = append(written, i)
+		if !slices.Contains(segPaths, segPath) {
+			segPaths = append(segPaths, segPath)
+		}
+		needMeta = needMeta || e.Opts.HasAllProducerHeaders() || e.Opts.Seq != "" || e.Opts.Close
+	}
+	if len(segPaths) == 0 {
+		return results
+	}
+
+	start := time.Now()
+	err := s.committer.commitAll(segPaths, needMeta)
+	metrics.Since(metrics.AppendFsyncWait, start)
+	for _, i := range written {
+		if err != nil {
+			results[i] = BatchResult{Err: fmt.Errorf("failed to sync segment: %w", err)}
+			continue
+		}
+		s.publish(entries[i].Path, streams[i], results[i].Result.Offset)
+	}
+	return results
+}
+
+// appendLocked validates and writes an append under the producer and stream
+// locks. It returns the segment path that must be made durable before the
+// append is acknowledged and published, or "" when nothing is pending
+// (duplicates of durable appends).
+func (s *FileStore) appendLocked(path string, data []byte, opts AppendOptions) (*fileStream, AppendResult, string, error) {
+	validateStart := time.Now()
+
 	// Validate producer headers - must be all or none
 	if opts.HasProducerHeaders() && !opts.HasAllProducerHeaders() {
-		return AppendResult{}, ErrPartialProducer
+		return nil, AppendResult{}, "", ErrPartialProducer
+	}
+
+	st := s.lookup(path)
+	if st == nil {
+		return nil, AppendResult{}, "", ErrStreamNotFound
 	}
 
 	// If producer headers provided, acquire per-producer lock for serialization
 	if opts.HasAllProducerHeaders() {
-		producerLock := s.getProducerLock(path, opts.ProducerId)
+		producerLock := st.producerLock(opts.ProducerId)
 		producerLock.Lock()
 		defer producerLock.Unlock()
 	}
 
-	s.metaCacheMu.Lock()
-	defer s.metaCacheMu.Unlock()
+	st.mu.Lock()
+	defer st.mu.Unlock()
 
-	meta, ok := s.metaCache[path]
-	if !ok {
-		return AppendResult{}, ErrStreamNotFound
+	if st.removed {
+		return nil, AppendResult{}, "", ErrStreamNotFound
 	}
+	meta := st.meta
 
 	// Check if stream is soft-deleted
 	if meta.SoftDeleted {
-		return AppendResult{}, ErrStreamSoftDeleted
+		return nil, AppendResult{}, "", ErrStreamSoftDeleted
 	}
 
 	// Check if stream has expired
-	if meta.IsExpired() {
-		return AppendResult{}, ErrStreamNotFound
+	if st.isExpired() {
+		return nil, AppendResult{}, "", ErrStreamNotFound
 	}
 
 	// Refresh TTL sliding window
-	meta.LastAccessedAt = time.Now()
+	st.touch()
 
 	// Check if stream is closed
 	if meta.Closed {
@@ -639,25 +925,23 @@ func (s *FileStore) Append(path string, data []byte, opts AppendOptions) (Append
 			meta.ClosedBy.Epoch == *opts.ProducerEpoch &&
 			meta.ClosedBy.Seq == *opts.ProducerSeq {
 			// Idempotent success - duplicate of closing request
-			return AppendResult{
+			return st, AppendResult{
 				Offset:         meta.CurrentOffset,
 				ProducerResult: ProducerResultDuplicate,
 				LastSeq:        *opts.ProducerSeq,
 				StreamClosed:   true,
-			}, nil
+			}, s.pendingSegment(st), nil
 		}
 		// Stream is closed - reject append
-		return AppendResult{
+		return nil, AppendResult{
 			Offset:       meta.CurrentOffset,
 			StreamClosed: true,
-		}, ErrStreamClosed
+		}, "", ErrStreamClosed
 	}
 
-	dirName := s.dirCache[path]
-
 	// Validate content type
 	if opts.ContentType != "" && !ContentTypeMatches(meta.ContentType, opts.ContentType) {
-		return AppendResult{}, ErrContentTypeMismatch
+		return nil, AppendResult{}, "", ErrContentTypeMismatch
 	}
 
 	// Validate producer FIRST (if headers provided)
@@ -670,15 +954,15 @@ func (s *FileStore) Append(path string, data []byte, opts AppendOptions) (Append
 		result, newState, err := s.validateProducer(meta, opts)
 		if err != nil {
 			result.Offset = meta.CurrentOffset
-			return result, err
+			return nil, result, "", err
 		}
 		if result.ProducerResult == ProducerResultDuplicate {
 			// Duplicate - return current offset, no append needed
-			return AppendResult{
+			return st, AppendResult{
 				Offset:         meta.CurrentOffset,
 				ProducerResult: ProducerResultDuplicate,
 				LastSeq:        result.LastSeq,
-			}, nil
+			}, s.pendingSegment(st), nil
 		}
 		producerState = newState
 		producerResult = result.ProducerResult
@@ -689,14 +973,22 @@ func (s *FileStore) Append(path string, data []byte, opts AppendOptions) (Append
 	// Only checked for non-duplicate appends.
 	if opts.Seq != "" {
 		if meta.LastSeq != "" && opts.Seq <= meta.LastSeq {
-			return AppendResult{}, ErrSequenceConflict
+			return nil, AppendResult{}, "", ErrSequenceConflict
 		}
 	}
 
+	metrics.Since(metrics.AppendValidate, validateStart)
+
+	// Roll to a new segment first if the active one is full
+	if err := s.maybeRotate(st); err != nil {
+		return nil, AppendResult{}, "", err
+	}
+
 	// Append to segment
-	newOffset, err := s.appendToStream(meta, dirName, data, opts, false) // Don't allow empty arrays on append
+	layout := st.layout()
+	newOffset, err := s.appendToStream(meta, layout, &st.tail, data, opts, false) // Don't allow empty arrays on append
 	if err != nil {
-		return AppendResult{}, err
+		return nil, AppendResult{}, "", err
 	}
 
 	// Update in-memory metadata
@@ -705,10 +997,7 @@ func (s *FileStore) Append(path string, data []byte, opts AppendOptions) (Append
 		meta.LastSeq = opts.Seq
 	}
 	if producerState != nil {
-		if meta.Producers == nil {
-			meta.Producers = make(map[string]*ProducerState)
-		}
-		meta.Producers[opts.ProducerId] = producerState
+		setProducerState(meta, opts.ProducerId, producerState)
 	}
 
 	// Handle stream closure if requested
@@ -724,81 +1013,171 @@ func (s *FileStore) Append(path string, data []byte, opts AppendOptions) (Append
 				Seq:        *opts.ProducerSeq,
 			}
 		}
-		// Notify pending long-polls that stream is closed
-		s.longPoll.notifyClosed(path)
-	}
-
-	// Persist to bbolt atomically (including closed state if requested)
-	if producerState != nil || opts.Close {
-		if err := s.metaStore.UpdateAppendState(path, newOffset, opts.Seq, opts.ProducerId, producerState, opts.Close, meta.ClosedBy); err != nil {
-			// Log error but don't fail - the file is the source of truth
-			// On recovery, we'll reconcile
-		}
-	} else {
-		if err := s.metaStore.UpdateOffset(path, newOffset, opts.Seq); err != nil {
-			// Log error but don't fail - the file is the source of truth
-			// On recovery, we'll reconcile
-		}
 	}
 
-	// Notify long-poll waiters
-	s.longPoll.notify(path)
+	// Buffer for bbolt; Append waits for the flush when it must be durable.
+	// Long-poll waiters are notified once it commits (see publish).
+	s.metaBatch.record(path, st.dirName, newOffset, opts.Seq, opts.ProducerId, producerState, opts.Close, meta.ClosedBy)
 
-	return AppendResult{
+	return st, AppendResult{
 		Offset:         newOffset,
 		ProducerResult: producerResult,
 		LastSeq:        producerLastSeq,
 		StreamClosed:   streamClosed,
-	}, nil
+	}, layout.path(s.dataDir, layout.active()), nil
 }
 
-// appendToStream appends data to the stream's segment file
-func (s *FileStore) appendToStream(meta *StreamMetadata, dirName string, data []byte, opts AppendOptions, allowEmpty bool) (Offset, error) {
-	segPath := filepath.Join(s.dataDir, "streams", dirName, SegmentFileName)
+// pendingSegment returns the active segment if the stream has appends that
+// are not durable yet, or "". A duplicate of such an append must wait for
+// it before being acknowledged. Caller must hold st.mu.
+func (s *FileStore) pendingSegment(st *fileStream) string {
+	if st.visible.Equal(st.meta.CurrentOffset) {
+		return ""
+	}
+	layout := st.layout()
+	return layout.path(s.dataDir, layout.active())
+}
 
-	file, err := s.writerPool.GetWriter(segPath)
+// maybeRotate rolls st to a new active segment once the current one has
+// reached the configured size or age. The manifest is installed before the
+// new segment takes any writes. Caller must hold st.mu.
+func (s *FileStore) maybeRotate(st *fileStream) error {
+	layout := st.layout()
+	active := layout.segments[layout.active()]
+	size := st.meta.CurrentOffset.ByteOffset - active.Start
+	if size == 0 {
+		return nil
+	}
+	full := s.segmentMaxBytes > 0 && size >= uint64(s.segmentMaxBytes)
+	old := s.segmentMaxAge > 0 && time.Since(active.CreatedAt) >= s.segmentMaxAge
+	if !full && !old {
+		return nil
+	}
+	return s.rotateLocked(st, active.ReadSeq+1)
+}
+
+// rotateLocked seals st's active segment and starts a new one with readSeq
+// at the stream's tail. Caller must hold st.mu.
+func (s *FileStore) rotateLocked(st *fileStream, readSeq uint64) error {
+	layout := st.layout()
+	active := layout.segments[layout.active()]
+	next := segmentInfo{
+		ReadSeq:   readSeq,
+		Start:     st.meta.CurrentOffset.ByteOffset,
+		File:      segmentFileName(readSeq),
+		CreatedAt: time.Now(),
+	}
+	streamDir := filepath.Join(s.dataDir, "streams", st.dirName)
+	nextPath := filepath.Join(streamDir, next.File)
+
+	// Make the sealed segment durable before the manifest moves writes past
+	// it: recovery only verifies the active segment, so a sealed segment
+	// must be complete on disk once a later one exists.
+	sealedPath := layout.path(s.dataDir, layout.active())
+	if err := s.committer.sync(sealedPath); err != nil {
+		return fmt.Errorf("failed to sync sealed segment: %w", err)
+	}
+
+	if err := CreateSegmentFile(nextPath); err != nil {
+		return err
+	}
+
+	segments := make([]segmentInfo, 0, len(layout.segments)+1)
+	segments = append(segments, layout.segments...)
+	segments = append(segments, next)
+	if err := writeManifest(streamDir, segments); err != nil {
+		os.Remove(nextPath)
+		return err
+	}
+	st.segments = segments
+
+	// The sealed segment takes no more writes. Commits still pending for it
+	// sync it by path.
+	s.writerPool.Remove(sealedPath)
+	if s.tier != nil {
+		s.tier.enqueue(tierUpload{stream: st, file: active.File})
+	}
+	return nil
+}
+
+// appendToStream appends data to the stream's active segment file and returns
+// the new tail offset. The written messages are added to tail (if non-nil)
+// for the readers about to be woken. It does not fsync; callers commit the
+// segment through s.committer.
+func (s *FileStore) appendToStream(meta *StreamMetadata, layout streamLayout, tail *streamTail, data []byte, opts AppendOptions, allowEmpty bool) (Offset, error) {
+	active := layout.active()
+	segPath := layout.path(s.dataDir, active)
+
+	// Pinned so that another stream's open cannot evict and close the handle
+	// between the writes of one frame
+	file, release, err := s.writerPool.AcquireWriter(segPath)
 	if err != nil {
 		return Offset{}, fmt.Errorf("failed to get writer: %w", err)
 	}
+	defer release()
+
+	// New offsets carry the ReadSeq of the segment they are written to
+	start := Offset{ReadSeq: layout.segments[active].ReadSeq, ByteOffset: meta.CurrentOffset.ByteOffset}
+	cacheTail := tail != nil && s.tails != nil
 
 	isJSON := IsJSONContentType(meta.ContentType)
 
 	if isJSON {
-		// JSON mode: parse and potentially flatten arrays
-		messages, err := processJSONAppend(data, allowEmpty)
+		// JSON mode: validate, flatten arrays and frame every message in
+		// one pass, then write all frames at once
+		bufp := frameBuffers.Get().(*[]byte)
+		defer func() {
+			if cap(*bufp) <= maxPooledFrameBuffer {
+				frameBuffers.Put(bufp)
+			}
+		}()
+		jsonStart := time.Now()
+		frames, count, err := appendJSONFrames((*bufp)[:0], data, allowEmpty)
+		*bufp = frames
 		if err != nil {
 			return Offset{}, err
 		}
+		writeStart := time.Now()
+		metrics.AppendJSON.Observe(writeStart.Sub(jsonStart).Seconds())
+		if _, err := file.Write(frames); err != nil {
+			return Offset{}, err
+		}
+		metrics.Since(metrics.AppendSegmentWrite, writeStart)
 
-		currentOffset := meta.CurrentOffset
-		for _, msgData := range messages {
-			n, err := WriteMessage(file, msgData)
-			if err != nil {
-				return Offset{}, err
+		// The tail cache copies what it keeps, so messages may alias frames
+		var written []Message
+		if cacheTail {
+			written = make([]Message, 0, count)
+		}
+		currentOffset := start
+		for pos := 0; pos < len(frames); {
+			next := pos + LengthPrefixSize + int(binary.BigEndian.Uint32(frames[pos:]))
+			currentOffset = currentOffset.Add(uint64(next - pos))
+			if cacheTail {
+				written = append(written, Message{Data: frames[pos+LengthPrefixSize : next], Offset: currentOffset})
 			}
-			currentOffset = currentOffset.Add(uint64(n))
+			pos = next
 		}
-
-		// Sync
-		if err := s.writerPool.Sync(segPath); err != nil {
-			return Offset{}, err
+		if cacheTail {
+			s.tails.add(tail, meta.CurrentOffset, written)
 		}
 
 		return currentOffset, nil
 	}
 
 	// Non-JSON mode: store raw bytes as single message
+	writeStart := time.Now()
 	n, err := WriteMessage(file, data)
 	if err != nil {
 		return Offset{}, err
 	}
+	metrics.Since(metrics.AppendSegmentWrite, writeStart)
 
-	// Sync
-	if err := s.writerPool.Sync(segPath); err != nil {
-		return Offset{}, err
+	newOffset := start.Add(uint64(n))
+	if cacheTail {
+		s.tails.add(tail, meta.CurrentOffset, []Message{{Data: data, Offset: newOffset}})
 	}
-
-	return meta.CurrentOffset.Add(uint64(n)), nil
+	return newOffset, nil
 }
 
 // resolveForkSubOffset walks the source stream from forkOffset and resolves a
@@ -814,189 +1193,378 @@ func (s *FileStore) appendToStream(meta *StreamMetadata, dirName string, data []
 //
 // Errors with ErrInvalidForkSubOffset if the resolution overshoots available
 // data.
-func (s *FileStore) resolveForkSubOffset(sourceMeta *StreamMetadata, sourceDirName string, forkOffset Offset, subOffset uint64) (Offset, []byte, error) {
-	// Read the source from forkOffset onward (across its own fork chain if any)
-	sourceMessages, err := s.readForkedStream(sourceMeta, sourceDirName, forkOffset)
+func (s *FileStore) resolveForkSubOffset(sourceMeta *StreamMetadata, sourceLayout streamLayout, forkOffset Offset, subOffset uint64) (Offset, []byte, error) {
+	// Walk the source's frames from forkOffset onward (across its own fork
+	// chain if any), only as far as the resolution needs: subOffset messages
+	// for JSON, the first message for binary. No payload is read for JSON.
+	limits := ReadLimits{MaxMessages: 1}
+	if IsJSONContentType(sourceMeta.ContentType) {
+		limits.MaxMessages = int(min(subOffset, math.MaxInt))
+	}
+	frames, err := s.readForkedFrames(sourceMeta, sourceLayout, forkOffset, sourceMeta.CurrentOffset, newReadBudget(limits))
 	if err != nil {
 		return Offset{}, nil, fmt.Errorf("failed to read source for sub-offset resolution: %w", err)
 	}
 
 	if IsJSONContentType(sourceMeta.ContentType) {
 		// Walk subOffset flattened messages from forkOffset.
-		if uint64(len(sourceMessages)) < subOffset {
+		if uint64(len(frames)) < subOffset {
 			return Offset{}, nil, ErrInvalidForkSubOffset
 		}
-		return sourceMessages[subOffset-1].Offset, nil, nil
+		return frames[subOffset-1].offset, nil, nil
 	}
 
 	// Binary: there must be at least one message past forkOffset to slice.
-	if len(sourceMessages) == 0 {
-		return Offset{}, nil, ErrInvalidForkSubOffset
-	}
-	first := sourceMessages[0].Data
-	if uint64(len(first)) < subOffset {
+	if len(frames) == 0 || uint64(frames[0].size) < subOffset {
 		return Offset{}, nil, ErrInvalidForkSubOffset
 	}
 	prefix := make([]byte, subOffset)
-	copy(prefix, first[:subOffset])
+	if err := s.readSegmentAt(frames[0].segPath, prefix, frames[0].pos); err != nil {
+		return Offset{}, nil, fmt.Errorf("failed to read source for sub-offset resolution: %w", err)
+	}
 	return forkOffset, prefix, nil
 }
 
-// readFromSegment reads messages from a segment file starting at the given physical offset.
-// Returns the messages read from the segment.
-func (s *FileStore) readFromSegment(dirName string, offset Offset) ([]Message, error) {
-	segPath := filepath.Join(s.dataDir, "streams", dirName, SegmentFileName)
-	reader, err := NewSegmentReader(segPath)
+// streamFrame locates one message payload of a stream: the segment holding it
+// and its logical (fork-translated) offset.
+type streamFrame struct {
+	segPath string
+	segmentFrame
+}
+
+// readSegmentFrames walks the frames of segment i of a stream from offset up
+// to the stream ByteOffset end, without reading payloads. Both bounds must lie
+// within the segment.
+func (s *FileStore) readSegmentFrames(layout streamLayout, i int, offset, end uint64, budget *readBudget) ([]streamFrame, error) {
+	seg := layout.segments[i]
+	segPath := layout.path(s.dataDir, i)
+	file, release, err := s.openSegment(segPath)
 	if err != nil {
 		return nil, fmt.Errorf("failed to open segment: %w", err)
 	}
+	defer release()
+
+	reader := newSegmentReaderAt(file)
 	defer reader.Close()
+	reader.setLimit(end - seg.Start)
 
-	messages, _, err := reader.ReadMessages(offset)
+	frames, err := reader.readFrames(Offset{ReadSeq: seg.ReadSeq, ByteOffset: offset - seg.Start}, budget)
 	if err != nil {
 		return nil, err
 	}
 
-	return messages, nil
+	streamFrames := make([]streamFrame, len(frames))
+	for j, frame := range frames {
+		frame.offset.ByteOffset += seg.Start
+		streamFrames[j] = streamFrame{segPath: segPath, segmentFrame: frame}
+	}
+	return streamFrames, nil
 }
 
-// readForkedStream reads messages across the fork chain for a FileStore stream.
-// For non-forks, it reads directly from the segment. For forks, it reads inherited
-// messages from the source chain (capped at ForkOffset) and then the fork's own
-// segment with offset translation. This method does NOT check SoftDeleted -- forks
-// must read through soft-deleted sources.
-func (s *FileStore) readForkedStream(meta *StreamMetadata, dirName string, offset Offset) ([]Message, error) {
-	if meta.ForkedFrom == "" {
-		// Not a fork: just read from segment directly
-		return s.readFromSegment(dirName, offset)
-	}
-
-	var inherited []Message
-
-	// Only read from source if the requested offset is before the fork point
-	if offset.LessThan(meta.ForkOffset) {
-		sourceMeta, ok := s.metaCache[meta.ForkedFrom]
-		sourceDirName := s.dirCache[meta.ForkedFrom]
-		if ok {
-			// Recursively read from source (source may itself be a fork)
-			sourceMessages, err := s.readForkedStream(sourceMeta, sourceDirName, offset)
-			if err != nil {
-				return nil, err
-			}
-			// Cap at ForkOffset -- source appends after fork creation are not visible
-			for _, msg := range sourceMessages {
-				if msg.Offset.LessThanOrEqual(meta.ForkOffset) {
-					inherited = append(inherited, msg)
-				}
-			}
+// readOwnFrames walks the frames of a stream's own segments from offset up to
+// end, opening only the segments that overlap the range.
+func (s *FileStore) readOwnFrames(layout streamLayout, offset, end Offset, budget *readBudget) ([]streamFrame, error) {
+	var frames []streamFrame
+	for i := layout.locate(offset.ByteOffset); i < len(layout.segments); i++ {
+		from := max(offset.ByteOffset, layout.segments[i].Start)
+		to := min(layout.end(i, end.ByteOffset), end.ByteOffset)
+		if from >= end.ByteOffset {
+			break
+		}
+		if from >= to {
+			continue
+		}
+
+		segFrames, err := s.readSegmentFrames(layout, i, from, to, budget)
+		if err != nil {
+			return nil, err
+		}
+		if frames == nil {
+			frames = segFrames
+		} else {
+			frames = append(frames, segFrames...)
+		}
+		if budget.exhausted() {
+			break
 		}
 	}
+	return frames, nil
+}
+
+// forkRange is the part of one stream's own segments a fork-chain read covers
+type forkRange struct {
+	layout     streamLayout
+	start, end Offset
+}
 
-	// Read fork's own segment with offset translation
-	// The fork's segment file starts at physical byte 0 but logical offsets start at ForkOffset.
-	// We only need to read from the fork's own segment if offset >= ForkOffset
-	// (or if we need messages from forkOffset onward).
-	var ownMessages []Message
-	readOwnOffset := offset
-	if readOwnOffset.LessThan(meta.ForkOffset) {
-		readOwnOffset = meta.ForkOffset
+// planForkRead resolves the fork chain of a stream into the ranges of each
+// ancestor's own segments that make up the logical range [offset, end),
+// oldest ancestor first. Each level contributes only what lies between its
+// own ForkOffset and the ForkOffset of the fork below it, so appends a source
+// received after a fork was created are never touched. This method does NOT
+// check SoftDeleted -- forks must read through soft-deleted sources.
+//
+// meta is a snapshot (or owned by a caller holding the stream's lock); each
+// ancestor is snapshotted under its own read lock.
+func (s *FileStore) planForkRead(meta *StreamMetadata, layout streamLayout, offset, end Offset) []forkRange {
+	var ranges []forkRange
+	for {
+		start := offset
+		if meta.ForkedFrom != "" && offset.LessThan(meta.ForkOffset) {
+			start = meta.ForkOffset
+		}
+		if start.LessThan(end) {
+			ranges = append(ranges, forkRange{layout: layout, start: start, end: end})
+		}
+		if start.Equal(offset) {
+			break
+		}
+
+		_, sourceMeta, sourceLayout, ok := s.view(meta.ForkedFrom)
+		if !ok {
+			break
+		}
+		// Source appends after fork creation are not visible: stop at ForkOffset
+		if meta.ForkOffset.LessThan(end) {
+			end = meta.ForkOffset
+		}
+		meta, layout = &sourceMeta, sourceLayout
 	}
 
-	// Translate logical offset to physical offset for the fork's segment
-	physicalOffset := Offset{
-		ReadSeq:    readOwnOffset.ReadSeq,
-		ByteOffset: readOwnOffset.ByteOffset - meta.ForkOffset.ByteOffset,
+	slices.Reverse(ranges)
+	return ranges
+}
+
+// readForkedFrames walks message frames across the fork chain for a FileStore
+// stream, from offset up to end (both logical), reading only the segment
+// ranges planForkRead selects. A fork's own segments start at its ForkOffset,
+// so frames need no offset translation. budget is shared across the whole
+// chain (nil = unlimited).
+func (s *FileStore) readForkedFrames(meta *StreamMetadata, layout streamLayout, offset, end Offset, budget *readBudget) ([]streamFrame, error) {
+	var frames []streamFrame
+	for _, r := range s.planForkRead(meta, layout, offset, end) {
+		own, err := s.readOwnFrames(r.layout, r.start, r.end, budget)
+		if err != nil {
+			return nil, err
+		}
+		if frames == nil {
+			frames = own
+		} else {
+			frames = append(frames, own...)
+		}
+		// Budget ran out before this range's end: end the chunk here so the
+		// next level's messages never follow a gap.
+		if budget.exhausted() {
+			break
+		}
 	}
+	return frames, nil
+}
 
-	rawMessages, err := s.readFromSegment(dirName, physicalOffset)
-	if err != nil {
-		return nil, err
+// loadFrames reads the payloads of frames. Each run of adjacent frames in one
+// segment is fetched with a single positional read into one buffer.
+func (s *FileStore) loadFrames(frames []streamFrame) ([]Message, error) {
+	messages := make([]Message, 0, len(frames))
+	for i := 0; i < len(frames); {
+		j := i + 1
+		for j < len(frames) && frames[j].segPath == frames[i].segPath &&
+			frames[j].pos == frames[j-1].pos+int64(frames[j-1].size)+LengthPrefixSize {
+			j++
+		}
+
+		start := frames[i].pos
+		buf := make([]byte, frames[j-1].pos+int64(frames[j-1].size)-start)
+		if err := s.readSegmentAt(frames[i].segPath, buf, start); err != nil {
+			return nil, err
+		}
+		for _, frame := range frames[i:j] {
+			lo := frame.pos - start
+			hi := lo + int64(frame.size)
+			messages = append(messages, Message{
+				Data:   buf[lo:hi:hi],
+				Offset: frame.offset,
+			})
+		}
+		i = j
 	}
+	return messages, nil
+}
 
-	// Translate physical offsets back to logical offsets
-	for _, msg := range rawMessages {
-		ownMessages = append(ownMessages, Message{
-			Data: msg.Data,
-			Offset: Offset{
-				ReadSeq:    msg.Offset.ReadSeq,
-				ByteOffset: msg.Offset.ByteOffset + meta.ForkOffset.ByteOffset,
-			},
-		})
+// readSegmentAt fills buf from a segment at pos through the reader pool
+func (s *FileStore) readSegmentAt(segPath string, buf []byte, pos int64) error {
+	file, release, err := s.openSegment(segPath)
+	if err != nil {
+		return fmt.Errorf("failed to open segment: %w", err)
 	}
+	defer release()
 
-	if len(inherited) == 0 {
-		return ownMessages, nil
+	if _, err := file.ReadAt(buf, pos); err != nil {
+		if err == io.EOF {
+			return io.ErrUnexpectedEOF
+		}
+		return err
 	}
-	if len(ownMessages) == 0 {
-		return inherited, nil
+	return nil
+}
+
+// readForkedStream reads messages across the fork chain up to the stream's
+// current offset. See readForkedFrames.
+func (s *FileStore) readForkedStream(meta *StreamMetadata, layout streamLayout, offset Offset, budget *readBudget) ([]Message, error) {
+	frames, err := s.readForkedFrames(meta, layout, offset, meta.CurrentOffset, budget)
+	if err != nil {
+		return nil, err
 	}
-	return append(inherited, ownMessages...), nil
+	return s.loadFrames(frames)
 }
 
 // Read reads messages from a stream
 func (s *FileStore) Read(path string, offset Offset) ([]Message, bool, error) {
-	s.metaCacheMu.RLock()
-	meta, ok := s.metaCache[path]
-	dirName := s.dirCache[path]
-	s.metaCacheMu.RUnlock()
+	return s.ReadWithLimits(path, offset, ReadLimits{})
+}
 
-	if !ok {
-		return nil, false, ErrStreamNotFound
+// ReadWithLimits reads messages from a stream, stopping once the chunk reaches limits
+func (s *FileStore) ReadWithLimits(path string, offset Offset, limits ReadLimits) ([]Message, bool, error) {
+	st, meta, layout, err := s.readableView(path)
+	if err != nil {
+		return nil, false, err
 	}
 
-	// Check if stream has expired
-	if meta.IsExpired() {
-		return nil, false, ErrStreamNotFound
+	// Check if already at tail
+	if offset.Equal(meta.CurrentOffset) {
+		return nil, chunkUpToDate(meta, offset, nil), nil
 	}
 
-	// Soft-deleted streams are not visible for direct reads
-	if meta.SoftDeleted {
-		return nil, false, ErrStreamNotFound
+	// Live readers start inside the cached tail
+	if messages, ok := s.tails.read(&st.tail, offset, meta.CurrentOffset, newReadBudget(limits)); ok {
+		return messages, messages[len(messages)-1].Offset.Equal(meta.CurrentOffset), nil
 	}
 
-	// Refresh TTL sliding window
-	meta.LastAccessedAt = time.Now()
-	s.metaCacheMu.Lock()
-	if cached, ok := s.metaCache[path]; ok {
-		cached.LastAccessedAt = meta.LastAccessedAt
+	readStart := time.Now()
+	frames, err := s.readForkedFrames(&meta, layout, offset, meta.CurrentOffset, newReadBudget(limits))
+	if err != nil {
+		return nil, false, err
+	}
+	if len(frames) == 0 {
+		return nil, chunkUpToDate(meta, offset, nil), nil
+	}
+
+	messages, err := s.loadFrames(frames)
+	if err != nil {
+		return nil, false, err
+	}
+	metrics.Since(metrics.ReadSegment, readStart)
+	return messages, chunkUpToDate(meta, offset, frames), nil
+}
+
+// ReadRaw reads one chunk of a stream as payload ranges of its segment files
+// instead of materialized messages. The chunk's bytes are read only when it is
+// written out with RawChunk.WriteTo. Chunks served from the tail cache carry
+// their messages instead.
+func (s *FileStore) ReadRaw(path string, offset Offset, limits ReadLimits) (*RawChunk, error) {
+	st, meta, layout, err := s.readableView(path)
+	if err != nil {
+		return nil, err
+	}
+
+	chunk := &RawChunk{
+		NextOffset: offset,
+		UpToDate:   chunkUpToDate(meta, offset, nil),
+		jsonArray:  IsJSONContentType(meta.ContentType),
+		open:       s.openSegment,
 	}
-	s.metaCacheMu.Unlock()
 
 	// Check if already at tail
 	if offset.Equal(meta.CurrentOffset) {
-		return nil, true, nil
+		return chunk, nil
+	}
+
+	if messages, ok := s.tails.read(&st.tail, offset, meta.CurrentOffset, newReadBudget(limits)); ok {
+		chunk.messages = messages
+		chunk.NextOffset = messages[len(messages)-1].Offset
+		chunk.UpToDate = chunk.NextOffset.Equal(meta.CurrentOffset)
+		var size int64
+		for _, msg := range messages {
+			size += int64(len(msg.Data))
+		}
+		chunk.setSize(size)
+		return chunk, nil
 	}
 
-	// Read messages across fork chain
-	messages, err := s.readForkedStream(meta, dirName, offset)
+	// Payloads are read when the chunk is written out; this times the
+	// frame index scan
+	readStart := time.Now()
+	frames, err := s.readForkedFrames(&meta, layout, offset, meta.CurrentOffset, newReadBudget(limits))
 	if err != nil {
-		return nil, false, err
+		return nil, err
 	}
+	metrics.Since(metrics.ReadSegment, readStart)
 
-	// upToDate is true when client has reached the tail of the fork's own data
-	var upToDate bool
-	if len(messages) > 0 {
-		upToDate = messages[len(messages)-1].Offset.Equal(meta.CurrentOffset)
-	} else {
-		upToDate = offset.Equal(meta.CurrentOffset) || meta.CurrentOffset.Equal(ZeroOffset)
+	chunk.frames = frames
+	chunk.UpToDate = chunkUpToDate(meta, offset, frames)
+	if len(frames) > 0 {
+		chunk.NextOffset = frames[len(frames)-1].offset
+	}
+	var size int64
+	for _, frame := range frames {
+		size += int64(frame.size)
+	}
+	chunk.setSize(size)
+	return chunk, nil
+}
+
+// readableView checks that a stream is readable and returns its entry and a
+// metadata snapshot to read against, refreshing its TTL.
+func (s *FileStore) readableView(path string) (*fileStream, StreamMetadata, streamLayout, error) {
+	st, meta, layout, ok := s.view(path)
+	if !ok {
+		return nil, meta, layout, ErrStreamNotFound
 	}
 
-	return messages, upToDate, nil
+	// Check if stream has expired
+	if meta.IsExpired() {
+		return nil, meta, layout, ErrStreamNotFound
+	}
+
+	// Soft-deleted streams are not visible for direct reads
+	if meta.SoftDeleted {
+		return nil, meta, layout, ErrStreamNotFound
+	}
+
+	// Refresh TTL sliding window (atomic; no stream write lock)
+	st.touch()
+
+	return st, meta, layout, nil
+}
+
+// chunkUpToDate reports whether a chunk read from offset reaches the tail of
+// the stream's own data
+func chunkUpToDate(meta StreamMetadata, offset Offset, frames []streamFrame) bool {
+	if len(frames) > 0 {
+		return frames[len(frames)-1].offset.Equal(meta.CurrentOffset)
+	}
+	return offset.Equal(meta.CurrentOffset) || meta.CurrentOffset.Equal(ZeroOffset)
+}
+
+// Watch implements StreamWatcher
+func (s *FileStore) Watch(paths []string, fn func(path string)) (stop func()) {
+	return s.longPoll.watch(paths, fn)
 }
 
 // WaitForMessages waits for new messages
-func (s *FileStore) WaitForMessages(ctx context.Context, path string, offset Offset, timeout time.Duration) ([]Message, bool, bool, error) {
+func (s *FileStore) WaitForMessages(ctx context.Context, path string, offset Offset, timeout time.Duration, limits ReadLimits) ([]Message, bool, bool, error) {
+	// Register before checking for data, so an append landing after the
+	// check still wakes this waiter
+	ready := s.longPoll.register(path)
+	defer s.longPoll.unregister(path)
+
 	// First check if stream is closed and client is at tail
-	s.metaCacheMu.RLock()
-	meta, ok := s.metaCache[path]
+	_, meta, _, ok := s.view(path)
 	if ok && meta.Closed && offset.Equal(meta.CurrentOffset) {
-		s.metaCacheMu.RUnlock()
 		return nil, false, true, nil // streamClosed = true
 	}
-	s.metaCacheMu.RUnlock()
 
 	// First check if there are already messages
-	messages, _, err := s.Read(path, offset)
+	messages, _, err := s.ReadWithLimits(path, offset, limits)
 	if err != nil {
 		return nil, false, false, err
 	}
@@ -1009,34 +1577,25 @@ func (s *FileStore) WaitForMessages(ctx context.Context, path string, offset Off
 	// returned it already, but if the source is missing/empty, don't wait
 	// -- inherited data will never arrive via long-poll notifications
 	// (source appends don't notify fork waiters).
-	s.metaCacheMu.RLock()
-	meta, ok = s.metaCache[path]
+	_, meta, _, ok = s.view(path)
 	if ok && meta.ForkedFrom != "" && offset.LessThan(meta.ForkOffset) {
-		s.metaCacheMu.RUnlock()
 		// Return empty -- no data available and waiting won't help
 		return nil, false, false, nil
 	}
-	s.metaCacheMu.RUnlock()
-
-	// No messages, set up wait
-	ch := make(chan struct{}, 1)
-	s.longPoll.register(path, ch)
-	defer s.longPoll.unregister(path, ch)
 
+	// No messages, wait for the stream to advance
 	timer := time.NewTimer(timeout)
 	defer timer.Stop()
 
 	select {
-	case <-ch:
+	case <-ready:
 		// New data or closure available - check which
-		s.metaCacheMu.RLock()
-		meta, ok := s.metaCache[path]
+		_, meta, _, ok := s.view(path)
 		if ok && meta.Closed {
 			// Stream was closed
 			currentOffset := meta.CurrentOffset
-			s.metaCacheMu.RUnlock()
 			// Check if there are any final messages
-			messages, _, err := s.Read(path, offset)
+			messages, _, err := s.ReadWithLimits(path, offset, limits)
 			if err != nil {
 				return nil, false, false, err
 			}
@@ -1046,16 +1605,13 @@ func (s *FileStore) WaitForMessages(ctx context.Context, path string, offset Off
 			}
 			return messages, false, false, nil
 		}
-		s.metaCacheMu.RUnlock()
 		// New data available
-		messages, _, err := s.Read(path, offset)
+		messages, _, err := s.ReadWithLimits(path, offset, limits)
 		return messages, false, false, err
 	case <-timer.C:
 		// Timeout - check if stream was closed during wait
-		s.metaCacheMu.RLock()
-		meta, ok := s.metaCache[path]
+		_, meta, _, ok := s.view(path)
 		streamClosed := ok && meta.Closed
-		s.metaCacheMu.RUnlock()
 		return nil, true, streamClosed, nil
 	case <-ctx.Done():
 		return nil, false, false, ctx.Err()
@@ -1064,24 +1620,30 @@ func (s *FileStore) WaitForMessages(ctx context.Context, path string, offset Off
 
 // CloseStream closes a stream without appending data
 func (s *FileStore) CloseStream(path string) (*CloseResult, error) {
-	s.metaCacheMu.Lock()
-	defer s.metaCacheMu.Unlock()
+	st := s.lookup(path)
+	if st == nil {
+		return nil, ErrStreamNotFound
+	}
 
-	meta, ok := s.metaCache[path]
-	if !ok {
+	st.mu.Lock()
+	defer st.mu.Unlock()
+
+	if st.removed {
 		return nil, ErrStreamNotFound
 	}
+	meta := st.meta
 
 	// Check if stream has expired
-	if meta.IsExpired() {
+	if st.isExpired() {
 		return nil, ErrStreamNotFound
 	}
 
 	alreadyClosed := meta.Closed
 	meta.Closed = true
 
-	// Persist to bbolt
-	s.metaStore.SetClosed(path, true, nil)
+	// Persist to bbolt, in order with buffered appends
+	s.metaBatch.record(path, st.dirName, meta.CurrentOffset, "", "", nil, true, nil)
+	s.metaBatch.flush()
 
 	// Notify pending long-polls that stream is closed
 	s.longPoll.notifyClosed(path)
@@ -1094,21 +1656,26 @@ func (s *FileStore) CloseStream(path string) (*CloseResult, error) {
 
 // CloseStreamWithProducer closes a stream without appending data, using producer headers.
 func (s *FileStore) CloseStreamWithProducer(path string, opts CloseProducerOptions) (*CloseProducerResult, error) {
+	st := s.lookup(path)
+	if st == nil {
+		return nil, ErrStreamNotFound
+	}
+
 	// Acquire per-producer lock for serialization
-	producerLock := s.getProducerLock(path, opts.ProducerId)
+	producerLock := st.producerLock(opts.ProducerId)
 	producerLock.Lock()
 	defer producerLock.Unlock()
 
-	s.metaCacheMu.Lock()
-	defer s.metaCacheMu.Unlock()
+	st.mu.Lock()
+	defer st.mu.Unlock()
 
-	meta, ok := s.metaCache[path]
-	if !ok {
+	if st.removed {
 		return nil, ErrStreamNotFound
 	}
+	meta := st.meta
 
 	// Check if stream has expired
-	if meta.IsExpired() {
+	if st.isExpired() {
 		return nil, ErrStreamNotFound
 	}
 
@@ -1164,10 +1731,7 @@ func (s *FileStore) CloseStreamWithProducer(path string, opts CloseProducerOptio
 	}
 
 	// Accept: commit producer state and close stream
-	if meta.Producers == nil {
-		meta.Producers = make(map[string]*ProducerState)
-	}
-	meta.Producers[opts.ProducerId] = newState
+	setProducerState(meta, opts.ProducerId, newState)
 	meta.Closed = true
 	meta.ClosedBy = &ClosedByProducer{
 		ProducerId: opts.ProducerId,
@@ -1175,8 +1739,10 @@ func (s *FileStore) CloseStreamWithProducer(path string, opts CloseProducerOptio
 		Seq:        opts.ProducerSeq,
 	}
 
-	// Persist producer state + closed state atomically
-	if err := s.metaStore.UpdateAppendState(path, meta.CurrentOffset, "", opts.ProducerId, newState, true, meta.ClosedBy); err != nil {
+	// Persist producer state + closed state atomically, in order with
+	// buffered appends
+	s.metaBatch.record(path, st.dirName, meta.CurrentOffset, "", opts.ProducerId, newState, true, meta.ClosedBy)
+	if err := s.metaBatch.flush(); err != nil {
 		// Log error but don't fail - file is the source of truth
 	}
 
@@ -1194,10 +1760,7 @@ func (s *FileStore) CloseStreamWithProducer(path string, opts CloseProducerOptio
 
 // GetCurrentOffset returns the current tail offset
 func (s *FileStore) GetCurrentOffset(path string) (Offset, error) {
-	s.metaCacheMu.RLock()
-	meta, ok := s.metaCache[path]
-	s.metaCacheMu.RUnlock()
-
+	_, meta, _, ok := s.view(path)
 	if !ok {
 		return Offset{}, ErrStreamNotFound
 	}
@@ -1210,12 +1773,39 @@ func (s *FileStore) Close() error {
 	close(s.cleanupStop)
 	<-s.cleanupDone // Wait for cleanup goroutine to finish
 
+	// Stop recovery workers; streams they did not reach stay unverified
+	close(s.recoveryStop)
+	s.recoveryWG.Wait()
+
+	// Stop uploads; segments not yet uploaded are queued again at startup
+	if s.tier != nil {
+		s.tier.close()
+	}
+
+	// Flush pending group commits before closing their file handles
+	s.committer.close()
+
 	var lastErr error
 
+	if err := s.metaBatch.close(); err != nil {
+		lastErr = err
+	}
+
 	if err := s.writerPool.Close(); err != nil {
 		lastErr = err
 	}
 
+	if err := s.readerPool.Close(); err != nil {
+		lastErr = err
+	}
+
+	// Segments are synced and closed: record the tails for a fast restart
+	if lastErr == nil {
+		if err := writeCheckpoint(s.dataDir, s.checkpointTails()); err != nil {
+			lastErr = err
+		}
+	}
+
 	if err := s.metaStore.Close(); err != nil {
 		lastErr = err
 	}
@@ -1240,46 +1830,45 @@ func (s *FileStore) backgroundCleanup(interval time.Duration) {
 	}
 }
 
-// cleanupExpiredStreams removes all expired streams
+// cleanupExpiredStreams removes the streams that have expired, found through
+// the expiry index. Each stream is checked and removed under its own lock,
+// so cleanup never stalls unrelated streams.
 func (s *FileStore) cleanupExpiredStreams() {
-	s.metaCacheMu.Lock()
-	defer s.metaCacheMu.Unlock()
-
-	var expiredPaths []string
-	for path, meta := range s.metaCache {
-		if meta.IsExpired() {
-			expiredPaths = append(expiredPaths, path)
+	now := time.Now()
+	for {
+		due := s.expiry.popDue(now, expiryBatchSize)
+		for _, item := range due {
+			if st, ok := item.stream.(*fileStream); ok {
+				s.expireStream(item.path, st)
+			}
+		}
+		if len(due) < expiryBatchSize {
+			return
 		}
 	}
+}
 
-	for _, path := range expiredPaths {
-		dirName := s.dirCache[path]
-
-		// Remove from writer pool
-		segPath := filepath.Join(s.dataDir, "streams", dirName, SegmentFileName)
-		s.writerPool.Remove(segPath)
-
-		// Delete from bbolt
-		s.metaStore.Delete(path)
-
-		// Remove from cache
-		delete(s.metaCache, path)
-		delete(s.dirCache, path)
-
-		// Async delete directory
-		streamDir := filepath.Join(s.dataDir, "streams", dirName)
-		deletedDir := filepath.Join(s.dataDir, "streams", ".deleted~"+dirName+"~"+fmt.Sprintf("%d", time.Now().UnixNano()))
-		os.Rename(streamDir, deletedDir)
-		go os.RemoveAll(deletedDir)
+// expireStream removes the stream st at path if it has expired, or
+// schedules its next check if its TTL window moved since it was scheduled
+func (s *FileStore) expireStream(path string, st *fileStream) {
+	s.awaitRecovery(path, st)
+	st.mu.Lock()
+	defer st.mu.Unlock()
+	if st.removed {
+		return
 	}
+	meta := st.snapshot()
+	if meta.IsExpired() {
+		s.removeStreamLocked(path, st)
+		s.longPoll.notify(path)
+		return
+	}
+	s.expiry.schedule(path, st, &meta)
 }
 
 // FormatResponse formats messages for HTTP response based on content type
 func (s *FileStore) FormatResponse(path string, messages []Message) ([]byte, error) {
-	s.metaCacheMu.RLock()
-	meta, ok := s.metaCache[path]
-	s.metaCacheMu.RUnlock()
-
+	_, meta, _, ok := s.view(path)
 	if !ok {
 		return nil, ErrStreamNotFound
 	}
@@ -1314,99 +1903,3 @@ func generateDirectoryName(path string) (string, error) {
 
 	return fmt.Sprintf("%s~%d~%s", encoded, timestamp, randomHex), nil
 }
-
-// Recovery functions
-
-// RecoveryEvent describes a repair made during store recovery.
-type RecoveryEvent struct {
-	StreamPath     string
-	SegmentPath    string
-	OriginalSize   uint64
-	RecoveredSize  uint64
-	DiscardedBytes uint64
-}
-
-// RecoverStore performs recovery on a file store, reconciling bbolt with segment files
-func RecoverStore(dataDir string) error {
-	return RecoverStoreWithEvents(dataDir, nil)
-}
-
-// RecoverStoreWithEvents performs recovery and calls onEvent for each repair.
-func RecoverStoreWithEvents(dataDir string, onEvent func(RecoveryEvent)) error {
-	metaDir := filepath.Join(dataDir, "metadata")
-	metaStore, err := NewBboltMetadataStore(metaDir)
-	if err != nil {
-		return fmt.Errorf("failed to open metadata store: %w", err)
-	}
-	defer metaStore.Close()
-
-	streamsDir := filepath.Join(dataDir, "streams")
-
-	return metaStore.ForEach(func(meta *StreamMetadata, dirName string) error {
-		segPath := filepath.Join(streamsDir, dirName, SegmentFileName)
-
-		trueOffset, err := recoverSegment(segPath, meta.Path, onEvent)
-		if err != nil {
-			if errors.Is(err, os.ErrNotExist) {
-				// Orphaned metadata - delete it
-				return metaStore.Delete(meta.Path)
-			}
-			return err
-		}
-
-		// Reconcile if mismatch
-		if !meta.CurrentOffset.Equal(trueOffset) {
-			if err := metaStore.UpdateOffset(meta.Path, trueOffset, ""); err != nil {
-				return fmt.Errorf("failed to update offset for %s: %w", meta.Path, err)
-			}
-		}
-
-		return nil
-	})
-}
-
-func recoverSegment(segPath, streamPath string, onEvent func(RecoveryEvent)) (offset Offset, err error) {
-	f, err := os.OpenFile(segPath, os.O_RDWR, 0644)
-	if err != nil {
-		return Offset{}, fmt.Errorf("failed to open segment for recovery %s: %w", streamPath, err)
-	}
-	defer func() {
-		if closeErr := f.Close(); err == nil && closeErr != nil {
-			err = fmt.Errorf("failed to close segment for %s: %w", streamPath, closeErr)
-		}
-	}()
-
-	trueOffset, err := ScanSegmentFile(f)
-	if err != nil {
-		return Offset{}, fmt.Errorf("failed to scan segment for %s: %w", streamPath, err)
-	}
-
-	info, err := f.Stat()
-	if err != nil {
-		return Offset{}, fmt.Errorf("failed to stat segment for %s: %w", streamPath, err)
-	}
-
-	originalSize := uint64(info.Size())
-	if originalSize > trueOffset.ByteOffset {
-		if err := f.Truncate(int64(trueOffset.ByteOffset)); err != nil {
-			return Offset{}, fmt.Errorf("failed to truncate segment for %s: %w", streamPath, err)
-		}
-		if err := f.Sync(); err != nil {
-			return Offset{}, fmt.Errorf("failed to sync segment for %s: %w", streamPath, err)
-		}
-		if onEvent != nil {
-			onEvent(RecoveryEvent{
-				StreamPath:     streamPath,
-				SegmentPath:    segPath,
-				OriginalSize:   originalSize,
-				RecoveredSize:  trueOffset.ByteOffset,
-				DiscardedBytes: originalSize - trueOffset.ByteOffset,
-			})
-		}
-	}
-
-	return trueOffset, nil
-}
-
-// Note: longPollManager and processJSONAppend are defined in memory_store.go
-// They are shared between memory and file stores
@@ -4,8 +4,12 @@ import (
 	"bytes"
 	"context"
 	"encoding/binary"
+	"errors"
+	"fmt"
 	"os"
 	"path/filepath"
+	"sync"
+	"sync/atomic"
 	"testing"
 	"time"
 )
@@ -356,7 +360,7 @@ func TestRecoverStore_TruncatesCorruptSegmentTail(t *testing.T) {
 			t.Fatalf("Append failed: %v", err)
 		}
 
-		segPath = filepath.Join(tmpDir, "streams", store.dirCache["/test"], SegmentFileName)
+		segPath = filepath.Join(tmpDir, "streams", store.streams.get("/test").dirName, SegmentFileName)
 		if err := store.Close(); err != nil {
 			t.Fatalf("Close failed: %v", err)
 		}
@@ -437,7 +441,7 @@ func TestRecoverStoreWithEvents_ReportsTruncation(t *testing.T) {
 			t.Fatalf("Append failed: %v", err)
 		}
 
-		segPath = filepath.Join(tmpDir, "streams", store.dirCache["/test"], SegmentFileName)
+		segPath = filepath.Join(tmpDir, "streams", store.streams.get("/test").dirName, SegmentFileName)
 		if err := store.Close(); err != nil {
 			t.Fatalf("Close failed: %v", err)
 		}
@@ -508,7 +512,7 @@ func TestFileStore_LongPoll(t *testing.T) {
 	var messages []Message
 	var timedOut bool
 	go func() {
-		messages, timedOut, _, _ = store.WaitForMessages(context.Background(), "/test", ZeroOffset, 5*time.Second)
+		messages, timedOut, _, _ = store.WaitForMessages(context.Background(), "/test", ZeroOffset, 5*time.Second, ReadLimits{})
 		close(done)
 	}()
 
@@ -548,7 +552,7 @@ func TestFileStore_LongPollTimeout(t *testing.T) {
 	offset, _ := store.GetCurrentOffset("/test")
 
 	// Long-poll at tail with short timeout
-	messages, timedOut, _, err := store.WaitForMessages(context.Background(), "/test", offset, 100*time.Millisecond)
+	messages, timedOut, _, err := store.WaitForMessages(context.Background(), "/test", offset, 100*time.Millisecond, ReadLimits{})
 	if err != nil {
 		t.Fatalf("WaitForMessages failed: %v", err)
 	}
@@ -744,3 +748,459 @@ func TestFileStore_AppendAndClose(t *testing.T) {
 		t.Error("data mismatch")
 	}
 }
+
+func TestFileStore_GroupCommitConcurrentAppends(t *testing.T) {
+	tmpDir, err := os.MkdirTemp("", "filestore-test-*")
+	if err != nil {
+		t.Fatalf("failed to create temp dir: %v", err)
+	}
+	defer os.RemoveAll(tmpDir)
+
+	store, err := NewFileStore(FileStoreConfig{
+		DataDir:          tmpDir,
+		GroupCommitDelay: 2 * time.Millisecond,
+	})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+
+	streams := []string{"/a", "/b", "/c"}
+	for _, path := range streams {
+		if _, _, err := store.Create(path, CreateOptions{ContentType: "text/plain"}); err != nil {
+			t.Fatalf("Create failed: %v", err)
+		}
+	}
+
+	const perStream = 20
+	var wg sync.WaitGroup
+	for _, path := range streams {
+		for i := 0; i < perStream; i++ {
+			wg.Add(1)
+			go func(path string) {
+				defer wg.Done()
+				if _, err := store.Append(path, []byte("x"), AppendOptions{}); err != nil {
+					t.Errorf("Append failed: %v", err)
+				}
+			}(path)
+		}
+	}
+	wg.Wait()
+
+	if err := store.Close(); err != nil {
+		t.Fatalf("Close failed: %v", err)
+	}
+
+	// Reopen: every acked append must be on disk
+	store, err = NewFileStore(FileStoreConfig{DataDir: tmpDir})
+	if err != nil {
+		t.Fatalf("failed to reopen store: %v", err)
+	}
+	defer store.Close()
+
+	for _, path := range streams {
+		messages, _, err := store.Read(path, ZeroOffset)
+		if err != nil {
+			t.Fatalf("Read failed: %v", err)
+		}
+		if len(messages) != perStream {
+			t.Errorf("%s: expected %d messages, got %d", path, perStream, len(messages))
+		}
+	}
+}
+
+func TestFileStore_AppendVisibleOnceDurable(t *testing.T) {
+	store, err := NewFileStore(FileStoreConfig{DataDir: t.TempDir()})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer store.Close()
+
+	if _, _, err := store.Create("/test", CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+
+	// Hold each fsync until the test decides its outcome
+	syncing := make(chan struct{})
+	outcome := make(chan error)
+	store.committer.close()
+	store.committer = newGroupCommitter(func(path string) error {
+		syncing <- struct{}{}
+		return <-outcome
+	}, store.metaBatch.flush, 0, 0)
+
+	appendAsync := func(data string) <-chan error {
+		done := make(chan error, 1)
+		go func() {
+			_, err := store.Append("/test", []byte(data), AppendOptions{})
+			done <- err
+		}()
+		<-syncing
+		return done
+	}
+	expectTail := func(want Offset, messages int) {
+		t.Helper()
+		offset, err := store.GetCurrentOffset("/test")
+		if err != nil {
+			t.Fatalf("GetCurrentOffset failed: %v", err)
+		}
+		if !offset.Equal(want) {
+			t.Errorf("expected tail %s, got %s", want, offset)
+		}
+		got, _, err := store.Read("/test", ZeroOffset)
+		if err != nil {
+			t.Fatalf("Read failed: %v", err)
+		}
+		if len(got) != messages {
+			t.Errorf("expected %d messages, got %d", messages, len(got))
+		}
+	}
+
+	// Written but not yet durable: invisible until the commit succeeds
+	done := appendAsync("durable")
+	expectTail(ZeroOffset, 0)
+	outcome <- nil
+	if err := <-done; err != nil {
+		t.Fatalf("Append failed: %v", err)
+	}
+	durable, _ := store.GetCurrentOffset("/test")
+	expectTail(durable, 1)
+
+	// A failed commit is never exposed, not even by later appends
+	done = appendAsync("lost")
+	outcome <- errors.New("disk on fire")
+	if err := <-done; err == nil {
+		t.Fatal("expected Append to fail")
+	}
+	expectTail(durable, 1)
+	if _, err := store.Append("/test", []byte("after"), AppendOptions{}); err == nil {
+		t.Fatal("expected Append after a failed sync to fail")
+	}
+	expectTail(durable, 1)
+}
+
+func TestFileStore_ConcurrentCreateAppendDelete(t *testing.T) {
+	tmpDir, err := os.MkdirTemp("", "filestore-test-*")
+	if err != nil {
+		t.Fatalf("failed to create temp dir: %v", err)
+	}
+	defer os.RemoveAll(tmpDir)
+
+	store, err := NewFileStore(FileStoreConfig{DataDir: tmpDir})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer store.Close()
+
+	// Racing creates of one path: exactly one creates, the rest see it
+	var created atomic.Int32
+	var wg sync.WaitGroup
+	for i := 0; i < 10; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			_, isNew, err := store.Create("/shared", CreateOptions{ContentType: "text/plain"})
+			if err != nil {
+				t.Errorf("Create failed: %v", err)
+				return
+			}
+			if isNew {
+				created.Add(1)
+			}
+		}()
+	}
+	wg.Wait()
+	if got := created.Load(); got != 1 {
+		t.Fatalf("expected exactly one create, got %d", got)
+	}
+
+	// Independent streams are created, appended and deleted concurrently
+	for i := 0; i < 8; i++ {
+		wg.Add(1)
+		go func(path string) {
+			defer wg.Done()
+			if _, _, err := store.Create(path, CreateOptions{ContentType: "text/plain"}); err != nil {
+				t.Errorf("Create failed: %v", err)
+				return
+			}
+			for j := 0; j < 10; j++ {
+				if _, err := store.Append(path, []byte("x"), AppendOptions{}); err != nil {
+					t.Errorf("Append failed: %v", err)
+					return
+				}
+				if _, _, err := store.Read(path, ZeroOffset); err != nil {
+					t.Errorf("Read failed: %v", err)
+					return
+				}
+			}
+			if err := store.Delete(path); err != nil {
+				t.Errorf("Delete failed: %v", err)
+			}
+		}(fmt.Sprintf("/stream-%d", i))
+	}
+	wg.Wait()
+
+	for i := 0; i < 8; i++ {
+		if store.Has(fmt.Sprintf("/stream-%d", i)) {
+			t.Errorf("stream-%d should have been deleted", i)
+		}
+	}
+	if !store.Has("/shared") {
+		t.Error("shared stream should still exist")
+	}
+}
+
+func TestReadWithLimits_PagesThroughStream(t *testing.T) {
+	tmpDir, err := os.MkdirTemp("", "filestore-test-*")
+	if err != nil {
+		t.Fatalf("failed to create temp dir: %v", err)
+	}
+	defer os.RemoveAll(tmpDir)
+
+	fileStore, err := NewFileStore(FileStoreConfig{DataDir: tmpDir})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer fileStore.Close()
+
+	stores := map[string]Store{
+		"memory": NewMemoryStore(),
+		"file":   fileStore,
+	}
+
+	for name, s := range stores {
+		t.Run(name, func(t *testing.T) {
+			if _, _, err := s.Create("/source", CreateOptions{ContentType: "application/json"}); err != nil {
+				t.Fatalf("Create failed: %v", err)
+			}
+			for i := 0; i < 5; i++ {
+				if _, err := s.Append("/source", []byte(fmt.Sprintf(`{"n":%d}`, i)), AppendOptions{}); err != nil {
+					t.Fatalf("Append failed: %v", err)
+				}
+			}
+			if _, _, err := s.Create("/fork", CreateOptions{ContentType: "application/json", ForkedFrom: "/source"}); err != nil {
+				t.Fatalf("fork Create failed: %v", err)
+			}
+			for i := 5; i < 10; i++ {
+				if _, err := s.Append("/fork", []byte(fmt.Sprintf(`{"n":%d}`, i)), AppendOptions{}); err != nil {
+					t.Fatalf("Append failed: %v", err)
+				}
+			}
+
+			// Page through the fork three messages at a time, across the fork point
+			var got []string
+			offset := ZeroOffset
+			for page := 0; ; page++ {
+				if page > 10 {
+					t.Fatal("pagination did not terminate")
+				}
+				messages, upToDate, err := s.ReadWithLimits("/fork", offset, ReadLimits{MaxMessages: 3})
+				if err != nil {
+					t.Fatalf("ReadWithLimits failed: %v", err)
+				}
+				if len(messages) > 3 {
+					t.Fatalf("chunk exceeded limit: %d messages", len(messages))
+				}
+				for _, msg := range messages {
+					got = append(got, string(msg.Data))
+				}
+				if len(messages) > 0 {
+					offset = messages[len(messages)-1].Offset
+				}
+				if upToDate {
+					break
+				}
+			}
+
+			if len(got) != 10 {
+				t.Fatalf("expected 10 messages, got %d: %v", len(got), got)
+			}
+			for i, data := range got {
+				if want := fmt.Sprintf(`{"n":%d}`, i); data != want {
+					t.Errorf("message %d: got %s, want %s", i, data, want)
+				}
+			}
+		})
+	}
+}
+
+func TestReadWithLimits_ForkChainIgnoresLaterSourceAppends(t *testing.T) {
+	fileStore, err := NewFileStore(FileStoreConfig{DataDir: t.TempDir(), TailCacheBytes: -1})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer fileStore.Close()
+
+	stores := map[string]Store{
+		"memory": NewMemoryStore(),
+		"file":   fileStore,
+	}
+
+	appendN := func(t *testing.T, s Store, path, prefix string, from, to int) {
+		t.Helper()
+		for i := from; i < to; i++ {
+			if _, err := s.Append(path, []byte(fmt.Sprintf("%s-%02d", prefix, i)), AppendOptions{}); err != nil {
+				t.Fatalf("Append failed: %v", err)
+			}
+		}
+	}
+
+	for name, s := range stores {
+		t.Run(name, func(t *testing.T) {
+			if _, _, err := s.Create("/root", CreateOptions{ContentType: "text/plain"}); err != nil {
+				t.Fatalf("Create failed: %v", err)
+			}
+			appendN(t, s, "/root", "m", 0, 4)
+			if _, _, err := s.Create("/mid", CreateOptions{ForkedFrom: "/root"}); err != nil {
+				t.Fatalf("fork Create failed: %v", err)
+			}
+			appendN(t, s, "/mid", "m", 4, 7)
+			if _, _, err := s.Create("/leaf", CreateOptions{ForkedFrom: "/mid"}); err != nil {
+				t.Fatalf("fork Create failed: %v", err)
+			}
+			appendN(t, s, "/leaf", "m", 7, 10)
+
+			// Appends after the forks were created are invisible to /leaf
+			appendN(t, s, "/root", "late", 0, 20)
+			appendN(t, s, "/mid", "late", 0, 20)
+
+			var got []string
+			offset := ZeroOffset
+			for page := 0; ; page++ {
+				if page > 10 {
+					t.Fatal("pagination did not terminate")
+				}
+				messages, upToDate, err := s.ReadWithLimits("/leaf", offset, ReadLimits{MaxMessages: 3})
+				if err != nil {
+					t.Fatalf("ReadWithLimits failed: %v", err)
+				}
+				// The budget is spent only on messages the fork can see
+				if !upToDate && len(messages) != 3 {
+					t.Fatalf("page %d: expected a full chunk, got %d messages", page, len(messages))
+				}
+				for _, msg := range messages {
+					got = append(got, string(msg.Data))
+				}
+				if len(messages) > 0 {
+					offset = messages[len(messages)-1].Offset
+				}
+				if upToDate {
+					break
+				}
+			}
+
+			if len(got) != 10 {
+				t.Fatalf("expected 10 messages, got %d: %v", len(got), got)
+			}
+			for i, data := range got {
+				if want := fmt.Sprintf("m-%02d", i); data != want {
+					t.Errorf("message %d: got %s, want %s", i, data, want)
+				}
+			}
+		})
+	}
+
+	// Each ancestor contributes only the range up to the fork below it
+	_, meta, layout, _ := fileStore.view("/leaf")
+	_, midMeta, _, _ := fileStore.view("/mid")
+	ranges := fileStore.planForkRead(&meta, layout, ZeroOffset, meta.CurrentOffset)
+	if len(ranges) != 3 {
+		t.Fatalf("expected ranges from 3 streams, got %d", len(ranges))
+	}
+	wantEnds := []Offset{midMeta.ForkOffset, meta.ForkOffset, meta.CurrentOffset}
+	for i, r := range ranges {
+		if !r.end.Equal(wantEnds[i]) {
+			t.Errorf("range %d: end %s, want %s", i, r.end, wantEnds[i])
+		}
+	}
+}
+
+func TestFileStore_BinaryForkSubOffsetReadsPrefixOnly(t *testing.T) {
+	store, err := NewFileStore(FileStoreConfig{DataDir: t.TempDir(), TailCacheBytes: -1})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer store.Close()
+
+	if _, _, err := store.Create("/source", CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	first, err := store.Append("/source", []byte("first"), AppendOptions{})
+	if err != nil {
+		t.Fatalf("Append failed: %v", err)
+	}
+	if _, err := store.Append("/source", []byte("hello world"), AppendOptions{}); err != nil {
+		t.Fatalf("Append failed: %v", err)
+	}
+
+	subOffset := uint64(5)
+	if _, _, err := store.Create("/fork", CreateOptions{ForkedFrom: "/source", ForkOffset: &first.Offset, ForkSubOffset: &subOffset}); err != nil {
+		t.Fatalf("fork Create failed: %v", err)
+	}
+	messages, _, err := store.Read("/fork", ZeroOffset)
+	if err != nil {
+		t.Fatalf("Read failed: %v", err)
+	}
+	if len(messages) != 2 || string(messages[0].Data) != "first" || string(messages[1].Data) != "hello" {
+		t.Fatalf("unexpected fork contents %q", messages)
+	}
+
+	tooLong := uint64(12)
+	if _, _, err := store.Create("/bad", CreateOptions{ForkedFrom: "/source", ForkOffset: &first.Offset, ForkSubOffset: &tooLong}); !errors.Is(err, ErrInvalidForkSubOffset) {
+		t.Errorf("expected ErrInvalidForkSubOffset, got %v", err)
+	}
+}
+
+func TestFileStore_AppendBatch(t *testing.T) {
+	store, err := NewFileStore(FileStoreConfig{DataDir: t.TempDir(), MetadataFlushInterval: -1})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer store.Close()
+
+	store.Create("/a", CreateOptions{ContentType: "text/plain"})
+	store.Create("/b", CreateOptions{ContentType: "application/json"})
+	store.Create("/closed", CreateOptions{ContentType: "text/plain", Closed: true})
+
+	epoch, seq := int64(0), int64(0)
+	producer := AppendOptions{ProducerId: "p1", ProducerEpoch: &epoch, ProducerSeq: &seq}
+	results := store.AppendBatch([]BatchEntry{
+		{Path: "/a", Data: []byte("one")},
+		{Path: "/b", Data: []byte(`[{"n":1},{"n":2}]`)},
+		{Path: "/closed", Data: []byte("x")},
+		{Path: "/missing", Data: []byte("x")},
+		{Path: "/a", Data: []byte("two"), Opts: producer},
+		{Path: "/a", Data: []byte("two"), Opts: producer},
+	})
+
+	for i, want := range []error{nil, nil, ErrStreamClosed, ErrStreamNotFound, nil, nil} {
+		if !errors.Is(results[i].Err, want) {
+			t.Errorf("entry %d: expected error %v, got %v", i, want, results[i].Err)
+		}
+	}
+	if r := results[4].Result; r.ProducerResult != ProducerResultAccepted {
+		t.Errorf("expected producer append to be accepted, got %+v", r)
+	}
+	if r := results[5].Result; r.ProducerResult != ProducerResultDuplicate || !r.Offset.Equal(results[4].Result.Offset) {
+		t.Errorf("expected retried producer append to be a duplicate, got %+v", r)
+	}
+
+	messages, _, err := store.Read("/a", ZeroOffset)
+	if err != nil {
+		t.Fatalf("Read failed: %v", err)
+	}
+	if len(messages) != 2 || string(messages[0].Data) != "one" || string(messages[1].Data) != "two" {
+		t.Errorf("unexpected messages on /a: %+v", messages)
+	}
+	if messages, _, _ := store.Read("/b", ZeroOffset); len(messages) != 2 {
+		t.Errorf("expected JSON array to be flattened into 2 messages, got %d", len(messages))
+	}
+
+	// Producer state is durable once the batch returns
+	meta, _, err := store.metaStore.Get("/a")
+	if err != nil {
+		t.Fatalf("metadata Get failed: %v", err)
+	}
+	if state := meta.Producers["p1"]; state == nil || state.LastSeq != 0 {
+		t.Errorf("expected persisted producer state, got %+v", state)
+	}
+}
@@ -2,8 +2,11 @@ package store
 
 import (
 	"container/list"
+	"errors"
 	"os"
 	"sync"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/metrics"
 )
 
 // FilePool manages a pool of file handles with LRU eviction
@@ -18,6 +21,8 @@ type poolEntry struct {
 	path    string
 	file    *os.File
 	element *list.Element
+	refs    int  // outstanding AcquireWriter handles
+	retired bool // no longer in the pool; closed once refs drops to zero
 }
 
 // NewFilePool creates a new file pool with the given maximum size
@@ -33,16 +38,41 @@ func NewFilePool(maxSize int) *FilePool {
 }
 
 // GetWriter gets a file handle for writing (append mode)
-// The returned file should not be closed by the caller
+// The returned file should not be closed by the caller. It is not pinned, so
+// it may be closed by eviction at any time; writers use AcquireWriter.
 func (p *FilePool) GetWriter(path string) (*os.File, error) {
 	p.mu.Lock()
 	defer p.mu.Unlock()
 
+	entry, err := p.getLocked(path)
+	if err != nil {
+		return nil, err
+	}
+	return entry.file, nil
+}
+
+// AcquireWriter gets a file handle for writing and pins it: the handle is
+// never evicted, and stays open even if it is removed meanwhile, until
+// release is called. A write made of several Write calls must hold one pin
+// throughout, so that the handle cannot close between them.
+func (p *FilePool) AcquireWriter(path string) (file *os.File, release func(), err error) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	entry, err := p.getLocked(path)
+	if err != nil {
+		return nil, nil, err
+	}
+	entry.refs++
+	return entry.file, func() { p.release(entry) }, nil
+}
+
+func (p *FilePool) getLocked(path string) (*poolEntry, error) {
 	// Check if already open
 	if entry, ok := p.files[path]; ok {
 		// Move to front of LRU
 		p.lru.MoveToFront(entry.element)
-		return entry.file, nil
+		return entry, nil
 	}
 
 	// Need to open
@@ -50,6 +80,7 @@ func (p *FilePool) GetWriter(path string) (*os.File, error) {
 	if err != nil {
 		return nil, err
 	}
+	metrics.OpenWriters.Inc()
 
 	// Evict if needed
 	p.evictIfNeeded()
@@ -62,20 +93,51 @@ func (p *FilePool) GetWriter(path string) (*os.File, error) {
 	entry.element = p.lru.PushFront(entry)
 	p.files[path] = entry
 
-	return file, nil
+	return entry, nil
+}
+
+func (p *FilePool) release(entry *poolEntry) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	entry.refs--
+	if entry.retired && entry.refs == 0 {
+		metrics.OpenWriters.Dec()
+		entry.file.Close()
+	}
+}
+
+// retire drops an entry from the pool and closes it unless it is pinned.
+// Must be called with lock held
+func (p *FilePool) retire(entry *poolEntry) error {
+	p.lru.Remove(entry.element)
+	delete(p.files, entry.path)
+	entry.retired = true
+	if entry.refs > 0 {
+		return nil
+	}
+	metrics.OpenWriters.Dec()
+	return entry.file.Close()
 }
 
-// Sync syncs a specific file to disk
+// Sync syncs a specific file to disk.
+// When fsyncs are deferred (group commit), the handle used for the write may
+// have been evicted, or be evicted concurrently, before the sync runs. The
+// written pages are still in the page cache, so in that case the file is
+// reopened and synced through a fresh descriptor.
 func (p *FilePool) Sync(path string) error {
 	p.mu.Lock()
 	entry, ok := p.files[path]
 	p.mu.Unlock()
 
-	if !ok {
-		return nil // Not open, nothing to sync
+	if ok {
+		err := entry.file.Sync()
+		if !errors.Is(err, os.ErrClosed) {
+			return err
+		}
 	}
 
-	return entry.file.Sync()
+	return syncByPath(path)
 }
 
 // SyncAll syncs all open files to disk
@@ -96,7 +158,8 @@ func (p *FilePool) SyncAll() error {
 	return lastErr
 }
 
-// Remove removes a file from the pool and closes its handle
+// Remove removes a file from the pool and closes its handle once no writer
+// holds it
 func (p *FilePool) Remove(path string) error {
 	p.mu.Lock()
 	defer p.mu.Unlock()
@@ -106,9 +169,7 @@ func (p *FilePool) Remove(path string) error {
 		return nil
 	}
 
-	p.lru.Remove(entry.element)
-	delete(p.files, path)
-	return entry.file.Close()
+	return p.retire(entry)
 }
 
 // Close closes all file handles
@@ -117,11 +178,10 @@ func (p *FilePool) Close() error {
 	defer p.mu.Unlock()
 
 	var lastErr error
-	for path, entry := range p.files {
-		if err := entry.file.Close(); err != nil {
+	for _, entry := range p.files {
+		if err := p.retire(entry); err != nil {
 			lastErr = err
 		}
-		delete(p.files, path)
 	}
 	p.lru.Init()
 
@@ -135,7 +195,9 @@ func (p *FilePool) Size() int {
 	return len(p.files)
 }
 
-// evictIfNeeded evicts the least recently used entry if the pool is full
+// evictIfNeeded evicts the least recently used unpinned entry if the pool
+// is full. While every entry is pinned the pool grows past maxSize instead
+// of failing writes; it shrinks back as later opens evict.
 // Must be called with lock held
 func (p *FilePool) evictIfNeeded() {
 	if len(p.files) < p.maxSize {
@@ -143,18 +205,32 @@ func (p *FilePool) evictIfNeeded() {
 	}
 
 	// Evict from back of LRU (least recently used)
-	elem := p.lru.Back()
-	if elem == nil {
-		return
+	for elem := p.lru.Back(); elem != nil; elem = elem.Prev() {
+		entry := elem.Value.(*poolEntry)
+		if entry.refs == 0 {
+			p.retire(entry)
+			return
+		}
 	}
+}
 
-	entry := elem.Value.(*poolEntry)
-	p.lru.Remove(elem)
-	delete(p.files, entry.path)
-	entry.file.Close()
+// syncByPath fsyncs a file that is not held open by the pool.
+// A file that no longer exists (e.g. the stream was deleted) has nothing left
+// to sync.
+func syncByPath(path string) error {
+	file, err := os.OpenFile(path, os.O_WRONLY, 0644)
+	if err != nil {
+		if errors.Is(err, os.ErrNotExist) {
+			return nil
+		}
+		return err
+	}
+	defer file.Close()
+	return file.Sync()
 }
 
-// ReaderPool manages a pool of file handles for reading
+// ReaderPool manages a pool of file handles for reading.
+// Handles are shared, so callers must use positional reads (ReadAt).
 type ReaderPool struct {
 	mu      sync.Mutex
 	maxSize int
@@ -166,6 +242,8 @@ type readerEntry struct {
 	path    string
 	file    *os.File
 	element *list.Element
+	refs    int  // outstanding Acquire handles
+	retired bool // no longer in the pool; closed once refs drops to zero
 }
 
 // NewReaderPool creates a new reader pool
@@ -185,15 +263,38 @@ func (p *ReaderPool) GetReader(path string) (*os.File, error) {
 	p.mu.Lock()
 	defer p.mu.Unlock()
 
+	entry, err := p.getLocked(path)
+	if err != nil {
+		return nil, err
+	}
+	return entry.file, nil
+}
+
+// Acquire gets a file handle for reading and pins it: the handle stays open,
+// even if it is evicted or removed meanwhile, until release is called.
+func (p *ReaderPool) Acquire(path string) (file *os.File, release func(), err error) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	entry, err := p.getLocked(path)
+	if err != nil {
+		return nil, nil, err
+	}
+	entry.refs++
+	return entry.file, func() { p.release(entry) }, nil
+}
+
+func (p *ReaderPool) getLocked(path string) (*readerEntry, error) {
 	if entry, ok := p.files[path]; ok {
 		p.lru.MoveToFront(entry.element)
-		return entry.file, nil
+		return entry, nil
 	}
 
 	file, err := os.Open(path)
 	if err != nil {
 		return nil, err
 	}
+	metrics.OpenReaders.Inc()
 
 	p.evictIfNeeded()
 
@@ -204,7 +305,31 @@ func (p *ReaderPool) GetReader(path string) (*os.File, error) {
 	entry.element = p.lru.PushFront(entry)
 	p.files[path] = entry
 
-	return file, nil
+	return entry, nil
+}
+
+func (p *ReaderPool) release(entry *readerEntry) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+
+	entry.refs--
+	if entry.retired && entry.refs == 0 {
+		metrics.OpenReaders.Dec()
+		entry.file.Close()
+	}
+}
+
+// retire drops an entry from the pool and closes it unless it is pinned.
+// Must be called with lock held
+func (p *ReaderPool) retire(entry *readerEntry) error {
+	p.lru.Remove(entry.element)
+	delete(p.files, entry.path)
+	entry.retired = true
+	if entry.refs > 0 {
+		return nil
+	}
+	metrics.OpenReaders.Dec()
+	return entry.file.Close()
 }
 
 // Remove removes a file from the pool
@@ -217,9 +342,7 @@ func (p *ReaderPool) Remove(path string) error {
 		return nil
 	}
 
-	p.lru.Remove(entry.element)
-	delete(p.files, path)
-	return entry.file.Close()
+	return p.retire(entry)
 }
 
 // Close closes all file handles
@@ -228,11 +351,10 @@ func (p *ReaderPool) Close() error {
 	defer p.mu.Unlock()
 
 	var lastErr error
-	for path, entry := range p.files {
-		if err := entry.file.Close(); err != nil {
+	for _, entry := range p.files {
+		if err := p.retire(entry); err != nil {
 			lastErr = err
 		}
-		delete(p.files, path)
 	}
 	p.lru.Init()
 
@@ -250,8 +372,5 @@ func (p *ReaderPool) evictIfNeeded() {
 		return
 	}
 
-	entry := elem.Value.(*readerEntry)
-	p.lru.Remove(elem)
-	delete(p.files, entry.path)
-	entry.file.Close()
+	p.retire(elem.Value.(*readerEntry))
 }
@@ -80,6 +80,43 @@ func TestFilePoolEviction(t *testing.T) {
 	}
 }
 
+func TestFilePoolAcquireWriterPinsHandle(t *testing.T) {
+	tmpDir, err := os.MkdirTemp("", "filepool-test-*")
+	if err != nil {
+		t.Fatalf("failed to create temp dir: %v", err)
+	}
+	defer os.RemoveAll(tmpDir)
+
+	pool := NewFilePool(1)
+	defer pool.Close()
+
+	pinnedPath := filepath.Join(tmpDir, "pinned.dat")
+	pinned, release, err := pool.AcquireWriter(pinnedPath)
+	if err != nil {
+		t.Fatalf("AcquireWriter failed: %v", err)
+	}
+
+	// Opening another file must not evict the pinned handle
+	if _, err := pool.GetWriter(filepath.Join(tmpDir, "other.dat")); err != nil {
+		t.Fatalf("GetWriter failed: %v", err)
+	}
+	if _, err := pinned.Write([]byte("still open")); err != nil {
+		t.Fatalf("Write through pinned handle failed: %v", err)
+	}
+
+	// A removed pinned handle stays open until released
+	if err := pool.Remove(pinnedPath); err != nil {
+		t.Fatalf("Remove failed: %v", err)
+	}
+	if _, err := pinned.Write([]byte("after remove")); err != nil {
+		t.Fatalf("Write after Remove failed: %v", err)
+	}
+	release()
+	if _, err := pinned.Write([]byte("after release")); err == nil {
+		t.Error("expected the handle to be closed after release")
+	}
+}
+
 func TestFilePoolSync(t *testing.T) {
 	tmpDir, err := os.MkdirTemp("", "filepool-test-*")
 	if err != nil {
@@ -216,3 +253,39 @@ func TestReaderPoolEviction(t *testing.T) {
 		t.Error("first file should have been evicted")
 	}
 }
+
+func TestReaderPoolAcquirePinsEvictedHandle(t *testing.T) {
+	tmpDir, err := os.MkdirTemp("", "readerpool-test-*")
+	if err != nil {
+		t.Fatalf("failed to create temp dir: %v", err)
+	}
+	defer os.RemoveAll(tmpDir)
+
+	pathA := filepath.Join(tmpDir, "a.dat")
+	pathB := filepath.Join(tmpDir, "b.dat")
+	os.WriteFile(pathA, []byte("hello"), 0644)
+	os.WriteFile(pathB, []byte("world"), 0644)
+
+	pool := NewReaderPool(1)
+	defer pool.Close()
+
+	f, release, err := pool.Acquire(pathA)
+	if err != nil {
+		t.Fatalf("Acquire failed: %v", err)
+	}
+
+	// Opening another file evicts a.dat, but the pinned handle stays usable
+	if _, err := pool.GetReader(pathB); err != nil {
+		t.Fatalf("GetReader failed: %v", err)
+	}
+	buf := make([]byte, 5)
+	if _, err := f.ReadAt(buf, 0); err != nil || string(buf) != "hello" {
+		t.Fatalf("pinned handle should still read, got %q, %v", buf, err)
+	}
+
+	// Releasing the last pin closes it
+	release()
+	if _, err := f.ReadAt(buf, 0); err == nil {
+		t.Error("evicted handle should be closed after release")
+	}
+}
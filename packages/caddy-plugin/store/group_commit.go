@@ -0,0 +1,323 @@
+package store
+
+import (
+	"sync"
+	"time"
+)
+
+const (
+	// DefaultGroupCommitMaxBatch is the default maximum number of appends
+	// acknowledged by a single group-commit window.
+	DefaultGroupCommitMaxBatch = 1024
+
+	// groupCommitSyncConcurrency bounds how many distinct segment files are
+	// fsynced concurrently within one commit window.
+	groupCommitSyncConcurrency = 16
+)
+
+// groupCommitter batches segment fsyncs across appends.
+//
+// Appends write their frames to the segment (ordering and offsets are decided
+// by the caller), then enqueue the segment path and block on the returned
+// channel. A single syncer goroutine collects requests for up to maxDelay, or
+// until maxBatch requests are queued, fsyncs every distinct segment in that
+// window exactly once, and then acks every waiter in the window. With a zero
+// maxDelay no latency is added: requests that arrive while an fsync is in
+// flight are simply committed together by the next one.
+//
+// A request made with commitMeta additionally needs the store's buffered
+// metadata on disk: after the window's fsyncs, flushMetaFn runs once for the
+// whole window before its meta requests are acked.
+//
+// A failed fsync fails every later sync of the same segment: the kernel may
+// have dropped the dirty pages, so a later success would not make the earlier
+// writes durable.
+type groupCommitter struct {
+	syncFn      func(path string) error
+	flushMetaFn func() error
+	maxDelay    time.Duration
+	maxBatch    int
+
+	mu     sync.Mutex
+	queue  []commitRequest
+	closed bool
+	failed map[string]error // First sync error per segment
+
+	wake chan struct{} // signaled when the queue goes non-empty or on close
+	full chan struct{} // signaled when the queue reaches maxBatch
+	done chan struct{}
+}
+
+type commitRequest struct {
+	segPath string
+	meta    bool // Also wait for flushMetaFn
+	result  chan error
+}
+
+// newGroupCommitter starts a syncer goroutine that fsyncs through syncFn and
+// flushes metadata through flushMetaFn (nil = no metadata to flush).
+func newGroupCommitter(syncFn func(path string) error, flushMetaFn func() error, maxDelay time.Duration, maxBatch int) *groupCommitter {
+	if maxBatch <= 0 {
+		maxBatch = DefaultGroupCommitMaxBatch
+	}
+	if maxDelay < 0 {
+		maxDelay = 0
+	}
+	g := &groupCommitter{
+		syncFn:      syncFn,
+		flushMetaFn: flushMetaFn,
+		maxDelay:    maxDelay,
+		maxBatch:    maxBatch,
+		wake:        make(chan struct{}, 1),
+		full:        make(chan struct{}, 1),
+		done:        make(chan struct{}),
+	}
+	go g.run()
+	return g
+}
+
+// enqueue registers a durability request for segPath. The returned channel
+// receives exactly one value: nil once the segment has been fsynced, or the
+// sync error. After close, the sync runs inline.
+func (g *groupCommitter) enqueue(segPath string, meta bool) <-chan error {
+	result := make(chan error, 1)
+
+	g.mu.Lock()
+	if g.closed {
+		g.mu.Unlock()
+		err := g.sync(segPath)
+		if err == nil && meta && g.flushMetaFn != nil {
+			err = g.flushMetaFn()
+		}
+		result <- err
+		return result
+	}
+	g.queue = append(g.queue, commitRequest{segPath: segPath, meta: meta, result: result})
+	n := len(g.queue)
+	g.mu.Unlock()
+
+	if n == 1 {
+		signal(g.wake)
+	}
+	if n >= g.maxBatch {
+		signal(g.full)
+	}
+	return result
+}
+
+// commit enqueues segPath and waits for the window containing it to be durable.
+func (g *groupCommitter) commit(segPath string) error {
+	return <-g.enqueue(segPath, false)
+}
+
+// commitMeta is commit that also waits for buffered metadata to be flushed.
+func (g *groupCommitter) commitMeta(segPath string) error {
+	return <-g.enqueue(segPath, true)
+}
+
+// commitAll enqueues every segment in segPaths in one step, so they share a
+// commit window and its metadata flush, and waits until all are durable.
+// Returns the first sync error.
+func (g *groupCommitter) commitAll(segPaths []string, meta bool) error {
+	g.mu.Lock()
+	if g.closed {
+		g.mu.Unlock()
+		for _, segPath := range segPaths {
+			if err := g.sync(segPath); err != nil {
+				return err
+			}
+		}
+		if meta && g.flushMetaFn != nil {
+			return g.flushMetaFn()
+		}
+		return nil
+	}
+	results := make([]chan error, len(segPaths))
+	for i, segPath := range segPaths {
+		results[i] = make(chan error, 1)
+		g.queue = append(g.queue, commitRequest{segPath: segPath, meta: meta, result: results[i]})
+	}
+	n := len(g.queue)
+	g.mu.Unlock()
+
+	if n == len(segPaths) {
+		signal(g.wake)
+	}
+	if n >= g.maxBatch {
+		signal(g.full)
+	}
+
+	var first error
+	for _, result := range results {
+		if err := <-result; err != nil && first == nil {
+			first = err
+		}
+	}
+	return first
+}
+
+// close flushes all queued requests and stops the syncer goroutine.
+func (g *groupCommitter) close() {
+	g.mu.Lock()
+	if g.closed {
+		g.mu.Unlock()
+		<-g.done
+		return
+	}
+	g.closed = true
+	g.mu.Unlock()
+
+	signal(g.wake)
+	signal(g.full)
+	<-g.done
+}
+
+func (g *groupCommitter) run() {
+	defer close(g.done)
+
+	for {
+		<-g.wake
+
+		// Hold the window open so concurrent appends can join it. The window
+		// closes early once maxBatch requests are queued or on shutdown.
+		if g.maxDelay > 0 && !g.isClosed() {
+			timer := time.NewTimer(g.maxDelay)
+			select {
+			case <-timer.C:
+			case <-g.full:
+			}
+			timer.Stop()
+		}
+
+		for {
+			batch, more := g.takeBatch()
+			if len(batch) > 0 {
+				g.syncBatch(batch)
+			}
+			if !more {
+				break
+			}
+		}
+
+		if g.isClosed() {
+			// Drain anything enqueued between the last takeBatch and close.
+			for {
+				batch, _ := g.takeBatch()
+				if len(batch) == 0 {
+					return
+				}
+				g.syncBatch(batch)
+			}
+		}
+	}
+}
+
+// takeBatch removes up to maxBatch requests from the queue. more reports
+// whether requests remain queued after this batch.
+func (g *groupCommitter) takeBatch() (batch []commitRequest, more bool) {
+	g.mu.Lock()
+	defer g.mu.Unlock()
+
+	n := len(g.queue)
+	if n > g.maxBatch {
+		n = g.maxBatch
+	}
+	batch = g.queue[:n:n]
+	if n == len(g.queue) {
+		g.queue = nil
+	} else {
+		g.queue = g.queue[n:]
+	}
+	// Drop a stale "full" signal left over from this window.
+	select {
+	case <-g.full:
+	default:
+	}
+	return batch, len(g.queue) > 0
+}
+
+// syncBatch fsyncs each distinct segment in the batch once, flushes metadata
+// if any request needs it, and acks waiters.
+func (g *groupCommitter) syncBatch(batch []commitRequest) {
+	paths := make([]string, 0, len(batch))
+	errs := make(map[string]error, len(batch))
+	needMeta := false
+	for _, req := range batch {
+		if _, seen := errs[req.segPath]; !seen {
+			errs[req.segPath] = nil
+			paths = append(paths, req.segPath)
+		}
+		needMeta = needMeta || req.meta
+	}
+
+	if len(paths) == 1 {
+		errs[paths[0]] = g.sync(paths[0])
+	} else {
+		var mu sync.Mutex
+		var wg sync.WaitGroup
+		sem := make(chan struct{}, groupCommitSyncConcurrency)
+		for _, path := range paths {
+			wg.Add(1)
+			sem <- struct{}{}
+			go func(path string) {
+				defer wg.Done()
+				err := g.sync(path)
+				<-sem
+				mu.Lock()
+				errs[path] = err
+				mu.Unlock()
+			}(path)
+		}
+		wg.Wait()
+	}
+
+	var metaErr error
+	if needMeta && g.flushMetaFn != nil {
+		metaErr = g.flushMetaFn()
+	}
+
+	for _, req := range batch {
+		err := errs[req.segPath]
+		if err == nil && req.meta {
+			err = metaErr
+		}
+		req.result <- err
+	}
+}
+
+// sync fsyncs segPath outside any commit window, returning the segment's
+// earlier sync error if it has one.
+func (g *groupCommitter) sync(segPath string) error {
+	g.mu.Lock()
+	err := g.failed[segPath]
+	g.mu.Unlock()
+	if err != nil {
+		return err
+	}
+
+	if err = g.syncFn(segPath); err != nil {
+		g.mu.Lock()
+		if g.failed == nil {
+			g.failed = make(map[string]error)
+		}
+		if g.failed[segPath] == nil {
+			g.failed[segPath] = err
+		}
+		g.mu.Unlock()
+	}
+	return err
+}
+
+func (g *groupCommitter) isClosed() bool {
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	return g.closed
+}
+
+// signal performs a non-blocking send on a capacity-1 channel.
+func signal(ch chan struct{}) {
+	select {
+	case ch <- struct{}{}:
+	default:
+	}
+}
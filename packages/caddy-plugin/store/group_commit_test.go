@@ -0,0 +1,191 @@
+package store
+
+import (
+	"errors"
+	"sync"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+func TestGroupCommitter_BatchesConcurrentCommits(t *testing.T) {
+	var syncs atomic.Int32
+	g := newGroupCommitter(func(path string) error {
+		syncs.Add(1)
+		return nil
+	}, nil, 20*time.Millisecond, 0)
+	defer g.close()
+
+	const n = 50
+	var wg sync.WaitGroup
+	for i := 0; i < n; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			if err := g.commit("/seg/a"); err != nil {
+				t.Errorf("commit failed: %v", err)
+			}
+		}()
+	}
+	wg.Wait()
+
+	// All commits target one segment; the window should collapse them into
+	// far fewer fsyncs than requests.
+	if got := syncs.Load(); got >= n/2 {
+		t.Errorf("expected commits to be batched, got %d syncs for %d commits", got, n)
+	}
+}
+
+func TestGroupCommitter_SyncsEachSegmentOncePerWindow(t *testing.T) {
+	var mu sync.Mutex
+	counts := make(map[string]int)
+	g := newGroupCommitter(func(path string) error {
+		mu.Lock()
+		counts[path]++
+		mu.Unlock()
+		return nil
+	}, nil, 50*time.Millisecond, 0)
+	defer g.close()
+
+	results := []<-chan error{
+		g.enqueue("/seg/a", false),
+		g.enqueue("/seg/b", false),
+		g.enqueue("/seg/a", false),
+		g.enqueue("/seg/b", false),
+	}
+	for _, ch := range results {
+		if err := <-ch; err != nil {
+			t.Fatalf("commit failed: %v", err)
+		}
+	}
+
+	mu.Lock()
+	defer mu.Unlock()
+	if counts["/seg/a"] != 1 || counts["/seg/b"] != 1 {
+		t.Errorf("expected one sync per segment, got %v", counts)
+	}
+}
+
+func TestGroupCommitter_MaxBatchClosesWindowEarly(t *testing.T) {
+	g := newGroupCommitter(func(path string) error { return nil }, nil, time.Hour, 4)
+	defer g.close()
+
+	var results []<-chan error
+	for i := 0; i < 4; i++ {
+		results = append(results, g.enqueue("/seg/a", false))
+	}
+
+	for _, ch := range results {
+		select {
+		case err := <-ch:
+			if err != nil {
+				t.Fatalf("commit failed: %v", err)
+			}
+		case <-time.After(2 * time.Second):
+			t.Fatal("full batch should not wait for the commit delay")
+		}
+	}
+}
+
+func TestGroupCommitter_PropagatesSyncError(t *testing.T) {
+	syncErr := errors.New("disk on fire")
+	g := newGroupCommitter(func(path string) error {
+		if path == "/seg/bad" {
+			return syncErr
+		}
+		return nil
+	}, nil, 10*time.Millisecond, 0)
+	defer g.close()
+
+	good := g.enqueue("/seg/good", false)
+	bad := g.enqueue("/seg/bad", false)
+
+	if err := <-good; err != nil {
+		t.Errorf("expected good segment to commit, got %v", err)
+	}
+	if err := <-bad; !errors.Is(err, syncErr) {
+		t.Errorf("expected sync error, got %v", err)
+	}
+}
+
+func TestGroupCommitter_CloseFlushesPending(t *testing.T) {
+	var syncs atomic.Int32
+	g := newGroupCommitter(func(path string) error {
+		syncs.Add(1)
+		return nil
+	}, nil, time.Hour, 0)
+
+	ch := g.enqueue("/seg/a", false)
+	g.close()
+
+	select {
+	case err := <-ch:
+		if err != nil {
+			t.Fatalf("commit failed: %v", err)
+		}
+	default:
+		t.Fatal("close should flush pending commits")
+	}
+
+	// Commits after close run inline
+	if err := g.commit("/seg/a"); err != nil {
+		t.Fatalf("commit after close failed: %v", err)
+	}
+	if got := syncs.Load(); got != 2 {
+		t.Errorf("expected 2 syncs, got %d", got)
+	}
+}
+
+func TestGroupCommitter_FlushesMetadataOncePerWindow(t *testing.T) {
+	var flushes atomic.Int32
+	g := newGroupCommitter(func(path string) error { return nil }, func() error {
+		flushes.Add(1)
+		return nil
+	}, 50*time.Millisecond, 0)
+	defer g.close()
+
+	// A window without meta requests does not flush
+	if err := g.commit("/seg/a"); err != nil {
+		t.Fatalf("commit failed: %v", err)
+	}
+	if got := flushes.Load(); got != 0 {
+		t.Fatalf("expected no metadata flush, got %d", got)
+	}
+
+	results := []<-chan error{
+		g.enqueue("/seg/a", true),
+		g.enqueue("/seg/b", false),
+		g.enqueue("/seg/c", true),
+	}
+	for _, ch := range results {
+		if err := <-ch; err != nil {
+			t.Fatalf("commit failed: %v", err)
+		}
+	}
+	if got := flushes.Load(); got != 1 {
+		t.Errorf("expected 1 metadata flush for the window, got %d", got)
+	}
+}
+
+func TestGroupCommitter_CommitAllSharesOneWindow(t *testing.T) {
+	var syncs, flushes atomic.Int32
+	g := newGroupCommitter(func(path string) error {
+		syncs.Add(1)
+		return nil
+	}, func() error {
+		flushes.Add(1)
+		return nil
+	}, 0, 0)
+	defer g.close()
+
+	// Without a commit delay, separate commits would each get a window
+	if err := g.commitAll([]string{"/seg/a", "/seg/b", "/seg/c"}, true); err != nil {
+		t.Fatalf("commitAll failed: %v", err)
+	}
+	if got := syncs.Load(); got != 3 {
+		t.Errorf("expected one sync per segment, got %d", got)
+	}
+	if got := flushes.Load(); got != 1 {
+		t.Errorf("expected 1 metadata flush for the batch, got %d", got)
+	}
+}
@@ -0,0 +1,313 @@
+package store
+
+import (
+	"encoding/binary"
+	"sync"
+)
+
+// JSON append parsing:
+// A JSON-mode append body is either a single value, stored as one message,
+// or an array, whose top-level elements are stored as one message each. The
+// scanner below validates the body and finds those element boundaries in a
+// single pass without allocating, so bodies are neither parsed twice nor
+// copied into intermediate structures. It accepts exactly what json.Valid
+// accepts.
+
+const (
+	// maxJSONNestingDepth matches encoding/json's nesting limit
+	maxJSONNestingDepth = 10000
+
+	// maxPooledFrameBuffer caps the frame buffers kept for reuse, so one
+	// large append does not pin its buffer
+	maxPooledFrameBuffer = 1024 * 1024
+)
+
+// frameBuffers recycles the buffers JSON appends are framed into
+var frameBuffers = sync.Pool{
+	New: func() any {
+		buf := make([]byte, 0, 4096)
+		return &buf
+	},
+}
+
+// forEachJSONAppendValue validates an append body and calls fn with each
+// message it flattens to: the top-level elements of an array, or the whole
+// value otherwise, without surrounding whitespace. The slices passed to fn
+// alias data. It returns the number of messages.
+//
+// Values are reported as they are scanned, so on error the caller must
+// discard whatever fn was given. An empty array is ErrEmptyJSONArray unless
+// allowEmpty is set.
+func forEachJSONAppendValue(data []byte, allowEmpty bool, fn func(value []byte)) (int, error) {
+	start := skipJSONSpace(data, 0)
+	if start == len(data) || data[start] != '[' {
+		end, err := scanJSONValue(data, start, 0)
+		if err != nil {
+			return 0, err
+		}
+		if skipJSONSpace(data, end) != len(data) {
+			return 0, ErrInvalidJSON
+		}
+		fn(data[start:end])
+		return 1, nil
+	}
+
+	// Top-level array: report each element as soon as it has been scanned
+	count := 0
+	i := skipJSONSpace(data, start+1)
+	if i < len(data) && data[i] == ']' {
+		i++
+	} else {
+		for {
+			end, err := scanJSONValue(data, i, 1)
+			if err != nil {
+				return 0, err
+			}
+			fn(data[i:end])
+			count++
+
+			i = skipJSONSpace(data, end)
+			if i >= len(data) {
+				return 0, ErrInvalidJSON
+			}
+			if data[i] == ']' {
+				i++
+				break
+			}
+			if data[i] != ',' {
+				return 0, ErrInvalidJSON
+			}
+			i = skipJSONSpace(data, i+1)
+		}
+	}
+	if skipJSONSpace(data, i) != len(data) {
+		return 0, ErrInvalidJSON
+	}
+
+	if count == 0 && !allowEmpty {
+		return 0, ErrEmptyJSONArray
+	}
+	return count, nil
+}
+
+// appendJSONFrames validates an append body and appends one length-prefixed
+// segment frame per message to dst, in the format WriteMessage produces.
+func appendJSONFrames(dst, data []byte, allowEmpty bool) ([]byte, int, error) {
+	tooLarge := false
+	count, err := forEachJSONAppendValue(data, allowEmpty, func(value []byte) {
+		if len(value) > MaxMessageSize {
+			tooLarge = true
+			return
+		}
+		dst = binary.BigEndian.AppendUint32(dst, uint32(len(value)))
+		dst = append(dst, value...)
+	})
+	if err != nil {
+		return dst, 0, err
+	}
+	if tooLarge {
+		return dst, 0, ErrMessageTooLarge
+	}
+	return dst, count, nil
+}
+
+// skipJSONSpace returns the index of the first non-whitespace byte at or
+// after i
+func skipJSONSpace(data []byte, i int) int {
+	for i < len(data) {
+		switch data[i] {
+		case ' ', '\t', '\n', '\r':
+			i++
+		default:
+			return i
+		}
+	}
+	return i
+}
+
+// scanJSONValue validates the value starting at data[i] and returns the index
+// just past it. depth is the number of enclosing arrays and objects.
+func scanJSONValue(data []byte, i, depth int) (int, error) {
+	if i >= len(data) {
+		return 0, ErrInvalidJSON
+	}
+	switch c := data[i]; {
+	case c == '{':
+		return scanJSONObject(data, i, depth+1)
+	case c == '[':
+		return scanJSONArray(data, i, depth+1)
+	case c == '"':
+		return scanJSONString(data, i)
+	case c == '-' || c >= '0' && c <= '9':
+		return scanJSONNumber(data, i)
+	case c == 't':
+		return scanJSONLiteral(data, i, "true")
+	case c == 'f':
+		return scanJSONLiteral(data, i, "false")
+	case c == 'n':
+		return scanJSONLiteral(data, i, "null")
+	}
+	return 0, ErrInvalidJSON
+}
+
+func scanJSONArray(data []byte, i, depth int) (int, error) {
+	if depth > maxJSONNestingDepth {
+		return 0, ErrInvalidJSON
+	}
+	i = skipJSONSpace(data, i+1)
+	if i < len(data) && data[i] == ']' {
+		return i + 1, nil
+	}
+	for {
+		end, err := scanJSONValue(data, i, depth)
+		if err != nil {
+			return 0, err
+		}
+		i = skipJSONSpace(data, end)
+		if i >= len(data) {
+			return 0, ErrInvalidJSON
+		}
+		switch data[i] {
+		case ',':
+			i = skipJSONSpace(data, i+1)
+		case ']':
+			return i + 1, nil
+		default:
+			return 0, ErrInvalidJSON
+		}
+	}
+}
+
+func scanJSONObject(data []byte, i, depth int) (int, error) {
+	if depth > maxJSONNestingDepth {
+		return 0, ErrInvalidJSON
+	}
+	i = skipJSONSpace(data, i+1)
+	if i < len(data) && data[i] == '}' {
+		return i + 1, nil
+	}
+	for {
+		if i >= len(data) || data[i] != '"' {
+			return 0, ErrInvalidJSON
+		}
+		end, err := scanJSONString(data, i)
+		if err != nil {
+			return 0, err
+		}
+		i = skipJSONSpace(data, end)
+		if i >= len(data) || data[i] != ':' {
+			return 0, ErrInvalidJSON
+		}
+		end, err = scanJSONValue(data, skipJSONSpace(data, i+1), depth)
+		if err != nil {
+			return 0, err
+		}
+		i = skipJSONSpace(data, end)
+		if i >= len(data) {
+			return 0, ErrInvalidJSON
+		}
+		switch data[i] {
+		case ',':
+			i = skipJSONSpace(data, i+1)
+		case '}':
+			return i + 1, nil
+		default:
+			return 0, ErrInvalidJSON
+		}
+	}
+}
+
+func scanJSONString(data []byte, i int) (int, error) {
+	i++ // Opening quote
+	for i < len(data) {
+		c := data[i]
+		switch {
+		case c == '"':
+			return i + 1, nil
+		case c == '\\':
+			if i+1 >= len(data) {
+				return 0, ErrInvalidJSON
+			}
+			switch data[i+1] {
+			case '"', '\\', '/', 'b', 'f', 'n', 'r', 't':
+				i += 2
+			case 'u':
+				if i+6 > len(data) {
+					return 0, ErrInvalidJSON
+				}
+				for _, h := range data[i+2 : i+6] {
+					if !isHexDigit(h) {
+						return 0, ErrInvalidJSON
+					}
+				}
+				i += 6
+			default:
+				return 0, ErrInvalidJSON
+			}
+		case c < 0x20:
+			// Control characters must be escaped
+			return 0, ErrInvalidJSON
+		default:
+			i++
+		}
+	}
+	return 0, ErrInvalidJSON
+}
+
+func scanJSONNumber(data []byte, i int) (int, error) {
+	if data[i] == '-' {
+		i++
+	}
+
+	// Integer part: 0 or a non-zero digit followed by digits
+	switch {
+	case i < len(data) && data[i] == '0':
+		i++
+	case i < len(data) && data[i] >= '1' && data[i] <= '9':
+		i = skipDigits(data, i+1)
+	default:
+		return 0, ErrInvalidJSON
+	}
+
+	// Fraction
+	if i < len(data) && data[i] == '.' {
+		j := skipDigits(data, i+1)
+		if j == i+1 {
+			return 0, ErrInvalidJSON
+		}
+		i = j
+	}
+
+	// Exponent
+	if i < len(data) && (data[i] == 'e' || data[i] == 'E') {
+		i++
+		if i < len(data) && (data[i] == '+' || data[i] == '-') {
+			i++
+		}
+		j := skipDigits(data, i)
+		if j == i {
+			return 0, ErrInvalidJSON
+		}
+		i = j
+	}
+	return i, nil
+}
+
+func scanJSONLiteral(data []byte, i int, literal string) (int, error) {
+	end := i + len(literal)
+	if end > len(data) || string(data[i:end]) != literal {
+		return 0, ErrInvalidJSON
+	}
+	return end, nil
+}
+
+func skipDigits(data []byte, i int) int {
+	for i < len(data) && data[i] >= '0' && data[i] <= '9' {
+		i++
+	}
+	return i
+}
+
+func isHexDigit(c byte) bool {
+	return c >= '0' && c <= '9' || c >= 'a' && c <= 'f' || c >= 'A' && c <= 'F'
+}
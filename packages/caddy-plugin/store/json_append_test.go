@@ -0,0 +1,126 @@
+package store
+
+import (
+	"bytes"
+	"encoding/json"
+	"errors"
+	"strings"
+	"testing"
+)
+
+// referenceJSONAppend is the two-pass encoding/json flattening the scanner
+// replaces
+func referenceJSONAppend(data []byte, allowEmpty bool) ([][]byte, error) {
+	if !json.Valid(data) {
+		return nil, ErrInvalidJSON
+	}
+	trimmed := bytes.TrimSpace(data)
+	if trimmed[0] != '[' {
+		return [][]byte{trimmed}, nil
+	}
+	var arr []json.RawMessage
+	if err := json.Unmarshal(trimmed, &arr); err != nil {
+		return nil, err
+	}
+	if len(arr) == 0 && !allowEmpty {
+		return nil, ErrEmptyJSONArray
+	}
+	result := make([][]byte, len(arr))
+	for i, elem := range arr {
+		result[i] = elem
+	}
+	return result, nil
+}
+
+// processJSONAppend collects the messages an append body flattens to
+func processJSONAppend(data []byte, allowEmpty bool) ([][]byte, error) {
+	owned := append([]byte(nil), data...)
+	messages := [][]byte{}
+	if _, err := forEachJSONAppendValue(owned, allowEmpty, func(value []byte) {
+		messages = append(messages, value[:len(value):len(value)])
+	}); err != nil {
+		return nil, err
+	}
+	return messages, nil
+}
+
+func TestProcessJSONAppend_MatchesEncodingJSON(t *testing.T) {
+	inputs := []string{
+		`{"a":1}`,
+		`  "x"  `,
+		`[1, 2 ,3]`,
+		"[\n  {\"a\": [1, {\"b\": null}]},\n  \"s\\\"q\\u00e9\",\n  -0.5e+10\n]\n",
+		`[]`,
+		`[ ]`,
+		`[[]]`,
+		`true`, `false`, `null`, `0`, `-0`, `1.25`, `1E5`, `12e-3`,
+		`"😀"`,
+		"\"caf\xc3\xa9\"",
+		`{"nested":{"deep":[[[{"k":"v"}]]]}}`,
+
+		// Invalid
+		``, ` `, `[`, `]`, `[1,]`, `[,1]`, `[1 2]`, `{"a"}`, `{"a":}`, `{a:1}`,
+		`{"a":1,}`, `01`, `-`, `1.`, `.5`, `1e`, `+1`, `tru`, `truex`, `nul`,
+		`"abc`, `"\x"`, `"\u12g4"`, "\"tab\there\"", `"a" "b"`, `[1]]`, `[1] x`,
+		`{"a":1} {}`, `NaN`, `'x'`,
+	}
+
+	for _, input := range inputs {
+		for _, allowEmpty := range []bool{false, true} {
+			want, wantErr := referenceJSONAppend([]byte(input), allowEmpty)
+			got, err := processJSONAppend([]byte(input), allowEmpty)
+
+			if (wantErr != nil) != (err != nil) {
+				t.Errorf("%q (allowEmpty=%v): error %v, want %v", input, allowEmpty, err, wantErr)
+				continue
+			}
+			if errors.Is(wantErr, ErrEmptyJSONArray) && !errors.Is(err, ErrEmptyJSONArray) {
+				t.Errorf("%q: expected ErrEmptyJSONArray, got %v", input, err)
+			}
+			if len(got) != len(want) {
+				t.Errorf("%q: got %d messages, want %d", input, len(got), len(want))
+				continue
+			}
+			for i := range want {
+				if !bytes.Equal(got[i], want[i]) {
+					t.Errorf("%q: message %d = %q, want %q", input, i, got[i], want[i])
+				}
+			}
+		}
+	}
+}
+
+func TestProcessJSONAppend_RejectsExcessiveNesting(t *testing.T) {
+	deep := strings.Repeat("[", maxJSONNestingDepth+1) + strings.Repeat("]", maxJSONNestingDepth+1)
+	if _, err := processJSONAppend([]byte(deep), true); !errors.Is(err, ErrInvalidJSON) {
+		t.Errorf("expected ErrInvalidJSON for nesting beyond the limit, got %v", err)
+	}
+
+	ok := strings.Repeat("[", maxJSONNestingDepth) + strings.Repeat("]", maxJSONNestingDepth)
+	if _, err := processJSONAppend([]byte(ok), true); err != nil {
+		t.Errorf("expected nesting at the limit to be accepted, got %v", err)
+	}
+}
+
+func TestAppendJSONFrames_MatchesWriteMessage(t *testing.T) {
+	data := []byte(`[{"id":1}, "two", [3]]`)
+
+	var want bytes.Buffer
+	for _, msg := range [][]byte{[]byte(`{"id":1}`), []byte(`"two"`), []byte(`[3]`)} {
+		if _, err := WriteMessage(&want, msg); err != nil {
+			t.Fatalf("WriteMessage failed: %v", err)
+		}
+	}
+
+	prefix := []byte("keep")
+	frames, count, err := appendJSONFrames(prefix, data, false)
+	if err != nil {
+		t.Fatalf("appendJSONFrames failed: %v", err)
+	}
+	if count != 3 {
+		t.Errorf("expected 3 frames, got %d", count)
+	}
+	if !bytes.HasPrefix(frames, prefix) || !bytes.Equal(frames[len(prefix):], want.Bytes()) {
+		t.Errorf("frames = %q, want %q after the prefix", frames, want.Bytes())
+	}
+}
@@ -0,0 +1,190 @@
+package store
+
+import (
+	"hash/maphash"
+	"sync"
+	"sync/atomic"
+)
+
+// longPollShards is the number of independently locked waiter shards
+const longPollShards = 64
+
+// StreamWatcher is implemented by stores that can wake one reader for
+// appends to, and closure of, any of several streams.
+type StreamWatcher interface {
+	// Watch calls fn with a stream's path each time one of paths advances or
+	// is closed, until stop is called. fn must not block. As with
+	// WaitForMessages, watching before reading means no append is missed.
+	Watch(paths []string, fn func(path string)) (stop func())
+}
+
+// longPollManager wakes long-poll readers when a stream advances or closes.
+//
+// Streams are spread over shards by path hash, so appends and waiters on
+// different streams rarely share a lock. Each stream with waiters has one
+// broadcast channel for the current generation: a notify closes it and starts
+// the next generation, which wakes every waiter at once regardless of their
+// number. Registering and unregistering only adjust a waiter count.
+//
+// Watches serve readers following many streams at once: a watch is a
+// callback run on every notify of any of its streams, so one reader needs no
+// goroutine or channel per stream. Watches of every stream (watchAll) are
+// kept in a copy-on-write list, so notify reads them without a lock.
+type longPollManager struct {
+	seed   maphash.Seed
+	shards [longPollShards]longPollShard
+
+	allMu sync.Mutex // serializes changes to all
+	all   atomic.Pointer[[]*streamWatch]
+}
+
+type longPollShard struct {
+	mu      sync.Mutex
+	streams map[string]*longPollStream
+}
+
+// longPollStream is the wait state of one stream with waiters
+type longPollStream struct {
+	ready   chan struct{} // Closed when the stream advances past this generation
+	waiters int
+	watches map[*streamWatch]struct{}
+}
+
+// streamWatch is one watcher of a set of streams
+type streamWatch struct {
+	fn func(path string)
+}
+
+func newLongPollManager() *longPollManager {
+	m := &longPollManager{seed: maphash.MakeSeed()}
+	for i := range m.shards {
+		m.shards[i].streams = make(map[string]*longPollStream)
+	}
+	return m
+}
+
+func (m *longPollManager) shard(path string) *longPollShard {
+	return &m.shards[maphash.String(m.seed, path)%longPollShards]
+}
+
+// register adds a waiter on path and returns a channel closed by the next
+// notify. Registering before checking for data means an append landing in
+// between is not missed. Every register must be paired with unregister.
+func (m *longPollManager) register(path string) <-chan struct{} {
+	sh := m.shard(path)
+	sh.mu.Lock()
+	defer sh.mu.Unlock()
+
+	st := sh.streams[path]
+	if st == nil {
+		st = &longPollStream{ready: make(chan struct{})}
+		sh.streams[path] = st
+	}
+	st.waiters++
+	return st.ready
+}
+
+// unregister removes a waiter added by register
+func (m *longPollManager) unregister(path string) {
+	sh := m.shard(path)
+	sh.mu.Lock()
+	defer sh.mu.Unlock()
+
+	st := sh.streams[path]
+	if st == nil {
+		return
+	}
+	st.waiters--
+	if st.waiters <= 0 && len(st.watches) == 0 {
+		delete(sh.streams, path)
+	}
+}
+
+// watch calls fn with the path on every notify of one of paths, until the
+// returned stop is called. fn runs under a shard lock, so it must not block
+// or call back into the manager.
+func (m *longPollManager) watch(paths []string, fn func(path string)) (stop func()) {
+	w := &streamWatch{fn: fn}
+	for _, path := range paths {
+		sh := m.shard(path)
+		sh.mu.Lock()
+		st := sh.streams[path]
+		if st == nil {
+			st = &longPollStream{ready: make(chan struct{})}
+			sh.streams[path] = st
+		}
+		if st.watches == nil {
+			st.watches = make(map[*streamWatch]struct{})
+		}
+		st.watches[w] = struct{}{}
+		sh.mu.Unlock()
+	}
+
+	return func() {
+		for _, path := range paths {
+			sh := m.shard(path)
+			sh.mu.Lock()
+			if st := sh.streams[path]; st != nil {
+				delete(st.watches, w)
+				if st.waiters <= 0 && len(st.watches) == 0 {
+					delete(sh.streams, path)
+				}
+			}
+			sh.mu.Unlock()
+		}
+	}
+}
+
+// watchAll calls fn with the path on every notify of any stream, until the
+// returned stop is called. fn must not block or call back into the manager.
+func (m *longPollManager) watchAll(fn func(path string)) (stop func()) {
+	w := &streamWatch{fn: fn}
+	m.allMu.Lock()
+	var watches []*streamWatch
+	if all := m.all.Load(); all != nil {
+		watches = append(watches, *all...)
+	}
+	watches = append(watches, w)
+	m.all.Store(&watches)
+	m.allMu.Unlock()
+
+	return func() {
+		m.allMu.Lock()
+		defer m.allMu.Unlock()
+		var watches []*streamWatch
+		for _, other := range *m.all.Load() {
+			if other != w {
+				watches = append(watches, other)
+			}
+		}
+		m.all.Store(&watches)
+	}
+}
+
+// notify wakes all current waiters on path
+func (m *longPollManager) notify(path string) {
+	sh := m.shard(path)
+	sh.mu.Lock()
+	if st := sh.streams[path]; st != nil {
+		if st.waiters > 0 {
+			close(st.ready)
+			st.ready = make(chan struct{})
+		}
+		for w := range st.watches {
+			w.fn(path)
+		}
+	}
+	sh.mu.Unlock()
+
+	if all := m.all.Load(); all != nil {
+		for _, w := range *all {
+			w.fn(path)
+		}
+	}
+}
+
+// notifyClosed notifies all waiters for a path that the stream has been closed
+// This is the same as notify - waiters will wake up and check stream state
+func (m *longPollManager) notifyClosed(path string) {
+	m.notify(path)
+}
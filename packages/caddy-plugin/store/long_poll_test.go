@@ -0,0 +1,106 @@
+package store
+
+import (
+	"strings"
+	"sync"
+	"testing"
+	"time"
+)
+
+func TestLongPollManager_NotifyWakesAllWaiters(t *testing.T) {
+	m := newLongPollManager()
+
+	const waiters = 100
+	var wg sync.WaitGroup
+	registered := make(chan struct{}, waiters)
+	for i := 0; i < waiters; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			ready := m.register("/s")
+			defer m.unregister("/s")
+			registered <- struct{}{}
+			select {
+			case <-ready:
+			case <-time.After(5 * time.Second):
+				t.Error("waiter was not woken")
+			}
+		}()
+	}
+	for i := 0; i < waiters; i++ {
+		<-registered
+	}
+
+	m.notify("/other")
+	m.notify("/s")
+	wg.Wait()
+
+	if n := len(m.shard("/s").streams); n != 0 {
+		t.Errorf("expected unregistered streams to be dropped, %d left", n)
+	}
+}
+
+func TestLongPollManager_NotifyBeforeWaitIsNotLost(t *testing.T) {
+	m := newLongPollManager()
+
+	ready := m.register("/s")
+	defer m.unregister("/s")
+	m.notify("/s") // Lands between the data check and the wait
+
+	select {
+	case <-ready:
+	default:
+		t.Fatal("notification after register was lost")
+	}
+
+	// Later waiters wait for the next generation
+	next := m.register("/s")
+	defer m.unregister("/s")
+	select {
+	case <-next:
+		t.Fatal("new waiter woken by an earlier notification")
+	default:
+	}
+}
+
+func TestLongPollManager_WatchSeesEveryStream(t *testing.T) {
+	m := newLongPollManager()
+
+	var mu sync.Mutex
+	var seen []string
+	stop := m.watch([]string{"/a", "/b"}, func(path string) {
+		mu.Lock()
+		seen = append(seen, path)
+		mu.Unlock()
+	})
+
+	m.notify("/b")
+	m.notify("/other")
+	m.notify("/a")
+
+	// Waiters and watches on the same stream are independent
+	ready := m.register("/a")
+	m.notify("/a")
+	select {
+	case <-ready:
+	default:
+		t.Fatal("waiter not woken alongside a watch")
+	}
+	m.unregister("/a")
+
+	mu.Lock()
+	got := strings.Join(seen, ",")
+	mu.Unlock()
+	if got != "/b,/a,/a" {
+		t.Errorf("watch saw %q, want /b,/a,/a", got)
+	}
+
+	stop()
+	m.notify("/a")
+	if n := len(seen); n != 3 {
+		t.Errorf("watch called after stop (%d calls)", n)
+	}
+	if n := len(m.shard("/a").streams) + len(m.shard("/b").streams); n != 0 {
+		t.Errorf("expected stopped watches to be dropped, %d streams left", n)
+	}
+}
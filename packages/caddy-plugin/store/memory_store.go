@@ -3,7 +3,7 @@ package store
 import (
 	"bytes"
 	"context"
-	"encoding/json"
+	"math"
 	"strings"
 	"sync"
 	"time"
@@ -15,6 +15,10 @@ type MemoryStore struct {
 	streams  map[string]*memoryStream
 	longPoll *longPollManager
 
+	// Expired streams are reclaimed in small batches as new ones are
+	// created (guarded by mu)
+	expiry expiryIndex
+
 	// Per-producer locks for serializing validation+append
 	// Key: "{streamPath}:{producerId}"
 	producerLocks   map[string]*sync.Mutex
@@ -23,22 +27,14 @@ type MemoryStore struct {
 
 type memoryStream struct {
 	metadata StreamMetadata
-	messages []Message
-	data     []byte // Raw accumulated data for non-JSON streams
-}
-
-type longPollManager struct {
-	mu      sync.Mutex
-	waiters map[string][]chan struct{}
+	messages *messageLog
 }
 
 // NewMemoryStore creates a new in-memory store
 func NewMemoryStore() *MemoryStore {
 	return &MemoryStore{
-		streams: make(map[string]*memoryStream),
-		longPoll: &longPollManager{
-			waiters: make(map[string][]chan struct{}),
-		},
+		streams:       make(map[string]*memoryStream),
+		longPoll:      newLongPollManager(),
 		producerLocks: make(map[string]*sync.Mutex),
 	}
 }
@@ -154,6 +150,8 @@ func (s *MemoryStore) Create(path string, opts CreateOptions) (*StreamMetadata,
 	s.mu.Lock()
 	defer s.mu.Unlock()
 
+	s.expireDueLocked()
+
 	// Check if stream already exists
 	if existing, ok := s.streams[path]; ok {
 		if existing.metadata.IsExpired() {
@@ -279,19 +277,12 @@ func (s *MemoryStore) Create(path string, opts CreateOptions) (*StreamMetadata,
 
 	stream := &memoryStream{
 		metadata: meta,
-		messages: make([]Message, 0),
-		data:     make([]byte, 0),
+		messages: newMessageLog(meta.CurrentOffset),
 	}
 
 	// Materialize binary sub-offset prefix as the fork's first own message.
 	if isFork && len(binarySubOffsetPrefix) > 0 {
-		newOffset := stream.metadata.CurrentOffset.Add(uint64(len(binarySubOffsetPrefix)))
-		stream.messages = append(stream.messages, Message{
-			Data:   binarySubOffsetPrefix,
-			Offset: newOffset,
-		})
-		stream.data = append(stream.data, binarySubOffsetPrefix...)
-		stream.metadata.CurrentOffset = newOffset
+		stream.metadata.CurrentOffset = stream.messages.append(binarySubOffsetPrefix)
 	}
 
 	// Handle initial data
@@ -310,6 +301,7 @@ func (s *MemoryStore) Create(path string, opts CreateOptions) (*StreamMetadata,
 	}
 
 	s.streams[path] = stream
+	s.expiry.schedule(path, stream, &stream.metadata)
 	return &stream.metadata, true, nil // true = newly created
 }
 
@@ -403,6 +395,27 @@ func (s *MemoryStore) Delete(path string) error {
 	return s.deleteWithCascade(path)
 }
 
+// expireDueLocked reclaims one batch of streams whose expiry has come due,
+// rescheduling those whose TTL window moved since. Expired streams with
+// forks are soft-deleted. Caller must hold s.mu.
+func (s *MemoryStore) expireDueLocked() {
+	for _, item := range s.expiry.popDue(time.Now(), expiryBatchSize) {
+		stream, ok := s.streams[item.path]
+		if !ok || stream != item.stream || stream.metadata.SoftDeleted {
+			continue
+		}
+		if !stream.metadata.IsExpired() {
+			s.expiry.schedule(item.path, stream, &stream.metadata)
+			continue
+		}
+		if stream.metadata.RefCount > 0 {
+			stream.metadata.SoftDeleted = true
+			continue
+		}
+		s.deleteWithCascade(item.path)
+	}
+}
+
 // deleteWithCascade fully deletes a stream and cascades to soft-deleted parents
 // whose refcount drops to zero. Caller must hold s.mu.
 func (s *MemoryStore) deleteWithCascade(path string) error {
@@ -706,54 +719,54 @@ func (s *MemoryStore) appendToStream(stream *memoryStream, data []byte, opts App
 	isJSON := isJSONContentType(stream.metadata.ContentType)
 
 	if isJSON {
-		// JSON mode: parse and potentially flatten arrays
-		messages, err := processJSONAppend(data, allowEmpty)
-		if err != nil {
-			return Offset{}, err
-		}
-
+		// JSON mode: flatten arrays, copying each value straight into the
+		// arena. Values are reported while the body is still being
+		// validated, so a failed append is rolled back.
+		mark := stream.messages.mark()
 		currentOffset := stream.metadata.CurrentOffset
-		for _, msgData := range messages {
-			currentOffset = currentOffset.Add(uint64(len(msgData)))
-			stream.messages = append(stream.messages, Message{
-				Data:   msgData,
-				Offset: currentOffset,
-			})
+		if _, err := forEachJSONAppendValue(data, allowEmpty, func(value []byte) {
+			currentOffset = stream.messages.append(value)
+		}); err != nil {
+			stream.messages.rollback(mark)
+			return Offset{}, err
 		}
 		return currentOffset, nil
 	}
 
 	// Non-JSON mode: store raw bytes
-	newOffset := stream.metadata.CurrentOffset.Add(uint64(len(data)))
-	stream.messages = append(stream.messages, Message{
-		Data:   data,
-		Offset: newOffset,
-	})
-	stream.data = append(stream.data, data...)
-	return newOffset, nil
+	return stream.messages.append(data), nil
 }
 
-// readOwnMessages reads messages from a single stream's own messages slice,
+// readOwnMessages reads messages from a single stream's own message log,
 // returning those with offset > the given offset. It does NOT follow fork chains.
 // If capAtOffset is non-nil, messages at or beyond that offset are excluded.
-func readOwnMessages(stream *memoryStream, offset Offset, capAtOffset *Offset) []Message {
+// Messages are ordered by offset, so the start is found by binary search. The
+// returned payloads alias the log's arena.
+func readOwnMessages(stream *memoryStream, offset Offset, capAtOffset *Offset, budget *readBudget) []Message {
 	var messages []Message
-	for _, msg := range stream.messages {
-		if msg.Offset.ByteOffset > offset.ByteOffset {
-			if capAtOffset != nil && !msg.Offset.LessThanOrEqual(*capAtOffset) {
-				break
-			}
-			messages = append(messages, msg)
+	stream.messages.forEach(stream.messages.search(offset.ByteOffset), func(msg Message) bool {
+		if capAtOffset != nil && !msg.Offset.LessThanOrEqual(*capAtOffset) {
+			return false
 		}
-	}
+		if !budget.admit(len(msg.Data)) {
+			return false
+		}
+		messages = append(messages, msg)
+		return true
+	})
 	return messages
 }
 
 // resolveForkSubOffset walks the source stream from forkOffset and resolves a
 // non-zero sub-offset. See FileStore.resolveForkSubOffset for semantics.
 func (s *MemoryStore) resolveForkSubOffset(sourceStream *memoryStream, forkOffset Offset, subOffset uint64) (Offset, []byte, error) {
-	// Read the source from forkOffset onward (across its fork chain if any)
-	sourceMessages := s.readForkedStream(sourceStream, forkOffset)
+	// Read the source from forkOffset onward (across its fork chain if any),
+	// only as far as the resolution needs
+	limits := ReadLimits{MaxMessages: 1}
+	if isJSONContentType(sourceStream.metadata.ContentType) {
+		limits.MaxMessages = int(min(subOffset, math.MaxInt))
+	}
+	sourceMessages := s.readForkedStream(sourceStream, forkOffset, newReadBudget(limits))
 
 	if isJSONContentType(sourceStream.metadata.ContentType) {
 		if uint64(len(sourceMessages)) < subOffset {
@@ -779,31 +792,46 @@ func (s *MemoryStore) resolveForkSubOffset(sourceStream *memoryStream, forkOffse
 // to readOwnMessages. For forks, it reads inherited messages from the source chain
 // (capped at ForkOffset) and then the fork's own messages, concatenating the results.
 // This method does NOT check SoftDeleted — forks must read through soft-deleted sources.
-func (s *MemoryStore) readForkedStream(stream *memoryStream, offset Offset) []Message {
+// budget is shared across the whole chain (nil = unlimited).
+func (s *MemoryStore) readForkedStream(stream *memoryStream, offset Offset, budget *readBudget) []Message {
+	return s.readForkedRange(stream, offset, nil, budget)
+}
+
+// readForkedRange is readForkedStream capped at capAtOffset (nil = the
+// stream's tail). Each source is read only up to the fork point below it, so
+// appends made after a fork was created are neither read nor counted against
+// the budget.
+func (s *MemoryStore) readForkedRange(stream *memoryStream, offset Offset, capAtOffset *Offset, budget *readBudget) []Message {
 	if stream.metadata.ForkedFrom == "" {
-		// Not a fork: just read own messages, no cap
-		return readOwnMessages(stream, offset, nil)
+		return readOwnMessages(stream, offset, capAtOffset, budget)
 	}
 
 	var inherited []Message
 
 	// Only read from source if the requested offset is before the fork point
-	if offset.LessThan(stream.metadata.ForkOffset) {
+	forkOffset := stream.metadata.ForkOffset
+	if offset.LessThan(forkOffset) {
 		sourceStream, ok := s.streams[stream.metadata.ForkedFrom]
 		if ok {
+			// Source appends after fork creation are not visible
+			sourceCap := &forkOffset
+			if capAtOffset != nil && capAtOffset.LessThan(forkOffset) {
+				sourceCap = capAtOffset
+			}
 			// Recursively read from source (source may itself be a fork)
-			sourceMessages := s.readForkedStream(sourceStream, offset)
-			// Cap at ForkOffset — source appends after fork creation are not visible
-			for _, msg := range sourceMessages {
-				if msg.Offset.LessThanOrEqual(stream.metadata.ForkOffset) {
-					inherited = append(inherited, msg)
-				}
+			inherited = s.readForkedRange(sourceStream, offset, sourceCap, budget)
+			// Budget ran out before the fork point: end the chunk here so the
+			// fork's own messages never follow a gap.
+			reachedFork := len(inherited) > 0 && !inherited[len(inherited)-1].Offset.LessThan(forkOffset)
+			if budget.exhausted() && !reachedFork {
+				return inherited
 			}
 		}
+		offset = forkOffset
 	}
 
 	// Read fork's own messages (offset >= ForkOffset)
-	ownMessages := readOwnMessages(stream, offset, nil)
+	ownMessages := readOwnMessages(stream, offset, capAtOffset, budget)
 
 	if len(inherited) == 0 {
 		return ownMessages
@@ -815,6 +843,11 @@ func (s *MemoryStore) readForkedStream(stream *memoryStream, offset Offset) []Me
 }
 
 func (s *MemoryStore) Read(path string, offset Offset) ([]Message, bool, error) {
+	return s.ReadWithLimits(path, offset, ReadLimits{})
+}
+
+// ReadWithLimits reads messages from a stream, stopping once the chunk reaches limits
+func (s *MemoryStore) ReadWithLimits(path string, offset Offset, limits ReadLimits) ([]Message, bool, error) {
 	s.mu.Lock()
 
 	stream, ok := s.streams[path]
@@ -843,7 +876,7 @@ func (s *MemoryStore) Read(path string, offset Offset) ([]Message, bool, error)
 	stream.metadata.LastAccessedAt = time.Now()
 
 	// Read messages across fork chain
-	messages := s.readForkedStream(stream, offset)
+	messages := s.readForkedStream(stream, offset, newReadBudget(limits))
 
 	// upToDate is true when client has reached the tail of the fork's own data
 	// (its CurrentOffset). For forks, this means we've read all inherited data
@@ -861,7 +894,17 @@ func (s *MemoryStore) Read(path string, offset Offset) ([]Message, bool, error)
 	return messages, upToDate, nil
 }
 
-func (s *MemoryStore) WaitForMessages(ctx context.Context, path string, offset Offset, timeout time.Duration) ([]Message, bool, bool, error) {
+// Watch implements StreamWatcher
+func (s *MemoryStore) Watch(paths []string, fn func(path string)) (stop func()) {
+	return s.longPoll.watch(paths, fn)
+}
+
+func (s *MemoryStore) WaitForMessages(ctx context.Context, path string, offset Offset, timeout time.Duration, limits ReadLimits) ([]Message, bool, bool, error) {
+	// Register before checking for data, so an append landing after the
+	// check still wakes this waiter
+	ready := s.longPoll.register(path)
+	defer s.longPoll.unregister(path)
+
 	// First check if stream is closed and client is at tail
 	s.mu.RLock()
 	stream, ok := s.streams[path]
@@ -872,7 +915,7 @@ func (s *MemoryStore) WaitForMessages(ctx context.Context, path string, offset O
 	s.mu.RUnlock()
 
 	// First check if there are already messages
-	messages, _, err := s.Read(path, offset)
+	messages, _, err := s.ReadWithLimits(path, offset, limits)
 	if err != nil {
 		return nil, false, false, err
 	}
@@ -896,16 +939,12 @@ func (s *MemoryStore) WaitForMessages(ctx context.Context, path string, offset O
 	}
 	s.mu.RUnlock()
 
-	// No messages, set up wait
-	ch := make(chan struct{}, 1)
-	s.longPoll.register(path, ch)
-	defer s.longPoll.unregister(path, ch)
-
+	// No messages, wait for the stream to advance
 	timer := time.NewTimer(timeout)
 	defer timer.Stop()
 
 	select {
-	case <-ch:
+	case <-ready:
 		// New data or closure available - check which
 		s.mu.RLock()
 		stream, ok := s.streams[path]
@@ -914,7 +953,7 @@ func (s *MemoryStore) WaitForMessages(ctx context.Context, path string, offset O
 			currentOffset := stream.metadata.CurrentOffset
 			s.mu.RUnlock()
 			// Check if there are any final messages
-			messages, _, err := s.Read(path, offset)
+			messages, _, err := s.ReadWithLimits(path, offset, limits)
 			if err != nil {
 				return nil, false, false, err
 			}
@@ -926,7 +965,7 @@ func (s *MemoryStore) WaitForMessages(ctx context.Context, path string, offset O
 		}
 		s.mu.RUnlock()
 		// New data available
-		messages, _, err := s.Read(path, offset)
+		messages, _, err := s.ReadWithLimits(path, offset, limits)
 		return messages, false, false, err
 	case <-timer.C:
 		// Timeout - check if stream was closed during wait
@@ -978,83 +1017,12 @@ func (s *MemoryStore) FormatResponse(path string, messages []Message) ([]byte, e
 }
 
 // Long-poll manager methods
-func (m *longPollManager) register(path string, ch chan struct{}) {
-	m.mu.Lock()
-	defer m.mu.Unlock()
-	m.waiters[path] = append(m.waiters[path], ch)
-}
-
-func (m *longPollManager) unregister(path string, ch chan struct{}) {
-	m.mu.Lock()
-	defer m.mu.Unlock()
-
-	waiters := m.waiters[path]
-	for i, w := range waiters {
-		if w == ch {
-			m.waiters[path] = append(waiters[:i], waiters[i+1:]...)
-			break
-		}
-	}
-}
-
-func (m *longPollManager) notify(path string) {
-	m.mu.Lock()
-	defer m.mu.Unlock()
-
-	for _, ch := range m.waiters[path] {
-		select {
-		case ch <- struct{}{}:
-		default:
-		}
-	}
-}
-
-// notifyClosed notifies all waiters for a path that the stream has been closed
-// This is the same as notify - waiters will wake up and check stream state
-func (m *longPollManager) notifyClosed(path string) {
-	m.notify(path)
-}
-
 // JSON helper functions
 func isJSONContentType(ct string) bool {
 	mediaType := strings.ToLower(extractMediaType(ct))
 	return mediaType == "application/json"
 }
 
-// processJSONAppend processes JSON data for append, flattening top-level arrays
-func processJSONAppend(data []byte, allowEmpty bool) ([][]byte, error) {
-	// Validate JSON
-	if !json.Valid(data) {
-		return nil, ErrInvalidJSON
-	}
-
-	// Check if it's an array
-	trimmed := bytes.TrimSpace(data)
-	if len(trimmed) > 0 && trimmed[0] == '[' {
-		var arr []json.RawMessage
-		if err := json.Unmarshal(trimmed, &arr); err != nil {
-			return nil, ErrInvalidJSON
-		}
-		if len(arr) == 0 {
-			// Empty arrays are allowed on PUT (create) but not on POST (append)
-			if !allowEmpty {
-				return nil, ErrEmptyJSONArray
-			}
-			// Return empty slice for empty array on create
-			return [][]byte{}, nil
-		}
-		// Flatten one level
-		result := make([][]byte, len(arr))
-		for i, elem := range arr {
-			result[i] = []byte(elem)
-		}
-		return result, nil
-	}
-
-	// Single value
-	return [][]byte{trimmed}, nil
-}
-
 // formatJSONResponse formats messages as a JSON array
 func formatJSONResponse(messages []Message) []byte {
 	if len(messages) == 0 {
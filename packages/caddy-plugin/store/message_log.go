@@ -0,0 +1,129 @@
+package store
+
+import "sort"
+
+const (
+	// minArenaChunk and maxArenaChunk bound the arena chunk sizes. Chunks
+	// start small so short streams stay cheap and double up to the maximum.
+	minArenaChunk = 4 * 1024
+	maxArenaChunk = 1024 * 1024
+)
+
+// messageLog stores the messages of a memory stream compactly: payloads are
+// packed back to back into append-only arena chunks, and each message costs
+// one end offset. A message's offset advances by exactly its payload length,
+// so its start is the previous message's end and its position in its chunk
+// follows from the chunk's starting offset.
+//
+// Chunks are never reallocated once written, so reads return sub-slices of
+// them without copying, and neither chunks nor offsets hold pointers for the
+// GC to scan.
+type messageLog struct {
+	readSeq uint64 // ReadSeq of every message offset
+	base    uint64 // ByteOffset before the first message
+
+	ends []uint64 // ByteOffset after each message
+
+	chunks     [][]byte // Arena chunks; len is the filled part
+	chunkFirst []int    // Index of the first message in each chunk
+	chunkStart []uint64 // ByteOffset at the start of each chunk
+}
+
+func newMessageLog(base Offset) *messageLog {
+	return &messageLog{readSeq: base.ReadSeq, base: base.ByteOffset}
+}
+
+// logMark records the length of a log, so a failed multi-message append
+// can be rolled back
+type logMark struct {
+	messages, chunks, fill int
+}
+
+func (l *messageLog) mark() logMark {
+	m := logMark{messages: len(l.ends), chunks: len(l.chunks)}
+	if len(l.chunks) > 0 {
+		m.fill = len(l.chunks[len(l.chunks)-1])
+	}
+	return m
+}
+
+// rollback discards everything appended since m. The discarded messages
+// must not have been read.
+func (l *messageLog) rollback(m logMark) {
+	l.ends = l.ends[:m.messages]
+	l.chunks = l.chunks[:m.chunks]
+	l.chunkFirst = l.chunkFirst[:m.chunks]
+	l.chunkStart = l.chunkStart[:m.chunks]
+	if m.chunks > 0 {
+		l.chunks[m.chunks-1] = l.chunks[m.chunks-1][:m.fill]
+	}
+}
+
+// Len returns the number of messages
+func (l *messageLog) Len() int {
+	return len(l.ends)
+}
+
+// end returns the offset after the last message
+func (l *messageLog) end() uint64 {
+	if len(l.ends) == 0 {
+		return l.base
+	}
+	return l.ends[len(l.ends)-1]
+}
+
+// append copies payload into the arena and returns the message's offset
+func (l *messageLog) append(payload []byte) Offset {
+	start := l.end()
+	last := len(l.chunks) - 1
+	if last < 0 || cap(l.chunks[last])-len(l.chunks[last]) < len(payload) {
+		size := minArenaChunk
+		if last >= 0 {
+			size = min(2*cap(l.chunks[last]), maxArenaChunk)
+		}
+		l.chunks = append(l.chunks, make([]byte, 0, max(size, len(payload))))
+		l.chunkFirst = append(l.chunkFirst, len(l.ends))
+		l.chunkStart = append(l.chunkStart, start)
+		last++
+	}
+	l.chunks[last] = append(l.chunks[last], payload...)
+
+	end := start + uint64(len(payload))
+	l.ends = append(l.ends, end)
+	return Offset{ReadSeq: l.readSeq, ByteOffset: end}
+}
+
+// search returns the index of the first message ending after offset
+func (l *messageLog) search(offset uint64) int {
+	return sort.Search(len(l.ends), func(i int) bool { return l.ends[i] > offset })
+}
+
+// messageIn returns message i, which lies in chunk c
+func (l *messageLog) messageIn(c, i int) Message {
+	start := l.chunkStart[c]
+	if i > l.chunkFirst[c] {
+		start = l.ends[i-1]
+	}
+	lo := start - l.chunkStart[c]
+	hi := l.ends[i] - l.chunkStart[c]
+	return Message{
+		Data:   l.chunks[c][lo:hi:hi],
+		Offset: Offset{ReadSeq: l.readSeq, ByteOffset: l.ends[i]},
+	}
+}
+
+// forEach calls fn with messages from index i onward until fn returns false
+func (l *messageLog) forEach(i int, fn func(Message) bool) {
+	if i >= len(l.ends) {
+		return
+	}
+	c := sort.Search(len(l.chunkFirst), func(c int) bool { return l.chunkFirst[c] > i }) - 1
+	for ; i < len(l.ends); i++ {
+		if c+1 < len(l.chunkFirst) && l.chunkFirst[c+1] == i {
+			c++
+		}
+		if !fn(l.messageIn(c, i)) {
+			return
+		}
+	}
+}
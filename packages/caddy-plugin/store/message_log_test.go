@@ -0,0 +1,100 @@
+package store
+
+import (
+	"bytes"
+	"fmt"
+	"testing"
+)
+
+func TestMessageLog_ReadsBackAcrossChunks(t *testing.T) {
+	base := Offset{ReadSeq: 2, ByteOffset: 100}
+	log := newMessageLog(base)
+
+	var payloads [][]byte
+	for i := 0; i < 600; i++ {
+		payload := []byte(fmt.Sprintf("message-%d", i))
+		if i%200 == 0 {
+			// Larger than any chunk: gets one of its own
+			payload = bytes.Repeat([]byte{byte(i)}, maxArenaChunk+1)
+		}
+		payloads = append(payloads, payload)
+		log.append(payload)
+	}
+	if len(log.chunks) < 3 {
+		t.Fatalf("expected payloads to span several chunks, got %d", len(log.chunks))
+	}
+
+	offset := base
+	for i := range payloads {
+		var got []Message
+		log.forEach(log.search(offset.ByteOffset), func(msg Message) bool {
+			got = append(got, msg)
+			return len(got) < 2
+		})
+		if !bytes.Equal(got[0].Data, payloads[i]) {
+			t.Fatalf("message %d: got %d bytes, want %d", i, len(got[0].Data), len(payloads[i]))
+		}
+		if cap(got[0].Data) != len(got[0].Data) {
+			t.Errorf("message %d: payload slice must not expose the rest of the arena", i)
+		}
+		want := offset.Add(uint64(len(payloads[i])))
+		if !got[0].Offset.Equal(want) {
+			t.Fatalf("message %d: offset %s, want %s", i, got[0].Offset, want)
+		}
+		offset = want
+	}
+}
+
+func TestMessageLog_Rollback(t *testing.T) {
+	log := newMessageLog(ZeroOffset)
+	log.append([]byte("kept"))
+
+	mark := log.mark()
+	log.append([]byte("discarded"))
+	log.append(make([]byte, minArenaChunk)) // Opens a new chunk
+	log.rollback(mark)
+
+	if log.Len() != 1 || len(log.chunks) != 1 || log.end() != 4 {
+		t.Fatalf("rollback left %d messages in %d chunks ending at %d", log.Len(), len(log.chunks), log.end())
+	}
+	log.append([]byte("next"))
+	var got []string
+	log.forEach(0, func(msg Message) bool {
+		got = append(got, string(msg.Data))
+		return true
+	})
+	if len(got) != 2 || got[0] != "kept" || got[1] != "next" {
+		t.Errorf("unexpected messages after rollback: %q", got)
+	}
+}
+
+func TestMemoryStore_FailedJSONAppendLeavesStreamUnchanged(t *testing.T) {
+	s := NewMemoryStore()
+	defer s.Close()
+
+	if _, _, err := s.Create("/s", CreateOptions{ContentType: "application/json"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	if _, err := s.Append("/s", []byte(`[1,2]`), AppendOptions{}); err != nil {
+		t.Fatalf("Append failed: %v", err)
+	}
+	// The first elements are stored before the scanner reaches the error
+	if _, err := s.Append("/s", []byte(`[3,4,}`), AppendOptions{}); err == nil {
+		t.Fatal("expected invalid JSON to be rejected")
+	}
+	if _, err := s.Append("/s", []byte(`5`), AppendOptions{}); err != nil {
+		t.Fatalf("Append failed: %v", err)
+	}
+
+	messages, _, err := s.Read("/s", ZeroOffset)
+	if err != nil {
+		t.Fatalf("Read failed: %v", err)
+	}
+	var got []string
+	for _, msg := range messages {
+		got = append(got, string(msg.Data))
+	}
+	if fmt.Sprint(got) != "[1 2 5]" {
+		t.Errorf("expected [1 2 5], got %v", got)
+	}
+}
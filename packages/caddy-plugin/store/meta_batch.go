@@ -0,0 +1,168 @@
+package store
+
+import (
+	"sync"
+	"time"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/metrics"
+)
+
+// DefaultMetadataFlushInterval is how often buffered append state is written
+// to bbolt when no append needs it sooner
+const DefaultMetadataFlushInterval = time.Second
+
+// metaBatch buffers per-stream append state (tail offset, Stream-Seq,
+// producer state, closure) and writes it to bbolt in one transaction per
+// flush instead of one per append.
+//
+// A stream's offset may lag in bbolt: the segment is the source of truth
+// and recovery repairs lagging offsets. Everything else an append records
+// is needed to reject duplicates after a restart, so appends carrying it ask
+// the group committer to flush before they are acknowledged. A flush covers
+// all buffered streams, so those appends share a single bbolt commit.
+type metaBatch struct {
+	store *BboltMetadataStore
+
+	mu    sync.Mutex
+	dirty map[string]*AppendStateUpdate // Stream path -> pending update
+
+	// flushMu serializes flushes, so an older batch never lands after a
+	// newer one
+	flushMu sync.Mutex
+
+	stop chan struct{}
+	done chan struct{}
+}
+
+// newMetaBatch returns a batch writing to store, flushed every interval
+// (<= 0 = only on demand and on close).
+func newMetaBatch(store *BboltMetadataStore, interval time.Duration) *metaBatch {
+	b := &metaBatch{
+		store: store,
+		dirty: make(map[string]*AppendStateUpdate),
+		stop:  make(chan struct{}),
+		done:  make(chan struct{}),
+	}
+	if interval > 0 {
+		go b.run(interval)
+	} else {
+		close(b.done)
+	}
+	return b
+}
+
+func (b *metaBatch) run(interval time.Duration) {
+	defer close(b.done)
+
+	ticker := time.NewTicker(interval)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-b.stop:
+			return
+		case <-ticker.C:
+			// Errors leave the updates buffered for the next flush
+			b.flush()
+		}
+	}
+}
+
+// record buffers an append's state, merged over anything already pending for
+// the stream. Caller must hold the stream's write lock.
+func (b *metaBatch) record(path, dirName string, offset Offset, lastSeq string, producerId string, producerState *ProducerState, closed bool, closedBy *ClosedByProducer) {
+	b.mu.Lock()
+	defer b.mu.Unlock()
+
+	u := b.dirty[path]
+	if u == nil || u.DirectoryName != dirName {
+		u = &AppendStateUpdate{Path: path, DirectoryName: dirName}
+		b.dirty[path] = u
+	}
+	u.Offset = offset
+	if lastSeq != "" {
+		u.LastSeq = lastSeq
+	}
+	if producerId != "" && producerState != nil {
+		if u.Producers == nil {
+			u.Producers = make(map[string]*ProducerState)
+		}
+		u.Producers[producerId] = producerState
+	}
+	if closed {
+		u.Closed = true
+		if closedBy != nil {
+			u.ClosedBy = closedBy
+		}
+	}
+}
+
+// drop discards pending state of a removed stream. Caller must hold the
+// stream's write lock.
+func (b *metaBatch) drop(path string) {
+	b.mu.Lock()
+	defer b.mu.Unlock()
+	delete(b.dirty, path)
+}
+
+// flush writes all pending updates in one transaction. On failure they are
+// kept, under anything recorded since, for the next flush.
+func (b *metaBatch) flush() error {
+	b.flushMu.Lock()
+	defer b.flushMu.Unlock()
+
+	b.mu.Lock()
+	if len(b.dirty) == 0 {
+		b.mu.Unlock()
+		return nil
+	}
+	pending := b.dirty
+	b.dirty = make(map[string]*AppendStateUpdate, len(pending))
+	b.mu.Unlock()
+
+	updates := make([]*AppendStateUpdate, 0, len(pending))
+	for _, u := range pending {
+		updates = append(updates, u)
+	}
+	start := time.Now()
+	err := b.store.ApplyAppendStates(updates)
+	metrics.Since(metrics.AppendBboltUpdate, start)
+	if err == nil {
+		return nil
+	}
+
+	b.mu.Lock()
+	defer b.mu.Unlock()
+	for path, old := range pending {
+		newer := b.dirty[path]
+		if newer == nil {
+			b.dirty[path] = old
+			continue
+		}
+		if newer.DirectoryName != old.DirectoryName {
+			continue
+		}
+		if newer.LastSeq == "" {
+			newer.LastSeq = old.LastSeq
+		}
+		for producerId, state := range old.Producers {
+			if _, ok := newer.Producers[producerId]; !ok {
+				if newer.Producers == nil {
+					newer.Producers = make(map[string]*ProducerState)
+				}
+				newer.Producers[producerId] = state
+			}
+		}
+		if old.Closed && !newer.Closed {
+			newer.Closed, newer.ClosedBy = true, old.ClosedBy
+		}
+	}
+	return err
+}
+
+// close stops the periodic flush and writes what is still pending
+func (b *metaBatch) close() error {
+	close(b.stop)
+	<-b.done
+	return b.flush()
+}
@@ -0,0 +1,106 @@
+package store
+
+import (
+	"path/filepath"
+	"testing"
+)
+
+func TestFileStore_BatchesMetadataUpdates(t *testing.T) {
+	tmpDir := t.TempDir()
+	store, err := NewFileStore(FileStoreConfig{DataDir: tmpDir, MetadataFlushInterval: -1})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+
+	if _, _, err := store.Create("/s", CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	persisted := func() *StreamMetadata {
+		t.Helper()
+		meta, _, err := store.metaStore.Get("/s")
+		if err != nil {
+			t.Fatalf("metadata Get failed: %v", err)
+		}
+		return meta
+	}
+
+	// Plain appends only buffer their offset
+	appendPayloads(t, store, "/s", 0, 3)
+	if got := persisted().CurrentOffset; !got.Equal(ZeroOffset) {
+		t.Errorf("expected bbolt offset to lag at %s, got %s", ZeroOffset, got)
+	}
+
+	// Producer state is durable once the append is acked, along with the
+	// offsets buffered before it
+	epoch, seq := int64(0), int64(0)
+	res, err := store.Append("/s", []byte("message-003"), AppendOptions{
+		ProducerId:    "p1",
+		ProducerEpoch: &epoch,
+		ProducerSeq:   &seq,
+	})
+	if err != nil {
+		t.Fatalf("producer Append failed: %v", err)
+	}
+	meta := persisted()
+	if !meta.CurrentOffset.Equal(res.Offset) {
+		t.Errorf("expected bbolt offset %s, got %s", res.Offset, meta.CurrentOffset)
+	}
+	if state := meta.Producers["p1"]; state == nil || state.LastSeq != 0 {
+		t.Errorf("expected persisted producer state, got %+v", state)
+	}
+
+	// Stream-Seq is durable too
+	res, err = store.Append("/s", []byte("message-004"), AppendOptions{Seq: "a"})
+	if err != nil {
+		t.Fatalf("Append with seq failed: %v", err)
+	}
+	if meta := persisted(); meta.LastSeq != "a" || !meta.CurrentOffset.Equal(res.Offset) {
+		t.Errorf("expected seq a at %s, got %q at %s", res.Offset, meta.LastSeq, meta.CurrentOffset)
+	}
+
+	// Close writes what is still buffered
+	more := appendPayloads(t, store, "/s", 5, 7)
+	if err := store.Close(); err != nil {
+		t.Fatalf("Close failed: %v", err)
+	}
+	metaStore, err := NewBboltMetadataStore(filepath.Join(tmpDir, "metadata"))
+	if err != nil {
+		t.Fatalf("failed to open metadata: %v", err)
+	}
+	defer metaStore.Close()
+	final, _, err := metaStore.Get("/s")
+	if err != nil {
+		t.Fatalf("metadata Get failed: %v", err)
+	}
+	if want := more[len(more)-1]; !final.CurrentOffset.Equal(want) {
+		t.Errorf("expected flushed offset %s, got %s", want, final.CurrentOffset)
+	}
+}
+
+func TestMetaBatch_SkipsRecreatedStreams(t *testing.T) {
+	metaStore, err := NewBboltMetadataStore(t.TempDir())
+	if err != nil {
+		t.Fatalf("failed to open metadata: %v", err)
+	}
+	defer metaStore.Close()
+
+	meta := &StreamMetadata{Path: "/s", ContentType: "text/plain"}
+	if err := metaStore.Put(meta, "new"); err != nil {
+		t.Fatalf("Put failed: %v", err)
+	}
+
+	// An update buffered for an earlier instance of the path is discarded
+	batch := newMetaBatch(metaStore, 0)
+	batch.record("/s", "old", Offset{ByteOffset: 99}, "", "", nil, true, nil)
+	if err := batch.close(); err != nil {
+		t.Fatalf("flush failed: %v", err)
+	}
+
+	got, _, err := metaStore.Get("/s")
+	if err != nil {
+		t.Fatalf("Get failed: %v", err)
+	}
+	if !got.CurrentOffset.Equal(ZeroOffset) || got.Closed {
+		t.Errorf("stale update applied to recreated stream: %+v", got)
+	}
+}
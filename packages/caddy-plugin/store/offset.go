@@ -10,7 +10,7 @@ import (
 // Format: "0000000000000000_0000000000000000" (16 digits each, zero-padded)
 // The format is lexicographically sortable.
 type Offset struct {
-	ReadSeq    uint64 // For future log rotation support
+	ReadSeq    uint64 // Segment the message was written to (see segment rotation)
 	ByteOffset uint64 // Bytes of actual data (not framing)
 }
 
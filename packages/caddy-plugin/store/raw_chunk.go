@@ -0,0 +1,260 @@
+package store
+
+import (
+	"errors"
+	"io"
+	"os"
+	"sync"
+)
+
+const (
+	// zeroCopyMinSize is the payload size from which RawChunk.WriteTo hands
+	// the payload to io.Copy straight from the segment file (sendfile on
+	// Linux sockets) instead of copying it through a buffer.
+	zeroCopyMinSize = 16 * 1024
+
+	// rawCopyBufferSize is the buffer used to gather smaller payloads
+	rawCopyBufferSize = 64 * 1024
+)
+
+var rawCopyBuffers = sync.Pool{
+	New: func() any {
+		buf := make([]byte, rawCopyBufferSize)
+		return &buf
+	},
+}
+
+// RawReader is implemented by stores that can return a read chunk as ranges
+// of their segment files. Non-JSON responses are the concatenated message
+// payloads and JSON responses the payloads joined into an array, so either
+// can be copied to the client without building a body in memory.
+type RawReader interface {
+	// ReadRaw reads one chunk starting at offset, like ReadWithLimits.
+	ReadRaw(path string, offset Offset, limits ReadLimits) (*RawChunk, error)
+}
+
+// RawChunk is a read chunk described by the payload ranges of its messages.
+type RawChunk struct {
+	NextOffset Offset // Offset after the last message (the start offset if empty)
+	UpToDate   bool   // Chunk reaches the tail of the stream
+	Size       int64  // Response body bytes (payloads plus any JSON framing)
+
+	frames    []streamFrame
+	messages  []Message // Set instead of frames when served from memory
+	jsonArray bool      // Write the payloads as a JSON array
+	open      func(segPath string) (io.ReaderAt, func(), error)
+}
+
+// Len returns the number of messages in the chunk
+func (c *RawChunk) Len() int {
+	if c.messages != nil {
+		return len(c.messages)
+	}
+	return len(c.frames)
+}
+
+// separator returns the bytes written before message i: the opening bracket
+// and commas of a JSON array, nothing otherwise
+func (c *RawChunk) separator(i int) []byte {
+	switch {
+	case !c.jsonArray:
+		return nil
+	case i == 0:
+		return []byte{'['}
+	default:
+		return []byte{','}
+	}
+}
+
+// setSize computes Size from the payload sizes, adding the JSON brackets
+// and commas for a JSON chunk with messages
+func (c *RawChunk) setSize(payloadBytes int64) {
+	c.Size = payloadBytes
+	if c.jsonArray && c.Len() > 0 {
+		c.Size += int64(c.Len()) + 1 // '[', commas and ']'
+	}
+}
+
+// WriteTo writes the concatenated message payloads to w, or for a JSON chunk
+// the payloads as one JSON array.
+//
+// Large payloads are copied with io.Copy from a dedicated file handle, which
+// lets net/http use sendfile when w is a response with a known
+// Content-Length. Runs of smaller payloads are gathered with one positional
+// read each and written in a single call.
+func (c *RawChunk) WriteTo(w io.Writer) (int64, error) {
+	written, err := c.writePayloads(w)
+	if err != nil || !c.jsonArray || c.Len() == 0 {
+		return written, err
+	}
+	n, err := w.Write([]byte{']'})
+	return written + int64(n), err
+}
+
+func (c *RawChunk) writePayloads(w io.Writer) (int64, error) {
+	var written int64
+
+	if c.messages != nil {
+		for i, msg := range c.messages {
+			if sep := c.separator(i); sep != nil {
+				n, err := w.Write(sep)
+				written += int64(n)
+				if err != nil {
+					return written, err
+				}
+			}
+			n, err := w.Write(msg.Data)
+			written += int64(n)
+			if err != nil {
+				return written, err
+			}
+		}
+		return written, nil
+	}
+
+	// sendfile consumes the file's own offset, so zero-copy payloads use a
+	// handle private to this call rather than the shared pooled one.
+	var direct *os.File
+	var directPath string
+	defer func() {
+		if direct != nil {
+			direct.Close()
+		}
+	}()
+
+	bufp := rawCopyBuffers.Get().(*[]byte)
+	defer rawCopyBuffers.Put(bufp)
+	buf := *bufp
+
+	for i := 0; i < len(c.frames); {
+		frame := c.frames[i]
+
+		if frame.size >= zeroCopyMinSize {
+			if direct == nil || directPath != frame.segPath {
+				if direct != nil {
+					direct.Close()
+				}
+				f, err := os.Open(frame.segPath)
+				if errors.Is(err, os.ErrNotExist) {
+					// Offloaded to the object store: copy through its reader
+					direct = nil
+					n, err := c.copyFrame(w, i)
+					written += n
+					if err != nil {
+						return written, err
+					}
+					i++
+					continue
+				}
+				if err != nil {
+					direct = nil
+					return written, err
+				}
+				direct, directPath = f, frame.segPath
+			}
+			if _, err := direct.Seek(frame.pos, io.SeekStart); err != nil {
+				return written, err
+			}
+			if sep := c.separator(i); sep != nil {
+				n, err := w.Write(sep)
+				written += int64(n)
+				if err != nil {
+					return written, err
+				}
+			}
+			n, err := io.Copy(w, io.LimitReader(direct, int64(frame.size)))
+			written += n
+			if err != nil {
+				return written, err
+			}
+			if n != int64(frame.size) {
+				return written, io.ErrUnexpectedEOF
+			}
+			i++
+			continue
+		}
+
+		// Gather the run of adjacent small frames that fits in buf: read the
+		// whole range (length prefixes included) and compact the payloads,
+		// with any JSON separators in place of the prefixes.
+		start := frame.pos - LengthPrefixSize
+		end := frame.pos + int64(frame.size)
+		j := i + 1
+		for j < len(c.frames) {
+			next := c.frames[j]
+			nextEnd := next.pos + int64(next.size)
+			if next.size >= zeroCopyMinSize || next.segPath != frame.segPath ||
+				next.pos-LengthPrefixSize != end || nextEnd-start > int64(len(buf)) {
+				break
+			}
+			end = nextEnd
+			j++
+		}
+
+		n, err := c.gather(buf, i, j, start, end)
+		if err != nil {
+			return written, err
+		}
+		m, err := w.Write(buf[:n])
+		written += int64(m)
+		if err != nil {
+			return written, err
+		}
+		i = j
+	}
+
+	return written, nil
+}
+
+// copyFrame writes frame i, after its separator, through the segment opener
+func (c *RawChunk) copyFrame(w io.Writer, i int) (int64, error) {
+	frame := c.frames[i]
+	file, release, err := c.open(frame.segPath)
+	if err != nil {
+		return 0, err
+	}
+	defer release()
+
+	var written int64
+	if sep := c.separator(i); sep != nil {
+		n, err := w.Write(sep)
+		written += int64(n)
+		if err != nil {
+			return written, err
+		}
+	}
+	n, err := io.Copy(w, io.NewSectionReader(file, frame.pos, int64(frame.size)))
+	written += n
+	if err == nil && n != int64(frame.size) {
+		err = io.ErrUnexpectedEOF
+	}
+	return written, err
+}
+
+// gather reads the segment range [start, end) holding frames i..j-1 into buf
+// and moves their payloads, each after its separator, to the front of buf.
+// A separator is never longer than the length prefix it replaces, so the
+// compaction stays behind the data it has yet to move. Returns the byte count.
+func (c *RawChunk) gather(buf []byte, i, j int, start, end int64) (int, error) {
+	frames := c.frames[i:j]
+	file, release, err := c.open(frames[0].segPath)
+	if err != nil {
+		return 0, err
+	}
+	defer release()
+
+	if _, err := file.ReadAt(buf[:end-start], start); err != nil {
+		if err == io.EOF {
+			return 0, io.ErrUnexpectedEOF
+		}
+		return 0, err
+	}
+
+	n := 0
+	for k, frame := range frames {
+		n += copy(buf[n:], c.separator(i+k))
+		lo := frame.pos - start
+		n += copy(buf[n:], buf[lo:lo+int64(frame.size)])
+	}
+	return n, nil
+}
@@ -0,0 +1,134 @@
+package store
+
+import (
+	"bytes"
+	"os"
+	"testing"
+)
+
+func TestFileStore_ReadRawMatchesRead(t *testing.T) {
+	tmpDir, err := os.MkdirTemp("", "filestore-test-*")
+	if err != nil {
+		t.Fatalf("failed to create temp dir: %v", err)
+	}
+	defer os.RemoveAll(tmpDir)
+
+	// Disable the tail cache so chunks come from the segment files
+	store, err := NewFileStore(FileStoreConfig{DataDir: tmpDir, TailCacheBytes: -1})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer store.Close()
+
+	// Mix payloads below and above the zero-copy threshold, across a fork
+	payloads := [][]byte{
+		[]byte("small-1"),
+		bytes.Repeat([]byte("L"), zeroCopyMinSize+1),
+		[]byte("small-2"),
+		[]byte("small-3"),
+	}
+	if _, _, err := store.Create("/source", CreateOptions{ContentType: "application/octet-stream"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	for _, p := range payloads[:2] {
+		if _, err := store.Append("/source", p, AppendOptions{}); err != nil {
+			t.Fatalf("Append failed: %v", err)
+		}
+	}
+	if _, _, err := store.Create("/fork", CreateOptions{ForkedFrom: "/source"}); err != nil {
+		t.Fatalf("fork Create failed: %v", err)
+	}
+	for _, p := range payloads[2:] {
+		if _, err := store.Append("/fork", p, AppendOptions{}); err != nil {
+			t.Fatalf("Append failed: %v", err)
+		}
+	}
+
+	want := bytes.Join(payloads, nil)
+
+	chunk, err := store.ReadRaw("/fork", ZeroOffset, ReadLimits{})
+	if err != nil {
+		t.Fatalf("ReadRaw failed: %v", err)
+	}
+	if chunk.Len() != len(payloads) || chunk.Size != int64(len(want)) || !chunk.UpToDate {
+		t.Fatalf("unexpected chunk: len=%d size=%d upToDate=%v", chunk.Len(), chunk.Size, chunk.UpToDate)
+	}
+
+	var buf bytes.Buffer
+	n, err := chunk.WriteTo(&buf)
+	if err != nil {
+		t.Fatalf("WriteTo failed: %v", err)
+	}
+	if n != chunk.Size || !bytes.Equal(buf.Bytes(), want) {
+		t.Errorf("raw body mismatch: wrote %d bytes, want %d", n, len(want))
+	}
+
+	messages, _, err := store.Read("/fork", ZeroOffset)
+	if err != nil {
+		t.Fatalf("Read failed: %v", err)
+	}
+	if !messages[len(messages)-1].Offset.Equal(chunk.NextOffset) {
+		t.Errorf("next offset mismatch: %s vs %s", messages[len(messages)-1].Offset, chunk.NextOffset)
+	}
+
+	// A bounded raw chunk stops short of the tail
+	partial, err := store.ReadRaw("/fork", ZeroOffset, ReadLimits{MaxMessages: 1})
+	if err != nil {
+		t.Fatalf("ReadRaw failed: %v", err)
+	}
+	if partial.Len() != 1 || partial.UpToDate || !partial.NextOffset.Equal(messages[0].Offset) {
+		t.Errorf("unexpected partial chunk: len=%d upToDate=%v next=%s", partial.Len(), partial.UpToDate, partial.NextOffset)
+	}
+}
+
+func TestFileStore_ReadRawJSONMatchesFormatResponse(t *testing.T) {
+	for _, cacheBytes := range []int64{-1, 0} {
+		tmpDir := t.TempDir()
+		store, err := NewFileStore(FileStoreConfig{DataDir: tmpDir, TailCacheBytes: cacheBytes})
+		if err != nil {
+			t.Fatalf("failed to create store: %v", err)
+		}
+
+		if _, _, err := store.Create("/json", CreateOptions{ContentType: "application/json"}); err != nil {
+			t.Fatalf("Create failed: %v", err)
+		}
+		large := `"` + string(bytes.Repeat([]byte("L"), zeroCopyMinSize+1)) + `"`
+		for _, body := range []string{`[{"a":1},"b"]`, large, `[3, [4]]`} {
+			if _, err := store.Append("/json", []byte(body), AppendOptions{}); err != nil {
+				t.Fatalf("Append failed: %v", err)
+			}
+		}
+
+		messages, _, err := store.Read("/json", ZeroOffset)
+		if err != nil {
+			t.Fatalf("Read failed: %v", err)
+		}
+		want := FormatJSONResponse(messages)
+
+		chunk, err := store.ReadRaw("/json", ZeroOffset, ReadLimits{})
+		if err != nil {
+			t.Fatalf("ReadRaw failed: %v", err)
+		}
+		var buf bytes.Buffer
+		n, err := chunk.WriteTo(&buf)
+		if err != nil {
+			t.Fatalf("WriteTo failed: %v", err)
+		}
+		if n != chunk.Size || chunk.Size != int64(len(want)) || !bytes.Equal(buf.Bytes(), want) {
+			t.Errorf("cache=%d: raw JSON body (%d bytes, size %d) does not match formatted response (%d bytes)",
+				cacheBytes, n, chunk.Size, len(want))
+		}
+
+		// A partial chunk is a complete array of its messages
+		partial, err := store.ReadRaw("/json", messages[0].Offset, ReadLimits{MaxMessages: 2})
+		if err != nil {
+			t.Fatalf("ReadRaw failed: %v", err)
+		}
+		buf.Reset()
+		partial.WriteTo(&buf)
+		if want := FormatJSONResponse(messages[1:3]); !bytes.Equal(buf.Bytes(), want) {
+			t.Errorf("cache=%d: partial chunk = %.40q..., want %.40q...", cacheBytes, buf.Bytes(), want)
+		}
+		store.Close()
+	}
+}
@@ -0,0 +1,448 @@
+package store
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"runtime"
+	"sync"
+	"sync/atomic"
+)
+
+// Recovery:
+// A clean FileStore.Close writes a checkpoint with the verified tail offset of
+// every stream. At startup each stream's recorded tail (from the checkpoint,
+// or from bbolt after a crash) is checked against the size of its active
+// segment with a single stat. Only streams where the two disagree are scanned
+// and repaired, so a clean restart reads no segment data at all.
+//
+// NewFileStore does not wait for this: streams are verified by a background
+// worker pool, and the first operation on a stream that has not been checked
+// yet verifies it inline. The store therefore serves healthy streams right
+// away while repairs continue.
+
+// CheckpointFileName is the name of the clean-shutdown checkpoint in the data directory
+const CheckpointFileName = "checkpoint.json"
+
+// RecoveryEvent describes a repair made during store recovery.
+type RecoveryEvent struct {
+	StreamPath     string
+	SegmentPath    string
+	OriginalSize   uint64
+	RecoveredSize  uint64
+	DiscardedBytes uint64
+
+	// Err is set when the stream could not be verified. The stream is left
+	// as recorded; the size fields are zero.
+	Err error
+}
+
+// recoveryCheckpoint is the on-disk checkpoint format
+type recoveryCheckpoint struct {
+	Streams map[string]string `json:"streams"` // Stream path -> tail offset
+}
+
+// readCheckpoint returns the tails recorded by the last clean shutdown, or
+// nil if there is no checkpoint.
+func readCheckpoint(dataDir string) (map[string]Offset, error) {
+	data, err := os.ReadFile(filepath.Join(dataDir, CheckpointFileName))
+	if errors.Is(err, os.ErrNotExist) {
+		return nil, nil
+	}
+	if err != nil {
+		return nil, err
+	}
+
+	var checkpoint recoveryCheckpoint
+	if err := json.Unmarshal(data, &checkpoint); err != nil {
+		return nil, fmt.Errorf("failed to parse checkpoint: %w", err)
+	}
+	tails := make(map[string]Offset, len(checkpoint.Streams))
+	for path, s := range checkpoint.Streams {
+		offset, err := ParseOffset(s)
+		if err != nil {
+			return nil, fmt.Errorf("invalid checkpoint offset for %s: %w", path, err)
+		}
+		tails[path] = offset
+	}
+	return tails, nil
+}
+
+// writeCheckpoint records verified stream tails for the next startup
+func writeCheckpoint(dataDir string, tails map[string]Offset) error {
+	checkpoint := recoveryCheckpoint{Streams: make(map[string]string, len(tails))}
+	for path, offset := range tails {
+		checkpoint.Streams[path] = offset.String()
+	}
+	data, err := json.Marshal(checkpoint)
+	if err != nil {
+		return err
+	}
+	if err := writeFileAtomic(dataDir, CheckpointFileName, data); err != nil {
+		return fmt.Errorf("failed to write checkpoint: %w", err)
+	}
+	return nil
+}
+
+// removeCheckpoint durably removes the checkpoint. It only describes the
+// store as it was closed, so it must be gone before anything is written.
+func removeCheckpoint(dataDir string) error {
+	err := os.Remove(filepath.Join(dataDir, CheckpointFileName))
+	if errors.Is(err, os.ErrNotExist) {
+		return nil
+	}
+	if err != nil {
+		return fmt.Errorf("failed to remove checkpoint: %w", err)
+	}
+	return syncDir(dataDir)
+}
+
+// verifyStreamTail returns the true tail of a stream recorded as ending at
+// recorded. The active segment is only scanned (and a torn tail truncated)
+// when its size does not match the recorded tail. Sealed segments are synced
+// before the next one is started (see rotateLocked) and are never scanned;
+// the last one's size is still checked against the manifest, since data
+// after it cannot be served if it is incomplete.
+func verifyStreamTail(dataDir string, layout streamLayout, streamPath string, recorded Offset, onEvent func(RecoveryEvent)) (Offset, error) {
+	active := layout.active()
+	seg := layout.segments[active]
+	segPath := layout.path(dataDir, active)
+
+	if err := verifySealedSegment(dataDir, layout, streamPath); err != nil {
+		return Offset{}, err
+	}
+
+	info, err := os.Stat(segPath)
+	if err != nil {
+		return Offset{}, fmt.Errorf("failed to stat segment for %s: %w", streamPath, err)
+	}
+	if recorded.ByteOffset >= seg.Start && uint64(info.Size()) == recorded.ByteOffset-seg.Start {
+		return recorded, nil
+	}
+
+	segmentEnd, err := recoverSegment(segPath, streamPath, onEvent)
+	if err != nil {
+		return Offset{}, err
+	}
+
+	// The tail is where the active segment's data ends. An empty active
+	// segment (rolled but not yet written to) leaves the tail at the end
+	// of the previous one, which keeps that segment's ReadSeq.
+	trueOffset := Offset{
+		ReadSeq:    seg.ReadSeq,
+		ByteOffset: seg.Start + segmentEnd.ByteOffset,
+	}
+	if segmentEnd.ByteOffset == 0 && active > 0 {
+		trueOffset.ReadSeq = layout.segments[active-1].ReadSeq
+	}
+	return trueOffset, nil
+}
+
+// verifySealedSegment checks that the last sealed segment of a stream is as
+// long as the manifest says, i.e. that it ends where the active one starts.
+// Segments offloaded to the object store may have no local copy.
+func verifySealedSegment(dataDir string, layout streamLayout, streamPath string) error {
+	active := layout.active()
+	if active == 0 {
+		return nil
+	}
+	sealed := layout.segments[active-1]
+	want := layout.segments[active].Start - sealed.Start
+
+	sealedPath := layout.path(dataDir, active-1)
+	info, err := os.Stat(sealedPath)
+	if errors.Is(err, os.ErrNotExist) && sealed.Remote {
+		return nil
+	}
+	if err != nil {
+		if errors.Is(err, os.ErrNotExist) {
+			// Not orphaned metadata: later segments hold the stream's data
+			return fmt.Errorf("%w: sealed segment %s of %s is missing", ErrCorruptedSegment, sealed.File, streamPath)
+		}
+		return fmt.Errorf("failed to stat segment for %s: %w", streamPath, err)
+	}
+	if uint64(info.Size()) != want {
+		return fmt.Errorf("%w: sealed segment %s of %s has %d bytes, expected %d", ErrCorruptedSegment, sealed.File, streamPath, info.Size(), want)
+	}
+	return nil
+}
+
+// RecoverStore performs recovery on a file store, reconciling bbolt with segment files
+func RecoverStore(dataDir string) error {
+	return RecoverStoreWithEvents(dataDir, nil)
+}
+
+// RecoverStoreWithEvents performs recovery and calls onEvent for each repair.
+// Streams are verified in parallel; onEvent calls are serialized.
+//
+// NewFileStore runs the same checks itself in the background, so calling this
+// first is only needed to finish all repairs before serving.
+func RecoverStoreWithEvents(dataDir string, onEvent func(RecoveryEvent)) error {
+	metaDir := filepath.Join(dataDir, "metadata")
+	metaStore, err := NewBboltMetadataStore(metaDir)
+	if err != nil {
+		return fmt.Errorf("failed to open metadata store: %w", err)
+	}
+	defer metaStore.Close()
+
+	// An unreadable checkpoint only costs the fast path: bbolt's offsets are
+	// verified the same way.
+	checkpoint, _ := readCheckpoint(dataDir)
+
+	type entry struct {
+		meta    *StreamMetadata
+		dirName string
+	}
+	var entries []entry
+	if err := metaStore.ForEach(func(meta *StreamMetadata, dirName string) error {
+		entries = append(entries, entry{meta: meta, dirName: dirName})
+		return nil
+	}); err != nil {
+		return err
+	}
+
+	onEvent = serializeRecoveryEvents(onEvent)
+	return forEachParallel(len(entries), defaultRecoveryWorkers(), func(i int) error {
+		meta, dirName := entries[i].meta, entries[i].dirName
+
+		segments, err := loadSegments(dataDir, dirName, meta)
+		if err != nil {
+			return fmt.Errorf("stream %s: %w", meta.Path, err)
+		}
+
+		recorded := meta.CurrentOffset
+		if offset, ok := checkpoint[meta.Path]; ok {
+			recorded = offset
+		}
+
+		layout := streamLayout{dirName: dirName, segments: segments}
+		trueOffset, err := verifyStreamTail(dataDir, layout, meta.Path, recorded, onEvent)
+		if err != nil {
+			if errors.Is(err, os.ErrNotExist) {
+				// Orphaned metadata - delete it
+				return metaStore.Delete(meta.Path)
+			}
+			return err
+		}
+
+		// Reconcile if mismatch
+		if !meta.CurrentOffset.Equal(trueOffset) {
+			if err := metaStore.UpdateOffset(meta.Path, trueOffset, ""); err != nil {
+				return fmt.Errorf("failed to update offset for %s: %w", meta.Path, err)
+			}
+		}
+		return nil
+	})
+}
+
+func recoverSegment(segPath, streamPath string, onEvent func(RecoveryEvent)) (offset Offset, err error) {
+	f, err := os.OpenFile(segPath, os.O_RDWR, 0644)
+	if err != nil {
+		return Offset{}, fmt.Errorf("failed to open segment for recovery %s: %w", streamPath, err)
+	}
+	defer func() {
+		if closeErr := f.Close(); err == nil && closeErr != nil {
+			err = fmt.Errorf("failed to close segment for %s: %w", streamPath, closeErr)
+		}
+	}()
+
+	trueOffset, err := ScanSegmentFile(f)
+	if err != nil {
+		return Offset{}, fmt.Errorf("failed to scan segment for %s: %w", streamPath, err)
+	}
+
+	info, err := f.Stat()
+	if err != nil {
+		return Offset{}, fmt.Errorf("failed to stat segment for %s: %w", streamPath, err)
+	}
+
+	originalSize := uint64(info.Size())
+	if originalSize > trueOffset.ByteOffset {
+		if err := f.Truncate(int64(trueOffset.ByteOffset)); err != nil {
+			return Offset{}, fmt.Errorf("failed to truncate segment for %s: %w", streamPath, err)
+		}
+		if err := f.Sync(); err != nil {
+			return Offset{}, fmt.Errorf("failed to sync segment for %s: %w", streamPath, err)
+		}
+		if onEvent != nil {
+			onEvent(RecoveryEvent{
+				StreamPath:     streamPath,
+				SegmentPath:    segPath,
+				OriginalSize:   originalSize,
+				RecoveredSize:  trueOffset.ByteOffset,
+				DiscardedBytes: originalSize - trueOffset.ByteOffset,
+			})
+		}
+	}
+
+	return trueOffset, nil
+}
+
+// streamRecovery gates the first access to a stream loaded at startup until
+// its tail has been verified.
+type streamRecovery struct {
+	recorded Offset // Tail to verify (checkpoint, else bbolt)
+	once     sync.Once
+	done     atomic.Bool
+}
+
+// awaitRecovery verifies st if that has not happened yet, or waits for a
+// verification already in progress. Callers must not hold st.mu.
+func (s *FileStore) awaitRecovery(path string, st *fileStream) {
+	r := st.recovery
+	if r == nil || r.done.Load() {
+		return
+	}
+	r.once.Do(func() {
+		s.recoverStream(path, st, r.recorded)
+		r.done.Store(true)
+	})
+}
+
+// recoverStream verifies and, if needed, repairs one stream's tail
+func (s *FileStore) recoverStream(path string, st *fileStream, recorded Offset) {
+	st.mu.Lock()
+	defer st.mu.Unlock()
+	if st.removed {
+		return
+	}
+
+	tail, err := verifyStreamTail(s.dataDir, st.layout(), path, recorded, s.onRecovery)
+	if err != nil {
+		if errors.Is(err, os.ErrNotExist) {
+			// Orphaned metadata
+			s.removeStreamLocked(path, st)
+			return
+		}
+		if s.onRecovery != nil {
+			s.onRecovery(RecoveryEvent{StreamPath: path, Err: err})
+		}
+		return
+	}
+
+	if !tail.Equal(st.meta.CurrentOffset) {
+		st.meta.CurrentOffset = tail
+		st.visible = tail
+		if err := s.metaStore.UpdateOffset(path, tail, ""); err != nil && s.onRecovery != nil {
+			s.onRecovery(RecoveryEvent{StreamPath: path, Err: err})
+		}
+	}
+}
+
+// startRecovery consumes the checkpoint, gates every loaded stream on
+// verification and starts the background workers. Called by NewFileStore
+// before the store is shared.
+func (s *FileStore) startRecovery(workers int) error {
+	checkpoint, _ := readCheckpoint(s.dataDir)
+	if err := removeCheckpoint(s.dataDir); err != nil {
+		return err
+	}
+
+	type entry struct {
+		path string
+		st   *fileStream
+	}
+	var pending []entry
+	s.streams.forEach(func(path string, st *fileStream) {
+		recorded := st.meta.CurrentOffset
+		if offset, ok := checkpoint[path]; ok {
+			recorded = offset
+		}
+		st.recovery = &streamRecovery{recorded: recorded}
+		pending = append(pending, entry{path: path, st: st})
+	})
+
+	if workers <= 0 {
+		workers = defaultRecoveryWorkers()
+	}
+	var next atomic.Int64
+	s.recoveryWG.Add(workers)
+	for i := 0; i < workers; i++ {
+		go func() {
+			defer s.recoveryWG.Done()
+			for {
+				select {
+				case <-s.recoveryStop:
+					return
+				default:
+				}
+				i := int(next.Add(1) - 1)
+				if i >= len(pending) {
+					return
+				}
+				s.awaitRecovery(pending[i].path, pending[i].st)
+			}
+		}()
+	}
+	return nil
+}
+
+// checkpointTails returns the tails of all verified streams for the
+// shutdown checkpoint. Streams still unverified are left out, so the next
+// startup checks them against bbolt.
+func (s *FileStore) checkpointTails() map[string]Offset {
+	tails := make(map[string]Offset)
+	s.streams.forEach(func(path string, st *fileStream) {
+		if st.recovery != nil && !st.recovery.done.Load() {
+			return
+		}
+		st.mu.RLock()
+		if !st.removed && st.meta != nil {
+			tails[path] = st.meta.CurrentOffset
+		}
+		st.mu.RUnlock()
+	})
+	return tails
+}
+
+// defaultRecoveryWorkers is the recovery parallelism. Verification is mostly
+// stats and sequential reads, so it runs wider than the CPU count.
+func defaultRecoveryWorkers() int {
+	return max(4*runtime.GOMAXPROCS(0), 8)
+}
+
+// serializeRecoveryEvents wraps onEvent so concurrent workers can report
+func serializeRecoveryEvents(onEvent func(RecoveryEvent)) func(RecoveryEvent) {
+	if onEvent == nil {
+		return nil
+	}
+	var mu sync.Mutex
+	return func(event RecoveryEvent) {
+		mu.Lock()
+		defer mu.Unlock()
+		onEvent(event)
+	}
+}
+
+// forEachParallel calls fn(0..n-1) from up to workers goroutines and returns
+// the first error. No new calls start after an error.
+func forEachParallel(n, workers int, fn func(i int) error) error {
+	var (
+		next     atomic.Int64
+		firstErr error
+		errOnce  sync.Once
+		failed   atomic.Bool
+		wg       sync.WaitGroup
+	)
+	for w := 0; w < min(workers, n); w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for !failed.Load() {
+				i := int(next.Add(1) - 1)
+				if i >= n {
+					return
+				}
+				if err := fn(i); err != nil {
+					errOnce.Do(func() { firstErr = err })
+					failed.Store(true)
+					return
+				}
+			}
+		}()
+	}
+	wg.Wait()
+	return firstErr
+}
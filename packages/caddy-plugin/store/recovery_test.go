@@ -0,0 +1,171 @@
+package store
+
+import (
+	"os"
+	"path/filepath"
+	"sync"
+	"testing"
+)
+
+// eventLog collects recovery events from background workers
+type eventLog struct {
+	mu     sync.Mutex
+	events []RecoveryEvent
+}
+
+func (l *eventLog) add(event RecoveryEvent) {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	l.events = append(l.events, event)
+}
+
+func (l *eventLog) list() []RecoveryEvent {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	return append([]RecoveryEvent(nil), l.events...)
+}
+
+func openRecoveringStore(t *testing.T, dir string, log *eventLog) *FileStore {
+	t.Helper()
+	store, err := NewFileStore(FileStoreConfig{DataDir: dir, OnRecovery: log.add})
+	if err != nil {
+		t.Fatalf("failed to open store: %v", err)
+	}
+	return store
+}
+
+// populateStore creates streams /a and /b with a few messages each, closes
+// the store cleanly and returns their tails and /a's segment path.
+func populateStore(t *testing.T, dir string) (map[string]Offset, string) {
+	t.Helper()
+	store := openRecoveringStore(t, dir, &eventLog{})
+	tails := make(map[string]Offset)
+	for _, path := range []string{"/a", "/b"} {
+		if _, _, err := store.Create(path, CreateOptions{ContentType: "text/plain"}); err != nil {
+			t.Fatalf("Create failed: %v", err)
+		}
+		offsets := appendPayloads(t, store, path, 0, 3)
+		tails[path] = offsets[len(offsets)-1]
+	}
+	_, _, layout, _ := store.view("/a")
+	segPath := layout.path(dir, layout.active())
+	if err := store.Close(); err != nil {
+		t.Fatalf("Close failed: %v", err)
+	}
+	return tails, segPath
+}
+
+func expectTail(t *testing.T, store *FileStore, path string, want Offset) {
+	t.Helper()
+	tail, err := store.GetCurrentOffset(path)
+	if err != nil {
+		t.Fatalf("GetCurrentOffset(%s) failed: %v", path, err)
+	}
+	if !tail.Equal(want) {
+		t.Errorf("%s: expected tail %s, got %s", path, want, tail)
+	}
+}
+
+func TestFileStore_CleanShutdownWritesCheckpoint(t *testing.T) {
+	tmpDir := t.TempDir()
+	tails, _ := populateStore(t, tmpDir)
+
+	checkpoint, err := readCheckpoint(tmpDir)
+	if err != nil {
+		t.Fatalf("readCheckpoint failed: %v", err)
+	}
+	if len(checkpoint) != 2 || !checkpoint["/a"].Equal(tails["/a"]) || !checkpoint["/b"].Equal(tails["/b"]) {
+		t.Fatalf("unexpected checkpoint %v, want %v", checkpoint, tails)
+	}
+
+	var log eventLog
+	store := openRecoveringStore(t, tmpDir, &log)
+	defer store.Close()
+
+	// The checkpoint is consumed at startup, before anything is written
+	if _, err := os.Stat(filepath.Join(tmpDir, CheckpointFileName)); !os.IsNotExist(err) {
+		t.Errorf("expected the checkpoint to be removed on open, got %v", err)
+	}
+	expectTail(t, store, "/a", tails["/a"])
+	expectTail(t, store, "/b", tails["/b"])
+	expectPayloads(t, store, "/a", ZeroOffset, 0, 3)
+	if events := log.list(); len(events) != 0 {
+		t.Errorf("expected no repairs after a clean shutdown, got %+v", events)
+	}
+}
+
+func TestFileStore_RepairsTornTailOnFirstAccess(t *testing.T) {
+	tmpDir := t.TempDir()
+	tails, segPath := populateStore(t, tmpDir)
+
+	// Simulate a crash: no checkpoint, and a torn write on /a
+	if err := os.Remove(filepath.Join(tmpDir, CheckpointFileName)); err != nil {
+		t.Fatalf("failed to remove checkpoint: %v", err)
+	}
+	f, err := os.OpenFile(segPath, os.O_APPEND|os.O_WRONLY, 0644)
+	if err != nil {
+		t.Fatalf("failed to open segment: %v", err)
+	}
+	f.Write([]byte{0, 0, 0, 9, 'x', 'y'})
+	f.Close()
+
+	var log eventLog
+	store := openRecoveringStore(t, tmpDir, &log)
+	defer store.Close()
+
+	// Appends wait for the stream's verification, so they land after the
+	// repaired tail whether or not a background worker got there first
+	res, err := store.Append("/a", []byte("message-003"), AppendOptions{})
+	if err != nil {
+		t.Fatalf("Append failed: %v", err)
+	}
+	if !tails["/a"].LessThan(res.Offset) {
+		t.Errorf("append offset %s should follow recovered tail %s", res.Offset, tails["/a"])
+	}
+	expectPayloads(t, store, "/a", ZeroOffset, 0, 4)
+	expectTail(t, store, "/b", tails["/b"])
+
+	events := log.list()
+	if len(events) != 1 || events[0].StreamPath != "/a" || events[0].DiscardedBytes != 6 || events[0].Err != nil {
+		t.Fatalf("expected one repair of /a, got %+v", events)
+	}
+}
+
+func TestFileStore_RecoversTailAheadOfMetadata(t *testing.T) {
+	tmpDir := t.TempDir()
+	tails, _ := populateStore(t, tmpDir)
+
+	// Crash after the segment write but before bbolt caught up
+	if err := os.Remove(filepath.Join(tmpDir, CheckpointFileName)); err != nil {
+		t.Fatalf("failed to remove checkpoint: %v", err)
+	}
+	metaStore, err := NewBboltMetadataStore(filepath.Join(tmpDir, "metadata"))
+	if err != nil {
+		t.Fatalf("failed to open metadata: %v", err)
+	}
+	if err := metaStore.UpdateOffset("/b", ZeroOffset, ""); err != nil {
+		t.Fatalf("UpdateOffset failed: %v", err)
+	}
+	metaStore.Close()
+
+	store := openRecoveringStore(t, tmpDir, &eventLog{})
+	expectTail(t, store, "/b", tails["/b"])
+	expectPayloads(t, store, "/b", ZeroOffset, 0, 3)
+	if err := store.Close(); err != nil {
+		t.Fatalf("Close failed: %v", err)
+	}
+
+	// The repaired offset was persisted
+	metaStore, err = NewBboltMetadataStore(filepath.Join(tmpDir, "metadata"))
+	if err != nil {
+		t.Fatalf("failed to open metadata: %v", err)
+	}
+	defer metaStore.Close()
+	meta, _, err := metaStore.Get("/b")
+	if err != nil {
+		t.Fatalf("Get failed: %v", err)
+	}
+	if !meta.CurrentOffset.Equal(tails["/b"]) {
+		t.Errorf("expected persisted tail %s, got %s", tails["/b"], meta.CurrentOffset)
+	}
+}
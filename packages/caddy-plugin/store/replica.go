@@ -0,0 +1,279 @@
+package store
+
+import (
+	"errors"
+	"fmt"
+	"maps"
+	"path/filepath"
+	"slices"
+	"strings"
+)
+
+// ErrReplicaDiverged is returned by Replicate when a follower's copy of a
+// stream no longer lines up with the leader's
+var ErrReplicaDiverged = errors.New("replica diverged from leader")
+
+// StreamInfo is a stream as a ChangeFeed reports it
+type StreamInfo struct {
+	Meta StreamMetadata
+
+	// ID identifies this incarnation of the stream: a path deleted and
+	// created again gets a new ID. Replicas keep their leader's IDs.
+	ID string
+}
+
+// ChangeFeed is implemented by stores that can be replicated: they list
+// every stream and report every change to one.
+type ChangeFeed interface {
+	// Streams returns every stream, soft-deleted included, in no
+	// particular order
+	Streams() []StreamInfo
+
+	// ReadChanges returns a snapshot of a stream (soft-deleted included)
+	// and its own messages after offset, as far as limits allow and never
+	// past the snapshot's CurrentOffset. Messages a fork shares with its
+	// source are not returned.
+	ReadChanges(path string, offset Offset, limits ReadLimits) (StreamInfo, []Message, error)
+
+	// WatchAll calls fn with a stream's path each time any stream is
+	// created, advances, is closed or is deleted, until stop is called. fn
+	// must not block.
+	WatchAll(fn func(path string)) (stop func())
+}
+
+// Replica is implemented by stores that can mirror a leader's streams,
+// keeping the offsets the leader assigned.
+type Replica interface {
+	ChangeFeed
+
+	// Replicate brings a stream up to the leader's: the stream is created as
+	// the leader created it if missing (or replaced if its ID differs), then
+	// messages, as returned by the leader's ReadChanges, are written after
+	// its tail. Messages it already has are skipped. Once the stream reaches
+	// the leader's CurrentOffset it also takes the leader's Stream-Seq,
+	// producer, closure and soft-delete state.
+	Replicate(info StreamInfo, messages []Message) error
+
+	// ReplicateDelete deletes a stream the leader deleted, also when it is
+	// soft-deleted already
+	ReplicateDelete(path string) error
+}
+
+// The file store identifies a stream by its directory name, which is unique
+// to each incarnation of a path; replicas take their leader's.
+
+// Streams implements ChangeFeed
+func (s *FileStore) Streams() []StreamInfo {
+	var streams []StreamInfo
+	s.streams.forEach(func(path string, st *fileStream) {
+		s.awaitRecovery(path, st)
+		st.mu.RLock()
+		defer st.mu.RUnlock()
+		if !st.removed {
+			streams = append(streams, StreamInfo{Meta: st.snapshot(), ID: st.dirName})
+		}
+	})
+	return streams
+}
+
+// ReadChanges implements ChangeFeed
+func (s *FileStore) ReadChanges(path string, offset Offset, limits ReadLimits) (StreamInfo, []Message, error) {
+	_, meta, layout, ok := s.view(path)
+	if !ok || meta.IsExpired() {
+		return StreamInfo{}, nil, ErrStreamNotFound
+	}
+	info := StreamInfo{Meta: meta, ID: layout.dirName}
+	if meta.ForkedFrom != "" && offset.LessThan(meta.ForkOffset) {
+		offset = meta.ForkOffset
+	}
+	if !offset.LessThan(meta.CurrentOffset) {
+		return info, nil, nil
+	}
+
+	frames, err := s.readOwnFrames(layout, offset, meta.CurrentOffset, newReadBudget(limits))
+	if err != nil {
+		return StreamInfo{}, nil, err
+	}
+	messages, err := s.loadFrames(frames)
+	if err != nil {
+		return StreamInfo{}, nil, err
+	}
+	return info, messages, nil
+}
+
+// WatchAll implements ChangeFeed
+func (s *FileStore) WatchAll(fn func(path string)) (stop func()) {
+	return s.longPoll.watchAll(fn)
+}
+
+// Replicate implements Replica
+func (s *FileStore) Replicate(info StreamInfo, messages []Message) error {
+	meta := info.Meta
+	if info.ID == "" || strings.HasPrefix(info.ID, ".") || filepath.Base(info.ID) != info.ID {
+		return fmt.Errorf("invalid replica stream id %q", info.ID)
+	}
+
+	st := s.lookup(meta.Path)
+	if st != nil {
+		st.mu.RLock()
+		same := !st.removed && st.dirName == info.ID
+		st.mu.RUnlock()
+		if !same {
+			// Recreated on the leader since this copy was made
+			if err := s.deleteStream(meta.Path, true); err != nil && !errors.Is(err, ErrStreamNotFound) {
+				return err
+			}
+			st = nil
+		}
+	}
+
+	if st == nil {
+		opts := CreateOptions{
+			ContentType: meta.ContentType,
+			TTLSeconds:  meta.TTLSeconds,
+			ExpiresAt:   meta.ExpiresAt,
+			ForkedFrom:  meta.ForkedFrom,
+			replica:     &info,
+		}
+		if meta.ForkedFrom != "" {
+			forkOffset := meta.ForkOffset
+			if meta.ForkOffsetRequested != nil {
+				forkOffset = *meta.ForkOffsetRequested
+			}
+			opts.ForkOffset = &forkOffset
+			if meta.ForkSubOffset > 0 {
+				subOffset := meta.ForkSubOffset
+				opts.ForkSubOffset = &subOffset
+			}
+		}
+		if _, _, err := s.Create(meta.Path, opts); err != nil {
+			return fmt.Errorf("failed to create replica: %w", err)
+		}
+		if st = s.lookup(meta.Path); st == nil {
+			return ErrStreamNotFound
+		}
+	}
+
+	segPaths, end, flushMeta, err := s.replicateLocked(st, info, messages)
+	if len(segPaths) > 0 {
+		if commitErr := s.committer.commitAll(segPaths, flushMeta); commitErr != nil {
+			if err == nil {
+				err = fmt.Errorf("failed to sync segment: %w", commitErr)
+			}
+		} else {
+			s.publish(info.Meta.Path, st, end)
+		}
+	} else if flushMeta {
+		if flushErr := s.metaBatch.flush(); flushErr != nil && err == nil {
+			err = flushErr
+		}
+	}
+	return err
+}
+
+// replicateLocked writes the messages of a Replicate call and applies the
+// leader's state under the stream lock. It returns the segments to commit,
+// the offset to publish once they are durable, and whether buffered metadata
+// must be flushed with them. Messages written before an error are still
+// returned for commit.
+func (s *FileStore) replicateLocked(st *fileStream, info StreamInfo, messages []Message) ([]string, Offset, bool, error) {
+	st.mu.Lock()
+	defer st.mu.Unlock()
+
+	meta := info.Meta
+	if st.removed || st.dirName != info.ID {
+		return nil, Offset{}, false, ErrReplicaDiverged
+	}
+	local := st.meta
+	st.touch()
+
+	var segPaths []string
+	var written []Message
+	start := local.CurrentOffset
+	var err error
+	for _, msg := range messages {
+		if msg.Offset.ByteOffset <= local.CurrentOffset.ByteOffset {
+			continue
+		}
+		if local.CurrentOffset.ByteOffset+uint64(LengthPrefixSize+len(msg.Data)) != msg.Offset.ByteOffset {
+			err = fmt.Errorf("%w: %s has no message ending at %s", ErrReplicaDiverged, meta.Path, msg.Offset)
+			break
+		}
+
+		// Follow the leader's segment rotations, so offsets keep its ReadSeq
+		layout := st.layout()
+		activeSeq := layout.segments[layout.active()].ReadSeq
+		if msg.Offset.ReadSeq < activeSeq {
+			err = fmt.Errorf("%w: %s is past segment %d", ErrReplicaDiverged, meta.Path, msg.Offset.ReadSeq)
+			break
+		}
+		if msg.Offset.ReadSeq > activeSeq {
+			if err = s.rotateLocked(st, msg.Offset.ReadSeq); err != nil {
+				break
+			}
+			layout = st.layout()
+		}
+
+		segPath := layout.path(s.dataDir, layout.active())
+		file, release, getErr := s.writerPool.AcquireWriter(segPath)
+		if getErr != nil {
+			err = fmt.Errorf("failed to get writer: %w", getErr)
+			break
+		}
+		_, err = WriteMessage(file, msg.Data)
+		release()
+		if err != nil {
+			break
+		}
+		local.CurrentOffset = msg.Offset
+		written = append(written, msg)
+		if !slices.Contains(segPaths, segPath) {
+			segPaths = append(segPaths, segPath)
+		}
+	}
+	if len(written) > 0 && s.tails != nil {
+		s.tails.add(&st.tail, start, written)
+	}
+
+	flushMeta := false
+	if err == nil && local.CurrentOffset.Equal(meta.CurrentOffset) {
+		if local.LastSeq != meta.LastSeq || !maps.EqualFunc(local.Producers, meta.Producers, producerStateEqual) {
+			local.LastSeq = meta.LastSeq
+			local.Producers = maps.Clone(meta.Producers)
+			for producerId, state := range local.Producers {
+				s.metaBatch.record(meta.Path, st.dirName, local.CurrentOffset, "", producerId, state, false, nil)
+			}
+			flushMeta = true
+		}
+		if meta.Closed && !local.Closed {
+			local.Closed = true
+			local.ClosedBy = meta.ClosedBy
+			flushMeta = true
+			s.longPoll.notifyClosed(meta.Path)
+		}
+		if meta.SoftDeleted && !local.SoftDeleted {
+			local.SoftDeleted = true
+			s.metaStore.SoftDelete(meta.Path)
+		}
+	} else if err == nil && meta.CurrentOffset.ByteOffset < local.CurrentOffset.ByteOffset {
+		err = fmt.Errorf("%w: %s is past the leader's tail %s", ErrReplicaDiverged, meta.Path, meta.CurrentOffset)
+	}
+
+	if len(written) > 0 || flushMeta {
+		s.metaBatch.record(meta.Path, st.dirName, local.CurrentOffset, local.LastSeq, "", nil, local.Closed, local.ClosedBy)
+	}
+	if len(written) == 0 && flushMeta {
+		// Nothing to commit first (see publish)
+		s.longPoll.notify(meta.Path)
+	}
+	return segPaths, local.CurrentOffset, flushMeta, err
+}
+
+// ReplicateDelete implements Replica
+func (s *FileStore) ReplicateDelete(path string) error {
+	return s.deleteStream(path, true)
+}
+
+func producerStateEqual(a, b *ProducerState) bool {
+	return *a == *b
+}
@@ -0,0 +1,173 @@
+package store
+
+import (
+	"errors"
+	"reflect"
+	"testing"
+)
+
+// replicateAll brings every stream of follower up to leader, sources before
+// their forks, a few messages per Replicate call
+func replicateAll(t *testing.T, leader, follower *FileStore) {
+	t.Helper()
+	have := make(map[string]StreamInfo)
+	for _, info := range follower.Streams() {
+		have[info.Meta.Path] = info
+	}
+
+	streams := leader.Streams()
+	var ordered []StreamInfo
+	for _, info := range streams {
+		if info.Meta.ForkedFrom == "" {
+			ordered = append(ordered, info)
+		}
+	}
+	for _, info := range streams {
+		if info.Meta.ForkedFrom != "" {
+			ordered = append(ordered, info)
+		}
+	}
+
+	for _, info := range ordered {
+		offset := ZeroOffset
+		if copy, ok := have[info.Meta.Path]; ok && copy.ID == info.ID {
+			offset = copy.Meta.CurrentOffset
+		}
+		for {
+			leaderInfo, messages, err := leader.ReadChanges(info.Meta.Path, offset, ReadLimits{MaxMessages: 3})
+			if err != nil {
+				t.Fatalf("ReadChanges %s failed: %v", info.Meta.Path, err)
+			}
+			if err := follower.Replicate(leaderInfo, messages); err != nil {
+				t.Fatalf("Replicate %s failed: %v", info.Meta.Path, err)
+			}
+			if len(messages) == 0 {
+				break
+			}
+			offset = messages[len(messages)-1].Offset
+		}
+		delete(have, info.Meta.Path)
+	}
+	for path := range have {
+		if err := follower.ReplicateDelete(path); err != nil && !errors.Is(err, ErrStreamNotFound) {
+			t.Fatalf("ReplicateDelete %s failed: %v", path, err)
+		}
+	}
+}
+
+func expectSameRead(t *testing.T, leader, follower *FileStore, path string) {
+	t.Helper()
+	want, _, err := leader.Read(path, ZeroOffset)
+	if err != nil {
+		t.Fatalf("leader Read %s failed: %v", path, err)
+	}
+	got, _, err := follower.Read(path, ZeroOffset)
+	if err != nil {
+		t.Fatalf("follower Read %s failed: %v", path, err)
+	}
+	if !reflect.DeepEqual(got, want) {
+		t.Errorf("%s: follower read %v, leader read %v", path, got, want)
+	}
+}
+
+func TestFileStore_ReplicateMirrorsLeader(t *testing.T) {
+	leader := newRotatingFileStore(t, t.TempDir(), 64)
+	defer leader.Close()
+	follower := newRotatingFileStore(t, t.TempDir(), -1)
+	defer func() { follower.Close() }()
+
+	leader.Create("/s", CreateOptions{ContentType: "text/plain"})
+	offsets := appendPayloads(t, leader, "/s", 0, 10)
+	forkOffset := offsets[4]
+	if _, _, err := leader.Create("/f", CreateOptions{ForkedFrom: "/s", ForkOffset: &forkOffset}); err != nil {
+		t.Fatalf("fork Create failed: %v", err)
+	}
+	appendPayloads(t, leader, "/f", 10, 12)
+	epoch, seq := int64(0), int64(0)
+	leader.Append("/s", []byte("last"), AppendOptions{
+		ProducerId: "p", ProducerEpoch: &epoch, ProducerSeq: &seq, Close: true,
+	})
+
+	replicateAll(t, leader, follower)
+	expectSameRead(t, leader, follower, "/s")
+	expectSameRead(t, leader, follower, "/f")
+
+	// Offsets are the leader's, rotations included, though the follower
+	// would not rotate on its own
+	_, _, layout, _ := follower.view("/s")
+	if len(layout.segments) < 2 {
+		t.Errorf("expected the leader's segment rotations, got %+v", layout.segments)
+	}
+	meta, _ := follower.Get("/s")
+	if !meta.Closed || meta.Producers["p"] == nil || meta.Producers["p"].LastSeq != 0 {
+		t.Errorf("expected closure and producer state replicated, got %+v", meta)
+	}
+
+	// Replicating again changes nothing
+	before, _ := follower.Get("/s")
+	replicateAll(t, leader, follower)
+	after, _ := follower.Get("/s")
+	if !before.CurrentOffset.Equal(after.CurrentOffset) {
+		t.Errorf("expected replication to be idempotent, offset moved %s -> %s", before.CurrentOffset, after.CurrentOffset)
+	}
+
+	// Replicas survive a restart, and a leader's delete soft-deletes the
+	// source of a live fork just like on the leader
+	dir := follower.dataDir
+	follower.Close()
+	follower = newRotatingFileStore(t, dir, -1)
+	leader.Delete("/s")
+	replicateAll(t, leader, follower)
+	if follower.Has("/s") {
+		t.Error("expected /s to be soft-deleted on the follower")
+	}
+	expectSameRead(t, leader, follower, "/f")
+
+	leader.Delete("/f")
+	replicateAll(t, leader, follower)
+	if streams := follower.Streams(); len(streams) != 0 {
+		t.Errorf("expected all streams removed, got %d", len(streams))
+	}
+}
+
+func TestFileStore_ReplicateReplacesRecreatedStreams(t *testing.T) {
+	leader := newRotatingFileStore(t, t.TempDir(), -1)
+	defer leader.Close()
+	follower := newRotatingFileStore(t, t.TempDir(), -1)
+	defer follower.Close()
+
+	leader.Create("/s", CreateOptions{ContentType: "text/plain"})
+	appendPayloads(t, leader, "/s", 0, 3)
+	replicateAll(t, leader, follower)
+
+	leader.Delete("/s")
+	leader.Create("/s", CreateOptions{ContentType: "text/plain"})
+	appendPayloads(t, leader, "/s", 5, 6)
+	replicateAll(t, leader, follower)
+	expectPayloads(t, follower, "/s", ZeroOffset, 5, 1)
+}
+
+func TestFileStore_ReplicateRejectsDivergedMessages(t *testing.T) {
+	leader := newRotatingFileStore(t, t.TempDir(), -1)
+	defer leader.Close()
+	follower := newRotatingFileStore(t, t.TempDir(), -1)
+	defer follower.Close()
+
+	leader.Create("/s", CreateOptions{ContentType: "text/plain"})
+	appendPayloads(t, leader, "/s", 0, 2)
+	info, messages, _ := leader.ReadChanges("/s", ZeroOffset, ReadLimits{})
+
+	// A gap: the first message is missing
+	if err := follower.Replicate(info, messages[1:]); !errors.Is(err, ErrReplicaDiverged) {
+		t.Errorf("expected ErrReplicaDiverged, got %v", err)
+	}
+	if err := follower.Replicate(info, messages); err != nil {
+		t.Fatalf("Replicate failed: %v", err)
+	}
+	expectSameRead(t, leader, follower, "/s")
+
+	info.ID = "../escape"
+	if err := follower.Replicate(info, nil); err == nil {
+		t.Error("expected an invalid stream id to be rejected")
+	}
+}
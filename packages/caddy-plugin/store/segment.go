@@ -6,7 +6,9 @@ import (
 	"errors"
 	"fmt"
 	"io"
+	"math"
 	"os"
+	"sync"
 )
 
 // Segment file format:
@@ -80,12 +82,30 @@ func ReadMessage(r io.Reader) ([]byte, error) {
 	return data, nil
 }
 
-// SegmentReader reads messages from a segment file
+// segmentReadBufferSize is the read buffer size of a SegmentReader
+const segmentReadBufferSize = 64 * 1024
+
+// segmentReadBuffers recycles SegmentReader buffers across reads
+var segmentReadBuffers = sync.Pool{
+	New: func() any { return bufio.NewReaderSize(nil, segmentReadBufferSize) },
+}
+
+// SegmentReader reads messages from a segment file.
+// All reads are positional (ReadAt), so a reader may share its file handle
+// with concurrent readers; the file's own offset is never moved.
 type SegmentReader struct {
-	file    *os.File
-	reader  *bufio.Reader
-	offset  uint64 // current byte offset in file
-	readSeq uint64 // current read sequence (for offset calculation)
+	file   io.ReaderAt
+	owned  bool // file was opened by this reader and is closed with it
+	reader *bufio.Reader
+	offset int64 // file position of the next byte returned by reader
+	limit  int64 // reads stop at this file position
+}
+
+// segmentFrame locates one message payload within a segment file
+type segmentFrame struct {
+	pos    int64  // file position of the payload (after its length prefix)
+	size   int    // payload length
+	offset Offset // offset after the message
 }
 
 // NewSegmentReader creates a new segment reader
@@ -95,27 +115,65 @@ func NewSegmentReader(path string) (*SegmentReader, error) {
 		return nil, err
 	}
 
+	r := newSegmentReaderAt(file)
+	r.owned = true
+	return r, nil
+}
+
+// newSegmentReaderAt creates a reader over a shared (pooled) file handle, or
+// an offloaded segment. Closing the reader does not close the file.
+func newSegmentReaderAt(file io.ReaderAt) *SegmentReader {
 	return &SegmentReader{
 		file:   file,
-		reader: bufio.NewReaderSize(file, 64*1024), // 64KB buffer
-	}, nil
+		reader: segmentReadBuffers.Get().(*bufio.Reader),
+		limit:  math.MaxInt64,
+	}
+}
+
+// setLimit stops reads at the given file position, e.g. a stream's
+// committed tail, so a concurrent append is never read half-written.
+// Takes effect at the next seek.
+func (r *SegmentReader) setLimit(pos uint64) {
+	if pos > math.MaxInt64 {
+		pos = math.MaxInt64
+	}
+	r.limit = int64(pos)
 }
 
 // SeekToOffset seeks to a position in the file based on byte offset
 func (r *SegmentReader) SeekToOffset(byteOffset uint64) error {
-	// Reset the buffered reader
-	if _, err := r.file.Seek(int64(byteOffset), io.SeekStart); err != nil {
-		return err
+	if byteOffset > math.MaxInt64 {
+		return ErrInvalidOffset
 	}
-	r.reader.Reset(r.file)
-	r.offset = byteOffset
+	r.resetAt(int64(byteOffset))
 	return nil
 }
 
+func (r *SegmentReader) resetAt(pos int64) {
+	n := r.limit - pos
+	if n < 0 {
+		n = 0
+	}
+	r.reader.Reset(io.NewSectionReader(r.file, pos, n))
+	r.offset = pos
+}
+
 // ReadMessages reads all messages starting from the given offset
 // Returns messages and the final offset
 func (r *SegmentReader) ReadMessages(startOffset Offset) ([]Message, Offset, error) {
-	// Seek to the starting byte offset
+	return r.readMessages(startOffset, nil)
+}
+
+// ReadMessagesWithLimits reads messages starting from the given offset until
+// EOF or until the chunk reaches limits. Messages past the limit are not read
+// into memory. Returns messages and the offset after the last one returned.
+func (r *SegmentReader) ReadMessagesWithLimits(startOffset Offset, limits ReadLimits) ([]Message, Offset, error) {
+	return r.readMessages(startOffset, newReadBudget(limits))
+}
+
+func (r *SegmentReader) readMessages(startOffset Offset, budget *readBudget) ([]Message, Offset, error) {
+	// Seek to the starting byte offset. Offsets are file positions, so a
+	// resume from any offset goes straight to its message without a scan.
 	if err := r.SeekToOffset(startOffset.ByteOffset); err != nil {
 		return nil, startOffset, err
 	}
@@ -124,6 +182,16 @@ func (r *SegmentReader) ReadMessages(startOffset Offset) ([]Message, Offset, err
 	currentOffset := startOffset
 
 	for {
+		// Peek the length prefix so a message that doesn't fit the budget
+		// is never allocated
+		lenBuf, err := r.reader.Peek(LengthPrefixSize)
+		if err == io.EOF && len(lenBuf) == 0 {
+			break
+		}
+		if err == nil && !budget.admit(int(binary.BigEndian.Uint32(lenBuf))) {
+			break
+		}
+
 		data, err := ReadMessage(r.reader)
 		if err == io.EOF {
 			break
@@ -150,9 +218,69 @@ func (r *SegmentReader) ReadMessages(startOffset Offset) ([]Message, Offset, err
 	return messages, currentOffset, nil
 }
 
+// readFrames walks message frames from startOffset without reading their
+// payloads: payloads larger than the buffered window are skipped by
+// repositioning instead of being read through.
+func (r *SegmentReader) readFrames(startOffset Offset, budget *readBudget) ([]segmentFrame, error) {
+	if err := r.SeekToOffset(startOffset.ByteOffset); err != nil {
+		return nil, err
+	}
+
+	var frames []segmentFrame
+	currentOffset := startOffset
+
+	for {
+		var lenBuf [LengthPrefixSize]byte
+		if _, err := io.ReadFull(r.reader, lenBuf[:]); err != nil {
+			if err == io.EOF {
+				break
+			}
+			return frames, err
+		}
+		length := binary.BigEndian.Uint32(lenBuf[:])
+		if length > MaxMessageSize {
+			return frames, ErrCorruptedSegment
+		}
+		if !budget.admit(int(length)) {
+			break
+		}
+		r.offset += LengthPrefixSize
+
+		// The whole payload must lie within the readable range
+		if r.offset+int64(length) > r.limit {
+			return frames, io.ErrUnexpectedEOF
+		}
+
+		currentOffset = Offset{
+			ReadSeq:    currentOffset.ReadSeq,
+			ByteOffset: currentOffset.ByteOffset + uint64(LengthPrefixSize) + uint64(length),
+		}
+		frames = append(frames, segmentFrame{
+			pos:    r.offset,
+			size:   int(length),
+			offset: currentOffset,
+		})
+
+		if int(length) <= r.reader.Buffered() {
+			r.reader.Discard(int(length))
+			r.offset += int64(length)
+		} else {
+			r.resetAt(r.offset + int64(length))
+		}
+	}
+
+	return frames, nil
+}
+
 // Close closes the segment reader
 func (r *SegmentReader) Close() error {
-	return r.file.Close()
+	r.reader.Reset(nil)
+	segmentReadBuffers.Put(r.reader)
+	r.reader = nil
+	if r.owned {
+		return r.file.(*os.File).Close()
+	}
+	return nil
 }
 
 // SegmentWriter writes messages to a segment file
@@ -0,0 +1,183 @@
+package store
+
+import (
+	"encoding/json"
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"sort"
+	"time"
+)
+
+// Segment rotation:
+// A stream's data is a sequence of segment files. The first is always
+// data.seg; later ones are named by their ReadSeq. Offsets keep counting
+// bytes across the whole stream (ByteOffset never resets), and carry the
+// ReadSeq of the segment their message was written to. Because both fields
+// only grow, offsets stay ordered and lexicographically sortable.
+//
+// The manifest lists the segments in order. It is written only when a
+// segment is rolled, so a stream that never rotated has none and is read as
+// the single data.seg.
+
+const (
+	// ManifestFileName is the name of the segment manifest within a stream directory
+	ManifestFileName = "manifest.json"
+
+	// DefaultSegmentMaxBytes is the default segment size at which a stream
+	// rolls to a new segment
+	DefaultSegmentMaxBytes = 256 * 1024 * 1024
+)
+
+// segmentInfo describes one segment file of a stream.
+type segmentInfo struct {
+	ReadSeq   uint64    `json:"readSeq"`   // ReadSeq of offsets in this segment
+	Start     uint64    `json:"start"`     // Stream ByteOffset of the segment's first byte
+	File      string    `json:"file"`      // File name within the stream directory
+	CreatedAt time.Time `json:"createdAt"` // When the segment was started
+
+	// Remote is set once the sealed segment is uploaded to the object store
+	// (see tier.go); its local copy may then be removed. Size is the
+	// segment's file size, recorded with the upload.
+	Remote bool  `json:"remote,omitempty"`
+	Size   int64 `json:"size,omitempty"`
+}
+
+type segmentManifest struct {
+	Segments []segmentInfo `json:"segments"`
+}
+
+// streamLayout locates a stream's segment files. segments is never modified
+// in place, so a layout taken under the stream's lock stays valid after it
+// is released.
+type streamLayout struct {
+	dirName  string
+	segments []segmentInfo
+}
+
+// segmentFileName returns the file name for a rolled segment with readSeq
+func segmentFileName(readSeq uint64) string {
+	return fmt.Sprintf("data-%016d.seg", readSeq)
+}
+
+// initialSegments returns the single-segment layout of a stream without a
+// manifest: data.seg, starting where the stream's own data starts.
+func initialSegments(meta *StreamMetadata) []segmentInfo {
+	return []segmentInfo{{
+		ReadSeq:   meta.ForkOffset.ReadSeq,
+		Start:     meta.ForkOffset.ByteOffset,
+		File:      SegmentFileName,
+		CreatedAt: meta.CreatedAt,
+	}}
+}
+
+// path returns the file path of segment i
+func (l streamLayout) path(dataDir string, i int) string {
+	return filepath.Join(dataDir, "streams", l.dirName, l.segments[i].File)
+}
+
+// active returns the index of the segment appends go to
+func (l streamLayout) active() int {
+	return len(l.segments) - 1
+}
+
+// index returns the index of the segment stored in file, or -1
+func (l streamLayout) index(file string) int {
+	for i := range l.segments {
+		if l.segments[i].File == file {
+			return i
+		}
+	}
+	return -1
+}
+
+// locate returns the index of the segment holding the message that starts at
+// byteOffset: the last segment starting at or before it.
+func (l streamLayout) locate(byteOffset uint64) int {
+	i := sort.Search(len(l.segments), func(i int) bool {
+		return l.segments[i].Start > byteOffset
+	})
+	if i == 0 {
+		return 0
+	}
+	return i - 1
+}
+
+// end returns the stream ByteOffset where segment i ends, given the stream's
+// tail (for the active segment)
+func (l streamLayout) end(i int, tail uint64) uint64 {
+	if i+1 < len(l.segments) {
+		return l.segments[i+1].Start
+	}
+	return tail
+}
+
+// loadSegments reads a stream's manifest, falling back to the initial
+// single-segment layout if it has none.
+func loadSegments(dataDir, dirName string, meta *StreamMetadata) ([]segmentInfo, error) {
+	data, err := os.ReadFile(filepath.Join(dataDir, "streams", dirName, ManifestFileName))
+	if errors.Is(err, os.ErrNotExist) {
+		return initialSegments(meta), nil
+	}
+	if err != nil {
+		return nil, fmt.Errorf("failed to read segment manifest: %w", err)
+	}
+
+	var manifest segmentManifest
+	if err := json.Unmarshal(data, &manifest); err != nil {
+		return nil, fmt.Errorf("failed to parse segment manifest: %w", err)
+	}
+	if len(manifest.Segments) == 0 {
+		return initialSegments(meta), nil
+	}
+	return manifest.Segments, nil
+}
+
+// writeManifest atomically replaces a stream's manifest
+func writeManifest(streamDir string, segments []segmentInfo) error {
+	data, err := json.Marshal(segmentManifest{Segments: segments})
+	if err != nil {
+		return err
+	}
+	if err := writeFileAtomic(streamDir, ManifestFileName, data); err != nil {
+		return fmt.Errorf("failed to write segment manifest: %w", err)
+	}
+	return nil
+}
+
+// writeFileAtomic durably replaces dir/name with data via a synced temporary
+// file and a rename.
+func writeFileAtomic(dir, name string, data []byte) error {
+	tmpPath := filepath.Join(dir, name+".tmp")
+	f, err := os.OpenFile(tmpPath, os.O_CREATE|os.O_WRONLY|os.O_TRUNC, 0644)
+	if err != nil {
+		return err
+	}
+	if _, err := f.Write(data); err != nil {
+		f.Close()
+		return err
+	}
+	if err := f.Sync(); err != nil {
+		f.Close()
+		return err
+	}
+	if err := f.Close(); err != nil {
+		return err
+	}
+
+	if err := os.Rename(tmpPath, filepath.Join(dir, name)); err != nil {
+		return err
+	}
+	return syncDir(dir)
+}
+
+// syncDir makes renames and removals within dir durable
+func syncDir(dir string) error {
+	d, err := os.Open(dir)
+	if err != nil {
+		return err
+	}
+	defer d.Close()
+	return d.Sync()
+}
@@ -0,0 +1,240 @@
+package store
+
+import (
+	"errors"
+	"fmt"
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+// newRotatingFileStore opens a file store that rolls segments every
+// segmentBytes, with the tail cache off so reads go to the segment files.
+func newRotatingFileStore(t *testing.T, dir string, segmentBytes int64) *FileStore {
+	t.Helper()
+	store, err := NewFileStore(FileStoreConfig{
+		DataDir:         dir,
+		SegmentMaxBytes: segmentBytes,
+		TailCacheBytes:  -1,
+	})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	return store
+}
+
+func appendPayloads(t *testing.T, store *FileStore, path string, from, to int) []Offset {
+	t.Helper()
+	var offsets []Offset
+	for i := from; i < to; i++ {
+		res, err := store.Append(path, []byte(fmt.Sprintf("message-%03d", i)), AppendOptions{})
+		if err != nil {
+			t.Fatalf("Append failed: %v", err)
+		}
+		offsets = append(offsets, res.Offset)
+	}
+	return offsets
+}
+
+func expectPayloads(t *testing.T, store *FileStore, path string, from Offset, first, count int) {
+	t.Helper()
+	messages, upToDate, err := store.Read(path, from)
+	if err != nil {
+		t.Fatalf("Read from %s failed: %v", from, err)
+	}
+	if len(messages) != count {
+		t.Fatalf("Read from %s: expected %d messages, got %d", from, count, len(messages))
+	}
+	for i, msg := range messages {
+		if want := fmt.Sprintf("message-%03d", first+i); string(msg.Data) != want {
+			t.Errorf("Read from %s: message %d = %q, want %q", from, i, msg.Data, want)
+		}
+	}
+	if !upToDate {
+		t.Errorf("Read from %s: expected upToDate", from)
+	}
+}
+
+func TestFileStore_RotatesSegments(t *testing.T) {
+	tmpDir := t.TempDir()
+	store := newRotatingFileStore(t, tmpDir, 64)
+	defer store.Close()
+
+	if _, _, err := store.Create("/s", CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	// 15 bytes per framed message: a segment fills up every 5 messages
+	offsets := appendPayloads(t, store, "/s", 0, 20)
+
+	st, _, layout, _ := store.view("/s")
+	if len(layout.segments) != 4 {
+		t.Fatalf("expected 4 segments, got %d", len(layout.segments))
+	}
+	for i, seg := range layout.segments {
+		if seg.ReadSeq != uint64(i) {
+			t.Errorf("segment %d has ReadSeq %d", i, seg.ReadSeq)
+		}
+		if _, err := os.Stat(layout.path(tmpDir, i)); err != nil {
+			t.Errorf("segment %d missing: %v", i, err)
+		}
+	}
+	if _, err := os.Stat(filepath.Join(tmpDir, "streams", st.dirName, ManifestFileName)); err != nil {
+		t.Errorf("expected a manifest: %v", err)
+	}
+
+	// Offsets keep counting bytes and carry their segment's ReadSeq
+	for i := 1; i < len(offsets); i++ {
+		if !offsets[i-1].LessThan(offsets[i]) {
+			t.Fatalf("offsets not increasing: %s then %s", offsets[i-1], offsets[i])
+		}
+	}
+	if offsets[4].ReadSeq != 0 || offsets[5].ReadSeq != 1 || offsets[19].ReadSeq != 3 {
+		t.Errorf("unexpected ReadSeqs: %s %s %s", offsets[4], offsets[5], offsets[19])
+	}
+
+	expectPayloads(t, store, "/s", ZeroOffset, 0, 20)
+	for i, offset := range offsets {
+		expectPayloads(t, store, "/s", offset, i+1, len(offsets)-i-1)
+	}
+
+	// Limits page across segment boundaries without gaps
+	var next Offset
+	seen := 0
+	for {
+		messages, upToDate, err := store.ReadWithLimits("/s", next, ReadLimits{MaxMessages: 3})
+		if err != nil {
+			t.Fatalf("ReadWithLimits failed: %v", err)
+		}
+		for _, msg := range messages {
+			if want := fmt.Sprintf("message-%03d", seen); string(msg.Data) != want {
+				t.Fatalf("paged message %d = %q, want %q", seen, msg.Data, want)
+			}
+			seen++
+		}
+		if upToDate {
+			break
+		}
+		next = messages[len(messages)-1].Offset
+	}
+	if seen != 20 {
+		t.Errorf("expected to page through 20 messages, got %d", seen)
+	}
+
+	// Delete removes every segment
+	streamDir := filepath.Join(tmpDir, "streams", st.dirName)
+	if err := store.Delete("/s"); err != nil {
+		t.Fatalf("Delete failed: %v", err)
+	}
+	if _, err := os.Stat(streamDir); !os.IsNotExist(err) {
+		t.Errorf("expected stream directory to be removed, got %v", err)
+	}
+}
+
+func TestFileStore_RotatedStreamSurvivesRestart(t *testing.T) {
+	tmpDir := t.TempDir()
+	store := newRotatingFileStore(t, tmpDir, 64)
+
+	if _, _, err := store.Create("/s", CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	offsets := appendPayloads(t, store, "/s", 0, 12)
+	_, _, layout, _ := store.view("/s")
+	activePath := layout.path(tmpDir, layout.active())
+	store.Close()
+
+	// Torn write at the end of the active segment
+	f, err := os.OpenFile(activePath, os.O_APPEND|os.O_WRONLY, 0644)
+	if err != nil {
+		t.Fatalf("failed to open active segment: %v", err)
+	}
+	f.Write([]byte{0, 0, 0, 50, 'x'})
+	f.Close()
+
+	var events []RecoveryEvent
+	if err := RecoverStoreWithEvents(tmpDir, func(e RecoveryEvent) { events = append(events, e) }); err != nil {
+		t.Fatalf("RecoverStore failed: %v", err)
+	}
+	if len(events) != 1 || events[0].SegmentPath != activePath || events[0].DiscardedBytes != 5 {
+		t.Fatalf("expected the torn tail of the active segment to be truncated, got %+v", events)
+	}
+
+	store = newRotatingFileStore(t, tmpDir, 64)
+	defer store.Close()
+
+	tail, err := store.GetCurrentOffset("/s")
+	if err != nil {
+		t.Fatalf("GetCurrentOffset failed: %v", err)
+	}
+	if !tail.Equal(offsets[len(offsets)-1]) {
+		t.Errorf("expected tail %s after recovery, got %s", offsets[len(offsets)-1], tail)
+	}
+	expectPayloads(t, store, "/s", ZeroOffset, 0, 12)
+	expectPayloads(t, store, "/s", offsets[6], 7, 5)
+
+	// Appends continue in the recovered layout
+	more := appendPayloads(t, store, "/s", 12, 16)
+	expectPayloads(t, store, "/s", offsets[len(offsets)-1], 12, 4)
+	if !offsets[len(offsets)-1].LessThan(more[0]) {
+		t.Errorf("offsets went backwards after restart: %s then %s", offsets[len(offsets)-1], more[0])
+	}
+}
+
+func TestRecoverStore_RejectsShortSealedSegment(t *testing.T) {
+	tmpDir := t.TempDir()
+	store := newRotatingFileStore(t, tmpDir, 64)
+
+	if _, _, err := store.Create("/s", CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	appendPayloads(t, store, "/s", 0, 12)
+	_, _, layout, _ := store.view("/s")
+	if layout.active() == 0 {
+		t.Fatal("expected the stream to have rotated")
+	}
+	sealedPath := layout.path(tmpDir, layout.active()-1)
+	store.Close()
+
+	// Lose the end of the sealed segment while the active one is intact
+	info, err := os.Stat(sealedPath)
+	if err != nil {
+		t.Fatalf("failed to stat sealed segment: %v", err)
+	}
+	if err := os.Truncate(sealedPath, info.Size()-3); err != nil {
+		t.Fatalf("failed to truncate sealed segment: %v", err)
+	}
+
+	err = RecoverStore(tmpDir)
+	if !errors.Is(err, ErrCorruptedSegment) {
+		t.Fatalf("expected ErrCorruptedSegment, got %v", err)
+	}
+}
+
+func TestFileStore_ForkOfRotatedStream(t *testing.T) {
+	tmpDir := t.TempDir()
+	store := newRotatingFileStore(t, tmpDir, 64)
+	defer store.Close()
+
+	if _, _, err := store.Create("/source", CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	sourceOffsets := appendPayloads(t, store, "/source", 0, 8)
+
+	// Fork mid-way through the source's second segment
+	forkAt := sourceOffsets[6]
+	if _, _, err := store.Create("/fork", CreateOptions{ForkedFrom: "/source", ForkOffset: &forkAt}); err != nil {
+		t.Fatalf("fork Create failed: %v", err)
+	}
+	forkOffsets := appendPayloads(t, store, "/fork", 7, 20)
+
+	_, _, layout, _ := store.view("/fork")
+	if len(layout.segments) < 2 {
+		t.Fatalf("expected the fork to rotate, got %d segments", len(layout.segments))
+	}
+	if layout.segments[0].Start != forkAt.ByteOffset || layout.segments[0].ReadSeq != forkAt.ReadSeq {
+		t.Errorf("fork's first segment should start at the fork offset, got %+v", layout.segments[0])
+	}
+
+	expectPayloads(t, store, "/fork", ZeroOffset, 0, 20)
+	expectPayloads(t, store, "/fork", sourceOffsets[2], 3, 17)
+	expectPayloads(t, store, "/fork", forkOffsets[5], 13, 7)
+}
@@ -394,3 +394,68 @@ func TestSegmentWriterAppend(t *testing.T) {
 		t.Errorf("expected 2 messages, got %d", len(msgs))
 	}
 }
+
+func TestSegmentReaderWithLimits(t *testing.T) {
+	tmpDir, err := os.MkdirTemp("", "segment-test-*")
+	if err != nil {
+		t.Fatalf("failed to create temp dir: %v", err)
+	}
+	defer os.RemoveAll(tmpDir)
+
+	segPath := filepath.Join(tmpDir, "test.seg")
+	writer, err := NewSegmentWriter(segPath)
+	if err != nil {
+		t.Fatalf("failed to create writer: %v", err)
+	}
+	for _, msg := range []string{"aaaa", "bbbb", "cccccccccc", "dd"} {
+		if _, err := writer.WriteMessage([]byte(msg)); err != nil {
+			t.Fatalf("WriteMessage failed: %v", err)
+		}
+	}
+	writer.Close()
+
+	reader, err := NewSegmentReader(segPath)
+	if err != nil {
+		t.Fatalf("failed to create reader: %v", err)
+	}
+	defer reader.Close()
+
+	// Byte limit stops before the message that would overflow it
+	messages, next, err := reader.ReadMessagesWithLimits(ZeroOffset, ReadLimits{MaxBytes: 10})
+	if err != nil {
+		t.Fatalf("ReadMessagesWithLimits failed: %v", err)
+	}
+	if len(messages) != 2 {
+		t.Fatalf("expected 2 messages, got %d", len(messages))
+	}
+	if next.ByteOffset != 16 {
+		t.Errorf("expected next offset 16, got %d", next.ByteOffset)
+	}
+
+	// A message larger than the limit is still returned on its own
+	messages, next, err = reader.ReadMessagesWithLimits(next, ReadLimits{MaxBytes: 4})
+	if err != nil {
+		t.Fatalf("ReadMessagesWithLimits failed: %v", err)
+	}
+	if len(messages) != 1 || string(messages[0].Data) != "cccccccccc" {
+		t.Fatalf("expected oversized message alone, got %v", messages)
+	}
+
+	// Message limit
+	messages, _, err = reader.ReadMessagesWithLimits(ZeroOffset, ReadLimits{MaxMessages: 3})
+	if err != nil {
+		t.Fatalf("ReadMessagesWithLimits failed: %v", err)
+	}
+	if len(messages) != 3 {
+		t.Errorf("expected 3 messages, got %d", len(messages))
+	}
+
+	// Remainder to EOF
+	messages, _, err = reader.ReadMessagesWithLimits(next, ReadLimits{MaxBytes: 1024})
+	if err != nil {
+		t.Fatalf("ReadMessagesWithLimits failed: %v", err)
+	}
+	if len(messages) != 1 || string(messages[0].Data) != "dd" {
+		t.Errorf("expected final message, got %v", messages)
+	}
+}
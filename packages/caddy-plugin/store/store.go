@@ -64,6 +64,42 @@ type AppendResult struct {
 	StreamClosed   bool  // Stream is now closed (either by this request or previously)
 }
 
+// BatchEntry is one append of a batch
+type BatchEntry struct {
+	Path string
+	Data []byte
+	Opts AppendOptions
+}
+
+// BatchResult is the outcome of one BatchEntry: what Append would have
+// returned for it
+type BatchResult struct {
+	Result AppendResult
+	Err    error
+}
+
+// BatchAppender is implemented by stores that can make a batch of appends,
+// to any number of streams, durable with a single commit.
+type BatchAppender interface {
+	// AppendBatch applies entries in order, each validated and written like
+	// Append, and returns once every written entry is durable. Entries
+	// succeed or fail independently; a failed entry doesn't undo others.
+	AppendBatch(entries []BatchEntry) []BatchResult
+}
+
+// AppendBatch appends entries to s, through a single commit if s is a
+// BatchAppender and one Append at a time otherwise.
+func AppendBatch(s Store, entries []BatchEntry) []BatchResult {
+	if b, ok := s.(BatchAppender); ok {
+		return b.AppendBatch(entries)
+	}
+	results := make([]BatchResult, len(entries))
+	for i, e := range entries {
+		results[i].Result, results[i].Err = s.Append(e.Path, e.Data, e.Opts)
+	}
+	return results
+}
+
 // CloseResult contains the result of a close operation
 type CloseResult struct {
 	FinalOffset   Offset
@@ -131,13 +167,19 @@ type Store interface {
 	// Returns ErrStreamNotFound if stream doesn't exist.
 	Read(path string, offset Offset) ([]Message, bool, error)
 
+	// ReadWithLimits is like Read but stops once the chunk reaches limits.
+	// A partial chunk reports upToDate=false; the caller resumes from the
+	// offset of its last message.
+	ReadWithLimits(path string, offset Offset, limits ReadLimits) ([]Message, bool, error)
+
 	// WaitForMessages waits for new messages after the given offset.
 	// Returns when messages are available, timeout expires, context is cancelled,
 	// or stream is closed.
 	// If messages exist at the offset, returns immediately.
+	// The messages returned are read within limits, like ReadWithLimits.
 	// timedOut is true if we returned due to timeout with no messages.
 	// streamClosed is true if the stream was closed during or before the wait.
-	WaitForMessages(ctx context.Context, path string, offset Offset, timeout time.Duration) (messages []Message, timedOut bool, streamClosed bool, err error)
+	WaitForMessages(ctx context.Context, path string, offset Offset, timeout time.Duration, limits ReadLimits) (messages []Message, timedOut bool, streamClosed bool, err error)
 
 	// GetCurrentOffset returns the current tail offset for a stream
 	GetCurrentOffset(path string) (Offset, error)
@@ -163,6 +205,10 @@ type CreateOptions struct {
 	ForkedFrom    string  // Source stream path (fork creation)
 	ForkOffset    *Offset // Fork offset (nil = source's current tail)
 	ForkSubOffset *uint64 // Sub-position past ForkOffset (nil = 0). Bytes for non-JSON, message count for JSON.
+
+	// replica is the leader's stream being created by Replicate: the copy
+	// takes its ID and CreatedAt, and may fork a soft-deleted source
+	replica *StreamInfo
 }
 
 // AppendOptions contains options for appending to a stream
@@ -193,6 +239,58 @@ type Message struct {
 	Offset Offset
 }
 
+// ReadLimits bounds the size of a single read chunk. Zero fields are
+// unlimited. The first message of a chunk is always returned, so a message
+// larger than MaxBytes is still readable on its own.
+type ReadLimits struct {
+	MaxBytes    int // Maximum total message payload bytes per chunk
+	MaxMessages int // Maximum messages per chunk
+}
+
+// readBudget tracks a chunk against ReadLimits while it is being read.
+// A nil budget admits everything.
+type readBudget struct {
+	limits  ReadLimits
+	count   int
+	bytes   int
+	stopped bool // a message was refused
+}
+
+func newReadBudget(limits ReadLimits) *readBudget {
+	if limits.MaxBytes <= 0 && limits.MaxMessages <= 0 {
+		return nil
+	}
+	return &readBudget{limits: limits}
+}
+
+// admit reports whether a message of n payload bytes fits, and counts it.
+func (b *readBudget) admit(n int) bool {
+	if b == nil {
+		return true
+	}
+	if b.stopped {
+		return false
+	}
+	if b.count > 0 {
+		if b.limits.MaxMessages > 0 && b.count >= b.limits.MaxMessages {
+			b.stopped = true
+			return false
+		}
+		if b.limits.MaxBytes > 0 && b.bytes+n > b.limits.MaxBytes {
+			b.stopped = true
+			return false
+		}
+	}
+	b.count++
+	b.bytes += n
+	return true
+}
+
+// exhausted reports whether the chunk stopped short because of its limits.
+func (b *readBudget) exhausted() bool {
+	return b != nil && b.stopped
+}
+
 // StreamMetadata contains metadata about a stream
 type StreamMetadata struct {
 	Path                string
@@ -234,6 +332,23 @@ func (m *StreamMetadata) IsExpired() bool {
 	return false
 }
 
+// expiryDeadline returns the time after which the stream is expired given
+// its current LastAccessedAt, or false if it never expires
+func (m *StreamMetadata) expiryDeadline() (time.Time, bool) {
+	var deadline time.Time
+	ok := false
+	if m.ExpiresAt != nil {
+		deadline, ok = *m.ExpiresAt, true
+	}
+	if m.TTLSeconds != nil {
+		ttlDeadline := m.LastAccessedAt.Add(time.Duration(*m.TTLSeconds) * time.Second)
+		if !ok || ttlDeadline.Before(deadline) {
+			deadline, ok = ttlDeadline, true
+		}
+	}
+	return deadline, ok
+}
+
 // ConfigMatches checks if another set of options matches this stream's config
 func (m *StreamMetadata) ConfigMatches(opts CreateOptions) bool {
 	// Content type must match (case-insensitive for the type/subtype)
@@ -0,0 +1,217 @@
+package store
+
+import (
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// streamMapShards is the number of independently locked shards in a
+// streamMap. Must be a power of two.
+const streamMapShards = 64
+
+// fileStream is the per-stream state of a FileStore.
+//
+// mu serializes writers on this stream only (appends, closes, refcount and
+// soft-delete changes). Readers take the read lock just long enough to
+// snapshot the metadata. Lock order across streams always follows the fork
+// chain from child to parent.
+type fileStream struct {
+	mu      sync.RWMutex
+	meta    *StreamMetadata
+	dirName string
+
+	// segments lists the stream's own segment files, oldest first. Rotation
+	// replaces the slice (under mu) rather than modifying it.
+	segments []segmentInfo
+
+	// removed is set (under mu) once the stream has been deleted and dropped
+	// from the map. A caller that looked the entry up concurrently must treat
+	// it as not found.
+	removed bool
+
+	// lastAccessed is the TTL sliding-window timestamp (UnixNano, 0 = never).
+	// It lives outside mu so reads refresh it without taking the write lock.
+	lastAccessed atomic.Int64
+
+	// visible is the tail readers see: meta.CurrentOffset as of the last
+	// append whose group commit succeeded. Writers advance meta first, so
+	// bytes between the two are not yet durable and must not be served.
+	visible Offset
+
+	// Newest messages kept in memory for live readers (see tailCache)
+	tail streamTail
+
+	// Startup verification gate; nil for streams created by this process.
+	// Set before the store is shared and never replaced.
+	recovery *streamRecovery
+
+	// Per-producer locks for serializing validation+append
+	producerLocks   map[string]*sync.Mutex
+	producerLocksMu sync.Mutex
+}
+
+func newFileStream(meta *StreamMetadata, dirName string, segments []segmentInfo) *fileStream {
+	st := &fileStream{
+		meta:          meta,
+		dirName:       dirName,
+		segments:      segments,
+		producerLocks: make(map[string]*sync.Mutex),
+	}
+	if meta != nil {
+		st.visible = meta.CurrentOffset
+		if !meta.LastAccessedAt.IsZero() {
+			st.lastAccessed.Store(meta.LastAccessedAt.UnixNano())
+		}
+	}
+	return st
+}
+
+// touch refreshes the TTL sliding window.
+func (st *fileStream) touch() {
+	st.lastAccessed.Store(time.Now().UnixNano())
+}
+
+// snapshot returns a copy of the stream metadata with the current
+// LastAccessedAt, ending at the visible tail. A close is only reported once
+// everything before it is visible. Caller must hold st.mu (read or write).
+func (st *fileStream) snapshot() StreamMetadata {
+	meta := *st.meta
+	if !st.visible.Equal(meta.CurrentOffset) {
+		meta.CurrentOffset = st.visible
+		meta.Closed = false
+		meta.ClosedBy = nil
+	}
+	if ns := st.lastAccessed.Load(); ns != 0 {
+		meta.LastAccessedAt = time.Unix(0, ns)
+	} else {
+		meta.LastAccessedAt = time.Time{}
+	}
+	return meta
+}
+
+// publish makes the stream visible up to offset once the append ending there
+// is durable. Commits can complete out of order; a later offset covers the
+// earlier ones, since an fsync covers the whole segment and rotation syncs
+// the sealed one first.
+func (st *fileStream) publish(offset Offset) {
+	st.mu.Lock()
+	if st.visible.LessThan(offset) {
+		st.visible = offset
+	}
+	st.mu.Unlock()
+}
+
+// layout returns the stream's segment layout. Caller must hold st.mu.
+func (st *fileStream) layout() streamLayout {
+	return streamLayout{dirName: st.dirName, segments: st.segments}
+}
+
+// isExpired reports whether the stream has expired. Caller must hold st.mu.
+func (st *fileStream) isExpired() bool {
+	meta := st.snapshot()
+	return meta.IsExpired()
+}
+
+// producerLock returns the mutex serializing validation+append for one
+// producer on this stream.
+func (st *fileStream) producerLock(producerId string) *sync.Mutex {
+	st.producerLocksMu.Lock()
+	defer st.producerLocksMu.Unlock()
+
+	if mu, ok := st.producerLocks[producerId]; ok {
+		return mu
+	}
+	mu := &sync.Mutex{}
+	st.producerLocks[producerId] = mu
+	return mu
+}
+
+// streamMap is a sharded path -> *fileStream index. It is only used for
+// lookup and membership; per-stream state is guarded by fileStream.mu.
+type streamMap struct {
+	shards [streamMapShards]streamMapShard
+}
+
+type streamMapShard struct {
+	mu sync.RWMutex
+	m  map[string]*fileStream
+}
+
+func newStreamMap() *streamMap {
+	sm := &streamMap{}
+	for i := range sm.shards {
+		sm.shards[i].m = make(map[string]*fileStream)
+	}
+	return sm
+}
+
+func (sm *streamMap) shard(path string) *streamMapShard {
+	// FNV-1a
+	h := uint32(2166136261)
+	for i := 0; i < len(path); i++ {
+		h ^= uint32(path[i])
+		h *= 16777619
+	}
+	return &sm.shards[h&(streamMapShards-1)]
+}
+
+// get returns the entry for path, or nil.
+func (sm *streamMap) get(path string) *fileStream {
+	sh := sm.shard(path)
+	sh.mu.RLock()
+	st := sh.m[path]
+	sh.mu.RUnlock()
+	return st
+}
+
+// set stores the entry for path unconditionally.
+func (sm *streamMap) set(path string, st *fileStream) {
+	sh := sm.shard(path)
+	sh.mu.Lock()
+	sh.m[path] = st
+	sh.mu.Unlock()
+}
+
+// getOrInsert returns the existing entry for path, or stores st and returns
+// it with inserted=true.
+func (sm *streamMap) getOrInsert(path string, st *fileStream) (actual *fileStream, inserted bool) {
+	sh := sm.shard(path)
+	sh.mu.Lock()
+	defer sh.mu.Unlock()
+	if existing, ok := sh.m[path]; ok {
+		return existing, false
+	}
+	sh.m[path] = st
+	return st, true
+}
+
+// remove deletes path from the map if it still maps to st.
+func (sm *streamMap) remove(path string, st *fileStream) {
+	sh := sm.shard(path)
+	sh.mu.Lock()
+	if sh.m[path] == st {
+		delete(sh.m, path)
+	}
+	sh.mu.Unlock()
+}
+
+// forEach calls fn for every entry, one shard at a time. fn runs without any
+// shard lock held, so it may lock the stream or modify the map.
+func (sm *streamMap) forEach(fn func(path string, st *fileStream)) {
+	for i := range sm.shards {
+		sh := &sm.shards[i]
+		sh.mu.RLock()
+		paths := make([]string, 0, len(sh.m))
+		entries := make([]*fileStream, 0, len(sh.m))
+		for path, st := range sh.m {
+			paths = append(paths, path)
+			entries = append(entries, st)
+		}
+		sh.mu.RUnlock()
+
+		for j, st := range entries {
+			fn(paths[j], st)
+		}
+	}
+}
@@ -0,0 +1,222 @@
+package store
+
+import (
+	"container/list"
+	"sort"
+	"sync"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/metrics"
+)
+
+const (
+	// DefaultTailCacheBytes is the default memory budget of the FileStore
+	// tail cache
+	DefaultTailCacheBytes = 64 * 1024 * 1024
+
+	// tailCacheStreamBytes caps the tail kept for any one stream, so a single
+	// busy stream cannot take the whole budget
+	tailCacheStreamBytes = 1024 * 1024
+)
+
+// streamTail holds the most recently appended messages of one stream. The
+// live messages, messages[head:], are contiguous and end at the stream's tail
+// as of the last append; start is the offset just before the first of them.
+// Trimming advances head, and the dropped prefix is only compacted away once
+// it outgrows the live part, so trimming is amortized O(1) per message.
+type streamTail struct {
+	mu       sync.RWMutex
+	start    Offset
+	end      Offset
+	messages []Message
+	head     int   // Index of the first live message
+	size     int64 // Payload bytes held
+
+	elem *list.Element // Position in the cache's LRU, nil when not cached
+}
+
+// live returns the cached messages. Caller must hold t.mu.
+func (t *streamTail) live() []Message {
+	return t.messages[t.head:]
+}
+
+// tailCache keeps a bounded in-memory copy of each stream's newest messages,
+// filled on the write path, so live readers waking up after an append are
+// served without touching the segment files.
+//
+// Streams are evicted whole, least recently appended first, once the global
+// budget is exceeded. Lock order is cache.mu before any streamTail.mu;
+// streamTail.mu is never held while taking cache.mu.
+type tailCache struct {
+	budget    int64
+	streamCap int64
+
+	mu   sync.Mutex
+	used int64
+	lru  list.List // of *streamTail, most recently appended first
+}
+
+// newTailCache returns a cache with the given budget (0 = default), or nil
+// if budget is negative (disabled).
+func newTailCache(budget int64) *tailCache {
+	if budget < 0 {
+		return nil
+	}
+	if budget == 0 {
+		budget = DefaultTailCacheBytes
+	}
+	return &tailCache{
+		budget:    budget,
+		streamCap: min(budget, tailCacheStreamBytes),
+	}
+}
+
+// add records messages appended to a stream whose tail was at prev. Caller
+// must hold the stream's write lock, so adds for one stream are serialized.
+func (c *tailCache) add(t *streamTail, prev Offset, messages []Message) {
+	if c == nil || len(messages) == 0 {
+		return
+	}
+
+	// Copy the payloads into one buffer; callers may reuse theirs
+	total := 0
+	for _, msg := range messages {
+		total += len(msg.Data)
+	}
+	buf := make([]byte, 0, total)
+	owned := make([]Message, len(messages))
+	for i, msg := range messages {
+		lo := len(buf)
+		buf = append(buf, msg.Data...)
+		owned[i] = Message{Data: buf[lo:len(buf):len(buf)], Offset: msg.Offset}
+	}
+
+	t.mu.Lock()
+	before := t.size
+	if len(t.live()) == 0 || !t.end.Equal(prev) {
+		// Empty or no longer contiguous with this append: start over
+		t.messages = nil
+		t.head = 0
+		t.size = 0
+		t.start = prev
+	}
+	t.messages = append(t.messages, owned...)
+	t.size += int64(total)
+	t.end = owned[len(owned)-1].Offset
+
+	// Trim to the per-stream cap, oldest first
+	for t.head < len(t.messages) && t.size > c.streamCap {
+		t.size -= int64(len(t.messages[t.head].Data))
+		t.start = t.messages[t.head].Offset
+		t.messages[t.head] = Message{} // Release the payload
+		t.head++
+	}
+	if t.head > len(t.messages)-t.head {
+		t.messages = append([]Message(nil), t.live()...)
+		t.head = 0
+	}
+	delta := t.size - before
+	t.mu.Unlock()
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	c.used += delta
+	if t.elem == nil {
+		t.elem = c.lru.PushFront(t)
+	} else {
+		c.lru.MoveToFront(t.elem)
+	}
+
+	// Evict whole streams, least recently appended first
+	for c.used > c.budget {
+		back := c.lru.Back()
+		if back == nil {
+			break
+		}
+		c.evictLocked(back.Value.(*streamTail))
+	}
+}
+
+// drop releases a stream's tail (stream deleted). Caller must hold the
+// stream's write lock.
+func (c *tailCache) drop(t *streamTail) {
+	if c == nil {
+		return
+	}
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	c.evictLocked(t)
+}
+
+// evictLocked empties t and removes it from the LRU. Caller holds c.mu.
+func (c *tailCache) evictLocked(t *streamTail) {
+	t.mu.Lock()
+	c.used -= t.size
+	t.messages = nil
+	t.head = 0
+	t.size = 0
+	t.mu.Unlock()
+
+	if t.elem != nil {
+		c.lru.Remove(t.elem)
+		t.elem = nil
+	}
+}
+
+// read returns the cached messages from offset up to end, within budget. It
+// reports false when the cache cannot serve the whole range: offset is before
+// the cached window or not a message boundary, or the cached window stops
+// short of end.
+func (c *tailCache) read(t *streamTail, offset, end Offset, budget *readBudget) ([]Message, bool) {
+	if c == nil {
+		return nil, false
+	}
+	messages, ok := c.lookup(t, offset, end, budget)
+	if ok {
+		metrics.TailCacheHits.Inc()
+	} else {
+		metrics.TailCacheMisses.Inc()
+	}
+	return messages, ok
+}
+
+// lookup is read without the hit accounting
+func (c *tailCache) lookup(t *streamTail, offset, end Offset, budget *readBudget) ([]Message, bool) {
+	t.mu.RLock()
+	defer t.mu.RUnlock()
+
+	cached := t.live()
+	if len(cached) == 0 || offset.LessThan(t.start) {
+		return nil, false
+	}
+
+	// First message ending after offset; offset must be where the previous
+	// one ended (or the window start)
+	i := sort.Search(len(cached), func(i int) bool {
+		return offset.LessThan(cached[i].Offset)
+	})
+	if i == len(cached) {
+		return nil, false
+	}
+	if i > 0 && !cached[i-1].Offset.Equal(offset) || i == 0 && !offset.Equal(t.start) {
+		return nil, false
+	}
+
+	j := i
+	for j < len(cached) && cached[j].Offset.LessThanOrEqual(end) {
+		if !budget.admit(len(cached[j].Data)) {
+			break
+		}
+		j++
+	}
+	if j == i {
+		return nil, false
+	}
+	if !cached[j-1].Offset.Equal(end) && !budget.exhausted() {
+		return nil, false
+	}
+
+	messages := make([]Message, j-i)
+	copy(messages, cached[i:j])
+	return messages, true
+}
@@ -0,0 +1,180 @@
+package store
+
+import (
+	"bytes"
+	"fmt"
+	"os"
+	"testing"
+)
+
+func tailMessages(prev Offset, payloads ...string) []Message {
+	messages := make([]Message, len(payloads))
+	offset := prev
+	for i, p := range payloads {
+		offset = offset.Add(uint64(LengthPrefixSize + len(p)))
+		messages[i] = Message{Data: []byte(p), Offset: offset}
+	}
+	return messages
+}
+
+func TestTailCache_ServesMessageBoundaries(t *testing.T) {
+	c := newTailCache(1024)
+	var tail streamTail
+
+	first := tailMessages(ZeroOffset, "a", "bb", "ccc")
+	c.add(&tail, ZeroOffset, first)
+	end := first[2].Offset
+
+	got, ok := c.read(&tail, ZeroOffset, end, nil)
+	if !ok || len(got) != 3 {
+		t.Fatalf("expected 3 cached messages, got %d (ok=%v)", len(got), ok)
+	}
+
+	got, ok = c.read(&tail, first[0].Offset, end, nil)
+	if !ok || len(got) != 2 || string(got[0].Data) != "bb" {
+		t.Fatalf("expected read from a boundary to hit, got %v (ok=%v)", got, ok)
+	}
+
+	// Not a message boundary
+	if _, ok := c.read(&tail, first[0].Offset.Add(1), end, nil); ok {
+		t.Error("expected mid-message offset to miss")
+	}
+
+	// Limits apply like a segment read
+	got, ok = c.read(&tail, ZeroOffset, end, newReadBudget(ReadLimits{MaxMessages: 2}))
+	if !ok || len(got) != 2 {
+		t.Errorf("expected 2 messages within limits, got %d (ok=%v)", len(got), ok)
+	}
+
+	// An append that doesn't continue the window replaces it
+	later := first[2].Offset.Add(100)
+	c.add(&tail, later, tailMessages(later, "d"))
+	if _, ok := c.read(&tail, ZeroOffset, end, nil); ok {
+		t.Error("expected the stale window to be dropped")
+	}
+}
+
+func TestTailCache_TrimsToStreamCap(t *testing.T) {
+	c := newTailCache(1024)
+	c.streamCap = 10
+	var tail streamTail
+
+	messages := tailMessages(ZeroOffset, "aaaa", "bbbb", "cccc")
+	c.add(&tail, ZeroOffset, messages)
+
+	if tail.size != 8 || len(tail.live()) != 2 {
+		t.Fatalf("expected the oldest message trimmed, got %d messages / %d bytes", len(tail.live()), tail.size)
+	}
+	if _, ok := c.read(&tail, ZeroOffset, messages[2].Offset, nil); ok {
+		t.Error("expected trimmed range to miss")
+	}
+	if _, ok := c.read(&tail, messages[0].Offset, messages[2].Offset, nil); !ok {
+		t.Error("expected the kept range to hit")
+	}
+}
+
+func TestTailCache_TrimsSingleAppendsAtCap(t *testing.T) {
+	c := newTailCache(1024)
+	c.streamCap = 40
+	var tail streamTail
+
+	// A stream of small appends sits at the cap, trimming on every append
+	prev := ZeroOffset
+	for i := 0; i < 1000; i++ {
+		messages := tailMessages(prev, "abcd")
+		c.add(&tail, prev, messages)
+		prev = messages[0].Offset
+
+		if len(tail.live()) != 10 {
+			t.Fatalf("append %d: expected 10 cached messages, got %d", i, len(tail.live()))
+		}
+		if len(tail.messages) > 2*len(tail.live())+1 {
+			t.Fatalf("append %d: dropped prefix not compacted, %d held for %d live", i, len(tail.messages), len(tail.live()))
+		}
+	}
+
+	got, ok := c.read(&tail, tail.start, prev, nil)
+	if !ok || len(got) != 10 || !got[9].Offset.Equal(prev) {
+		t.Fatalf("expected the newest 10 messages, got %d (ok=%v)", len(got), ok)
+	}
+}
+
+func TestTailCache_EvictsLeastRecentlyAppended(t *testing.T) {
+	c := newTailCache(10)
+	var a, b streamTail
+
+	c.add(&a, ZeroOffset, tailMessages(ZeroOffset, "aaaaaa"))
+	c.add(&b, ZeroOffset, tailMessages(ZeroOffset, "bbbbbb"))
+
+	if len(a.live()) != 0 {
+		t.Error("expected the older stream to be evicted")
+	}
+	if len(b.live()) != 1 {
+		t.Error("expected the newer stream to stay cached")
+	}
+	if c.used != 6 {
+		t.Errorf("expected 6 bytes accounted, got %d", c.used)
+	}
+
+	c.drop(&b)
+	if c.used != 0 || c.lru.Len() != 0 {
+		t.Errorf("expected an empty cache after drop, got %d bytes / %d streams", c.used, c.lru.Len())
+	}
+}
+
+func TestFileStore_TailCacheMatchesSegmentReads(t *testing.T) {
+	tmpDir, err := os.MkdirTemp("", "filestore-test-*")
+	if err != nil {
+		t.Fatalf("failed to create temp dir: %v", err)
+	}
+	defer os.RemoveAll(tmpDir)
+
+	store, err := NewFileStore(FileStoreConfig{DataDir: tmpDir})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	defer store.Close()
+
+	if _, _, err := store.Create("/s", CreateOptions{ContentType: "application/json"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	var offsets []Offset
+	for i := 0; i < 5; i++ {
+		res, err := store.Append("/s", []byte(fmt.Sprintf(`[{"n":%d},{"m":%d}]`, i, i)), AppendOptions{})
+		if err != nil {
+			t.Fatalf("Append failed: %v", err)
+		}
+		offsets = append(offsets, res.Offset)
+	}
+
+	st, meta, layout, _ := store.view("/s")
+	if st.tail.size == 0 {
+		t.Fatal("expected appends to fill the tail cache")
+	}
+
+	for _, from := range append([]Offset{ZeroOffset}, offsets[:len(offsets)-1]...) {
+		cached, _, err := store.Read("/s", from)
+		if err != nil {
+			t.Fatalf("Read failed: %v", err)
+		}
+		disk, err := store.readForkedStream(&meta, layout, from, nil)
+		if err != nil {
+			t.Fatalf("segment read failed: %v", err)
+		}
+		if len(cached) != len(disk) {
+			t.Fatalf("from %s: cached %d messages, segment %d", from, len(cached), len(disk))
+		}
+		for i := range cached {
+			if !bytes.Equal(cached[i].Data, disk[i].Data) || !cached[i].Offset.Equal(disk[i].Offset) {
+				t.Errorf("from %s: message %d differs", from, i)
+			}
+		}
+	}
+
+	if err := store.Delete("/s"); err != nil {
+		t.Fatalf("Delete failed: %v", err)
+	}
+	if store.tails.used != 0 {
+		t.Errorf("expected deleted stream's tail to be released, got %d bytes", store.tails.used)
+	}
+}
@@ -0,0 +1,486 @@
+package store
+
+import (
+	"container/list"
+	"context"
+	"errors"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"slices"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/durable-streams/durable-streams/packages/caddy-plugin/metrics"
+)
+
+// Tiered storage:
+// Sealed segments (all of a stream's segments but the active one) are
+// uploaded to an ObjectStore in the background and marked Remote in the
+// stream's manifest. Uploaded segments stay on local disk while the local
+// budget allows; past it the least recently read are removed. Reads of a
+// removed segment fetch block-sized ranges with ranged GETs into a local
+// block cache sharing that budget. A stream's active segment, which live
+// readers tail, is never offloaded.
+//
+// Objects are keyed "<stream dir>/<segment file>"; stream directory names are
+// unique per incarnation, so a recreated stream never sees stale objects.
+
+const (
+	// DefaultTierLocalBytes is the default local disk budget for uploaded
+	// segments and cached blocks
+	DefaultTierLocalBytes = 64 * 1024 * 1024 * 1024
+
+	// DefaultTierBlockBytes is the default size of the ranges fetched back
+	// from the object store
+	DefaultTierBlockBytes = 4 * 1024 * 1024
+
+	// tierCacheDirName is the block cache directory within the data directory
+	tierCacheDirName = "tier-cache"
+
+	// tierRetryInterval is how long a failed upload waits before its retry
+	tierRetryInterval = 30 * time.Second
+)
+
+// tierEntry is a local file counted against the budget: an uploaded segment
+// or a cached block of one
+type tierEntry struct {
+	path    string
+	size    int64
+	segment *tierSegment // set for segments
+	element *list.Element
+}
+
+// tierSegment is an uploaded segment
+type tierSegment struct {
+	key   string
+	size  int64
+	local *tierEntry // nil once the local copy is removed
+}
+
+// tierUpload is a sealed segment waiting to be uploaded
+type tierUpload struct {
+	stream *fileStream
+	file   string
+}
+
+// segmentTier tracks uploaded segments and the block cache.
+type segmentTier struct {
+	objects    ObjectStore
+	cacheDir   string
+	budget     int64
+	blockBytes int64
+	pool       *ReaderPool
+
+	mu       sync.Mutex
+	lru      *list.List // of *tierEntry, most recently read first
+	used     int64
+	segments map[string]*tierSegment  // segment path -> uploaded segment
+	blocks   map[string]*tierEntry    // block path -> cached block
+	fetching map[string]chan struct{} // block path -> in-flight fetch
+
+	queueMu sync.Mutex
+	queue   []tierUpload
+	wake    chan struct{}
+	closed  bool
+	ctx     context.Context
+	cancel  context.CancelFunc
+	done    chan struct{}
+}
+
+func newSegmentTier(objects ObjectStore, dataDir string, budget, blockBytes int64, pool *ReaderPool) (*segmentTier, error) {
+	if budget <= 0 {
+		budget = DefaultTierLocalBytes
+	}
+	if blockBytes <= 0 {
+		blockBytes = DefaultTierBlockBytes
+	}
+	// Cached blocks are refetched on demand; start from an empty cache
+	cacheDir := filepath.Join(dataDir, tierCacheDirName)
+	if err := os.RemoveAll(cacheDir); err != nil {
+		return nil, fmt.Errorf("failed to clear tier cache: %w", err)
+	}
+	ctx, cancel := context.WithCancel(context.Background())
+	return &segmentTier{
+		objects:    objects,
+		cacheDir:   cacheDir,
+		budget:     budget,
+		blockBytes: blockBytes,
+		pool:       pool,
+		lru:        list.New(),
+		segments:   make(map[string]*tierSegment),
+		blocks:     make(map[string]*tierEntry),
+		fetching:   make(map[string]chan struct{}),
+		wake:       make(chan struct{}, 1),
+		ctx:        ctx,
+		cancel:     cancel,
+		done:       make(chan struct{}),
+	}, nil
+}
+
+// objectKey returns the object store key of a stream's segment file
+func objectKey(dirName, file string) string {
+	return dirName + "/" + file
+}
+
+// addSegment records an uploaded segment, counting its local copy if it
+// still has one
+func (t *segmentTier) addSegment(segPath, key string, size int64, local bool) {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	seg := &tierSegment{key: key, size: size}
+	t.segments[segPath] = seg
+	if local {
+		seg.local = &tierEntry{path: segPath, size: size, segment: seg}
+		t.insertLocked(seg.local)
+	}
+}
+
+// insertLocked adds a local file as the most recently read and enforces the
+// budget. The new file itself is kept even if it alone exceeds the budget,
+// as a just fetched block is about to be read. Caller must hold t.mu.
+func (t *segmentTier) insertLocked(e *tierEntry) {
+	e.element = t.lru.PushFront(e)
+	t.used += e.size
+	for t.used > t.budget {
+		back := t.lru.Back()
+		if back == nil || back.Value.(*tierEntry) == e {
+			return
+		}
+		t.evictLocked(back.Value.(*tierEntry))
+	}
+}
+
+// evictLocked removes a local file. Readers that already hold it open keep
+// reading the unlinked file. Caller must hold t.mu.
+func (t *segmentTier) evictLocked(e *tierEntry) {
+	t.forgetLocked(e)
+	if e.segment != nil {
+		t.pool.Remove(e.path)
+	}
+	os.Remove(e.path)
+	metrics.TierEvictions.Inc()
+}
+
+// forgetLocked stops counting a local file. Caller must hold t.mu.
+func (t *segmentTier) forgetLocked(e *tierEntry) {
+	t.lru.Remove(e.element)
+	t.used -= e.size
+	if e.segment != nil {
+		e.segment.local = nil
+	} else {
+		delete(t.blocks, e.path)
+	}
+}
+
+// touch marks an uploaded segment's local copy as just read
+func (t *segmentTier) touch(segPath string) {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	if seg := t.segments[segPath]; seg != nil && seg.local != nil {
+		t.lru.MoveToFront(seg.local.element)
+	}
+}
+
+// remote returns a reader over an uploaded segment served from the object
+// store, or false if segPath was never uploaded
+func (t *segmentTier) remote(segPath string) (io.ReaderAt, bool) {
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	seg := t.segments[segPath]
+	if seg == nil {
+		return nil, false
+	}
+	return &remoteSegment{tier: t, seg: seg}, true
+}
+
+// dropStream forgets a removed stream's segments and cached blocks and
+// deletes its objects in the background
+func (t *segmentTier) dropStream(dirName string, segPaths, keys []string) {
+	t.mu.Lock()
+	for _, segPath := range segPaths {
+		if seg := t.segments[segPath]; seg != nil {
+			if seg.local != nil {
+				t.forgetLocked(seg.local)
+			}
+			delete(t.segments, segPath)
+		}
+	}
+	prefix := filepath.Join(t.cacheDir, dirName) + string(filepath.Separator)
+	for path, e := range t.blocks {
+		if strings.HasPrefix(path, prefix) {
+			t.forgetLocked(e)
+		}
+	}
+	t.mu.Unlock()
+
+	os.RemoveAll(strings.TrimSuffix(prefix, string(filepath.Separator)))
+	if len(keys) > 0 {
+		go func() {
+			for _, key := range keys {
+				t.objects.Delete(t.ctx, key)
+			}
+		}()
+	}
+}
+
+// block returns cached block idx of seg as an open file, fetching it first
+// if it is not cached
+func (t *segmentTier) block(seg *tierSegment, idx int64) (*os.File, error) {
+	path := filepath.Join(t.cacheDir, filepath.FromSlash(seg.key)) + fmt.Sprintf(".%d", idx)
+	for {
+		t.mu.Lock()
+		if e := t.blocks[path]; e != nil {
+			t.lru.MoveToFront(e.element)
+			t.mu.Unlock()
+			f, err := os.Open(path)
+			if err == nil {
+				metrics.TierCacheHits.Inc()
+				return f, nil
+			}
+			if !errors.Is(err, os.ErrNotExist) {
+				return nil, err
+			}
+			// Evicted since the lookup: fetch it again
+			t.mu.Lock()
+			if e := t.blocks[path]; e != nil {
+				t.forgetLocked(e)
+			}
+			t.mu.Unlock()
+			continue
+		}
+		if wait, ok := t.fetching[path]; ok {
+			t.mu.Unlock()
+			<-wait
+			continue
+		}
+		wait := make(chan struct{})
+		t.fetching[path] = wait
+		t.mu.Unlock()
+
+		err := t.fetch(seg, idx, path)
+
+		t.mu.Lock()
+		delete(t.fetching, path)
+		close(wait)
+		t.mu.Unlock()
+		if err != nil {
+			return nil, err
+		}
+	}
+}
+
+// fetch downloads block idx of seg to path and records it in the cache
+func (t *segmentTier) fetch(seg *tierSegment, idx int64, path string) error {
+	offset := idx * t.blockBytes
+	data, err := t.objects.GetRange(t.ctx, seg.key, offset, min(t.blockBytes, seg.size-offset))
+	if err != nil {
+		return fmt.Errorf("failed to fetch segment range: %w", err)
+	}
+	metrics.TierFetches.Inc()
+
+	if err := os.MkdirAll(filepath.Dir(path), 0755); err != nil {
+		return err
+	}
+	// The cache needs no durability, only that a block is never seen partial
+	tmp := path + ".tmp"
+	if err := os.WriteFile(tmp, data, 0644); err != nil {
+		return err
+	}
+	if err := os.Rename(tmp, path); err != nil {
+		return err
+	}
+
+	t.mu.Lock()
+	defer t.mu.Unlock()
+	e := &tierEntry{path: path, size: int64(len(data))}
+	t.blocks[path] = e
+	t.insertLocked(e)
+	return nil
+}
+
+// remoteSegment reads an uploaded segment whose local copy was removed,
+// block by block through the cache
+type remoteSegment struct {
+	tier *segmentTier
+	seg  *tierSegment
+}
+
+func (r *remoteSegment) ReadAt(p []byte, off int64) (int, error) {
+	n := 0
+	for n < len(p) {
+		pos := off + int64(n)
+		if pos >= r.seg.size {
+			return n, io.EOF
+		}
+		idx := pos / r.tier.blockBytes
+		f, err := r.tier.block(r.seg, idx)
+		if err != nil {
+			return n, err
+		}
+		want := min(int64(len(p)-n), (idx+1)*r.tier.blockBytes-pos)
+		m, err := f.ReadAt(p[n:n+int(want)], pos-idx*r.tier.blockBytes)
+		f.Close()
+		n += m
+		if err != nil && err != io.EOF {
+			return n, err
+		}
+		if m == 0 {
+			return n, io.ErrUnexpectedEOF
+		}
+	}
+	return n, nil
+}
+
+// enqueue schedules a sealed segment for upload
+func (t *segmentTier) enqueue(job tierUpload) {
+	t.queueMu.Lock()
+	defer t.queueMu.Unlock()
+	if t.closed {
+		return
+	}
+	t.queue = append(t.queue, job)
+	select {
+	case t.wake <- struct{}{}:
+	default:
+	}
+}
+
+// next blocks until an upload is queued or the tier is closed
+func (t *segmentTier) next() (tierUpload, bool) {
+	for {
+		t.queueMu.Lock()
+		if t.closed {
+			t.queueMu.Unlock()
+			return tierUpload{}, false
+		}
+		if len(t.queue) > 0 {
+			job := t.queue[0]
+			t.queue[0] = tierUpload{}
+			t.queue = t.queue[1:]
+			t.queueMu.Unlock()
+			return job, true
+		}
+		t.queueMu.Unlock()
+		<-t.wake
+	}
+}
+
+// close stops the upload worker, abandoning queued uploads (they are queued
+// again at the next start) and canceling object store requests
+func (t *segmentTier) close() {
+	t.queueMu.Lock()
+	t.closed = true
+	t.queueMu.Unlock()
+	t.cancel()
+	select {
+	case t.wake <- struct{}{}:
+	default:
+	}
+	<-t.done
+}
+
+// runUploads uploads queued segments one at a time until the tier is closed.
+// Failed uploads are retried after tierRetryInterval.
+func (s *FileStore) runUploads() {
+	defer close(s.tier.done)
+	for {
+		job, ok := s.tier.next()
+		if !ok {
+			return
+		}
+		if err := s.uploadSegment(job); err != nil && s.tier.ctx.Err() == nil {
+			if s.onTierError != nil {
+				s.onTierError(err)
+			}
+			time.AfterFunc(tierRetryInterval, func() { s.tier.enqueue(job) })
+		}
+	}
+}
+
+// uploadSegment uploads one sealed segment and marks it Remote in the
+// stream's manifest
+func (s *FileStore) uploadSegment(job tierUpload) error {
+	st := job.stream
+	st.mu.RLock()
+	removed := st.removed
+	layout := st.layout()
+	st.mu.RUnlock()
+	i := layout.index(job.file)
+	if removed || i < 0 || i == layout.active() || layout.segments[i].Remote {
+		return nil
+	}
+
+	// Appends acknowledged before the rotation may still await their commit
+	segPath := layout.path(s.dataDir, i)
+	if err := syncByPath(segPath); err != nil {
+		return fmt.Errorf("failed to sync segment %s: %w", segPath, err)
+	}
+	f, err := os.Open(segPath)
+	if err != nil {
+		return fmt.Errorf("failed to open segment %s: %w", segPath, err)
+	}
+	defer f.Close()
+	info, err := f.Stat()
+	if err != nil {
+		return err
+	}
+	key := objectKey(layout.dirName, job.file)
+	if err := s.tier.objects.Put(s.tier.ctx, key, f, info.Size()); err != nil {
+		return fmt.Errorf("failed to upload segment %s: %w", segPath, err)
+	}
+	metrics.TierUploads.Inc()
+
+	st.mu.Lock()
+	defer st.mu.Unlock()
+	if st.removed {
+		// Deleted during the upload; its objects are not tracked anywhere
+		go s.tier.objects.Delete(s.tier.ctx, key)
+		return nil
+	}
+	segments := slices.Clone(st.segments)
+	i = streamLayout{segments: segments}.index(job.file)
+	segments[i].Remote = true
+	segments[i].Size = info.Size()
+	if err := writeManifest(filepath.Join(s.dataDir, "streams", st.dirName), segments); err != nil {
+		return err
+	}
+	st.segments = segments
+	s.tier.addSegment(segPath, key, info.Size(), true)
+	return nil
+}
+
+// registerTiered records a loaded stream's uploaded segments and queues the
+// sealed ones not yet uploaded
+func (s *FileStore) registerTiered(st *fileStream) {
+	layout := st.layout()
+	for i, seg := range layout.segments[:layout.active()] {
+		if !seg.Remote {
+			s.tier.enqueue(tierUpload{stream: st, file: seg.File})
+			continue
+		}
+		segPath := layout.path(s.dataDir, i)
+		_, err := os.Stat(segPath)
+		s.tier.addSegment(segPath, objectKey(layout.dirName, seg.File), seg.Size, err == nil)
+	}
+}
+
+// openSegment returns a reader over a segment file: the pooled local file, or
+// for an offloaded segment the object store through the block cache.
+func (s *FileStore) openSegment(segPath string) (io.ReaderAt, func(), error) {
+	file, release, err := s.readerPool.Acquire(segPath)
+	if err == nil {
+		if s.tier != nil {
+			s.tier.touch(segPath)
+		}
+		return file, release, nil
+	}
+	if s.tier != nil && errors.Is(err, os.ErrNotExist) {
+		if r, ok := s.tier.remote(segPath); ok {
+			return r, func() {}, nil
+		}
+	}
+	return nil, nil, err
+}
@@ -0,0 +1,142 @@
+package store
+
+import (
+	"bytes"
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+)
+
+// newTieredFileStore opens a rotating file store offloading to objects that
+// keeps at most localBytes of uploaded segments and cached blocks on disk
+func newTieredFileStore(t *testing.T, dir string, objects ObjectStore, localBytes int64) *FileStore {
+	t.Helper()
+	store, err := NewFileStore(FileStoreConfig{
+		DataDir:         dir,
+		SegmentMaxBytes: 64,
+		TailCacheBytes:  -1,
+		Objects:         objects,
+		TierLocalBytes:  localBytes,
+		TierBlockBytes:  16,
+		OnTierError:     func(err error) { t.Errorf("tier error: %v", err) },
+	})
+	if err != nil {
+		t.Fatalf("failed to create store: %v", err)
+	}
+	return store
+}
+
+// waitUploaded waits until every sealed segment of path is marked Remote
+func waitUploaded(t *testing.T, store *FileStore, path string) streamLayout {
+	t.Helper()
+	deadline := time.Now().Add(5 * time.Second)
+	for {
+		_, _, layout, _ := store.view(path)
+		uploaded := true
+		for _, seg := range layout.segments[:layout.active()] {
+			uploaded = uploaded && seg.Remote
+		}
+		if uploaded {
+			return layout
+		}
+		if time.Now().After(deadline) {
+			t.Fatalf("sealed segments not uploaded: %+v", layout.segments)
+		}
+		time.Sleep(5 * time.Millisecond)
+	}
+}
+
+func TestFileStore_TieredReadsOffloadedSegments(t *testing.T) {
+	tmpDir := t.TempDir()
+	objects := &DirObjectStore{Root: t.TempDir()}
+	// A budget below one segment: uploaded segments are removed as soon as
+	// the next one is added
+	store := newTieredFileStore(t, tmpDir, objects, 1)
+
+	if _, _, err := store.Create("/s", CreateOptions{ContentType: "text/plain"}); err != nil {
+		t.Fatalf("Create failed: %v", err)
+	}
+	appendPayloads(t, store, "/s", 0, 20)
+	layout := waitUploaded(t, store, "/s")
+	if len(layout.segments) != 4 {
+		t.Fatalf("expected 4 segments, got %d", len(layout.segments))
+	}
+
+	for i, seg := range layout.segments {
+		_, localErr := os.Stat(layout.path(tmpDir, i))
+		_, remoteErr := os.Stat(objects.path(objectKey(layout.dirName, seg.File)))
+		if i == layout.active() {
+			if localErr != nil || remoteErr == nil {
+				t.Errorf("active segment must stay local only (local: %v, remote: %v)", localErr, remoteErr)
+			}
+			continue
+		}
+		if i == layout.active()-1 {
+			continue
+		}
+		if !os.IsNotExist(localErr) || remoteErr != nil {
+			t.Errorf("segment %d should be offloaded (local: %v, remote: %v)", i, localErr, remoteErr)
+		}
+	}
+
+	// Cold reads are served from the object store through the block cache
+	expectPayloads(t, store, "/s", ZeroOffset, 0, 20)
+	chunk, err := store.ReadRaw("/s", ZeroOffset, ReadLimits{})
+	if err != nil {
+		t.Fatalf("ReadRaw failed: %v", err)
+	}
+	var buf bytes.Buffer
+	if _, err := chunk.WriteTo(&buf); err != nil {
+		t.Fatalf("WriteTo failed: %v", err)
+	}
+	if !bytes.HasPrefix(buf.Bytes(), []byte("message-000message-001")) || int64(buf.Len()) != chunk.Size {
+		t.Errorf("unexpected raw chunk %q", buf.Bytes())
+	}
+
+	// The manifest remembers where segments live across a restart
+	if err := store.Close(); err != nil {
+		t.Fatalf("Close failed: %v", err)
+	}
+	store = newTieredFileStore(t, tmpDir, objects, 1)
+	expectPayloads(t, store, "/s", ZeroOffset, 0, 20)
+
+	if err := store.Delete("/s"); err != nil {
+		t.Fatalf("Delete failed: %v", err)
+	}
+	deadline := time.Now().Add(5 * time.Second)
+	for {
+		entries, _ := os.ReadDir(filepath.Join(objects.Root, layout.dirName))
+		if len(entries) == 0 {
+			break
+		}
+		if time.Now().After(deadline) {
+			t.Fatalf("objects of a deleted stream not removed: %v", entries)
+		}
+		time.Sleep(5 * time.Millisecond)
+	}
+	store.Close()
+}
+
+func TestFileStore_TieredKeepsRecentlyReadSegmentsLocal(t *testing.T) {
+	tmpDir := t.TempDir()
+	objects := &DirObjectStore{Root: t.TempDir()}
+	// Room for a little over two sealed segments
+	store := newTieredFileStore(t, tmpDir, objects, 160)
+	defer store.Close()
+
+	store.Create("/s", CreateOptions{ContentType: "text/plain"})
+	appendPayloads(t, store, "/s", 0, 20)
+	layout := waitUploaded(t, store, "/s")
+
+	_, err := os.Stat(layout.path(tmpDir, 0))
+	if !os.IsNotExist(err) {
+		t.Errorf("oldest segment should be removed past the budget, got %v", err)
+	}
+	for i := 1; i < layout.active(); i++ {
+		if _, err := os.Stat(layout.path(tmpDir, i)); err != nil {
+			t.Errorf("segment %d should stay local: %v", i, err)
+		}
+	}
+	expectPayloads(t, store, "/s", ZeroOffset, 0, 20)
+}
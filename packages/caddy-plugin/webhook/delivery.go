@@ -0,0 +1,235 @@
+package webhook
+
+import (
+	"container/heap"
+	"net/http"
+	"net/url"
+	"slices"
+	"sync"
+	"time"
+)
+
+// maxDeliveriesPerDestination bounds the concurrent webhook POSTs to one
+// endpoint (scheme + host)
+const maxDeliveriesPerDestination = 8
+
+// newDeliveryClient returns the HTTP client shared by all deliveries. It
+// keeps enough idle connections per host for every delivery worker, so a
+// burst reuses keep-alive and HTTP/2 connections instead of dialing.
+func newDeliveryClient() *http.Client {
+	transport := http.DefaultTransport.(*http.Transport).Clone()
+	transport.ForceAttemptHTTP2 = true
+	transport.MaxIdleConnsPerHost = maxDeliveriesPerDestination
+	return &http.Client{
+		Timeout:   webhookRequestTimeout,
+		Transport: transport,
+	}
+}
+
+// delivery is a webhook POST waking one consumer
+type delivery struct {
+	consumer    *ConsumerInstance
+	sub         *Subscription
+	payload     map[string]interface{}
+	triggeredBy []string
+}
+
+// deliveryPool runs webhook deliveries on bounded per-destination workers.
+//
+// Workers are started on demand, up to maxDeliveriesPerDestination per
+// endpoint, and exit once their endpoint's queue is empty, so a burst of
+// wakes costs a bounded number of goroutines and connections per endpoint.
+// A consumer has at most one queued delivery: a wake submitted while an
+// earlier one is still queued replaces its payload and merges the
+// triggering streams into it.
+type deliveryPool struct {
+	deliver func(*delivery)
+
+	mu           sync.Mutex
+	queued       map[*ConsumerInstance]*delivery // Deliveries not yet started
+	destinations map[string]*destinationQueue
+	closed       bool
+}
+
+type destinationQueue struct {
+	pending []*delivery
+	workers int
+}
+
+func newDeliveryPool(deliver func(*delivery)) *deliveryPool {
+	return &deliveryPool{
+		deliver:      deliver,
+		queued:       make(map[*ConsumerInstance]*delivery),
+		destinations: make(map[string]*destinationQueue),
+	}
+}
+
+// submit queues d, or coalesces it into the consumer's queued delivery
+func (p *deliveryPool) submit(d *delivery) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	if p.closed {
+		return
+	}
+
+	if queued, ok := p.queued[d.consumer]; ok {
+		// The newer wake's epoch and wake_id supersede the queued ones
+		queued.sub = d.sub
+		queued.payload = d.payload
+		for _, path := range d.triggeredBy {
+			if !slices.Contains(queued.triggeredBy, path) {
+				queued.triggeredBy = append(queued.triggeredBy, path)
+			}
+		}
+		queued.payload["triggered_by"] = queued.triggeredBy
+		return
+	}
+
+	p.queued[d.consumer] = d
+	key := destinationKey(d.sub.Webhook)
+	q := p.destinations[key]
+	if q == nil {
+		q = &destinationQueue{}
+		p.destinations[key] = q
+	}
+	q.pending = append(q.pending, d)
+	if q.workers < maxDeliveriesPerDestination {
+		q.workers++
+		go p.work(key, q)
+	}
+}
+
+func (p *deliveryPool) work(key string, q *destinationQueue) {
+	for {
+		p.mu.Lock()
+		if len(q.pending) == 0 || p.closed {
+			q.workers--
+			if q.workers == 0 {
+				delete(p.destinations, key)
+			}
+			p.mu.Unlock()
+			return
+		}
+		d := q.pending[0]
+		q.pending[0] = nil
+		q.pending = q.pending[1:]
+		delete(p.queued, d.consumer)
+		p.mu.Unlock()
+
+		p.deliver(d)
+	}
+}
+
+// close drops queued deliveries and stops accepting new ones. Deliveries in
+// flight run to completion.
+func (p *deliveryPool) close() {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	p.closed = true
+	clear(p.queued)
+	for _, q := range p.destinations {
+		q.pending = nil
+	}
+}
+
+// destinationKey groups webhook URLs by the endpoint they connect to
+func destinationKey(webhookURL string) string {
+	u, err := url.Parse(webhookURL)
+	if err != nil || u.Host == "" {
+		return webhookURL
+	}
+	return u.Scheme + "://" + u.Host
+}
+
+// retryScheduler fires delayed delivery retries from one shared timer rather
+// than a goroutine and timer per pending retry.
+type retryScheduler struct {
+	fire func(*delivery)
+
+	mu     sync.Mutex
+	items  retryHeap
+	timer  *time.Timer
+	closed bool
+}
+
+type retryItem struct {
+	at     time.Time
+	d      *delivery
+	cancel <-chan struct{} // Closed if the retry is cancelled
+}
+
+func newRetryScheduler(fire func(*delivery)) *retryScheduler {
+	return &retryScheduler{fire: fire}
+}
+
+// schedule fires d at at, unless cancel is closed first
+func (s *retryScheduler) schedule(at time.Time, d *delivery, cancel <-chan struct{}) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if s.closed {
+		return
+	}
+	heap.Push(&s.items, retryItem{at: at, d: d, cancel: cancel})
+	if s.items[0].d == d {
+		s.armLocked()
+	}
+}
+
+// armLocked sets the timer for the earliest retry
+func (s *retryScheduler) armLocked() {
+	if len(s.items) == 0 {
+		return
+	}
+	wait := time.Until(s.items[0].at)
+	if s.timer == nil {
+		s.timer = time.AfterFunc(wait, s.run)
+	} else {
+		s.timer.Reset(wait)
+	}
+}
+
+func (s *retryScheduler) run() {
+	s.mu.Lock()
+	var due []retryItem
+	now := time.Now()
+	for len(s.items) > 0 && !s.items[0].at.After(now) {
+		due = append(due, heap.Pop(&s.items).(retryItem))
+	}
+	if !s.closed {
+		s.armLocked()
+	}
+	s.mu.Unlock()
+
+	for _, item := range due {
+		select {
+		case <-item.cancel:
+		default:
+			s.fire(item.d)
+		}
+	}
+}
+
+// close drops all pending retries
+func (s *retryScheduler) close() {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	s.closed = true
+	s.items = nil
+	if s.timer != nil {
+		s.timer.Stop()
+	}
+}
+
+type retryHeap []retryItem
+
+func (h retryHeap) Len() int           { return len(h) }
+func (h retryHeap) Less(i, j int) bool { return h[i].at.Before(h[j].at) }
+func (h retryHeap) Swap(i, j int)      { h[i], h[j] = h[j], h[i] }
+func (h *retryHeap) Push(x any)        { *h = append(*h, x.(retryItem)) }
+
+func (h *retryHeap) Pop() any {
+	old := *h
+	item := old[len(old)-1]
+	*h = old[:len(old)-1]
+	return item
+}
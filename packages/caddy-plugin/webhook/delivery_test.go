@@ -0,0 +1,121 @@
+package webhook
+
+import (
+	"slices"
+	"sync"
+	"sync/atomic"
+	"testing"
+	"time"
+)
+
+func TestDeliveryPool_CoalescesQueuedWakes(t *testing.T) {
+	release := make(chan struct{})
+	var mu sync.Mutex
+	var delivered []*delivery
+	p := newDeliveryPool(func(d *delivery) {
+		<-release
+		mu.Lock()
+		delivered = append(delivered, d)
+		mu.Unlock()
+	})
+
+	sub := &Subscription{SubscriptionID: "s", Webhook: "http://hooks.example/a"}
+	busy := make([]*ConsumerInstance, maxDeliveriesPerDestination)
+	for i := range busy {
+		busy[i] = &ConsumerInstance{}
+		p.submit(&delivery{consumer: busy[i], sub: sub, payload: map[string]interface{}{}})
+	}
+
+	// Every worker is now busy, so these stay queued and coalesce
+	c := &ConsumerInstance{}
+	p.submit(&delivery{consumer: c, sub: sub, payload: map[string]interface{}{"epoch": 1}, triggeredBy: []string{"/a"}})
+	p.submit(&delivery{consumer: c, sub: sub, payload: map[string]interface{}{"epoch": 2}, triggeredBy: []string{"/b", "/a"}})
+	close(release)
+
+	deadline := time.Now().Add(5 * time.Second)
+	for {
+		mu.Lock()
+		n := len(delivered)
+		mu.Unlock()
+		if n == len(busy)+1 {
+			break
+		}
+		if time.Now().After(deadline) {
+			t.Fatalf("got %d deliveries, want %d", n, len(busy)+1)
+		}
+		time.Sleep(time.Millisecond)
+	}
+
+	mu.Lock()
+	defer mu.Unlock()
+	i := slices.IndexFunc(delivered, func(d *delivery) bool { return d.consumer == c })
+	if i < 0 {
+		t.Fatal("coalesced delivery missing")
+	}
+	d := delivered[i]
+	if d.payload["epoch"] != 2 {
+		t.Errorf("epoch = %v, want the newer wake's 2", d.payload["epoch"])
+	}
+	if got := d.payload["triggered_by"]; !slices.Equal(got.([]string), []string{"/a", "/b"}) {
+		t.Errorf("triggered_by = %v, want [/a /b]", got)
+	}
+}
+
+func TestDeliveryPool_BoundsWorkersPerDestination(t *testing.T) {
+	var active, peak atomic.Int32
+	var wg sync.WaitGroup
+	p := newDeliveryPool(func(d *delivery) {
+		defer wg.Done()
+		n := active.Add(1)
+		for {
+			old := peak.Load()
+			if n <= old || peak.CompareAndSwap(old, n) {
+				break
+			}
+		}
+		time.Sleep(time.Millisecond)
+		active.Add(-1)
+	})
+
+	sub := &Subscription{Webhook: "https://hooks.example/path"}
+	const n = 10 * maxDeliveriesPerDestination
+	wg.Add(n)
+	for i := 0; i < n; i++ {
+		p.submit(&delivery{consumer: &ConsumerInstance{}, sub: sub, payload: map[string]interface{}{}})
+	}
+	wg.Wait()
+
+	if got := peak.Load(); got > maxDeliveriesPerDestination {
+		t.Fatalf("peak concurrency %d exceeds %d", got, maxDeliveriesPerDestination)
+	}
+}
+
+func TestRetryScheduler_FiresInOrderAndHonoursCancel(t *testing.T) {
+	fired := make(chan *delivery, 3)
+	s := newRetryScheduler(func(d *delivery) { fired <- d })
+	defer s.close()
+
+	first, second, cancelled := &delivery{}, &delivery{}, &delivery{}
+	cancel := make(chan struct{})
+	now := time.Now()
+	s.schedule(now.Add(20*time.Millisecond), second, nil)
+	s.schedule(now.Add(10*time.Millisecond), cancelled, cancel)
+	s.schedule(now.Add(5*time.Millisecond), first, nil)
+	close(cancel)
+
+	for _, want := range []*delivery{first, second} {
+		select {
+		case got := <-fired:
+			if got != want {
+				t.Fatal("retries fired out of order or cancelled retry fired")
+			}
+		case <-time.After(5 * time.Second):
+			t.Fatal("retry did not fire")
+		}
+	}
+	select {
+	case <-fired:
+		t.Fatal("cancelled retry fired")
+	case <-time.After(20 * time.Millisecond):
+	}
+}
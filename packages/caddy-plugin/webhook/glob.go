@@ -1,6 +1,9 @@
 package webhook
 
-import "strings"
+import (
+	"slices"
+	"strings"
+)
 
 // GlobMatch matches a stream path against a glob pattern.
 // Supports: * (one segment), ** (zero or more segments), literal, %2A decoding.
@@ -55,3 +58,133 @@ func matchParts(pattern []string, pi int, path []string, si int) bool {
 
 	return pi == len(pattern) && si == len(path)
 }
+
+// globIndex is a path-segment trie over subscription patterns. Matching a
+// path walks only the trie branches its segments can take, so its cost
+// depends on path depth and the patterns sharing its prefixes rather than on
+// the total number of subscriptions. It matches exactly what GlobMatch does.
+type globIndex struct {
+	root globNode
+}
+
+type globNode struct {
+	literals map[string]*globNode // Decoded literal segment -> child
+	star     *globNode            // Child for a * segment
+	globstar *globNode            // Child for a ** segment
+
+	subs map[string]*Subscription // Subscriptions whose pattern ends here, by ID
+}
+
+func (n *globNode) empty() bool {
+	return len(n.literals) == 0 && n.star == nil && n.globstar == nil && len(n.subs) == 0
+}
+
+// decodeLiteral decodes %2A in a literal pattern segment, as GlobMatch does
+func decodeLiteral(seg string) string {
+	seg = strings.ReplaceAll(seg, "%2A", "*")
+	return strings.ReplaceAll(seg, "%2a", "*")
+}
+
+// add indexes sub under its pattern
+func (x *globIndex) add(sub *Subscription) {
+	n := &x.root
+	for _, seg := range splitPath(sub.Pattern) {
+		switch seg {
+		case "**":
+			if n.globstar == nil {
+				n.globstar = &globNode{}
+			}
+			n = n.globstar
+		case "*":
+			if n.star == nil {
+				n.star = &globNode{}
+			}
+			n = n.star
+		default:
+			lit := decodeLiteral(seg)
+			child := n.literals[lit]
+			if child == nil {
+				if n.literals == nil {
+					n.literals = make(map[string]*globNode)
+				}
+				child = &globNode{}
+				n.literals[lit] = child
+			}
+			n = child
+		}
+	}
+	if n.subs == nil {
+		n.subs = make(map[string]*Subscription)
+	}
+	n.subs[sub.SubscriptionID] = sub
+}
+
+// remove unindexes sub and prunes the nodes left empty
+func (x *globIndex) remove(sub *Subscription) {
+	removeFrom(&x.root, splitPath(sub.Pattern), sub.SubscriptionID)
+}
+
+// removeFrom removes id below n and reports whether n is now empty
+func removeFrom(n *globNode, parts []string, id string) bool {
+	if len(parts) == 0 {
+		delete(n.subs, id)
+		return n.empty()
+	}
+
+	switch seg := parts[0]; seg {
+	case "**":
+		if n.globstar != nil && removeFrom(n.globstar, parts[1:], id) {
+			n.globstar = nil
+		}
+	case "*":
+		if n.star != nil && removeFrom(n.star, parts[1:], id) {
+			n.star = nil
+		}
+	default:
+		lit := decodeLiteral(seg)
+		if child := n.literals[lit]; child != nil && removeFrom(child, parts[1:], id) {
+			delete(n.literals, lit)
+		}
+	}
+	return n.empty()
+}
+
+// match returns the subscriptions whose pattern matches path
+func (x *globIndex) match(path string) []*Subscription {
+	var ends []*globNode
+	collectMatches(&x.root, splitPath(path), &ends)
+
+	var result []*Subscription
+	for _, n := range ends {
+		for _, sub := range n.subs {
+			result = append(result, sub)
+		}
+	}
+	return result
+}
+
+// collectMatches adds to ends every node with subscriptions reached by
+// matching parts from n. A node reachable along several ** expansions is
+// added once.
+func collectMatches(n *globNode, parts []string, ends *[]*globNode) {
+	if n.globstar != nil {
+		// ** matches zero or more segments
+		for i := 0; i <= len(parts); i++ {
+			collectMatches(n.globstar, parts[i:], ends)
+		}
+	}
+
+	if len(parts) == 0 {
+		if len(n.subs) > 0 && !slices.Contains(*ends, n) {
+			*ends = append(*ends, n)
+		}
+		return
+	}
+
+	if child := n.literals[parts[0]]; child != nil {
+		collectMatches(child, parts[1:], ends)
+	}
+	if n.star != nil {
+		collectMatches(n.star, parts[1:], ends)
+	}
+}
@@ -0,0 +1,91 @@
+package webhook
+
+import (
+	"slices"
+	"testing"
+)
+
+func TestGlobIndex_MatchesLikeGlobMatch(t *testing.T) {
+	patterns := []string{
+		"", "/**", "/*", "/a", "/a/*", "/a/**", "/a/**/z", "/**/z", "/*/b/**",
+		"/a/%2A", "/**/**/c", "/a/b/c", "/x/*/*",
+	}
+	paths := []string{
+		"", "/a", "/a/b", "/a/b/c", "/a/z", "/a/b/z", "/q/b", "/q/b/c/d",
+		"/a/*", "/x/y", "/x/y/z", "/c", "/a/b/c/c",
+	}
+
+	var x globIndex
+	for i, p := range patterns {
+		x.add(&Subscription{SubscriptionID: string(rune('A' + i)), Pattern: p})
+	}
+
+	for _, path := range paths {
+		var want []string
+		for i, p := range patterns {
+			if GlobMatch(p, path) {
+				want = append(want, string(rune('A'+i)))
+			}
+		}
+		var got []string
+		for _, sub := range x.match(path) {
+			got = append(got, sub.SubscriptionID)
+		}
+		slices.Sort(got)
+		if !slices.Equal(got, want) {
+			t.Errorf("match(%q) = %v, want %v", path, got, want)
+		}
+	}
+}
+
+func TestGlobIndex_RemovePrunesNodes(t *testing.T) {
+	var x globIndex
+	a := &Subscription{SubscriptionID: "a", Pattern: "/a/**/z"}
+	b := &Subscription{SubscriptionID: "b", Pattern: "/a/*"}
+	x.add(a)
+	x.add(b)
+
+	x.remove(a)
+	if got := x.match("/a/b/z"); len(got) != 0 {
+		t.Fatalf("removed subscription still matches: %v", got)
+	}
+	if got := x.match("/a/b"); len(got) != 1 || got[0] != b {
+		t.Fatalf("remaining subscription not matched: %v", got)
+	}
+
+	x.remove(b)
+	if !x.root.empty() {
+		t.Fatal("trie not pruned after removing every subscription")
+	}
+}
+
+func TestStore_StreamConsumersCopiedOnWrite(t *testing.T) {
+	s := NewStore()
+	if _, _, err := s.CreateSubscription("s1", "/**", "http://example.com", ""); err != nil {
+		t.Fatal(err)
+	}
+	if _, _, err := s.CreateSubscription("s2", "/a/*", "http://example.com", ""); err != nil {
+		t.Fatal(err)
+	}
+	for _, sub := range s.FindMatchingSubscriptions("/a/b") {
+		s.GetOrCreateConsumer(sub.SubscriptionID, "/a/b")
+	}
+
+	before := s.GetConsumersForStream("/a/b")
+	if len(before) != 2 {
+		t.Fatalf("got %d consumers, want 2", len(before))
+	}
+	first := before[0]
+
+	s.DeleteSubscription(before[1].SubscriptionID)
+	if len(before) != 2 || before[0] != first {
+		t.Fatal("handed-out consumer slice was modified")
+	}
+	if after := s.GetConsumersForStream("/a/b"); len(after) != 1 || after[0] != first {
+		t.Fatalf("got %v after delete, want only %s", after, first.ConsumerID)
+	}
+
+	if allocs := testing.AllocsPerRun(100, func() { s.GetConsumersForStream("/a/b") }); allocs != 0 {
+		t.Fatalf("GetConsumersForStream allocates %v times", allocs)
+	}
+}
@@ -39,6 +39,8 @@ type Manager struct {
 	client          *http.Client
 	logger          *zap.Logger
 	enrichPayload   EnrichPayloadFunc
+	deliveries      *deliveryPool
+	retries         *retryScheduler
 
 	mu           sync.Mutex
 	shuttingDown bool
@@ -50,11 +52,11 @@ func NewManager(callbackBaseURL string, getTailOffset func(string) string, logge
 		Store:           NewStore(),
 		callbackBaseURL: callbackBaseURL,
 		getTailOffset:   getTailOffset,
-		client: &http.Client{
-			Timeout: webhookRequestTimeout,
-		},
-		logger: logger,
+		client:          newDeliveryClient(),
+		logger:          logger,
 	}
+	m.deliveries = newDeliveryPool(m.deliverWebhook)
+	m.retries = newRetryScheduler(m.retryDelivery)
 	if opts != nil {
 		m.enrichPayload = opts.EnrichPayload
 	}
@@ -70,14 +72,12 @@ func (m *Manager) OnStreamAppend(streamPath string) {
 	}
 	m.mu.Unlock()
 
-	consumerIDs := m.Store.GetConsumersForStream(streamPath)
-	for _, cid := range consumerIDs {
-		consumer := m.Store.GetConsumer(cid)
-		if consumer == nil {
-			continue
-		}
-
+	for _, consumer := range m.Store.GetConsumersForStream(streamPath) {
 		if consumer.State == StateIDLE {
+			// The slice may predate the consumer's removal
+			if m.Store.GetConsumer(consumer.ConsumerID) != consumer {
+				continue
+			}
 			if m.Store.HasPendingWork(consumer, m.getTailOffset) {
 				m.wakeConsumer(consumer, []string{streamPath})
 			}
@@ -149,16 +149,22 @@ func (m *Manager) wakeConsumer(consumer *ConsumerInstance, triggeredBy []string)
 		payload = m.enrichPayload(payload, consumer)
 	}
 
-	go m.deliverWebhook(consumer, sub, payload)
+	m.deliveries.submit(&delivery{
+		consumer:    consumer,
+		sub:         sub,
+		payload:     payload,
+		triggeredBy: triggeredBy,
+	})
 }
 
-func (m *Manager) deliverWebhook(consumer *ConsumerInstance, sub *Subscription, payload map[string]interface{}) {
-	body, _ := json.Marshal(payload)
+func (m *Manager) deliverWebhook(d *delivery) {
+	consumer, sub := d.consumer, d.sub
+	body, _ := json.Marshal(d.payload)
 	signature := SignWebhookPayload(string(body))
 
 	req, err := http.NewRequest("POST", sub.Webhook, bytes.NewReader(body))
 	if err != nil {
-		m.handleDeliveryError(consumer, sub, payload, err)
+		m.handleDeliveryError(d, err)
 		return
 	}
 	req.Header.Set("Content-Type", "application/json")
@@ -166,7 +172,7 @@ func (m *Manager) deliverWebhook(consumer *ConsumerInstance, sub *Subscription,
 
 	resp, err := m.client.Do(req)
 	if err != nil {
-		m.handleDeliveryError(consumer, sub, payload, err)
+		m.handleDeliveryError(d, err)
 		return
 	}
 	defer resp.Body.Close()
@@ -203,13 +209,17 @@ func (m *Manager) deliverWebhook(consumer *ConsumerInstance, sub *Subscription,
 		return
 	}
 
+	// Drain the error body so the connection can be reused
+	io.Copy(io.Discard, io.LimitReader(resp.Body, 64*1024))
+
 	// Non-2xx — schedule retry if still in WAKING and unclaimed
 	if !consumer.WakeIDClaimed && consumer.State == StateWAKING {
-		m.scheduleRetry(consumer, sub, payload)
+		m.scheduleRetry(d)
 	}
 }
 
-func (m *Manager) handleDeliveryError(consumer *ConsumerInstance, sub *Subscription, payload map[string]interface{}, err error) {
+func (m *Manager) handleDeliveryError(d *delivery, err error) {
+	consumer := d.consumer
 	m.logger.Debug("webhook delivery failed",
 		zap.String("consumer_id", consumer.ConsumerID),
 		zap.Error(err))
@@ -226,11 +236,12 @@ func (m *Manager) handleDeliveryError(consumer *ConsumerInstance, sub *Subscript
 	}
 
 	if consumer.State == StateWAKING {
-		m.scheduleRetry(consumer, sub, payload)
+		m.scheduleRetry(d)
 	}
 }
 
-func (m *Manager) scheduleRetry(consumer *ConsumerInstance, sub *Subscription, payload map[string]interface{}) {
+func (m *Manager) scheduleRetry(d *delivery) {
+	consumer := d.consumer
 	m.mu.Lock()
 	if m.shuttingDown {
 		m.mu.Unlock()
@@ -245,19 +256,15 @@ func (m *Manager) scheduleRetry(consumer *ConsumerInstance, sub *Subscription, p
 	cancel := make(chan struct{})
 	consumer.retryCancel = cancel
 
-	go func() {
-		timer := time.NewTimer(time.Duration(delay) * time.Millisecond)
-		defer timer.Stop()
+	m.retries.schedule(time.Now().Add(time.Duration(delay)*time.Millisecond), d, cancel)
+}
 
-		select {
-		case <-timer.C:
-			if consumer.State == StateWAKING && !consumer.WakeIDClaimed && !m.isShuttingDown() {
-				m.deliverWebhook(consumer, sub, payload)
-			}
-		case <-cancel:
-			return
-		}
-	}()
+// retryDelivery resubmits a delivery whose retry delay has passed
+func (m *Manager) retryDelivery(d *delivery) {
+	consumer := d.consumer
+	if consumer.State == StateWAKING && !consumer.WakeIDClaimed && !m.isShuttingDown() {
+		m.deliveries.submit(d)
+	}
 }
 
 func (m *Manager) calculateRetryDelay(retryCount int) int {
@@ -431,5 +438,7 @@ func (m *Manager) Shutdown() {
 	m.mu.Lock()
 	m.shuttingDown = true
 	m.mu.Unlock()
+	m.retries.close()
+	m.deliveries.close()
 	m.Store.Shutdown()
 }
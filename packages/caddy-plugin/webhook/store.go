@@ -3,6 +3,7 @@ package webhook
 import (
 	"fmt"
 	"net/url"
+	"slices"
 	"sync"
 	"time"
 )
@@ -11,10 +12,11 @@ import (
 type Store struct {
 	mu sync.RWMutex
 
-	subscriptions         map[string]*Subscription     // subscription_id -> Subscription
-	consumers             map[string]*ConsumerInstance // consumer_id -> ConsumerInstance
-	subscriptionConsumers map[string]map[string]bool   // subscription_id -> set of consumer_ids
-	streamConsumers       map[string]map[string]bool   // stream_path -> set of consumer_ids
+	subscriptions         map[string]*Subscription       // subscription_id -> Subscription
+	patterns              globIndex                      // Subscriptions indexed by pattern
+	consumers             map[string]*ConsumerInstance   // consumer_id -> ConsumerInstance
+	subscriptionConsumers map[string]map[string]bool     // subscription_id -> set of consumer_ids
+	streamConsumers       map[string][]*ConsumerInstance // stream_path -> consumers, copied on write
 }
 
 // NewStore creates a new webhook Store.
@@ -23,7 +25,7 @@ func NewStore() *Store {
 		subscriptions:         make(map[string]*Subscription),
 		consumers:             make(map[string]*ConsumerInstance),
 		subscriptionConsumers: make(map[string]map[string]bool),
-		streamConsumers:       make(map[string]map[string]bool),
+		streamConsumers:       make(map[string][]*ConsumerInstance),
 	}
 }
 
@@ -48,6 +50,7 @@ func (s *Store) CreateSubscription(subscriptionID, pattern, webhook string, desc
 	}
 
 	s.subscriptions[subscriptionID] = sub
+	s.patterns.add(sub)
 	s.subscriptionConsumers[subscriptionID] = make(map[string]bool)
 	return sub, true, nil
 }
@@ -78,7 +81,8 @@ func (s *Store) DeleteSubscription(subscriptionID string) bool {
 	s.mu.Lock()
 	defer s.mu.Unlock()
 
-	if _, ok := s.subscriptions[subscriptionID]; !ok {
+	sub, ok := s.subscriptions[subscriptionID]
+	if !ok {
 		return false
 	}
 
@@ -90,6 +94,7 @@ func (s *Store) DeleteSubscription(subscriptionID string) bool {
 
 	delete(s.subscriptionConsumers, subscriptionID)
 	delete(s.subscriptions, subscriptionID)
+	s.patterns.remove(sub)
 	return true
 }
 
@@ -98,13 +103,7 @@ func (s *Store) FindMatchingSubscriptions(streamPath string) []*Subscription {
 	s.mu.RLock()
 	defer s.mu.RUnlock()
 
-	var result []*Subscription
-	for _, sub := range s.subscriptions {
-		if GlobMatch(sub.Pattern, streamPath) {
-			result = append(result, sub)
-		}
-	}
-	return result
+	return s.patterns.match(streamPath)
 }
 
 // BuildConsumerID builds a consumer ID from subscription ID and stream path.
@@ -143,7 +142,7 @@ func (s *Store) GetOrCreateConsumer(subscriptionID, streamPath string) *Consumer
 	if subConsumers, ok := s.subscriptionConsumers[subscriptionID]; ok {
 		subConsumers[consumerID] = true
 	}
-	s.addStreamIndex(streamPath, consumerID)
+	s.addStreamIndex(streamPath, c)
 
 	return c
 }
@@ -201,7 +200,7 @@ func (s *Store) SubscribeStreams(c *ConsumerInstance, paths []string, getTailOff
 		if _, ok := c.Streams[path]; !ok {
 			tail := getTailOffset(path)
 			c.Streams[path] = tail
-			s.addStreamIndex(path, c.ConsumerID)
+			s.addStreamIndex(path, c)
 		}
 	}
 }
@@ -245,17 +244,14 @@ func (s *Store) GetStreamsData(c *ConsumerInstance) []StreamEntry {
 	return result
 }
 
-// GetConsumersForStream returns consumer IDs subscribed to a stream.
-func (s *Store) GetConsumersForStream(streamPath string) []string {
+// GetConsumersForStream returns the consumers subscribed to a stream.
+// The slice is shared and replaced rather than modified when the
+// subscriptions change, so it is safe to iterate without copying but must
+// not be modified by the caller.
+func (s *Store) GetConsumersForStream(streamPath string) []*ConsumerInstance {
 	s.mu.RLock()
 	defer s.mu.RUnlock()
-
-	set := s.streamConsumers[streamPath]
-	result := make([]string, 0, len(set))
-	for cid := range set {
-		result = append(result, cid)
-	}
-	return result
+	return s.streamConsumers[streamPath]
 }
 
 // RemoveConsumer removes a consumer and cleans up all indexes.
@@ -291,17 +287,12 @@ func (s *Store) RemoveStreamFromConsumers(streamPath string) {
 	s.mu.Lock()
 	defer s.mu.Unlock()
 
-	set := s.streamConsumers[streamPath]
 	var toRemove []string
 
-	for cid := range set {
-		c, ok := s.consumers[cid]
-		if !ok {
-			continue
-		}
+	for _, c := range s.streamConsumers[streamPath] {
 		delete(c.Streams, streamPath)
 		if len(c.Streams) == 0 {
-			toRemove = append(toRemove, cid)
+			toRemove = append(toRemove, c.ConsumerID)
 		}
 	}
 
@@ -324,26 +315,30 @@ func (s *Store) Shutdown() {
 
 	s.consumers = make(map[string]*ConsumerInstance)
 	s.subscriptions = make(map[string]*Subscription)
+	s.patterns = globIndex{}
 	s.subscriptionConsumers = make(map[string]map[string]bool)
-	s.streamConsumers = make(map[string]map[string]bool)
+	s.streamConsumers = make(map[string][]*ConsumerInstance)
 }
 
-func (s *Store) addStreamIndex(streamPath, consumerID string) {
-	set, ok := s.streamConsumers[streamPath]
-	if !ok {
-		set = make(map[string]bool)
-		s.streamConsumers[streamPath] = set
+// addStreamIndex and removeStreamIndex replace a stream's consumer slice
+// instead of modifying it, since GetConsumersForStream hands it out
+func (s *Store) addStreamIndex(streamPath string, c *ConsumerInstance) {
+	list := s.streamConsumers[streamPath]
+	if slices.Contains(list, c) {
+		return
 	}
-	set[consumerID] = true
+	s.streamConsumers[streamPath] = append(list[:len(list):len(list)], c)
 }
 
 func (s *Store) removeStreamIndex(streamPath, consumerID string) {
-	set, ok := s.streamConsumers[streamPath]
-	if !ok {
+	list := s.streamConsumers[streamPath]
+	i := slices.IndexFunc(list, func(c *ConsumerInstance) bool { return c.ConsumerID == consumerID })
+	if i < 0 {
 		return
 	}
-	delete(set, consumerID)
-	if len(set) == 0 {
+	if len(list) == 1 {
 		delete(s.streamConsumers, streamPath)
+		return
 	}
+	s.streamConsumers[streamPath] = slices.Delete(slices.Clone(list), i, i+1)
 }
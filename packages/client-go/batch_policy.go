@@ -0,0 +1,104 @@
+package durablestreams
+
+import (
+	"bytes"
+	"compress/gzip"
+	"time"
+)
+
+// BatchingMode selects adaptive batching for an IdempotentProducer.
+type BatchingMode string
+
+const (
+	// BatchingStatic sends batches after LingerMs or at MaxBatchBytes (default).
+	BatchingStatic BatchingMode = ""
+
+	// BatchingLatency sends as soon as a pipeline slot is free, with batches
+	// capped in proportion to the batches in flight.
+	BatchingLatency BatchingMode = "latency"
+
+	// BatchingThroughput lingers about one round trip per pipeline slot, so
+	// the pipeline stays full with the largest batches it can carry.
+	BatchingThroughput BatchingMode = "throughput"
+)
+
+// CompressionGzip compresses producer batch bodies with gzip.
+const CompressionGzip = "gzip"
+
+const (
+	// adaptiveMaxLingerMs bounds linger in adaptive mode when LingerMs is unset.
+	adaptiveMaxLingerMs = 25
+
+	// compressionMinBytes is the smallest batch body worth compressing.
+	compressionMinBytes = 1024
+)
+
+// batchPolicy sizes linger and batches from smoothed append round-trip
+// times and the number of batches in flight, as the TypeScript and Rust
+// producers do:
+//
+//   - latency: no linger while a pipeline slot is free, and batches capped
+//     in proportion to the slots in use
+//   - throughput: linger the smoothed round trip divided by MaxInFlight, the
+//     rate at which a full pipeline frees slots, with batches up to
+//     MaxBatchBytes
+//
+// In both modes a batch waits, growing, while every slot is busy, and is
+// rescheduled as batches complete. Guarded by the producer's mu.
+type batchPolicy struct {
+	mode          BatchingMode
+	maxLinger     time.Duration
+	maxBatchBytes int
+	maxInFlight   int
+
+	// srtt is the smoothed round-trip time, zero until one is observed
+	srtt time.Duration
+}
+
+// recordRoundTrip records the round-trip time of a successful batch
+// (TCP-style smoothing with gain 1/8).
+func (b *batchPolicy) recordRoundTrip(rtt time.Duration) {
+	if b.srtt == 0 {
+		b.srtt = rtt
+		return
+	}
+	b.srtt += (rtt - b.srtt) / 8
+}
+
+// linger returns how long a new batch should linger, or false if every
+// pipeline slot is busy and the batch should wait for one to free.
+func (b *batchPolicy) linger(inFlight int) (time.Duration, bool) {
+	if inFlight >= b.maxInFlight {
+		return 0, false
+	}
+	if b.mode == BatchingLatency {
+		return 0, true
+	}
+	if b.srtt == 0 {
+		return b.maxLinger, true
+	}
+	return min(b.maxLinger, b.srtt/time.Duration(b.maxInFlight)), true
+}
+
+// batchBytes returns the batch size at which a batch is sent without
+// further linger.
+func (b *batchPolicy) batchBytes(inFlight int) int {
+	if b.mode == BatchingThroughput {
+		return b.maxBatchBytes
+	}
+	slots := min(inFlight+1, b.maxInFlight)
+	return (b.maxBatchBytes*slots + b.maxInFlight - 1) / b.maxInFlight
+}
+
+// gzipBody compresses a batch body.
+func gzipBody(body []byte) ([]byte, error) {
+	var buf bytes.Buffer
+	zw := gzip.NewWriter(&buf)
+	if _, err := zw.Write(body); err != nil {
+		return nil, err
+	}
+	if err := zw.Close(); err != nil {
+		return nil, err
+	}
+	return buf.Bytes(), nil
+}
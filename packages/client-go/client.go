@@ -4,23 +4,100 @@ import (
 	"net"
 	"net/http"
 	"strings"
+	"sync"
 	"time"
 )
 
 // Client is a durable streams client.
 // It is safe for concurrent use.
 //
-// The client uses an optimized HTTP transport with:
-//   - Connection pooling (100 idle connections, 10 per host)
-//   - HTTP/2 support (automatic for HTTPS)
-//   - Reasonable timeouts for dial, TLS handshake, and idle connections
-//   - Keep-alive for connection reuse
+// Unless WithHTTPClient or WithTransport is given, every client uses one
+// shared HTTP transport (see NewTransport), so streams from any number of
+// clients to the same host reuse pooled connections.
 type Client struct {
 	httpClient  *http.Client
 	baseURL     string
 	retryPolicy RetryPolicy
 }
 
+// TransportOptions tunes a transport built by NewTransport.
+// Zero fields take the defaults.
+type TransportOptions struct {
+	// MaxIdleConns is the maximum number of idle connections across all hosts.
+	// Default is 1000.
+	MaxIdleConns int
+
+	// MaxIdleConnsPerHost is the maximum number of idle connections kept per
+	// host. Tailing many streams over HTTP/1.1 holds one connection per
+	// pending long-poll, so this should cover the streams tailed per host.
+	// Default is 100.
+	MaxIdleConnsPerHost int
+
+	// MaxConnsPerHost limits connections per host, including active ones.
+	// Default is 0 (no limit).
+	MaxConnsPerHost int
+
+	// IdleConnTimeout is how long an idle connection stays pooled.
+	// Default is 90s.
+	IdleConnTimeout time.Duration
+}
+
+// NewTransport returns an HTTP transport tuned for durable streams:
+//   - Connection pooling sized for tailing many streams per host
+//   - HTTP/2 for HTTPS, multiplexing every stream to a host over one connection
+//   - Reasonable timeouts for dial, TLS handshake, and idle connections
+//   - Keep-alive for connection reuse
+//
+// Pass it to WithTransport to share it between clients.
+func NewTransport(opts TransportOptions) *http.Transport {
+	if opts.MaxIdleConns == 0 {
+		opts.MaxIdleConns = 1000
+	}
+	if opts.MaxIdleConnsPerHost == 0 {
+		opts.MaxIdleConnsPerHost = 100
+	}
+	if opts.IdleConnTimeout == 0 {
+		opts.IdleConnTimeout = 90 * time.Second
+	}
+
+	return &http.Transport{
+		// Connection pooling
+		MaxIdleConns:        opts.MaxIdleConns,
+		MaxIdleConnsPerHost: opts.MaxIdleConnsPerHost,
+		MaxConnsPerHost:     opts.MaxConnsPerHost,
+		IdleConnTimeout:     opts.IdleConnTimeout,
+
+		// Timeouts
+		DialContext: (&net.Dialer{
+			Timeout:   30 * time.Second,
+			KeepAlive: 30 * time.Second,
+		}).DialContext,
+		TLSHandshakeTimeout:   10 * time.Second,
+		ResponseHeaderTimeout: 0, // No timeout (handled at request level)
+		ExpectContinueTimeout: 1 * time.Second,
+
+		// Compression
+		DisableCompression: false,
+
+		// A custom DialContext disables HTTP/2 unless it is forced
+		ForceAttemptHTTP2: true,
+	}
+}
+
+var (
+	sharedTransportOnce sync.Once
+	sharedTransport     *http.Transport
+)
+
+// defaultTransport returns the transport shared by clients that don't
+// configure their own.
+func defaultTransport() *http.Transport {
+	sharedTransportOnce.Do(func() {
+		sharedTransport = NewTransport(TransportOptions{})
+	})
+	return sharedTransport
+}
+
 // NewClient creates a new durable streams client.
 //
 // Example:
@@ -33,33 +110,12 @@ func NewClient(opts ...ClientOption) *Client {
 		opt(cfg)
 	}
 
-	// Default HTTP client with optimized transport settings
 	httpClient := cfg.httpClient
 	if httpClient == nil {
-		transport := &http.Transport{
-			// Connection pooling
-			MaxIdleConns:        100,
-			MaxIdleConnsPerHost: 10,
-			MaxConnsPerHost:     0, // No limit
-			IdleConnTimeout:     90 * time.Second,
-
-			// Timeouts
-			DialContext: (&net.Dialer{
-				Timeout:   30 * time.Second,
-				KeepAlive: 30 * time.Second,
-			}).DialContext,
-			TLSHandshakeTimeout:   10 * time.Second,
-			ResponseHeaderTimeout: 0, // No timeout (handled at request level)
-			ExpectContinueTimeout: 1 * time.Second,
-
-			// Compression
-			DisableCompression: false,
-
-			// HTTP/2 is enabled by default for HTTPS when using http.DefaultTransport
-			// or when ForceAttemptHTTP2 is true
-			ForceAttemptHTTP2: true,
+		transport := cfg.transport
+		if transport == nil {
+			transport = defaultTransport()
 		}
-
 		httpClient = &http.Client{
 			Timeout:   0, // No global timeout - use context for per-request timeout
 			Transport: transport,
@@ -115,6 +115,17 @@ type IdempotentProducerConfig struct {
 	// MaxInFlight is the maximum concurrent batches (default 5).
 	MaxInFlight int
 
+	// Adaptive sizes linger and batches from observed append round trips
+	// and the batches in flight (BatchingLatency or BatchingThroughput).
+	// LingerMs and MaxBatchBytes then act as upper bounds, LingerMs
+	// defaulting to 25ms.
+	Adaptive BatchingMode
+
+	// Compression compresses batch bodies of at least 1 KiB with this
+	// content coding (CompressionGzip). The server must accept
+	// Content-Encoding on appends.
+	Compression string
+
 	// ContentType is the content type for appends (default "application/octet-stream").
 	ContentType string
 
@@ -184,6 +195,7 @@ type IdempotentProducer struct {
 	pendingBatch []pendingEntry
 	batchBytes   int
 	lingerTimer  *time.Timer
+	policy       *batchPolicy // nil for static batching
 
 	// Pipelining state
 	inFlight   int
@@ -216,6 +228,9 @@ func (c *Client) IdempotentProducer(url, producerID string, config IdempotentPro
 	}
 	if config.LingerMs == 0 {
 		config.LingerMs = 5
+		if config.Adaptive != BatchingStatic {
+			config.LingerMs = adaptiveMaxLingerMs
+		}
 	}
 	if config.MaxInFlight == 0 {
 		config.MaxInFlight = 5
@@ -237,6 +252,24 @@ func (c *Client) IdempotentProducer(url, producerID string, config IdempotentPro
 	if config.LingerMs < 0 {
 		return nil, fmt.Errorf("lingerMs must be >= 0")
 	}
+	switch config.Adaptive {
+	case BatchingStatic, BatchingLatency, BatchingThroughput:
+	default:
+		return nil, fmt.Errorf("unknown batching mode %q", config.Adaptive)
+	}
+	if config.Compression != "" && config.Compression != CompressionGzip {
+		return nil, fmt.Errorf("unsupported compression %q", config.Compression)
+	}
+
+	var policy *batchPolicy
+	if config.Adaptive != BatchingStatic {
+		policy = &batchPolicy{
+			mode:          config.Adaptive,
+			maxLinger:     time.Duration(config.LingerMs) * time.Millisecond,
+			maxBatchBytes: config.MaxBatchBytes,
+			maxInFlight:   config.MaxInFlight,
+		}
+	}
 
 	return &IdempotentProducer{
 		url:          url,
@@ -245,6 +278,7 @@ func (c *Client) IdempotentProducer(url, producerID string, config IdempotentPro
 		config:       config,
 		epoch:        config.Epoch,
 		closedCh:     make(chan struct{}),
+		policy:       policy,
 		seqState:     make(map[int]map[int]*seqState),
 		epochClaimed: !config.AutoClaim, // When autoClaim, epoch not known until first batch
 	}, nil
@@ -329,26 +363,44 @@ func (p *IdempotentProducer) Append(data any) error {
 	p.batchBytes += len(dataBytes)
 
 	// Check if batch should be sent immediately
-	shouldSend := p.batchBytes >= p.config.MaxBatchBytes
+	batchLimit := p.config.MaxBatchBytes
+	if p.policy != nil {
+		batchLimit = p.policy.batchBytes(p.inFlight)
+	}
+	shouldSend := p.batchBytes >= batchLimit
 	shouldStartTimer := !shouldSend && p.lingerTimer == nil
 
 	if shouldSend {
 		p.sendCurrentBatchLocked()
 	} else if shouldStartTimer {
-		p.lingerTimer = time.AfterFunc(time.Duration(p.config.LingerMs)*time.Millisecond, func() {
-			p.mu.Lock()
-			p.lingerTimer = nil
-			if len(p.pendingBatch) > 0 {
-				p.sendCurrentBatchLocked()
-			}
-			p.mu.Unlock()
-		})
+		p.startLingerLocked()
 	}
 	p.mu.Unlock()
 
 	return nil
 }
 
+// startLingerLocked starts the linger timer for the pending batch. With
+// adaptive batching the batch instead waits for a free pipeline slot while
+// all are busy, and is rescheduled as batches complete. Caller must hold p.mu.
+func (p *IdempotentProducer) startLingerLocked() {
+	linger := time.Duration(p.config.LingerMs) * time.Millisecond
+	if p.policy != nil {
+		var ok bool
+		if linger, ok = p.policy.linger(p.inFlight); !ok {
+			return
+		}
+	}
+	p.lingerTimer = time.AfterFunc(linger, func() {
+		p.mu.Lock()
+		p.lingerTimer = nil
+		if len(p.pendingBatch) > 0 {
+			p.sendCurrentBatchLocked()
+		}
+		p.mu.Unlock()
+	})
+}
+
 // Flush sends any pending batch and waits for all in-flight batches to complete.
 func (p *IdempotentProducer) Flush(ctx context.Context) error {
 	for {
@@ -569,10 +621,15 @@ func (p *IdempotentProducer) sendCurrentBatchLocked() {
 		defer func() {
 			p.mu.Lock()
 			p.inFlight--
+			// A batch held back while the pipeline was full can go now
+			if p.policy != nil && len(p.pendingBatch) > 0 && p.lingerTimer == nil {
+				p.startLingerLocked()
+			}
 			p.mu.Unlock()
 			p.inFlightWg.Done()
 		}()
 
+		start := time.Now()
 		result, err := p.doSendBatch(context.Background(), batch, seq, epoch)
 
 		// Mark epoch as claimed after first successful batch
@@ -582,6 +639,9 @@ func (p *IdempotentProducer) sendCurrentBatchLocked() {
 			if !p.epochClaimed {
 				p.epochClaimed = true
 			}
+			if p.policy != nil {
+				p.policy.recordRoundTrip(time.Since(start))
+			}
 			p.mu.Unlock()
 		}
 
@@ -641,6 +701,17 @@ func (p *IdempotentProducer) doSendBatch(ctx context.Context, batch []pendingEnt
 		}
 	}
 
+	// Compress bodies large enough to benefit
+	contentEncoding := ""
+	if p.config.Compression != "" && len(batchedBody) >= compressionMinBytes {
+		compressed, err := gzipBody(batchedBody)
+		if err != nil {
+			return IdempotentAppendResult{}, err
+		}
+		batchedBody = compressed
+		contentEncoding = p.config.Compression
+	}
+
 	// Build request
 	req, err := http.NewRequestWithContext(ctx, http.MethodPost, p.url, bytes.NewReader(batchedBody))
 	if err != nil {
@@ -648,6 +719,9 @@ func (p *IdempotentProducer) doSendBatch(ctx context.Context, batch []pendingEnt
 	}
 
 	req.Header.Set(headerContentType, p.config.ContentType)
+	if contentEncoding != "" {
+		req.Header.Set("Content-Encoding", contentEncoding)
+	}
 	req.Header.Set(headerProducerID, p.producerID)
 	req.Header.Set(headerProducerEpoch, strconv.Itoa(epoch))
 	req.Header.Set(headerProducerSeq, strconv.Itoa(seq))
@@ -87,10 +87,65 @@ type ChunkIterator struct {
 	ssePending      *Chunk // Pending chunk from SSE data event
 	sseDataEncoding string // Detected from Stream-SSE-Data-Encoding response header
 
+	// Buffer reuse state (WithBufferReuse)
+	reuseBuffers bool
+	buf          []byte // Body buffer, reused across responses
+	chunk        Chunk  // Chunk returned from every Next
+
 	// initErr holds any validation error from Read() to be returned on first Next()
 	initErr error
 }
 
+// maxReusedBufferSize bounds the body buffer kept across responses, so one
+// large catch-up response doesn't pin its memory for the iterator's lifetime.
+const maxReusedBufferSize = 4 << 20
+
+// emit returns the chunk to hand out from Next: the iterator's reused Chunk
+// when buffers are reused, otherwise a new one.
+func (it *ChunkIterator) emit(c Chunk) *Chunk {
+	if !it.reuseBuffers {
+		return &c
+	}
+	it.chunk = c
+	return &it.chunk
+}
+
+// retainBuffer keeps data's backing array for the next response.
+func (it *ChunkIterator) retainBuffer(data []byte) {
+	if cap(data) <= maxReusedBufferSize {
+		it.buf = data[:0]
+	} else {
+		it.buf = nil
+	}
+}
+
+// readBody reads a response body to EOF, into the reused buffer when
+// buffers are reused.
+func (it *ChunkIterator) readBody(resp *http.Response) ([]byte, error) {
+	if !it.reuseBuffers {
+		return io.ReadAll(resp.Body)
+	}
+
+	buf := it.buf[:0]
+	if resp.ContentLength > int64(cap(buf)) && resp.ContentLength <= maxReusedBufferSize {
+		buf = make([]byte, 0, resp.ContentLength)
+	}
+	for {
+		if len(buf) == cap(buf) {
+			buf = append(buf, 0)[:len(buf)]
+		}
+		n, err := resp.Body.Read(buf[len(buf):cap(buf)])
+		buf = buf[:len(buf)+n]
+		if err == io.EOF {
+			it.retainBuffer(buf)
+			return buf, nil
+		}
+		if err != nil {
+			return nil, err
+		}
+	}
+}
+
 // Next returns the next chunk of bytes from the stream.
 // Returns Done when iteration is complete (live=false and caught up).
 // In live mode, blocks waiting for new data.
@@ -182,7 +237,7 @@ func (it *ChunkIterator) nextHTTP() (*Chunk, error) {
 	switch resp.StatusCode {
 	case http.StatusOK:
 		// Read body
-		data, err := io.ReadAll(resp.Body)
+		data, err := it.readBody(resp)
 		if err != nil {
 			return nil, newStreamError("read", it.stream.url, resp.StatusCode, err)
 		}
@@ -209,7 +264,7 @@ func (it *ChunkIterator) nextHTTP() (*Chunk, error) {
 		}
 		it.mu.Unlock()
 
-		return &Chunk{
+		return it.emit(Chunk{
 			NextOffset:   nextOffset,
 			Data:         data,
 			UpToDate:     upToDate,
@@ -217,7 +272,7 @@ func (it *ChunkIterator) nextHTTP() (*Chunk, error) {
 			Cursor:       cursor,
 			ETag:         etag,
 			StatusCode:   http.StatusOK,
-		}, nil
+		}), nil
 
 	case http.StatusNoContent:
 		// 204 - Long-poll timeout or caught up with no new data
@@ -247,14 +302,14 @@ func (it *ChunkIterator) nextHTTP() (*Chunk, error) {
 		it.mu.Unlock()
 
 		// In live mode, return empty chunk and continue
-		return &Chunk{
+		return it.emit(Chunk{
 			NextOffset:   nextOffset,
 			Data:         nil,
 			UpToDate:     upToDate,
 			StreamClosed: streamClosed,
 			Cursor:       cursor,
 			StatusCode:   http.StatusNoContent,
-		}, nil
+		}), nil
 
 	case http.StatusNotModified:
 		// 304 - Not modified (cache hit)
@@ -266,14 +321,14 @@ func (it *ChunkIterator) nextHTTP() (*Chunk, error) {
 			it.mu.Unlock()
 		}
 		// Return empty chunk
-		return &Chunk{
+		return it.emit(Chunk{
 			NextOffset:   it.offset,
 			Data:         nil,
 			UpToDate:     it.UpToDate,
 			StreamClosed: it.StreamClosed,
 			Cursor:       it.cursor,
 			StatusCode:   http.StatusNotModified,
-		}, nil
+		}), nil
 
 	case http.StatusNotFound:
 		io.Copy(io.Discard, resp.Body)
@@ -337,6 +392,17 @@ func (it *ChunkIterator) nextSSE() (*Chunk, error) {
 		case sse.DataEvent:
 			// Buffer data, wait for control event to get offset.
 			// Multiple data events may arrive before a single control event - accumulate them.
+			if it.reuseBuffers && it.sseDataEncoding != "base64" {
+				// Copy the event text straight into the reused buffer
+				it.mu.Lock()
+				if it.ssePending == nil {
+					it.ssePending = it.emit(Chunk{Data: it.buf[:0]})
+				}
+				it.ssePending.Data = append(it.ssePending.Data, e.Data...)
+				it.mu.Unlock()
+				continue
+			}
+
 			data := []byte(e.Data)
 
 			// Decode base64 if server indicated base64 encoding via response header
@@ -349,7 +415,11 @@ func (it *ChunkIterator) nextSSE() (*Chunk, error) {
 			}
 
 			it.mu.Lock()
-			if it.ssePending == nil {
+			if it.ssePending == nil && it.reuseBuffers {
+				it.ssePending = it.emit(Chunk{
+					Data: append(it.buf[:0], data...),
+				})
+			} else if it.ssePending == nil {
 				it.ssePending = &Chunk{
 					Data: data,
 				}
@@ -380,6 +450,9 @@ func (it *ChunkIterator) nextSSE() (*Chunk, error) {
 				chunk.StreamClosed = e.StreamClosed
 				chunk.StatusCode = http.StatusOK // SSE is always over 200
 				it.ssePending = nil
+				if it.reuseBuffers {
+					it.retainBuffer(chunk.Data)
+				}
 				it.mu.Unlock()
 				return chunk, nil
 			}
@@ -387,13 +460,13 @@ func (it *ChunkIterator) nextSSE() (*Chunk, error) {
 
 			// Control event without data (e.g., up-to-date signal or closed stream)
 			if e.UpToDate || e.StreamClosed {
-				return &Chunk{
+				return it.emit(Chunk{
 					NextOffset:   Offset(e.StreamNextOffset),
 					Cursor:       e.StreamCursor,
 					UpToDate:     e.UpToDate,
 					StreamClosed: e.StreamClosed,
 					StatusCode:   http.StatusOK, // SSE is always over 200
-				}, nil
+				}), nil
 			}
 		}
 	}
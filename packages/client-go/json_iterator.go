@@ -52,7 +52,9 @@ type Batch[T any] struct {
 //	    }
 //	}
 type JSONBatchIterator[T any] struct {
-	chunks *ChunkIterator
+	chunks  *ChunkIterator
+	decoder jsonBatchDecoder[T]
+	batch   Batch[T] // Batch returned from every Next with WithBufferReuse
 
 	// Public state mirrored from underlying iterator
 	// Offset is the current position in the stream.
@@ -82,6 +84,10 @@ func newJSONBatchIterator[T any](chunks *ChunkIterator) *JSONBatchIterator[T] {
 // Each batch contains items parsed from a single HTTP response.
 // If the response body is a JSON array, items are flattened into the batch.
 // If it's a single JSON object, the batch contains one item.
+//
+// json.RawMessage items refer to the bytes of the response rather than
+// copies. With WithBufferReuse, the returned Batch, its Items and those
+// bytes are reused by the next call to Next.
 func (it *JSONBatchIterator[T]) Next() (*Batch[T], error) {
 	chunk, err := it.chunks.Next()
 	if err != nil {
@@ -94,16 +100,16 @@ func (it *JSONBatchIterator[T]) Next() (*Batch[T], error) {
 		it.Offset = chunk.NextOffset
 		it.UpToDate = chunk.UpToDate
 		it.Cursor = chunk.Cursor
-		return &Batch[T]{
+		return it.emit(Batch[T]{
 			Items:      nil,
 			NextOffset: chunk.NextOffset,
 			UpToDate:   chunk.UpToDate,
 			Cursor:     chunk.Cursor,
-		}, nil
+		}), nil
 	}
 
 	// Parse JSON from chunk data
-	items, err := parseJSONBatch[T](chunk.Data)
+	items, err := it.decoder.decode(chunk.Data, it.chunks.reuseBuffers)
 	if err != nil {
 		return nil, newStreamError("read", it.chunks.stream.url, 0, err)
 	}
@@ -113,12 +119,22 @@ func (it *JSONBatchIterator[T]) Next() (*Batch[T], error) {
 	it.UpToDate = chunk.UpToDate
 	it.Cursor = chunk.Cursor
 
-	return &Batch[T]{
+	return it.emit(Batch[T]{
 		Items:      items,
 		NextOffset: chunk.NextOffset,
 		UpToDate:   chunk.UpToDate,
 		Cursor:     chunk.Cursor,
-	}, nil
+	}), nil
+}
+
+// emit returns the batch to hand out from Next: the iterator's reused Batch
+// with WithBufferReuse, otherwise a new one.
+func (it *JSONBatchIterator[T]) emit(b Batch[T]) *Batch[T] {
+	if !it.chunks.reuseBuffers {
+		return &b
+	}
+	it.batch = b
+	return &it.batch
 }
 
 // Close cancels the iterator and releases resources.
@@ -131,22 +147,124 @@ func (it *JSONBatchIterator[T]) Close() error {
 // Ensure JSONBatchIterator implements io.Closer
 var _ io.Closer = (*JSONBatchIterator[any])(nil)
 
-// parseJSONBatch parses JSON data, flattening top-level arrays.
-// Per protocol spec, top-level arrays are flattened one level.
-func parseJSONBatch[T any](data []byte) ([]T, error) {
-	// First, try to parse as array
+// jsonBatchDecoder decodes JSON response bodies into items, flattening
+// top-level arrays. Per protocol spec, top-level arrays are flattened one
+// level. The body is split into items in place and each item is decoded on
+// its own, so no intermediate copy of the body is made; json.RawMessage
+// items are the split bytes themselves.
+type jsonBatchDecoder[T any] struct {
+	raw   []json.RawMessage // Scratch for split items, reused across bodies
+	items []T               // Decoded items, reused across bodies if reuse is set
+}
+
+// decode parses one JSON body. With reuse set, the returned slice shares its
+// backing array with the previous result.
+func (d *jsonBatchDecoder[T]) decode(data []byte, reuse bool) ([]T, error) {
 	var items []T
-	if err := json.Unmarshal(data, &items); err == nil {
+	if reuse {
+		items = d.items[:0]
+	}
+
+	// Raw items need no decoding: hand out the split bytes
+	if raw, ok := any(items).([]json.RawMessage); ok {
+		raw, err := splitJSONItems(data, raw)
+		if err != nil {
+			return nil, err
+		}
+		items = any(raw).([]T)
+		if reuse {
+			d.items = items
+		}
 		return items, nil
 	}
 
-	// If that fails, try to parse as single item
-	var item T
-	if err := json.Unmarshal(data, &item); err != nil {
+	raw, err := splitJSONItems(data, d.raw[:0])
+	d.raw = raw
+	if err != nil {
+		return nil, err
+	}
+	for _, item := range raw {
+		var zero T
+		items = append(items, zero)
+		if err := json.Unmarshal(item, &items[len(items)-1]); err != nil {
+			// Not an array of T: the body may itself be a single T
+			var whole T
+			if json.Unmarshal(data, &whole) == nil {
+				items = append(items[:0], whole)
+				break
+			}
+			return nil, errors.New("invalid JSON: " + err.Error())
+		}
+	}
+	if reuse {
+		d.items = items
+	}
+	return items, nil
+}
+
+// splitJSONItems appends the raw bytes of each item of a JSON body to dst.
+// Items of a top-level array are appended individually; any other value is
+// appended as a single item. The appended items are subslices of data.
+func splitJSONItems(data []byte, dst []json.RawMessage) ([]json.RawMessage, error) {
+	if !json.Valid(data) {
+		var v any
+		err := json.Unmarshal(data, &v)
+		if err == nil {
+			err = errors.New("invalid JSON")
+		}
 		return nil, errors.New("invalid JSON: " + err.Error())
 	}
 
-	return []T{item}, nil
+	data = trimJSONSpace(data)
+	if len(data) == 0 || data[0] != '[' {
+		return append(dst, data), nil
+	}
+
+	// The body is valid JSON, so only nesting and strings need tracking
+	depth := 0
+	inString := false
+	escaped := false
+	start := 1
+	for i := 1; i < len(data)-1; i++ {
+		b := data[i]
+		switch {
+		case inString:
+			if escaped {
+				escaped = false
+			} else if b == '\\' {
+				escaped = true
+			} else if b == '"' {
+				inString = false
+			}
+		case b == '"':
+			inString = true
+		case b == '[' || b == '{':
+			depth++
+		case b == ']' || b == '}':
+			depth--
+		case b == ',' && depth == 0:
+			dst = append(dst, trimJSONSpace(data[start:i]))
+			start = i + 1
+		}
+	}
+	if last := trimJSONSpace(data[start : len(data)-1]); len(last) > 0 {
+		dst = append(dst, last)
+	}
+	return dst, nil
+}
+
+// trimJSONSpace trims JSON whitespace from both ends of data.
+func trimJSONSpace(data []byte) []byte {
+	isSpace := func(b byte) bool {
+		return b == ' ' || b == '\t' || b == '\n' || b == '\r'
+	}
+	for len(data) > 0 && isSpace(data[0]) {
+		data = data[1:]
+	}
+	for len(data) > 0 && isSpace(data[len(data)-1]) {
+		data = data[:len(data)-1]
+	}
+	return data
 }
 
 // ReadJSON returns an iterator for reading JSON batches.
@@ -203,6 +321,11 @@ func Items[T any](ctx context.Context, stream *Stream, opts ...ReadOption) (<-ch
 		defer close(items)
 		defer close(errs)
 
+		// Items are handed to another goroutine, so their bytes can't be
+		// reused once the next batch is read
+		opts = append(opts[:len(opts):len(opts)], func(cfg *readConfig) {
+			cfg.reuseBuffers = false
+		})
 		it := ReadJSON[T](ctx, stream, opts...)
 		defer it.Close()
 
@@ -0,0 +1,151 @@
+package durablestreams
+
+import (
+	"context"
+	"encoding/json"
+	"net/http"
+	"net/http/httptest"
+	"testing"
+)
+
+// TestSplitJSONItems tests that JSON bodies are split into the raw bytes of their items
+func TestSplitJSONItems(t *testing.T) {
+	tests := []struct {
+		name string
+		body string
+		want []string
+	}{
+		{
+			name: "array of objects",
+			body: `[{"a":1},{"b":[2,3]}]`,
+			want: []string{`{"a":1}`, `{"b":[2,3]}`},
+		},
+		{
+			name: "whitespace around items",
+			body: " [ 1 ,\n\t\"x\" ] \n",
+			want: []string{`1`, `"x"`},
+		},
+		{
+			name: "delimiters inside strings",
+			body: `["a,b]", "c\"]}", "d\\"]`,
+			want: []string{`"a,b]"`, `"c\"]}"`, `"d\\"`},
+		},
+		{
+			name: "nested arrays are not flattened",
+			body: `[[1,2],[]]`,
+			want: []string{`[1,2]`, `[]`},
+		},
+		{
+			name: "empty array",
+			body: `[]`,
+			want: nil,
+		},
+		{
+			name: "single object",
+			body: ` {"a":[1,2]} `,
+			want: []string{`{"a":[1,2]}`},
+		},
+	}
+
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			items, err := splitJSONItems([]byte(tt.body), nil)
+			if err != nil {
+				t.Fatalf("unexpected error: %v", err)
+			}
+			if len(items) != len(tt.want) {
+				t.Fatalf("got %d items, want %d", len(items), len(tt.want))
+			}
+			for i, item := range items {
+				if string(item) != tt.want[i] {
+					t.Errorf("item %d: got %s, want %s", i, item, tt.want[i])
+				}
+			}
+		})
+	}
+
+	if _, err := splitJSONItems([]byte(`[{"a":1},`), nil); err == nil {
+		t.Error("expected error for invalid JSON")
+	}
+}
+
+// TestJSONBatchDecoderReuseAllocations tests that decoding raw items into reused slices doesn't allocate
+func TestJSONBatchDecoderReuseAllocations(t *testing.T) {
+	body := []byte(`[{"id":1,"name":"a"},{"id":2,"name":"b"},{"id":3,"name":"c"}]`)
+
+	var d jsonBatchDecoder[json.RawMessage]
+	if _, err := d.decode(body, true); err != nil {
+		t.Fatalf("unexpected error: %v", err)
+	}
+
+	allocs := testing.AllocsPerRun(100, func() {
+		items, err := d.decode(body, true)
+		if err != nil || len(items) != 3 {
+			t.Fatalf("unexpected decode result: %d items, %v", len(items), err)
+		}
+	})
+	if allocs != 0 {
+		t.Errorf("got %v allocations per decode, want 0", allocs)
+	}
+}
+
+// TestReadJSONBufferReuse tests that WithBufferReuse returns the same batch, reusing its items
+func TestReadJSONBufferReuse(t *testing.T) {
+	server := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		w.Header().Set("Content-Type", "application/json")
+		if r.URL.Query().Get("offset") == "-1" {
+			w.Header().Set("Stream-Next-Offset", "1")
+			w.WriteHeader(http.StatusOK)
+			w.Write([]byte(`[{"n":1},{"n":2}]`))
+			return
+		}
+		w.Header().Set("Stream-Next-Offset", "2")
+		w.Header().Set("Stream-Up-To-Date", "true")
+		w.WriteHeader(http.StatusOK)
+		w.Write([]byte(`[{"n":3}]`))
+	}))
+	defer server.Close()
+
+	stream := NewClient(WithBaseURL(server.URL)).Stream("/test")
+	it := ReadJSON[json.RawMessage](context.Background(), stream, WithBufferReuse())
+	defer it.Close()
+
+	first, err := it.Next()
+	if err != nil {
+		t.Fatalf("unexpected error: %v", err)
+	}
+	if len(first.Items) != 2 || string(first.Items[1]) != `{"n":2}` {
+		t.Fatalf("unexpected first batch: %s", first.Items)
+	}
+
+	second, err := it.Next()
+	if err != nil {
+		t.Fatalf("unexpected error: %v", err)
+	}
+	if second != first {
+		t.Error("expected the batch to be reused")
+	}
+	if len(second.Items) != 1 || string(second.Items[0]) != `{"n":3}` {
+		t.Fatalf("unexpected second batch: %s", second.Items)
+	}
+	if second.NextOffset != "2" || !second.UpToDate {
+		t.Errorf("unexpected batch state: offset %s, up to date %v", second.NextOffset, second.UpToDate)
+	}
+}
+
+// TestNewClientSharesTransport tests that default clients share one transport
+func TestNewClientSharesTransport(t *testing.T) {
+	a := NewClient().HTTPClient().Transport
+	b := NewClient().HTTPClient().Transport
+	if a != b {
+		t.Error("expected default clients to share a transport")
+	}
+
+	custom := NewTransport(TransportOptions{MaxIdleConnsPerHost: 500})
+	if custom.MaxIdleConnsPerHost != 500 || custom.MaxIdleConns != 1000 {
+		t.Errorf("unexpected transport tuning: %d per host, %d total", custom.MaxIdleConnsPerHost, custom.MaxIdleConns)
+	}
+	if NewClient(WithTransport(custom)).HTTPClient().Transport != custom {
+		t.Error("expected WithTransport to set the client's transport")
+	}
+}
@@ -28,6 +28,7 @@ const (
 
 type clientConfig struct {
 	httpClient  *http.Client
+	transport   http.RoundTripper
 	baseURL     string
 	retryPolicy *RetryPolicy
 }
@@ -43,6 +44,17 @@ func WithHTTPClient(c *http.Client) ClientOption {
 	}
 }
 
+// WithTransport sets the transport for the client's default HTTP client.
+// Clients created without WithHTTPClient or WithTransport share one
+// package-level transport; use NewTransport to build a tuned one and pass
+// the same transport to every client that should share its connections.
+// Ignored if WithHTTPClient is also set.
+func WithTransport(rt http.RoundTripper) ClientOption {
+	return func(cfg *clientConfig) {
+		cfg.transport = rt
+	}
+}
+
 // WithBaseURL sets a base URL that will be prepended to stream paths.
 // This is optional; you can also use full URLs when calling Client.Stream().
 func WithBaseURL(url string) ClientOption {
@@ -191,11 +203,12 @@ func WithAppendHeaders(headers map[string]string) AppendOption {
 // =============================================================================
 
 type readConfig struct {
-	offset  Offset
-	live    LiveMode
-	cursor  string
-	headers map[string]string
-	timeout time.Duration
+	offset       Offset
+	live         LiveMode
+	cursor       string
+	headers      map[string]string
+	timeout      time.Duration
+	reuseBuffers bool
 }
 
 // ReadOption configures a Read operation.
@@ -241,6 +254,18 @@ func WithReadTimeout(d time.Duration) ReadOption {
 	}
 }
 
+// WithBufferReuse makes the iterator read every response into one reused
+// buffer and return the same Chunk (or Batch) from each call to Next,
+// instead of allocating new ones per poll. Chunk.Data, Batch.Items and any
+// json.RawMessage items, which refer to the buffer, are only valid until
+// the next call to Next. Use it for consumers that process or forward each
+// response before reading the next one.
+func WithBufferReuse() ReadOption {
+	return func(cfg *readConfig) {
+		cfg.reuseBuffers = true
+	}
+}
+
 // =============================================================================
 // Head Options
 // =============================================================================
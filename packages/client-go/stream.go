@@ -499,6 +499,7 @@ func (s *Stream) Read(ctx context.Context, opts ...ReadOption) *ChunkIterator {
 		cursor:  cfg.cursor,
 		headers: cfg.headers,
 		timeout: cfg.timeout,
+		reuseBuffers: cfg.reuseBuffers,
 		Offset:  cfg.offset,
 		UpToDate: false,
 	}
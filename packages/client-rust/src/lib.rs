@@ -39,7 +39,7 @@ mod types;
 pub use client::{Client, ClientBuilder};
 pub use error::{InvalidHeaderError, ProducerError, StreamError};
 pub use iterator::{Chunk, ChunkIterator, ReadBuilder};
-pub use producer::{Producer, ProducerBuilder};
+pub use producer::{BatchingMode, Producer, ProducerBuilder};
 pub use stream::{AppendOptions, AppendResponse, CloseOptions, CloseResponse, CreateOptions, DurableStream, HeadResponse};
 pub use types::{LiveMode, Offset};
 
@@ -24,6 +24,20 @@ pub struct AppendReceipt {
     pub duplicate: bool,
 }
 
+/// Adaptive batching goal for a producer.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum BatchingMode {
+    /// Send as soon as a pipeline slot is free, with batches capped in
+    /// proportion to the batches in flight.
+    Latency,
+    /// Linger about one round trip per pipeline slot, so the pipeline stays
+    /// full with the largest batches it can carry.
+    Throughput,
+}
+
+/// Upper bound for linger in adaptive mode when no linger is set.
+const ADAPTIVE_MAX_LINGER: Duration = Duration::from_millis(25);
+
 /// Type alias for error callback function.
 pub type OnErrorCallback = Arc<dyn Fn(ProducerError) + Send + Sync>;
 
@@ -35,8 +49,9 @@ pub struct ProducerBuilder {
     epoch: u64,
     auto_claim: bool,
     max_batch_bytes: usize,
-    linger: Duration,
+    linger: Option<Duration>,
     max_in_flight: usize,
+    adaptive: Option<BatchingMode>,
     content_type: Option<String>,
     on_error: Option<OnErrorCallback>,
 }
@@ -49,8 +64,9 @@ impl ProducerBuilder {
             epoch: 0,
             auto_claim: false,
             max_batch_bytes: 1024 * 1024,
-            linger: Duration::from_millis(5),
+            linger: None,
             max_in_flight: 5,
+            adaptive: None,
             content_type: None,
             on_error: None,
         }
@@ -74,9 +90,9 @@ impl ProducerBuilder {
         self
     }
 
-    /// Set linger time before sending a batch.
+    /// Set linger time before sending a batch (default 5ms).
     pub fn linger(mut self, duration: Duration) -> Self {
-        self.linger = duration;
+        self.linger = Some(duration);
         self
     }
 
@@ -86,6 +102,16 @@ impl ProducerBuilder {
         self
     }
 
+    /// Size linger and batches from observed append round trips and the
+    /// batches in flight instead of the static linger.
+    ///
+    /// The linger and maximum batch size become upper bounds; linger then
+    /// defaults to 25ms.
+    pub fn adaptive(mut self, mode: BatchingMode) -> Self {
+        self.adaptive = Some(mode);
+        self
+    }
+
     /// Set content type for appends.
     pub fn content_type(mut self, ct: impl Into<String>) -> Self {
         self.content_type = Some(ct.into());
@@ -124,7 +150,19 @@ impl ProducerBuilder {
                 .unwrap_or_else(|| "application/octet-stream".to_string())
         });
 
-        let linger = self.linger;
+        let linger = self.linger.unwrap_or(if self.adaptive.is_some() {
+            ADAPTIVE_MAX_LINGER
+        } else {
+            Duration::from_millis(5)
+        });
+        let policy = self.adaptive.map(|mode| BatchPolicy {
+            mode,
+            max_linger: linger,
+            max_batch_bytes: self.max_batch_bytes,
+            max_in_flight: self.max_in_flight.max(1),
+            srtt: None,
+        });
+        let adaptive = policy.is_some();
 
         let producer = Producer {
             stream: self.stream,
@@ -138,6 +176,8 @@ impl ProducerBuilder {
                 epoch_claimed: !self.auto_claim,
                 stream_closed: false,
                 batch_started_at: None,
+                policy,
+                linger_scheduled: false,
             })),
             config: Arc::new(ProducerConfig {
                 auto_claim: self.auto_claim,
@@ -151,8 +191,8 @@ impl ProducerBuilder {
             seq_state: Arc::new(tokio::sync::Mutex::new(HashMap::new())),
         };
 
-        // Spawn linger task if linger > 0
-        if linger > Duration::ZERO {
+        // Spawn linger task if linger > 0 (adaptive batches schedule their own)
+        if linger > Duration::ZERO && !adaptive {
             let producer_clone = producer.clone();
             tokio::spawn(async move {
                 producer_clone.linger_task().await;
@@ -182,6 +222,67 @@ struct ProducerState {
     stream_closed: bool,
     /// When the first item was added to the current pending batch
     batch_started_at: Option<Instant>,
+    /// Adaptive batching policy, if enabled
+    policy: Option<BatchPolicy>,
+    /// Whether a linger is scheduled for the current pending batch
+    linger_scheduled: bool,
+}
+
+/// Sizes linger and batches from smoothed append round-trip times and the
+/// number of batches in flight, as the TypeScript and Go producers do:
+///
+/// - latency: no linger while a pipeline slot is free, and batches capped in
+///   proportion to the slots in use
+/// - throughput: linger the smoothed round trip divided by `max_in_flight`,
+///   the rate at which a full pipeline frees slots, with batches up to
+///   `max_batch_bytes`
+///
+/// In both modes a batch waits, growing, while every slot is busy, and is
+/// rescheduled as batches complete.
+struct BatchPolicy {
+    mode: BatchingMode,
+    max_linger: Duration,
+    max_batch_bytes: usize,
+    max_in_flight: usize,
+    /// Smoothed round-trip time, once one was observed
+    srtt: Option<Duration>,
+}
+
+impl BatchPolicy {
+    /// Record the round-trip time of a successful batch (TCP-style smoothing
+    /// with gain 1/8).
+    fn record_round_trip(&mut self, rtt: Duration) {
+        self.srtt = Some(match self.srtt {
+            None => rtt,
+            Some(srtt) => (srtt * 7 + rtt) / 8,
+        });
+    }
+
+    /// How long a new batch should linger, or `None` if every pipeline slot
+    /// is busy and the batch should wait for one to free.
+    fn linger(&self, in_flight: usize) -> Option<Duration> {
+        if in_flight >= self.max_in_flight {
+            return None;
+        }
+        Some(match (self.mode, self.srtt) {
+            (BatchingMode::Latency, _) => Duration::ZERO,
+            (BatchingMode::Throughput, None) => self.max_linger,
+            (BatchingMode::Throughput, Some(srtt)) => {
+                self.max_linger.min(srtt / self.max_in_flight as u32)
+            }
+        })
+    }
+
+    /// Batch size at which a batch is sent without further linger.
+    fn batch_bytes(&self, in_flight: usize) -> usize {
+        match self.mode {
+            BatchingMode::Throughput => self.max_batch_bytes,
+            BatchingMode::Latency => {
+                let slots = (in_flight + 1).min(self.max_in_flight);
+                (self.max_batch_bytes * slots + self.max_in_flight - 1) / self.max_in_flight
+            }
+        }
+    }
 }
 
 struct PendingEntry {
@@ -245,9 +346,7 @@ impl Producer {
         });
         state.batch_bytes += data_len;
 
-        if state.batch_bytes >= self.config.max_batch_bytes {
-            self.send_batch_locked(&mut state);
-        }
+        self.maybe_send_locked(&mut state);
     }
 
     /// Append JSON data (fire-and-forget).
@@ -292,9 +391,7 @@ impl Producer {
         });
         state.batch_bytes += len;
 
-        if state.batch_bytes >= self.config.max_batch_bytes {
-            self.send_batch_locked(&mut state);
-        }
+        self.maybe_send_locked(&mut state);
     }
 
     /// Flush all pending data and wait for all in-flight batches to complete.
@@ -400,6 +497,45 @@ impl Producer {
         self.state.lock().next_seq
     }
 
+    /// Send the pending batch once it is full, or schedule its adaptive
+    /// linger.
+    fn maybe_send_locked(&self, state: &mut ProducerState) {
+        let in_flight = self.in_flight.load(Ordering::Acquire);
+        let limit = match &state.policy {
+            Some(policy) => policy.batch_bytes(in_flight),
+            None => self.config.max_batch_bytes,
+        };
+        if state.batch_bytes >= limit {
+            self.send_batch_locked(state);
+        } else if state.policy.is_some() && !state.linger_scheduled {
+            self.schedule_linger_locked(state);
+        }
+    }
+
+    /// Schedule sending the pending batch after the adaptive policy's linger.
+    /// While every pipeline slot is busy nothing is scheduled; the batch keeps
+    /// growing and is rescheduled when a batch completes.
+    fn schedule_linger_locked(&self, state: &mut ProducerState) {
+        let (Some(policy), Some(started_at)) = (&state.policy, state.batch_started_at) else {
+            return;
+        };
+        let Some(linger) = policy.linger(self.in_flight.load(Ordering::Acquire)) else {
+            return;
+        };
+
+        state.linger_scheduled = true;
+        let producer = self.clone();
+        tokio::spawn(async move {
+            sleep(linger).await;
+            let mut state = producer.state.lock();
+            // A batch sent in the meantime scheduled its successor anew
+            if state.batch_started_at == Some(started_at) {
+                state.linger_scheduled = false;
+                producer.send_batch_locked(&mut state);
+            }
+        });
+    }
+
     /// Background task that sends batches after linger duration.
     async fn linger_task(&self) {
         let linger = self.config.linger;
@@ -468,6 +604,7 @@ impl Producer {
         state.next_seq += 1;
         state.batch_bytes = 0;
         state.batch_started_at = None;
+        state.linger_scheduled = false;
 
         // Increment in-flight (atomic - no lock needed)
         self.in_flight.fetch_add(1, Ordering::AcqRel);
@@ -479,8 +616,10 @@ impl Producer {
         let in_flight_counter = self.in_flight.clone();
         let state_arc = self.state.clone();
         let seq_state = self.seq_state.clone();
+        let adaptive = state.policy.is_some().then(|| self.clone());
 
         tokio::spawn(async move {
+            let started_at = Instant::now();
             let result =
                 do_send_batch(&stream, &producer_id, &config.content_type, batch, seq, epoch, config.auto_claim, &state_arc)
                     .await;
@@ -491,6 +630,9 @@ impl Producer {
                 if !state.epoch_claimed {
                     state.epoch_claimed = true;
                 }
+                if let Some(policy) = state.policy.as_mut() {
+                    policy.record_round_trip(started_at.elapsed());
+                }
             }
 
             // Call on_error callback if configured and error occurred
@@ -515,6 +657,14 @@ impl Producer {
 
             // Decrement in-flight (atomic - no lock needed)
             in_flight_counter.fetch_sub(1, Ordering::AcqRel);
+
+            // A batch held back while the pipeline was full can go now
+            if let Some(producer) = adaptive {
+                let mut state = producer.state.lock();
+                if !state.pending_batch.is_empty() && !state.linger_scheduled {
+                    producer.schedule_linger_locked(&mut state);
+                }
+            }
         });
     }
 }
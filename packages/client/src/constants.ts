@@ -108,6 +108,12 @@ export const CURSOR_QUERY_PARAM = `cursor`
  */
 export const STREAM_SSE_DATA_ENCODING_HEADER = `stream-sse-data-encoding`
 
+/**
+ * Path of the multiplexed read endpoint, relative to the server's stream
+ * route.
+ */
+export const MULTIPLEX_PATH = `/__ds/multiplex`
+
 // ============================================================================
 // SSE Control Event Fields (camelCase per PROTOCOL.md Section 5.7)
 // ============================================================================
@@ -20,6 +20,12 @@ import {
   STREAM_CLOSED_HEADER,
   STREAM_OFFSET_HEADER,
 } from "./constants"
+import {
+  ADAPTIVE_MAX_LINGER_MS,
+  AdaptiveBatchPolicy,
+  COMPRESSION_MIN_BYTES,
+  compressBody,
+} from "./producer-batching"
 import { resolveHeaders } from "./utils"
 import type { queueAsPromised } from "fastq"
 import type { DurableStream } from "./stream"
@@ -28,6 +34,7 @@ import type {
   HeadersRecord,
   IdempotentProducerOptions,
   Offset,
+  ProducerCompression,
 } from "./types"
 
 /**
@@ -132,6 +139,8 @@ export class IdempotentProducer {
   readonly #autoClaim: boolean
   readonly #maxBatchBytes: number
   readonly #lingerMs: number
+  readonly #policy?: AdaptiveBatchPolicy
+  readonly #compression?: ProducerCompression
   readonly #fetchClient: typeof fetch
   readonly #headers?: HeadersRecord
   readonly #signal?: AbortSignal
@@ -186,7 +195,8 @@ export class IdempotentProducer {
     const epoch = opts?.epoch ?? 0
     const maxBatchBytes = opts?.maxBatchBytes ?? 1024 * 1024 // 1MB
     const maxInFlight = opts?.maxInFlight ?? 5
-    const lingerMs = opts?.lingerMs ?? 5
+    const lingerMs =
+      opts?.lingerMs ?? (opts?.adaptive ? ADAPTIVE_MAX_LINGER_MS : 5)
 
     if (epoch < 0) {
       throw new Error(`epoch must be >= 0`)
@@ -214,6 +224,15 @@ export class IdempotentProducer {
       opts?.fetch ?? ((...args: Parameters<typeof fetch>) => fetch(...args))
 
     this.#maxInFlight = maxInFlight
+    this.#compression = opts?.compression
+    if (opts?.adaptive) {
+      this.#policy = new AdaptiveBatchPolicy(
+        opts.adaptive,
+        lingerMs,
+        maxBatchBytes,
+        maxInFlight
+      )
+    }
 
     // When autoClaim is true, epoch is not yet known until first batch completes
     // We block pipelining until then to avoid racing with the claim
@@ -296,16 +315,12 @@ export class IdempotentProducer {
     this.#batchBytes += bytes.length
 
     // Check if batch should be sent immediately
-    if (this.#batchBytes >= this.#maxBatchBytes) {
+    const batchLimit =
+      this.#policy?.batchBytes(this.inFlightCount) ?? this.#maxBatchBytes
+    if (this.#batchBytes >= batchLimit) {
       this.#enqueuePendingBatch()
     } else if (!this.#lingerTimeout) {
-      // Start linger timer
-      this.#lingerTimeout = setTimeout(() => {
-        this.#lingerTimeout = null
-        if (this.#pendingBatch.length > 0) {
-          this.#enqueuePendingBatch()
-        }
-      }, this.#lingerMs)
+      this.#scheduleLinger(this.inFlightCount)
     }
   }
 
@@ -540,6 +555,25 @@ export class IdempotentProducer {
   // Private implementation
   // ============================================================================
 
+  /**
+   * Start the linger timer for the pending batch. With adaptive batching
+   * the batch instead waits for a free pipeline slot while all are busy,
+   * and is rescheduled as batches complete.
+   */
+  #scheduleLinger(inFlight: number): void {
+    const lingerMs = this.#policy
+      ? this.#policy.lingerMs(inFlight)
+      : this.#lingerMs
+    if (lingerMs === undefined) return
+
+    this.#lingerTimeout = setTimeout(() => {
+      this.#lingerTimeout = null
+      if (this.#pendingBatch.length > 0) {
+        this.#enqueuePendingBatch()
+      }
+    }, lingerMs)
+  }
+
   /**
    * Enqueue the current pending batch for processing.
    */
@@ -589,9 +623,11 @@ export class IdempotentProducer {
   async #batchWorker(task: BatchTask): Promise<void> {
     const { batch, seq } = task
     const epoch = this.#epoch
+    const startedAt = Date.now()
 
     try {
       const result = await this.#doSendBatch(batch, seq, epoch)
+      this.#policy?.recordRoundTrip(Date.now() - startedAt)
       this.#recordSuccessfulOffset(result.offset)
 
       // Mark epoch as claimed after first successful batch
@@ -611,6 +647,13 @@ export class IdempotentProducer {
         this.#onError(error as Error)
       }
       throw error
+    } finally {
+      // A batch held back while the pipeline was full can go now; this
+      // task still counts as running
+      const held = this.#pendingBatch.length > 0 && !this.#lingerTimeout
+      if (this.#policy && held) {
+        this.#scheduleLinger(this.inFlightCount - 1)
+      }
     }
   }
 
@@ -713,7 +756,7 @@ export class IdempotentProducer {
     const isJson = normalizeContentType(contentType) === `application/json`
 
     // Build batch body based on content type
-    let batchedBody: BodyInit
+    let batchedBody: Uint8Array | string
     if (isJson) {
       // For JSON mode: always send as array (server flattens one level)
       // Single append: [value] → server stores value
@@ -736,18 +779,34 @@ export class IdempotentProducer {
     // Build URL
     const url = this.#stream.url
 
-    const headers = await this.#buildHeaders({
+    const protocolHeaders: Record<string, string> = {
       "content-type": contentType,
       [PRODUCER_ID_HEADER]: this.#producerId,
       [PRODUCER_EPOCH_HEADER]: epoch.toString(),
       [PRODUCER_SEQ_HEADER]: seq.toString(),
-    })
+    }
+
+    // Compress bodies large enough to benefit
+    let body = batchedBody as unknown as BodyInit
+    if (this.#compression) {
+      const bytes =
+        typeof batchedBody === `string`
+          ? new TextEncoder().encode(batchedBody)
+          : batchedBody
+      if (bytes.length >= COMPRESSION_MIN_BYTES) {
+        const compressed = await compressBody(bytes, this.#compression)
+        body = compressed as unknown as BodyInit
+        protocolHeaders[`content-encoding`] = this.#compression
+      }
+    }
+
+    const headers = await this.#buildHeaders(protocolHeaders)
 
     // Send request
     const response = await this.#fetchClient(url, {
       method: `POST`,
       headers,
-      body: batchedBody,
+      body,
       signal: this.#signal,
     })
 
@@ -13,6 +13,9 @@
 // Standalone stream() function - the fetch-like read API
 export { stream } from "./stream-api"
 
+// multiplex() - follow many streams over one connection
+export { multiplex } from "./multiplex"
+
 // ============================================================================
 // Handle API (read/write)
 // ============================================================================
@@ -72,6 +75,15 @@ export type {
   // Idempotent producer types
   IdempotentProducerOptions,
   IdempotentAppendResult,
+  ProducerBatchingMode,
+  ProducerCompression,
+
+  // Multiplexed read types
+  MultiplexStream,
+  MultiplexOptions,
+  MultiplexChunk,
+  MultiplexStreamError,
+  MultiplexEvent,
 
   // Error handling
   DurableStreamErrorCode,
@@ -127,6 +139,7 @@ export {
   SSE_COMPATIBLE_CONTENT_TYPES,
   SSE_CLOSED_FIELD,
   DURABLE_STREAM_PROTOCOL_QUERY_PARAMS,
+  MULTIPLEX_PATH,
   // Idempotent producer headers
   PRODUCER_ID_HEADER,
   PRODUCER_EPOCH_HEADER,
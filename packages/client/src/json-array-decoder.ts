@@ -0,0 +1,245 @@
+/**
+ * Incremental decoding of JSON-mode response bodies.
+ *
+ * A JSON-mode read returns one JSON array per response. Rather than
+ * buffering the body and parsing the whole array, JsonArrayDecoder scans
+ * bytes as they arrive and hands out the raw bytes of each complete item,
+ * so the first item is available before the last byte is received and no
+ * copy of the whole body is held alongside the parsed items.
+ */
+
+import { DurableStreamError } from "./error"
+
+const QUOTE = 0x22
+const COMMA = 0x2c
+const BACKSLASH = 0x5c
+const LBRACKET = 0x5b
+const RBRACKET = 0x5d
+const LBRACE = 0x7b
+const RBRACE = 0x7d
+
+function isWhitespace(b: number): boolean {
+  return b === 0x20 || b === 0x0a || b === 0x0d || b === 0x09
+}
+
+/**
+ * Splits a JSON body into the raw bytes of its top-level array items.
+ *
+ * Feed body chunks to push() and call end() once the body is complete. A
+ * body that is not an array yields itself as a single item; an empty body
+ * yields no items. Items are only delimited, not validated: parse them
+ * with parseJsonItem().
+ */
+export class JsonArrayDecoder {
+  #mode: `start` | `array` | `item` | `value` | `end` = `start`
+  #afterComma = false
+
+  // Scanner state within the current item
+  #depth = 0
+  #inString = false
+  #escaped = false
+
+  // Bytes of the current item received in earlier chunks
+  #parts: Array<Uint8Array> = []
+
+  /**
+   * Scan a body chunk, returning the items it completes. Items lying within
+   * one chunk are subarrays of it, not copies.
+   */
+  push(chunk: Uint8Array): Array<Uint8Array> {
+    const items: Array<Uint8Array> = []
+    let itemStart = 0
+    let i = 0
+    while (i < chunk.length) {
+      switch (this.#mode) {
+        case `start`: {
+          const b = chunk[i]!
+          if (isWhitespace(b)) {
+            i++
+          } else if (b === LBRACKET) {
+            this.#mode = `array`
+            i++
+          } else {
+            this.#mode = `value`
+          }
+          break
+        }
+
+        case `array`: {
+          const b = chunk[i]!
+          if (isWhitespace(b)) {
+            i++
+          } else if (b === RBRACKET && !this.#afterComma) {
+            this.#mode = `end`
+            i++
+          } else if (b === COMMA || b === RBRACKET) {
+            throw new SyntaxError(`Unexpected ${String.fromCharCode(b)}`)
+          } else {
+            this.#mode = `item`
+            this.#afterComma = false
+            this.#depth = 0
+            itemStart = i
+          }
+          break
+        }
+
+        case `item`: {
+          const end = this.#scanItem(chunk, i)
+          if (end === -1) {
+            this.#parts.push(chunk.subarray(itemStart))
+            i = chunk.length
+            break
+          }
+          items.push(this.#takeItem(chunk.subarray(itemStart, end)))
+          const b = chunk[end]!
+          if (b === COMMA) {
+            this.#mode = `array`
+            this.#afterComma = true
+          } else if (b === RBRACKET) {
+            this.#mode = `end`
+          } else {
+            throw new SyntaxError(`Unexpected ${String.fromCharCode(b)}`)
+          }
+          i = end + 1
+          break
+        }
+
+        case `value`:
+          this.#parts.push(chunk.subarray(i))
+          i = chunk.length
+          break
+
+        case `end`:
+          if (!isWhitespace(chunk[i]!)) {
+            throw new SyntaxError(`Unexpected data after JSON array`)
+          }
+          i++
+          break
+      }
+    }
+    return items
+  }
+
+  /**
+   * Finish the body, returning a non-array body as its single item.
+   */
+  end(): Array<Uint8Array> {
+    switch (this.#mode) {
+      case `start`:
+      case `end`:
+        return []
+      case `value`: {
+        const item = this.#takeItem(new Uint8Array(0))
+        return item.length > 0 ? [item] : []
+      }
+      default:
+        throw new SyntaxError(`Unexpected end of JSON array`)
+    }
+  }
+
+  /**
+   * Scan item bytes from `from`, returning the index of the comma or
+   * bracket that ends the item, or -1 if it continues past this chunk.
+   */
+  #scanItem(chunk: Uint8Array, from: number): number {
+    for (let i = from; i < chunk.length; i++) {
+      const b = chunk[i]!
+      if (this.#inString) {
+        if (this.#escaped) {
+          this.#escaped = false
+        } else if (b === BACKSLASH) {
+          this.#escaped = true
+        } else if (b === QUOTE) {
+          this.#inString = false
+        }
+      } else if (b === QUOTE) {
+        this.#inString = true
+      } else if (b === LBRACKET || b === LBRACE) {
+        this.#depth++
+      } else if (b === RBRACKET || b === RBRACE) {
+        if (this.#depth === 0) return i
+        this.#depth--
+      } else if (b === COMMA && this.#depth === 0) {
+        return i
+      }
+    }
+    return -1
+  }
+
+  /**
+   * Join the current item's parts with its final bytes, trimming trailing
+   * whitespace.
+   */
+  #takeItem(tail: Uint8Array): Uint8Array {
+    let item = tail
+    if (this.#parts.length > 0) {
+      this.#parts.push(tail)
+      const size = this.#parts.reduce((sum, part) => sum + part.length, 0)
+      item = new Uint8Array(size)
+      let offset = 0
+      for (const part of this.#parts) {
+        item.set(part, offset)
+        offset += part.length
+      }
+      this.#parts = []
+    }
+
+    let end = item.length
+    while (end > 0 && isWhitespace(item[end - 1]!)) end--
+    return end === item.length ? item : item.subarray(0, end)
+  }
+}
+
+/**
+ * Read a JSON-mode response as raw item bytes, decoding the body as it
+ * arrives. Body chunks are only read as items are consumed, so a slow
+ * consumer holds back the network read.
+ */
+export async function* readJsonItems(
+  response: Response
+): AsyncGenerator<Uint8Array, void, undefined> {
+  const body = response.body
+  if (!body) return
+
+  const decoder = new JsonArrayDecoder()
+  const reader = body.getReader()
+  try {
+    for (;;) {
+      const { done, value } = await reader.read()
+      let items: Array<Uint8Array>
+      try {
+        items = done ? decoder.end() : decoder.push(value)
+      } catch (err) {
+        throw new DurableStreamError(
+          `Failed to parse JSON response: ${err instanceof Error ? err.message : String(err)}`,
+          `PARSE_ERROR`
+        )
+      }
+      yield* items
+      if (done) return
+    }
+  } finally {
+    // Cancels the body if the consumer stopped early
+    reader.cancel().catch(() => {})
+    reader.releaseLock()
+  }
+}
+
+const textDecoder = new TextDecoder()
+
+/**
+ * Parse the raw bytes of one JSON item.
+ */
+export function parseJsonItem<T>(bytes: Uint8Array): T {
+  const content = textDecoder.decode(bytes)
+  try {
+    return JSON.parse(content) as T
+  } catch (err) {
+    const preview =
+      content.length > 100 ? content.slice(0, 100) + `...` : content
+    throw new DurableStreamError(
+      `Failed to parse JSON response: ${err instanceof Error ? err.message : String(err)}. Data: ${preview}`,
+      `PARSE_ERROR`
+    )
+  }
+}
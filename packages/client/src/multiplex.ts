@@ -0,0 +1,225 @@
+/**
+ * multiplex() - follow many streams over one connection.
+ *
+ * Instead of a long-poll or SSE connection per stream, a single request to
+ * the server's multiplexed read endpoint carries every (stream, offset) pair
+ * and returns interleaved chunks tagged by stream. The client tracks each
+ * stream's offset and reconnects from there, dropping streams once they are
+ * closed or fail.
+ */
+
+import { LIVE_QUERY_PARAM, MULTIPLEX_PATH } from "./constants"
+import { DurableStreamError, FetchBackoffAbortError } from "./error"
+import { BackoffDefaults, createFetchWithBackoff } from "./fetch"
+import { decodeBase64 } from "./response"
+import { parseSSEStream } from "./sse"
+import { resolveHeaders } from "./utils"
+import type {
+  MultiplexChunk,
+  MultiplexEvent,
+  MultiplexOptions,
+  Offset,
+} from "./types"
+
+/**
+ * A long-poll response entry or SSE control event of a multiplexed read.
+ */
+interface MultiplexWireEvent {
+  stream: string
+  data?: unknown
+  dataEncoding?: `json` | `text` | `base64`
+  streamNextOffset?: Offset
+  upToDate?: boolean
+  streamClosed?: boolean
+  status?: number
+  error?: string
+}
+
+/**
+ * Follow many streams over one connection.
+ *
+ * Yields each stream's chunks as they arrive, interleaved across streams,
+ * and ends once every stream is closed or has failed (or after one response
+ * when `live` is false).
+ *
+ * @example
+ * ```typescript
+ * for await (const event of multiplex<AgentEvent>({
+ *   url: `https://streams.example.com/v1/stream`,
+ *   streams: sessions.map((s) => ({ path: s.path, offset: s.offset })),
+ * })) {
+ *   if (event.type === `chunk` && event.items) {
+ *     render(event.path, event.items)
+ *   }
+ * }
+ * ```
+ */
+export async function* multiplex<TJson = unknown>(
+  options: MultiplexOptions
+): AsyncGenerator<MultiplexEvent<TJson>, void, undefined> {
+  if (!options.url) {
+    throw new DurableStreamError(
+      `Invalid multiplex options: missing required url parameter`,
+      `BAD_REQUEST`
+    )
+  }
+
+  const live = options.live ?? `sse`
+  const endpoint = new URL(
+    `${options.url.toString().replace(/\/+$/, ``)}${MULTIPLEX_PATH}`
+  )
+  if (live) {
+    endpoint.searchParams.set(LIVE_QUERY_PARAM, live)
+  }
+
+  // Offsets of the streams still being followed
+  const offsets = new Map<string, Offset>()
+  for (const { path, offset } of options.streams) {
+    offsets.set(path, offset ?? `-1`)
+  }
+
+  const baseFetchClient =
+    options.fetch ?? ((...args: Parameters<typeof fetch>) => fetch(...args))
+  const fetchClient = createFetchWithBackoff(
+    baseFetchClient,
+    options.backoffOptions ?? BackoffDefaults
+  )
+
+  while (offsets.size > 0 && !options.signal?.aborted) {
+    const headers = await resolveHeaders(options.headers)
+    let response: Response
+    try {
+      response = await fetchClient(endpoint.toString(), {
+        method: `POST`,
+        headers: { ...headers, "content-type": `application/json` },
+        body: JSON.stringify({
+          streams: Array.from(offsets, ([path, offset]) => ({ path, offset })),
+        }),
+        signal: options.signal,
+      })
+    } catch (err) {
+      if (err instanceof FetchBackoffAbortError || options.signal?.aborted) {
+        return
+      }
+      throw err
+    }
+
+    try {
+      if (live === `sse`) {
+        if (!response.body) return
+        // Data events are followed by the control event naming their stream
+        let pending: Array<string> = []
+        for await (const event of parseSSEStream(
+          response.body,
+          options.signal
+        )) {
+          if (event.type === `data`) {
+            pending.push(event.data)
+            continue
+          }
+          if (!event.stream) continue
+          const result = advance<TJson>(offsets, {
+            ...event,
+            stream: event.stream,
+          })
+          if (result.type === `chunk` && pending.length > 0) {
+            decodeSSEData(result, event.dataEncoding, pending)
+          }
+          pending = []
+          yield result
+        }
+        continue
+      }
+
+      if (response.status === 204) continue
+      const body = (await response.json()) as {
+        streams: Array<MultiplexWireEvent>
+      }
+      for (const event of body.streams) {
+        const result = advance<TJson>(offsets, event)
+        if (result.type === `chunk` && event.data !== undefined) {
+          switch (event.dataEncoding) {
+            case `json`:
+              result.items = event.data as Array<TJson>
+              break
+            case `base64`:
+              result.bytes = decodeBase64(event.data as string)
+              break
+            default:
+              result.text = event.data as string
+          }
+        }
+        yield result
+      }
+    } catch (err) {
+      if (options.signal?.aborted) return
+      throw err
+    }
+    if (!live) return
+  }
+}
+
+/**
+ * Advance a stream past an event, or drop it if the event ends it.
+ */
+function advance<TJson>(
+  offsets: Map<string, Offset>,
+  event: MultiplexWireEvent
+): MultiplexEvent<TJson> {
+  const path = event.stream
+  if (event.status !== undefined) {
+    offsets.delete(path)
+    return {
+      type: `error`,
+      path,
+      status: event.status,
+      message: event.error ?? `stream read failed`,
+    }
+  }
+
+  const offset = event.streamNextOffset ?? offsets.get(path) ?? `-1`
+  const streamClosed = event.streamClosed === true
+  if (streamClosed) {
+    offsets.delete(path)
+  } else {
+    offsets.set(path, offset)
+  }
+  return {
+    type: `chunk`,
+    path,
+    offset,
+    upToDate: streamClosed || event.upToDate === true,
+    streamClosed,
+  }
+}
+
+/**
+ * Attach the data events preceding a stream's control event to its chunk.
+ * Each event is encoded independently.
+ */
+function decodeSSEData<TJson>(
+  chunk: MultiplexChunk<TJson>,
+  dataEncoding: MultiplexWireEvent[`dataEncoding`],
+  data: Array<string>
+): void {
+  switch (dataEncoding) {
+    case `json`:
+      chunk.items = data.flatMap((part) => JSON.parse(part) as Array<TJson>)
+      break
+    case `base64`: {
+      const parts = data.map((part) => decodeBase64(part))
+      const bytes = new Uint8Array(
+        parts.reduce((total, part) => total + part.length, 0)
+      )
+      let position = 0
+      for (const part of parts) {
+        bytes.set(part, position)
+        position += part.length
+      }
+      chunk.bytes = bytes
+      break
+    }
+    default:
+      chunk.text = data.join(``)
+  }
+}
@@ -0,0 +1,101 @@
+/**
+ * Adaptive batching and body compression for IdempotentProducer.
+ *
+ * The same policy is implemented by the Go and Rust producers, so workers
+ * written against any client batch alike under the same load.
+ */
+
+import type { ProducerBatchingMode, ProducerCompression } from "./types"
+
+/**
+ * Upper bound for linger in adaptive mode when lingerMs is not set.
+ */
+export const ADAPTIVE_MAX_LINGER_MS = 25
+
+/**
+ * Smallest batch body worth compressing.
+ */
+export const COMPRESSION_MIN_BYTES = 1024
+
+/**
+ * Sizes linger and batches from smoothed append round-trip times and the
+ * number of batches in flight.
+ *
+ * - latency: no linger while a pipeline slot is free, and batches capped in
+ *   proportion to the slots in use, so an idle producer sends small
+ *   batches at once and a busy one coalesces.
+ * - throughput: linger about one round trip divided by maxInFlight, the
+ *   rate at which a full pipeline frees slots, with batches up to
+ *   maxBatchBytes.
+ *
+ * In both modes a batch waits, growing, while every slot is busy; the
+ * producer reschedules it when a batch completes.
+ */
+export class AdaptiveBatchPolicy {
+  readonly #mode: ProducerBatchingMode
+  readonly #maxLingerMs: number
+  readonly #maxBatchBytes: number
+  readonly #maxInFlight: number
+  #srttMs: number | undefined
+
+  constructor(
+    mode: ProducerBatchingMode,
+    maxLingerMs: number,
+    maxBatchBytes: number,
+    maxInFlight: number
+  ) {
+    this.#mode = mode
+    this.#maxLingerMs = maxLingerMs
+    this.#maxBatchBytes = maxBatchBytes
+    this.#maxInFlight = maxInFlight
+  }
+
+  /**
+   * Smoothed append round-trip time (ms), once one was observed.
+   */
+  get roundTripMs(): number | undefined {
+    return this.#srttMs
+  }
+
+  /**
+   * Record the round-trip time of a successful batch (TCP-style smoothing
+   * with gain 1/8).
+   */
+  recordRoundTrip(ms: number): void {
+    this.#srttMs =
+      this.#srttMs === undefined ? ms : this.#srttMs + (ms - this.#srttMs) / 8
+  }
+
+  /**
+   * How long a new batch should linger, or undefined if every pipeline slot
+   * is busy and the batch should wait for one to free.
+   */
+  lingerMs(inFlight: number): number | undefined {
+    if (inFlight >= this.#maxInFlight) return undefined
+    if (this.#mode === `latency`) return 0
+    if (this.#srttMs === undefined) return this.#maxLingerMs
+    return Math.min(this.#maxLingerMs, this.#srttMs / this.#maxInFlight)
+  }
+
+  /**
+   * Batch size at which a batch is sent without further linger.
+   */
+  batchBytes(inFlight: number): number {
+    if (this.#mode === `throughput`) return this.#maxBatchBytes
+    const slots = Math.min(inFlight + 1, this.#maxInFlight)
+    return Math.ceil((this.#maxBatchBytes * slots) / this.#maxInFlight)
+  }
+}
+
+/**
+ * Compress a batch body with the given content coding.
+ */
+export async function compressBody(
+  body: Uint8Array,
+  compression: ProducerCompression
+): Promise<Uint8Array> {
+  const stream = new Response(body as unknown as BodyInit).body!.pipeThrough(
+    new CompressionStream(compression)
+  )
+  return new Uint8Array(await new Response(stream).arrayBuffer())
+}
@@ -14,6 +14,7 @@ import {
   STREAM_UP_TO_DATE_HEADER,
 } from "./constants"
 import { DurableStreamError } from "./error"
+import { parseJsonItem, readJsonItems } from "./json-array-decoder"
 import { parseSSEStream } from "./sse"
 import { LongPollState, PausedState, SSEState } from "./stream-response-state"
 import type { ReadableStreamAsyncIterable } from "./asyncIterableReadableStream"
@@ -927,24 +928,9 @@ export class StreamResponseImpl<
       while (!result.done) {
         // Capture upToDate BEFORE parsing (to avoid race with prefetch)
         const wasUpToDate = this.upToDate
-        // Get response text first (handles empty responses gracefully)
-        const text = await result.value.text()
-        const content = text.trim() || `[]` // Default to empty array if no content or whitespace
-        let parsed: T | Array<T>
-        try {
-          parsed = JSON.parse(content) as T | Array<T>
-        } catch (err) {
-          const preview =
-            content.length > 100 ? content.slice(0, 100) + `...` : content
-          throw new DurableStreamError(
-            `Failed to parse JSON response: ${err instanceof Error ? err.message : String(err)}. Data: ${preview}`,
-            `PARSE_ERROR`
-          )
-        }
-        if (Array.isArray(parsed)) {
-          items.push(...parsed)
-        } else {
-          items.push(parsed)
+        // Parse items as the body arrives (an empty body has none)
+        for await (const item of readJsonItems(result.value)) {
+          items.push(parseJsonItem<T>(item))
         }
         // Check if THIS response had upToDate set when we started reading it
         if (wasUpToDate) break
@@ -1052,60 +1038,61 @@ export class StreamResponseImpl<
   jsonStream(): ReadableStreamAsyncIterable<TJson> {
     this.#ensureNoConsumption(`jsonStream`)
     this.#ensureJsonMode()
+    return asAsyncIterableReadableStream(
+      this.#createJsonItemStream((item) => parseJsonItem<TJson>(item))
+    )
+  }
+
+  jsonRawStream(): ReadableStreamAsyncIterable<Uint8Array> {
+    this.#ensureNoConsumption(`jsonRawStream`)
+    this.#ensureJsonMode()
+    return asAsyncIterableReadableStream(
+      this.#createJsonItemStream((item) => item)
+    )
+  }
+
+  /**
+   * Stream the JSON items of every response, decoding each body
+   * incrementally. A body is only read as far as items are pulled, so the
+   * consumer's pace holds back the network read.
+   */
+  #createJsonItemStream<T>(map: (item: Uint8Array) => T): ReadableStream<T> {
     const reader = this.#getResponseReader()
-    let pendingItems: Array<TJson> = []
+    let items: AsyncGenerator<Uint8Array, void, undefined> | undefined
 
-    const stream = new ReadableStream<TJson>({
+    return new ReadableStream<T>({
       pull: async (controller) => {
-        // Drain pending items first
-        if (pendingItems.length > 0) {
-          controller.enqueue(pendingItems.shift())
-          return
-        }
-
         // Keep reading until we can enqueue at least one item.
         // This avoids stalling when a response contains an empty JSON array.
-        let result = await reader.read()
-        while (!result.done) {
-          const response = result.value
-
-          // Parse JSON and flatten arrays (handle empty responses gracefully)
-          const text = await response.text()
-          const content = text.trim() || `[]` // Default to empty array if no content or whitespace
-          let parsed: TJson | Array<TJson>
-          try {
-            parsed = JSON.parse(content) as TJson | Array<TJson>
-          } catch (err) {
-            const preview =
-              content.length > 100 ? content.slice(0, 100) + `...` : content
-            throw new DurableStreamError(
-              `Failed to parse JSON response: ${err instanceof Error ? err.message : String(err)}. Data: ${preview}`,
-              `PARSE_ERROR`
-            )
+        for (;;) {
+          if (!items) {
+            const result = await reader.read()
+            if (result.done) {
+              this.#markClosed()
+              controller.close()
+              return
+            }
+            items = readJsonItems(result.value)
           }
-          pendingItems = Array.isArray(parsed) ? parsed : [parsed]
 
-          if (pendingItems.length > 0) {
-            controller.enqueue(pendingItems.shift())
+          const next = await items.next()
+          if (!next.done) {
+            controller.enqueue(map(next.value))
             return
           }
 
-          // Empty JSON batch; read the next response.
-          result = await reader.read()
+          // Response exhausted; read the next one.
+          items = undefined
         }
-
-        this.#markClosed()
-        controller.close()
-        return
       },
 
       cancel: () => {
+        // Cancels the current body, once any pending read settles
+        items?.return().catch(() => {})
         reader.releaseLock()
         this.cancel()
       },
     })
-
-    return asAsyncIterableReadableStream(stream)
   }
 
   textStream(): ReadableStreamAsyncIterable<string> {
@@ -1157,21 +1144,11 @@ export class StreamResponseImpl<
               this.streamClosed
             )
 
-          // Get response text first (handles empty responses gracefully)
-          const text = await response.text()
-          const content = text.trim() || `[]` // Default to empty array if no content or whitespace
-          let parsed: T | Array<T>
-          try {
-            parsed = JSON.parse(content) as T | Array<T>
-          } catch (err) {
-            const preview =
-              content.length > 100 ? content.slice(0, 100) + `...` : content
-            throw new DurableStreamError(
-              `Failed to parse JSON response: ${err instanceof Error ? err.message : String(err)}. Data: ${preview}`,
-              `PARSE_ERROR`
-            )
+          // Parse items as the body arrives (an empty body has none)
+          const items: Array<T> = []
+          for await (const item of readJsonItems(response)) {
+            items.push(parseJsonItem<T>(item))
           }
-          const items = Array.isArray(parsed) ? parsed : [parsed]
 
           // Await callback (handles both sync and async)
           await subscriber({
@@ -1376,7 +1353,7 @@ function getMetadataFromResponse(
  * Decode base64 string to Uint8Array.
  * Per protocol: concatenate data lines, remove \n and \r, then decode.
  */
-function decodeBase64(base64Str: string): Uint8Array {
+export function decodeBase64(base64Str: string): Uint8Array {
   // Remove all newlines and carriage returns per protocol
   const cleaned = base64Str.replace(/[\n\r]/g, ``)
 
@@ -4,6 +4,9 @@
  * SSE format from protocol:
  * - `event: data` events contain the stream data
  * - `event: control` events contain `streamNextOffset` and optional `streamCursor` and `upToDate`
+ *
+ * Multiplexed responses (see multiplex.ts) tag each control event with the
+ * `stream` its preceding data events belong to.
  */
 
 import { DurableStreamError } from "./error"
@@ -23,10 +26,46 @@ export interface SSEControlEvent {
   streamCursor?: string
   upToDate?: boolean
   streamClosed?: boolean
+  /** Stream path, on multiplexed responses only */
+  stream?: string
+  /** How the stream's data is encoded, on multiplexed responses only */
+  dataEncoding?: `json` | `text` | `base64`
+  /** Error status of a stream dropped from a multiplexed response */
+  status?: number
+  /** Error message of a stream dropped from a multiplexed response */
+  error?: string
 }
 
 export type SSEEvent = SSEDataEvent | SSEControlEvent
 
+/**
+ * Parse the JSON payload of a control event.
+ */
+function parseControlEvent(dataStr: string): SSEControlEvent {
+  try {
+    const control = JSON.parse(dataStr) as Omit<SSEControlEvent, `type`>
+    return {
+      type: `control`,
+      streamNextOffset: control.streamNextOffset,
+      streamCursor: control.streamCursor,
+      upToDate: control.upToDate,
+      streamClosed: control.streamClosed,
+      stream: control.stream,
+      dataEncoding: control.dataEncoding,
+      status: control.status,
+      error: control.error,
+    }
+  } catch (err) {
+    // Control events contain critical offset data - don't silently ignore
+    const preview =
+      dataStr.length > 100 ? dataStr.slice(0, 100) + `...` : dataStr
+    throw new DurableStreamError(
+      `Failed to parse SSE control event: ${err instanceof Error ? err.message : String(err)}. Data: ${preview}`,
+      `PARSE_ERROR`
+    )
+  }
+}
+
 /**
  * Parse SSE events from a ReadableStream<Uint8Array>.
  * Yields parsed events as they arrive.
@@ -69,29 +108,7 @@ export async function* parseSSEStream(
             if (currentEvent.type === `data`) {
               yield { type: `data`, data: dataStr }
             } else if (currentEvent.type === `control`) {
-              try {
-                const control = JSON.parse(dataStr) as {
-                  streamNextOffset: Offset
-                  streamCursor?: string
-                  upToDate?: boolean
-                  streamClosed?: boolean
-                }
-                yield {
-                  type: `control`,
-                  streamNextOffset: control.streamNextOffset,
-                  streamCursor: control.streamCursor,
-                  upToDate: control.upToDate,
-                  streamClosed: control.streamClosed,
-                }
-              } catch (err) {
-                // Control events contain critical offset data - don't silently ignore
-                const preview =
-                  dataStr.length > 100 ? dataStr.slice(0, 100) + `...` : dataStr
-                throw new DurableStreamError(
-                  `Failed to parse SSE control event: ${err instanceof Error ? err.message : String(err)}. Data: ${preview}`,
-                  `PARSE_ERROR`
-                )
-              }
+              yield parseControlEvent(dataStr)
             }
             // Unknown event types are silently skipped per protocol
           }
@@ -125,28 +142,7 @@ export async function* parseSSEStream(
       if (currentEvent.type === `data`) {
         yield { type: `data`, data: dataStr }
       } else if (currentEvent.type === `control`) {
-        try {
-          const control = JSON.parse(dataStr) as {
-            streamNextOffset: Offset
-            streamCursor?: string
-            upToDate?: boolean
-            streamClosed?: boolean
-          }
-          yield {
-            type: `control`,
-            streamNextOffset: control.streamNextOffset,
-            streamCursor: control.streamCursor,
-            upToDate: control.upToDate,
-            streamClosed: control.streamClosed,
-          }
-        } catch (err) {
-          const preview =
-            dataStr.length > 100 ? dataStr.slice(0, 100) + `...` : dataStr
-          throw new DurableStreamError(
-            `Failed to parse SSE control event: ${err instanceof Error ? err.message : String(err)}. Data: ${preview}`,
-            `PARSE_ERROR`
-          )
-        }
+        yield parseControlEvent(dataStr)
       }
     }
   } finally {
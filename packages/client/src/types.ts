@@ -799,13 +799,24 @@ export interface StreamResponse<TJson = unknown> {
 
   /**
    * Individual JSON items (flattened) as a ReadableStream<TJson>.
-   * Built on jsonBatches().
+   * Items are parsed one at a time as each response body arrives, so large
+   * catch-up batches are not buffered or parsed whole.
    *
    * The returned stream is guaranteed to be async-iterable, so you can use
    * `for await...of` syntax even on Safari/iOS which may lack native support.
    */
   jsonStream: () => ReadableStreamAsyncIterable<TJson>
 
+  /**
+   * The raw JSON bytes of each item (flattened) as a
+   * ReadableStream<Uint8Array>, for consumers that parse items lazily or
+   * forward them unparsed. Only valid in JSON-mode; throws otherwise.
+   *
+   * Like jsonStream(), items are split out of each response as its body
+   * arrives, and the body is only read as fast as items are consumed.
+   */
+  jsonRawStream: () => ReadableStreamAsyncIterable<Uint8Array>
+
   /**
    * Text chunks as ReadableStream<string>.
    *
@@ -878,6 +889,20 @@ export interface StreamResponse<TJson = unknown> {
 /**
  * Options for creating an IdempotentProducer.
  */
+/**
+ * Adaptive batching goal for an IdempotentProducer.
+ * - "latency": send as soon as a pipeline slot is free, with batches capped
+ *   in proportion to the batches in flight
+ * - "throughput": linger about one round trip per pipeline slot, so the
+ *   pipeline stays full with the largest batches it can carry
+ */
+export type ProducerBatchingMode = `latency` | `throughput`
+
+/**
+ * Content coding for producer batch bodies.
+ */
+export type ProducerCompression = `gzip`
+
 export interface IdempotentProducerOptions {
   /**
    * Starting epoch (default: 0).
@@ -911,6 +936,21 @@ export interface IdempotentProducerOptions {
    */
   maxInFlight?: number
 
+  /**
+   * Size linger and batches from observed append round-trip times and the
+   * number of batches in flight instead of the static lingerMs. lingerMs
+   * and maxBatchBytes become upper bounds; lingerMs then defaults to 25.
+   * @default undefined (static batching)
+   */
+  adaptive?: ProducerBatchingMode
+
+  /**
+   * Compress batch bodies of at least 1 KiB with this content coding.
+   * The server must accept Content-Encoding on appends.
+   * @default undefined (no compression)
+   */
+  compression?: ProducerCompression
+
   /**
    * Custom fetch implementation.
    */
@@ -952,3 +992,127 @@ export interface IdempotentAppendResult {
    */
   duplicate: boolean
 }
+
+// ============================================================================
+// Multiplexed Read Types
+// ============================================================================
+
+/**
+ * A stream followed by a multiplexed read.
+ */
+export interface MultiplexStream {
+  /**
+   * Stream path as seen by the server, e.g. "/v1/stream/agents/session-1".
+   */
+  path: string
+
+  /**
+   * Starting offset. Defaults to "-1" (start of stream).
+   */
+  offset?: Offset
+}
+
+/**
+ * Options for the multiplex() function.
+ */
+export interface MultiplexOptions {
+  /**
+   * Origin of the server, or the route prefix the streams are mounted
+   * under. Requests go to `${url}/__ds/multiplex`.
+   * E.g., "https://streams.example.com/v1/stream"
+   */
+  url: string | URL
+
+  /**
+   * Streams to follow, each from its own offset.
+   */
+  streams: Array<MultiplexStream>
+
+  /**
+   * Live mode behavior:
+   * - false: Catch-up only, one chunk per stream
+   * - "sse" (default): One server-sent events connection for all streams
+   * - "long-poll": Each request returns as soon as any stream has data
+   */
+  live?: false | `long-poll` | `sse`
+
+  /**
+   * HTTP headers to include in requests. Functions are evaluated per request.
+   */
+  headers?: HeadersRecord
+
+  /**
+   * AbortSignal for cancellation.
+   */
+  signal?: AbortSignal
+
+  /**
+   * Custom fetch implementation (for auth layers, proxies, etc.).
+   * Defaults to globalThis.fetch.
+   */
+  fetch?: typeof globalThis.fetch
+
+  /**
+   * Backoff options for retry behavior.
+   */
+  backoffOptions?: BackoffOptions
+}
+
+/**
+ * A chunk of one stream from a multiplexed read. Exactly one of items, text
+ * or bytes is set when the chunk carries data; control-only chunks (e.g. the
+ * first one of each stream) only advance the offset.
+ */
+export interface MultiplexChunk<TJson = unknown> {
+  type: `chunk`
+
+  /**
+   * Path of the stream the chunk belongs to.
+   */
+  path: string
+
+  /**
+   * Messages of a JSON stream.
+   */
+  items?: Array<TJson>
+
+  /**
+   * Data of a text stream.
+   */
+  text?: string
+
+  /**
+   * Data of a binary stream.
+   */
+  bytes?: Uint8Array
+
+  /**
+   * Offset after this chunk. Resume the stream from here.
+   */
+  offset: Offset
+
+  /**
+   * Whether the stream is caught up to its tail.
+   */
+  upToDate: boolean
+
+  /**
+   * Whether the stream is closed. This is the stream's last chunk.
+   */
+  streamClosed: boolean
+}
+
+/**
+ * A stream dropped from a multiplexed read because it could not be read
+ * (e.g. 404 when it does not exist, 410 when it was deleted).
+ */
+export interface MultiplexStreamError {
+  type: `error`
+  path: string
+  status: number
+  message: string
+}
+
+export type MultiplexEvent<TJson = unknown> =
+  | MultiplexChunk<TJson>
+  | MultiplexStreamError
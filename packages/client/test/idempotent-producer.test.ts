@@ -1,3 +1,4 @@
+import { gunzipSync } from "node:zlib"
 import { describe, expect, it, vi } from "vitest"
 import {
   PRODUCER_SEQ_HEADER,
@@ -190,6 +191,79 @@ describe(`IdempotentProducer`, () => {
     expect(producer.lastSuccessfulOffset).toBe(`3_15`)
   })
 
+  it(`gzips batch bodies past the compression threshold`, async () => {
+    const mockFetch = vi.fn().mockImplementation(
+      () =>
+        new Response(null, {
+          status: 200,
+          headers: { [STREAM_OFFSET_HEADER]: offset(0, 5) },
+        })
+    )
+    const stream = new DurableStream({
+      url: `https://example.com/stream`,
+      contentType: `text/plain`,
+    })
+    const producer = new IdempotentProducer(stream, `test-producer`, {
+      compression: `gzip`,
+      fetch: mockFetch,
+    })
+
+    producer.append(`small`)
+    await producer.flush()
+    producer.append(`x`.repeat(4096))
+    await producer.flush()
+
+    const [small, large] = mockFetch.mock.calls.map(([, init]) => init)
+    expect(new Headers(small.headers).get(`content-encoding`)).toBeNull()
+    expect(new Headers(large.headers).get(`content-encoding`)).toBe(`gzip`)
+    expect(gunzipSync(large.body).toString()).toBe(`x`.repeat(4096))
+  })
+
+  it(`holds adaptive batches while every pipeline slot is busy`, async () => {
+    let resolveFirst: ((response: Response) => void) | undefined
+    const first = new Promise<Response>((resolve) => {
+      resolveFirst = resolve
+    })
+    const mockFetch = vi
+      .fn()
+      .mockReturnValueOnce(first)
+      .mockResolvedValueOnce(
+        new Response(null, {
+          status: 200,
+          headers: { [STREAM_OFFSET_HEADER]: offset(0, 3) },
+        })
+      )
+    const stream = new DurableStream({
+      url: `https://example.com/stream`,
+      contentType: `text/plain`,
+    })
+    const producer = new IdempotentProducer(stream, `test-producer`, {
+      adaptive: `latency`,
+      maxInFlight: 1,
+      fetch: mockFetch,
+    })
+
+    producer.append(`a`)
+    await vi.waitFor(() => expect(mockFetch).toHaveBeenCalledTimes(1))
+    producer.append(`b`)
+    producer.append(`c`)
+    await new Promise((resolve) => setTimeout(resolve, 20))
+    expect(mockFetch).toHaveBeenCalledTimes(1)
+
+    resolveFirst!(
+      new Response(null, {
+        status: 200,
+        headers: { [STREAM_OFFSET_HEADER]: offset(0, 1) },
+      })
+    )
+    await vi.waitFor(() => expect(mockFetch).toHaveBeenCalledTimes(2))
+    await producer.flush()
+
+    const body = mockFetch.mock.calls[1]![1]?.body as Uint8Array
+    expect(new TextDecoder().decode(body)).toBe(`bc`)
+    expect(producer.lastSuccessfulOffset).toBe(offset(0, 3))
+  })
+
   it(`exports SSE control event field constants from the public entrypoint`, () => {
     expect(SSE_OFFSET_FIELD).toBe(`streamNextOffset`)
     expect(SSE_CURSOR_FIELD).toBe(`streamCursor`)
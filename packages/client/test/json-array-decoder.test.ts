@@ -0,0 +1,46 @@
+import { describe, expect, it } from "vitest"
+import { JsonArrayDecoder, parseJsonItem } from "../src/json-array-decoder"
+
+const encoder = new TextEncoder()
+
+function decode(body: string, chunkSize: number): Array<unknown> {
+  const decoder = new JsonArrayDecoder()
+  const bytes = encoder.encode(body)
+  const items: Array<Uint8Array> = []
+  for (let i = 0; i < bytes.length; i += chunkSize) {
+    items.push(...decoder.push(bytes.subarray(i, i + chunkSize)))
+  }
+  items.push(...decoder.end())
+  return items.map((item) => parseJsonItem(item))
+}
+
+describe(`JsonArrayDecoder`, () => {
+  it(`splits array items at any chunk boundary`, () => {
+    const body = ` [ {"a":"x,]}\\"[","b":[1,{"c":3}]} , "s\\\\" ,3, true,null,[ ] ] `
+    const expected = JSON.parse(body)
+    for (let size = 1; size <= body.length; size++) {
+      expect(decode(body, size)).toEqual(expected)
+    }
+  })
+
+  it(`slices items within a chunk without copying`, () => {
+    const decoder = new JsonArrayDecoder()
+    const chunk = encoder.encode(`[1,"two"]`)
+    const [first, second] = decoder.push(chunk)
+
+    expect(first!.buffer).toBe(chunk.buffer)
+    expect(new TextDecoder().decode(second)).toBe(`"two"`)
+  })
+
+  it(`treats empty bodies and non-array bodies like JSON.parse`, () => {
+    expect(decode(``, 1)).toEqual([])
+    expect(decode(` [ ] `, 2)).toEqual([])
+    expect(decode(`{"a":1}`, 3)).toEqual([{ a: 1 }])
+  })
+
+  it(`rejects malformed arrays`, () => {
+    for (const body of [`[1,]`, `[,1]`, `[1,,2]`, `[1`, `[1}`, `[1] x`]) {
+      expect(() => decode(body, 1), body).toThrow(SyntaxError)
+    }
+  })
+})
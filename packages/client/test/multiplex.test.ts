@@ -0,0 +1,177 @@
+import { beforeEach, describe, expect, it, vi } from "vitest"
+import { multiplex } from "../src/index"
+import type { MultiplexEvent } from "../src/index"
+import type { Mock } from "vitest"
+
+function sseResponse(body: string): Response {
+  return new Response(body, {
+    status: 200,
+    headers: { "content-type": `text/event-stream` },
+  })
+}
+
+async function collect(
+  events: AsyncGenerator<MultiplexEvent>
+): Promise<Array<MultiplexEvent>> {
+  const result: Array<MultiplexEvent> = []
+  for await (const event of events) {
+    result.push(event)
+  }
+  return result
+}
+
+describe(`multiplex()`, () => {
+  let mockFetch: Mock<typeof fetch>
+
+  beforeEach(() => {
+    mockFetch = vi.fn()
+  })
+
+  it(`should post every stream and offset to the multiplex endpoint`, async () => {
+    mockFetch.mockResolvedValue(
+      new Response(JSON.stringify({ streams: [] }), { status: 200 })
+    )
+
+    await collect(
+      multiplex({
+        url: `https://example.com/v1/stream/`,
+        streams: [{ path: `/v1/stream/a`, offset: `1_5` }, { path: `/b` }],
+        live: false,
+        fetch: mockFetch,
+      })
+    )
+
+    expect(mockFetch).toHaveBeenCalledTimes(1)
+    const [url, init] = mockFetch.mock.calls[0]!
+    expect(url).toBe(`https://example.com/v1/stream/__ds/multiplex`)
+    expect(init?.method).toBe(`POST`)
+    expect(JSON.parse(init?.body as string)).toEqual({
+      streams: [
+        { path: `/v1/stream/a`, offset: `1_5` },
+        { path: `/b`, offset: `-1` },
+      ],
+    })
+  })
+
+  it(`should decode long-poll entries by data encoding`, async () => {
+    mockFetch.mockResolvedValue(
+      new Response(
+        JSON.stringify({
+          streams: [
+            {
+              stream: `/json`,
+              data: [{ n: 1 }],
+              dataEncoding: `json`,
+              streamNextOffset: `0_7`,
+              upToDate: true,
+            },
+            {
+              stream: `/bin`,
+              data: `/wA=`,
+              dataEncoding: `base64`,
+              streamNextOffset: `0_2`,
+              streamClosed: true,
+            },
+            { stream: `/missing`, status: 404, error: `stream not found` },
+          ],
+        }),
+        { status: 200 }
+      )
+    )
+
+    const events = await collect(
+      multiplex({
+        url: `https://example.com`,
+        streams: [{ path: `/json` }, { path: `/bin` }, { path: `/missing` }],
+        live: false,
+        fetch: mockFetch,
+      })
+    )
+
+    expect(events).toEqual([
+      {
+        type: `chunk`,
+        path: `/json`,
+        items: [{ n: 1 }],
+        offset: `0_7`,
+        upToDate: true,
+        streamClosed: false,
+      },
+      {
+        type: `chunk`,
+        path: `/bin`,
+        bytes: new Uint8Array([0xff, 0x00]),
+        offset: `0_2`,
+        upToDate: true,
+        streamClosed: true,
+      },
+      {
+        type: `error`,
+        path: `/missing`,
+        status: 404,
+        message: `stream not found`,
+      },
+    ])
+  })
+
+  it(`should attach SSE data to the control event naming its stream`, async () => {
+    mockFetch.mockResolvedValueOnce(
+      sseResponse(
+        [
+          `event: data`,
+          `data:hello`,
+          ``,
+          `event: control`,
+          `data:{"stream":"/a","dataEncoding":"text","streamNextOffset":"0_5","upToDate":true}`,
+          ``,
+          `event: control`,
+          `data:{"stream":"/b","dataEncoding":"json","streamNextOffset":"0_0","upToDate":true}`,
+          ``,
+          `event: data`,
+          `data:[{"n":1}]`,
+          ``,
+          `event: control`,
+          `data:{"stream":"/b","dataEncoding":"json","streamNextOffset":"0_7","streamClosed":true}`,
+          ``,
+          ``,
+        ].join(`\n`)
+      )
+    )
+    // Reconnect with the remaining stream from its tracked offset
+    mockFetch.mockResolvedValueOnce(
+      sseResponse(
+        `event: control\ndata:{"stream":"/a","status":410,"error":"stream has been deleted"}\n\n`
+      )
+    )
+
+    const events = await collect(
+      multiplex({
+        url: `https://example.com`,
+        streams: [{ path: `/a` }, { path: `/b`, offset: `now` }],
+        fetch: mockFetch,
+      })
+    )
+
+    expect(events.map((e) => e.type)).toEqual([
+      `chunk`,
+      `chunk`,
+      `chunk`,
+      `error`,
+    ])
+    expect(events[0]).toMatchObject({ path: `/a`, text: `hello` })
+    expect(events[1]).toMatchObject({ path: `/b`, offset: `0_0` })
+    expect(events[1]).not.toHaveProperty(`items`)
+    expect(events[2]).toMatchObject({
+      path: `/b`,
+      items: [{ n: 1 }],
+      streamClosed: true,
+    })
+
+    expect(mockFetch).toHaveBeenCalledTimes(2)
+    const [url, init] = mockFetch.mock.calls[1]!
+    expect(url).toBe(`https://example.com/__ds/multiplex?live=sse`)
+    expect(JSON.parse(init?.body as string)).toEqual({
+      streams: [{ path: `/a`, offset: `0_5` }],
+    })
+  })
+})
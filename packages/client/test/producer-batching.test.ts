@@ -0,0 +1,48 @@
+import { gunzipSync } from "node:zlib"
+import { describe, expect, it } from "vitest"
+import { AdaptiveBatchPolicy, compressBody } from "../src/producer-batching"
+
+describe(`AdaptiveBatchPolicy`, () => {
+  it(`sends at once in latency mode while a slot is free`, () => {
+    const policy = new AdaptiveBatchPolicy(`latency`, 25, 1000, 4)
+
+    expect(policy.lingerMs(0)).toBe(0)
+    expect(policy.lingerMs(3)).toBe(0)
+    expect(policy.lingerMs(4)).toBeUndefined()
+
+    // Batches grow with the slots in use
+    expect(policy.batchBytes(0)).toBe(250)
+    expect(policy.batchBytes(1)).toBe(500)
+    expect(policy.batchBytes(3)).toBe(1000)
+    expect(policy.batchBytes(8)).toBe(1000)
+  })
+
+  it(`lingers a round trip per slot in throughput mode`, () => {
+    const policy = new AdaptiveBatchPolicy(`throughput`, 25, 1000, 4)
+
+    // The upper bound until a round trip is observed
+    expect(policy.lingerMs(0)).toBe(25)
+
+    policy.recordRoundTrip(40)
+    expect(policy.roundTripMs).toBe(40)
+    expect(policy.lingerMs(1)).toBe(10)
+    expect(policy.lingerMs(4)).toBeUndefined()
+    expect(policy.batchBytes(0)).toBe(1000)
+
+    // Smoothed, and capped at the upper bound
+    policy.recordRoundTrip(200)
+    expect(policy.roundTripMs).toBe(60)
+    policy.recordRoundTrip(10000)
+    expect(policy.lingerMs(0)).toBe(25)
+  })
+})
+
+describe(`compressBody`, () => {
+  it(`gzips a body`, async () => {
+    const body = new TextEncoder().encode(`hello `.repeat(500))
+    const compressed = await compressBody(body, `gzip`)
+
+    expect(compressed.length).toBeLessThan(body.length)
+    expect(gunzipSync(compressed).toString()).toBe(`hello `.repeat(500))
+  })
+})
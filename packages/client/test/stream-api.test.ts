@@ -282,6 +282,71 @@ describe(`stream() function`, () => {
 
       expect(() => res.jsonStream()).toThrow()
     })
+
+    it(`should yield items before the response body completes`, async () => {
+      const encoder = new TextEncoder()
+      let sendRest: (() => void) | undefined
+      const body = new ReadableStream<Uint8Array>({
+        start(controller) {
+          controller.enqueue(encoder.encode(`[{"id":1},{"id":`))
+          sendRest = () => {
+            controller.enqueue(encoder.encode(`2}]`))
+            controller.close()
+          }
+        },
+      })
+      mockFetch.mockResolvedValue(
+        new Response(body, {
+          status: 200,
+          headers: {
+            "content-type": `application/json`,
+            [STREAM_OFFSET_HEADER]: `1_30`,
+            [STREAM_UP_TO_DATE_HEADER]: `true`,
+          },
+        })
+      )
+
+      const res = await stream<{ id: number }>({
+        url: `https://example.com/stream`,
+        fetch: mockFetch,
+        live: false,
+      })
+      const reader = res.jsonStream().getReader()
+
+      expect(await reader.read()).toEqual({ done: false, value: { id: 1 } })
+      sendRest!()
+      expect(await reader.read()).toEqual({ done: false, value: { id: 2 } })
+      expect((await reader.read()).done).toBe(true)
+    })
+  })
+
+  describe(`jsonRawStream() method`, () => {
+    it(`should return the raw bytes of each JSON item`, async () => {
+      mockFetch.mockResolvedValue(
+        new Response(`[{"id": 1}, "a,]"]`, {
+          status: 200,
+          headers: {
+            "content-type": `application/json`,
+            [STREAM_OFFSET_HEADER]: `1_30`,
+            [STREAM_UP_TO_DATE_HEADER]: `true`,
+          },
+        })
+      )
+
+      const res = await stream({
+        url: `https://example.com/stream`,
+        fetch: mockFetch,
+        live: false,
+      })
+
+      const decoder = new TextDecoder()
+      const collected: Array<string> = []
+      for await (const item of res.jsonRawStream()) {
+        collected.push(decoder.decode(item))
+      }
+
+      expect(collected).toEqual([`{"id": 1}`, `"a,]"`])
+    })
   })
 
   describe(`textStream() method`, () => {
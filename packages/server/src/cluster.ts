@@ -0,0 +1,1278 @@
+/**
+ * Multi-core mode for the reference server.
+ *
+ * A ClusteredDurableStreamServer forks worker processes with node:cluster.
+ * Streams are partitioned across workers by a hash of their path, and each
+ * worker runs a DurableStreamTestServer holding only the streams it owns.
+ * Every worker accepts connections on the shared public port; a request for
+ * a stream owned by another worker is proxied to that worker's internal
+ * listener. Because all appends and reads of a stream reach its owner, the
+ * owner's in-process append lock and long-poll/SSE waits stay authoritative:
+ * a waiting reader's proxied response carries its notification.
+ *
+ * What spans streams goes through the cluster channel, relayed by the
+ * primary process:
+ * - A fork must live with its source, so it is placed on its source's
+ *   worker (the root of its fork chain) in a placement table every worker
+ *   routes by. The placement is released once the fork's data is gone.
+ * - Subscriptions are served by worker 0, which the other workers tell of
+ *   every stream they create, append to or delete.
+ */
+
+import cluster from "node:cluster"
+import {
+  createWriteStream,
+  mkdirSync,
+  readFileSync,
+  renameSync,
+  writeFileSync,
+} from "node:fs"
+import { Agent, createServer, request } from "node:http"
+import { availableParallelism } from "node:os"
+import * as path from "node:path"
+import { DurableStreamTestServer } from "./server"
+import { serverLog } from "./log"
+import type {
+  IncomingHttpHeaders,
+  IncomingMessage,
+  Server,
+  ServerResponse,
+} from "node:http"
+import type { Worker } from "node:cluster"
+import type { WriteStream } from "node:fs"
+import type {
+  SubscriptionManager,
+  SubscriptionStreamStore,
+} from "./subscription-manager"
+import type { TestServerOptions } from "./types"
+
+const WORKER_INDEX_ENV = `DURABLE_STREAMS_CLUSTER_WORKER`
+const CLUSTER_LAYOUT_FILE = `cluster.json`
+/**
+ * Fork placements of a file-backed cluster, a [path, partition] per line;
+ * a null partition releases the path
+ */
+const CLUSTER_PLACEMENTS_FILE = `placements.jsonl`
+
+/**
+ * Control routes not tied to one stream, subscriptions among them, are
+ * served by this worker
+ */
+const CONTROL_PARTITION = 0
+const RESERVED_CONTROL_PREFIX = `/v1/stream/__ds`
+const STREAM_FORKED_FROM_HEADER = `stream-forked-from`
+const TEST_INJECT_ERROR_PATH = `/_test/inject-error`
+
+/** Headers that describe a single connection and must not be proxied */
+const HOP_BY_HOP_HEADERS = [
+  `connection`,
+  `keep-alive`,
+  `proxy-connection`,
+  `upgrade`,
+]
+
+/**
+ * Options for a clustered server. All TestServerOptions apply to every
+ * worker; `port` and `host` are the shared public listener.
+ */
+export interface ClusteredServerOptions extends TestServerOptions {
+  /**
+   * Number of worker processes. Streams are partitioned across workers, so
+   * a file-backed dataDir must always be served with the same count.
+   * Default: os.availableParallelism().
+   */
+  workers?: number
+}
+
+/**
+ * A stream as a worker reports it to the subscription worker. `offset` is
+ * its tail, or null once it is deleted; `appended` is set when data was
+ * appended since the last report.
+ */
+interface StreamReport {
+  path: string
+  offset: string | null
+  appended: boolean
+}
+
+/** Messages from one worker to another */
+export type PeerMessage =
+  | {
+      kind: `streams`
+      partition: number
+      /** Every stream of the partition, replacing earlier reports */
+      full: boolean
+      streams: Array<StreamReport>
+    }
+  | { kind: `report-streams` }
+  | { kind: `append`; path: string; data: string }
+
+/** Messages between a worker's ClusterChannel and the ClusterCoordinator */
+export type ChannelMessage =
+  | { type: `placements`; placements: Array<[string, number]> }
+  | { type: `place`; id: number; path: string; partition: number }
+  | { type: `placed`; id: number; partition: number }
+  | { type: `placement`; path: string; partition: number }
+  | { type: `placement-ack`; path: string }
+  | { type: `release`; path: string }
+  | { type: `released`; path: string }
+  | { type: `relay`; to: number; message: PeerMessage }
+  | { type: `peer`; message: PeerMessage }
+
+type ClusterMessage =
+  | { type: `ready`; index: number; url: string }
+  | { type: `listening`; index: number; url: string }
+  | { type: `peers`; peers: Array<string> }
+  | { type: `stop` }
+  | ChannelMessage
+
+/**
+ * Return the partition owning a stream path: FNV-1a of the path modulo the
+ * partition count. Stable across processes and restarts. A fork is owned by
+ * its source's partition instead (see ClusterChannel.placement).
+ */
+export function streamPartition(
+  streamPath: string,
+  partitions: number
+): number {
+  let hash = 0x811c9dc5
+  for (const byte of new TextEncoder().encode(streamPath)) {
+    hash ^= byte
+    hash = Math.imul(hash, 0x01000193)
+  }
+  return (hash >>> 0) % partitions
+}
+
+function forwardHeaders(headers: IncomingHttpHeaders): IncomingHttpHeaders {
+  const forwarded = { ...headers }
+  for (const name of HOP_BY_HOP_HEADERS) {
+    delete forwarded[name]
+  }
+  return forwarded
+}
+
+function isControlRoute(pathname: string): boolean {
+  return (
+    pathname === RESERVED_CONTROL_PREFIX ||
+    pathname.startsWith(`${RESERVED_CONTROL_PREFIX}/`)
+  )
+}
+
+// ============================================================================
+// Cluster channel
+// ============================================================================
+
+/**
+ * Primary side of the cluster channel. Holds the placement table, hands it
+ * to each worker that joins, and relays messages between workers.
+ *
+ * A new placement is broadcast to every joined worker and only confirmed to
+ * the worker that asked once all of them acknowledged it and it was
+ * persisted, so no worker can route a placed path elsewhere once a client
+ * has seen it created. A worker that exits stops being waited for; its
+ * replacement joins with the full table. The worker a path is placed on
+ * releases it once the path's data is gone, so the table only holds paths
+ * with data.
+ */
+export class ClusterCoordinator {
+  private readonly send: (index: number, message: ChannelMessage) => void
+  private readonly onPlace?: (
+    path: string,
+    partition: number
+  ) => void | Promise<void>
+  private readonly onRelease?: (path: string) => void
+  private readonly placements: Map<string, number>
+  /** Workers that hold the placement table */
+  private readonly joined = new Set<number>()
+  /** Placements not yet persisted or acknowledged by some joined worker */
+  private readonly pending = new Map<
+    string,
+    {
+      awaiting: Set<number>
+      persisting: boolean
+      waiters: Array<{ index: number; id: number }>
+    }
+  >()
+
+  /**
+   * @param options.send Deliver a message to a worker
+   * @param options.placements Placements recorded earlier
+   * @param options.onPlace Called with each new placement, e.g. to persist
+   *   it; a returned promise delays confirming the placement until it settles
+   * @param options.onRelease Called with each released path
+   */
+  constructor(options: {
+    send: (index: number, message: ChannelMessage) => void
+    placements?: Iterable<[string, number]>
+    onPlace?: (path: string, partition: number) => void | Promise<void>
+    onRelease?: (path: string) => void
+  }) {
+    this.send = options.send
+    this.onPlace = options.onPlace
+    this.onRelease = options.onRelease
+    this.placements = new Map(options.placements)
+  }
+
+  /**
+   * Send the placement table to a worker, which from then on receives every
+   * new placement and messages relayed to it.
+   */
+  join(index: number): void {
+    this.joined.add(index)
+    this.send(index, {
+      type: `placements`,
+      placements: Array.from(this.placements),
+    })
+  }
+
+  /**
+   * Forget a worker that exited.
+   */
+  leave(index: number): void {
+    this.joined.delete(index)
+    for (const [streamPath, pending] of this.pending) {
+      pending.awaiting.delete(index)
+      pending.waiters = pending.waiters.filter(
+        (waiter) => waiter.index !== index
+      )
+      this.settle(streamPath)
+    }
+  }
+
+  /**
+   * Handle a message from a worker.
+   */
+  receive(index: number, message: ChannelMessage): void {
+    switch (message.type) {
+      case `place`:
+        this.place(index, message.id, message.path, message.partition)
+        return
+      case `placement-ack`: {
+        const pending = this.pending.get(message.path)
+        if (pending) {
+          pending.awaiting.delete(index)
+          this.settle(message.path)
+        }
+        return
+      }
+      case `release`:
+        this.release(index, message.path)
+        return
+      case `relay`:
+        if (this.joined.has(message.to)) {
+          this.send(message.to, { type: `peer`, message: message.message })
+        }
+        return
+    }
+  }
+
+  private place(
+    index: number,
+    id: number,
+    streamPath: string,
+    partition: number
+  ): void {
+    const pending = this.pending.get(streamPath)
+    if (pending) {
+      pending.waiters.push({ index, id })
+      return
+    }
+    const placed = this.placements.get(streamPath)
+    if (placed !== undefined) {
+      this.send(index, { type: `placed`, id, partition: placed })
+      return
+    }
+
+    this.placements.set(streamPath, partition)
+    const placing = {
+      awaiting: new Set(this.joined),
+      persisting: false,
+      waiters: [{ index, id }],
+    }
+    this.pending.set(streamPath, placing)
+    if (this.onPlace) {
+      placing.persisting = true
+      Promise.resolve(this.onPlace(streamPath, partition))
+        .catch((err) => {
+          serverLog.error(`[cluster] failed to persist placement:`, err)
+        })
+        .finally(() => {
+          placing.persisting = false
+          this.settle(streamPath)
+        })
+    }
+    for (const worker of this.joined) {
+      this.send(worker, { type: `placement`, path: streamPath, partition })
+    }
+    this.settle(streamPath)
+  }
+
+  /**
+   * Drop a placement at the request of the worker it is placed on. A path
+   * being placed again is kept: a fork is about to be created there.
+   */
+  private release(index: number, streamPath: string): void {
+    if (
+      this.placements.get(streamPath) !== index ||
+      this.pending.has(streamPath)
+    ) {
+      return
+    }
+    this.placements.delete(streamPath)
+    this.onRelease?.(streamPath)
+    for (const worker of this.joined) {
+      this.send(worker, { type: `released`, path: streamPath })
+    }
+  }
+
+  private settle(streamPath: string): void {
+    const pending = this.pending.get(streamPath)
+    if (!pending || pending.persisting || pending.awaiting.size > 0) return
+    this.pending.delete(streamPath)
+    const partition = this.placements.get(streamPath)!
+    for (const { index, id } of pending.waiters) {
+      this.send(index, { type: `placed`, id, partition })
+    }
+  }
+}
+
+/**
+ * Worker side of the cluster channel: the worker's copy of the placement
+ * table, and messages to and from other workers.
+ */
+export class ClusterChannel {
+  private readonly send: (message: ChannelMessage) => void
+  private placements = new Map<string, number>()
+  private nextPlaceId = 0
+  private readonly placing = new Map<number, (partition: number) => void>()
+  private readonly peerHandlers = new Set<(message: PeerMessage) => void>()
+  private readonly releaseHandlers = new Set<(path: string) => void>()
+
+  /**
+   * @param send Deliver a message to the coordinator
+   */
+  constructor(send: (message: ChannelMessage) => void) {
+    this.send = send
+  }
+
+  /**
+   * Partition a path was placed on, if it was.
+   */
+  placement(streamPath: string): number | undefined {
+    return this.placements.get(streamPath)
+  }
+
+  /**
+   * Place a path on a partition unless it is placed already. Resolves with
+   * the path's partition once every worker routes it there.
+   */
+  place(streamPath: string, partition: number): Promise<number> {
+    const id = this.nextPlaceId++
+    return new Promise((resolve) => {
+      this.placing.set(id, resolve)
+      this.send({ type: `place`, id, path: streamPath, partition })
+    })
+  }
+
+  /**
+   * Release a path placed on this worker, once its data is gone.
+   */
+  release(streamPath: string): void {
+    this.send({ type: `release`, path: streamPath })
+  }
+
+  /**
+   * Call `handler` with each path whose placement was released. Returns a
+   * function that removes the handler.
+   */
+  onRelease(handler: (path: string) => void): () => void {
+    this.releaseHandlers.add(handler)
+    return () => {
+      this.releaseHandlers.delete(handler)
+    }
+  }
+
+  /**
+   * Send a message to another worker. Messages to a worker that is not
+   * running are dropped.
+   */
+  relay(to: number, message: PeerMessage): void {
+    this.send({ type: `relay`, to, message })
+  }
+
+  /**
+   * Call `handler` with each message other workers relay to this one.
+   * Returns a function that removes the handler.
+   */
+  onPeerMessage(handler: (message: PeerMessage) => void): () => void {
+    this.peerHandlers.add(handler)
+    return () => {
+      this.peerHandlers.delete(handler)
+    }
+  }
+
+  /**
+   * Handle a message from the coordinator.
+   */
+  receive(message: ChannelMessage): void {
+    switch (message.type) {
+      case `placements`:
+        this.placements = new Map(message.placements)
+        return
+      case `placement`:
+        this.placements.set(message.path, message.partition)
+        this.send({ type: `placement-ack`, path: message.path })
+        return
+      case `released`:
+        this.placements.delete(message.path)
+        for (const handler of this.releaseHandlers) {
+          handler(message.path)
+        }
+        return
+      case `placed`: {
+        const resolve = this.placing.get(message.id)
+        this.placing.delete(message.id)
+        resolve?.(message.partition)
+        return
+      }
+      case `peer`:
+        for (const handler of this.peerHandlers) {
+          handler(message.message)
+        }
+        return
+    }
+  }
+}
+
+// ============================================================================
+// Subscriptions
+// ============================================================================
+
+/**
+ * Keeps the subscriptions served by the control worker in step with the
+ * streams of every worker.
+ *
+ * Each other worker reports its streams to the control worker: all of them
+ * when it starts or is asked to, then each one it creates, appends to or
+ * deletes, coalesced per event-loop turn. The control worker keeps their
+ * tails and serves subscriptions over its own streams plus those, waking
+ * them on the reported appends. Wake events for another worker's stream are
+ * appended by that worker.
+ */
+class ClusterSubscriptions {
+  private readonly index: number
+  private readonly local: DurableStreamTestServer
+  /** The local server's streams */
+  private readonly store: SubscriptionStreamStore
+  private readonly channel: ClusterChannel
+  private readonly unsubscribe: Array<() => void>
+
+  /** Reports not yet sent, by path: whether data was appended */
+  private readonly unreported = new Map<string, boolean>()
+  private reportScheduled = false
+
+  /** Control worker: tails of the other workers' streams */
+  private readonly remote = new Map<
+    string,
+    { partition: number; currentOffset: string }
+  >()
+  private manager: SubscriptionManager | null = null
+
+  constructor(options: {
+    index: number
+    local: DurableStreamTestServer
+    channel: ClusterChannel
+  }) {
+    this.index = options.index
+    this.local = options.local
+    this.store = options.local.store
+    this.channel = options.channel
+    this.unsubscribe = [
+      this.local.onStreamChange((streamPath, change) => {
+        if (this.index !== CONTROL_PARTITION && change !== `removed`) {
+          this.queueReport(streamPath, change === `appended`)
+        }
+      }),
+      this.channel.onPeerMessage((message) => this.receive(message)),
+    ]
+    if (this.index !== CONTROL_PARTITION) {
+      this.reportAll()
+    }
+  }
+
+  /**
+   * On the control worker, serve subscriptions over the streams of all
+   * `partitions` workers, with callbacks addressed to `publicUrl`.
+   */
+  serve(publicUrl: string, partitions: number): void {
+    if (this.index !== CONTROL_PARTITION || partitions < 2) return
+    const { store } = this
+    const streams: SubscriptionStreamStore = {
+      has: (streamPath) => store.has(streamPath) || this.remote.has(streamPath),
+      get: (streamPath) => store.get(streamPath) ?? this.remote.get(streamPath),
+      list: () => [...store.list(), ...this.remote.keys()],
+      append: (streamPath, data) => this.append(streamPath, data),
+    }
+    this.manager = this.local.serveSubscriptions(streams, publicUrl)
+
+    // Workers that started first reported before anyone listened
+    for (let partition = 0; partition < partitions; partition++) {
+      if (partition !== this.index) {
+        this.channel.relay(partition, { kind: `report-streams` })
+      }
+    }
+  }
+
+  close(): void {
+    for (const unsubscribe of this.unsubscribe) unsubscribe()
+    this.unreported.clear()
+    this.manager = null
+  }
+
+  private receive(message: PeerMessage): void {
+    switch (message.kind) {
+      case `streams`:
+        this.applyReports(message.partition, message.full, message.streams)
+        return
+      case `report-streams`:
+        this.reportAll()
+        return
+      case `append`:
+        this.appendLocal(message.path, Buffer.from(message.data, `base64`))
+        return
+    }
+  }
+
+  private queueReport(streamPath: string, appended: boolean): void {
+    this.unreported.set(
+      streamPath,
+      appended || (this.unreported.get(streamPath) ?? false)
+    )
+    if (this.reportScheduled) return
+    this.reportScheduled = true
+    setImmediate(() => {
+      this.reportScheduled = false
+      if (this.unreported.size === 0) return
+      const streams = Array.from(this.unreported, ([streamPath, appended]) =>
+        this.report(streamPath, appended)
+      )
+      this.unreported.clear()
+      this.channel.relay(CONTROL_PARTITION, {
+        kind: `streams`,
+        partition: this.index,
+        full: false,
+        streams,
+      })
+    })
+  }
+
+  private reportAll(): void {
+    this.channel.relay(CONTROL_PARTITION, {
+      kind: `streams`,
+      partition: this.index,
+      full: true,
+      streams: this.store
+        .list()
+        .map((streamPath) => this.report(streamPath, false)),
+    })
+  }
+
+  private report(streamPath: string, appended: boolean): StreamReport {
+    return {
+      path: streamPath,
+      offset: this.store.get(streamPath)?.currentOffset ?? null,
+      appended,
+    }
+  }
+
+  private applyReports(
+    partition: number,
+    full: boolean,
+    streams: Array<StreamReport>
+  ): void {
+    if (full) {
+      const reported = new Set(streams.map((stream) => stream.path))
+      for (const [streamPath, entry] of this.remote) {
+        if (entry.partition === partition && !reported.has(streamPath)) {
+          this.remote.delete(streamPath)
+          this.manager?.onStreamDeleted(streamPath)
+        }
+      }
+    }
+
+    for (const stream of streams) {
+      if (stream.offset === null) {
+        this.remote.delete(stream.path)
+        this.manager?.onStreamDeleted(stream.path)
+        continue
+      }
+      this.remote.set(stream.path, { partition, currentOffset: stream.offset })
+      if (stream.appended && this.manager) {
+        this.manager.onStreamAppend(stream.path).catch((err) => {
+          serverLog.error(`[cluster] subscription append hook failed:`, err)
+        })
+      }
+    }
+  }
+
+  private append(streamPath: string, data: Uint8Array): unknown {
+    const entry = this.remote.get(streamPath)
+    if (this.store.has(streamPath) || !entry) {
+      return this.store.append(streamPath, data)
+    }
+    this.channel.relay(entry.partition, {
+      kind: `append`,
+      path: streamPath,
+      data: Buffer.from(data).toString(`base64`),
+    })
+    return undefined
+  }
+
+  private appendLocal(streamPath: string, data: Uint8Array): void {
+    if (!this.store.has(streamPath)) return
+    Promise.resolve(this.store.append(streamPath, data))
+      .then(() => this.queueReport(streamPath, false))
+      .catch((err) => {
+        serverLog.warn(
+          `[cluster] wake append to ${streamPath} failed:`,
+          err instanceof Error ? err.message : err
+        )
+      })
+  }
+}
+
+// ============================================================================
+// Routing
+// ============================================================================
+
+/**
+ * Routes requests arriving at one worker: requests for streams the worker
+ * owns go straight to its local server, the rest are proxied to the owner.
+ */
+export class ClusterRouter {
+  private readonly index: number
+  private readonly local: DurableStreamTestServer
+  private readonly channel: ClusterChannel
+  private readonly subscriptions: ClusterSubscriptions
+  private readonly unsubscribe: Array<() => void>
+  private peers: Array<string>
+  private readonly agent = new Agent({ keepAlive: true })
+
+  /**
+   * @param options.index Partition owned by this worker
+   * @param options.local Started server holding this worker's streams
+   * @param options.peers Internal URL of each partition's server
+   * @param options.channel This worker's end of the cluster channel
+   */
+  constructor(options: {
+    index: number
+    local: DurableStreamTestServer
+    peers: Array<string>
+    channel: ClusterChannel
+  }) {
+    this.index = options.index
+    this.local = options.local
+    this.peers = options.peers
+    this.channel = options.channel
+    this.subscriptions = new ClusterSubscriptions({
+      index: options.index,
+      local: options.local,
+      channel: options.channel,
+    })
+    this.unsubscribe = [
+      // A placement is kept only while its path has data here
+      this.local.onStreamChange((streamPath, change) => {
+        if (
+          change === `removed` &&
+          this.channel.placement(streamPath) === this.index
+        ) {
+          this.channel.release(streamPath)
+        }
+      }),
+      // A path recreated here before its release took effect is placed again
+      this.channel.onRelease((streamPath) => {
+        if (this.local.store.get(streamPath)) {
+          this.channel.place(streamPath, this.index).catch((err) => {
+            serverLog.error(`[cluster] fork placement failed:`, err)
+          })
+        }
+      }),
+    ]
+  }
+
+  /**
+   * Replace the partition table, e.g. after a worker restarted on a new
+   * internal port. The partition count must not change.
+   */
+  setPeers(peers: Array<string>): void {
+    this.peers = peers
+  }
+
+  /**
+   * Start serving subscriptions on the control worker (a no-op on the
+   * others), with callbacks addressed to the cluster's public URL. Call once
+   * the partition table is known.
+   */
+  serveSubscriptions(publicUrl: string): void {
+    this.subscriptions.serve(publicUrl, this.peers.length)
+  }
+
+  /**
+   * Close idle proxy connections to other workers and stop reporting
+   * streams.
+   */
+  close(): void {
+    for (const unsubscribe of this.unsubscribe) unsubscribe()
+    this.subscriptions.close()
+    this.agent.destroy()
+  }
+
+  /**
+   * Partition owning a stream path: where it was placed, if it is a fork,
+   * else its hash partition.
+   */
+  owner(streamPath: string): number {
+    return (
+      this.channel.placement(streamPath) ??
+      streamPartition(streamPath, this.peers.length)
+    )
+  }
+
+  handle(req: IncomingMessage, res: ServerResponse): void {
+    const pathname = new URL(req.url ?? `/`, `http://localhost`).pathname
+
+    if (pathname === TEST_INJECT_ERROR_PATH) {
+      this.handleTestInjectError(req, res).catch((err) => {
+        serverLog.error(`[cluster] fault injection routing failed:`, err)
+        this.unavailable(res)
+      })
+      return
+    }
+
+    if (isControlRoute(pathname)) {
+      this.route(CONTROL_PARTITION, req, res)
+      return
+    }
+
+    // A fork reads its source in the owner's store, so it is placed on its
+    // source's worker first
+    const forkedFrom = req.headers[STREAM_FORKED_FROM_HEADER]
+    if (
+      this.peers.length > 1 &&
+      req.method?.toUpperCase() === `PUT` &&
+      typeof forkedFrom === `string` &&
+      forkedFrom !== ``
+    ) {
+      const sourceOwner = this.owner(forkedFrom)
+      if (this.owner(pathname) !== sourceOwner) {
+        this.channel.place(pathname, sourceOwner).then(
+          (owner) => this.route(owner, req, res),
+          (err) => {
+            serverLog.error(`[cluster] fork placement failed:`, err)
+            this.unavailable(res)
+          }
+        )
+        return
+      }
+    }
+
+    this.route(this.owner(pathname), req, res)
+  }
+
+  private route(
+    partition: number,
+    req: IncomingMessage,
+    res: ServerResponse
+  ): void {
+    if (partition === this.index) {
+      this.local.handle(req, res)
+    } else {
+      this.forward(partition, req, res)
+    }
+  }
+
+  private unavailable(res: ServerResponse): void {
+    if (!res.headersSent) {
+      res.writeHead(502, { "content-type": `text/plain` })
+      res.end(`Cluster worker unavailable`)
+    }
+  }
+
+  /**
+   * Proxy a request to the worker owning `partition`, streaming both bodies
+   * so that long-polls and SSE responses pass through as they are written.
+   */
+  private forward(
+    partition: number,
+    req: IncomingMessage,
+    res: ServerResponse,
+    body?: Uint8Array
+  ): void {
+    const upstream = request(
+      new URL(req.url ?? `/`, this.peers[partition]),
+      {
+        method: req.method,
+        headers: forwardHeaders(req.headers),
+        agent: this.agent,
+      },
+      (upstreamRes) => {
+        res.writeHead(
+          upstreamRes.statusCode ?? 502,
+          upstreamRes.statusMessage,
+          forwardHeaders(upstreamRes.headers)
+        )
+        // Flush headers now: SSE and long-poll bodies may not follow soon
+        res.flushHeaders()
+        upstreamRes.pipe(res)
+      }
+    )
+
+    upstream.on(`error`, (err) => {
+      if (!res.headersSent) {
+        serverLog.warn(
+          `[cluster] worker ${partition} unreachable:`,
+          err.message
+        )
+        this.unavailable(res)
+      } else {
+        res.destroy()
+      }
+    })
+
+    // A client that disconnects mid-read releases the owner's wait too
+    res.on(`close`, () => {
+      if (!res.writableFinished) upstream.destroy()
+    })
+
+    if (body) {
+      upstream.end(body)
+    } else {
+      req.pipe(upstream)
+    }
+  }
+
+  /**
+   * Faults are consumed by the server that handles the faulted path, so
+   * injections are routed to that path's owner and clears go to every
+   * worker.
+   */
+  private async handleTestInjectError(
+    req: IncomingMessage,
+    res: ServerResponse
+  ): Promise<void> {
+    const chunks: Array<Buffer> = []
+    for await (const chunk of req) {
+      chunks.push(chunk as Buffer)
+    }
+    const body = Buffer.concat(chunks)
+
+    if (req.method?.toUpperCase() === `POST`) {
+      let owner = this.index
+      try {
+        const config = JSON.parse(body.toString(`utf8`)) as { path?: unknown }
+        if (typeof config.path === `string`) {
+          owner = this.owner(config.path)
+        }
+      } catch {
+        // Let the local server reject the malformed body
+      }
+      this.forward(owner, req, res, body)
+      return
+    }
+
+    const responses = await Promise.all(
+      this.peers.map((peer) =>
+        fetch(new URL(req.url ?? `/`, peer), {
+          method: req.method,
+          body: body.length > 0 ? body : undefined,
+        })
+      )
+    )
+    const failed = responses.find((response) => !response.ok)
+    const response = failed ?? responses[0]!
+    res.writeHead(response.status, {
+      "content-type": response.headers.get(`content-type`) ?? `text/plain`,
+    })
+    res.end(Buffer.from(await response.arrayBuffer()))
+  }
+}
+
+// ============================================================================
+// Data directory
+// ============================================================================
+
+/**
+ * Record the partition count of a file-backed data directory, refusing to
+ * serve it with a different count: that would assign streams to workers
+ * whose stores do not hold them.
+ */
+function checkClusterLayout(dataDir: string, workers: number): void {
+  const file = path.join(dataDir, CLUSTER_LAYOUT_FILE)
+  let layout: { workers?: unknown } | undefined
+  try {
+    layout = JSON.parse(readFileSync(file, `utf8`)) as { workers?: unknown }
+  } catch (err) {
+    if ((err as { code?: unknown }).code !== `ENOENT`) throw err
+  }
+
+  if (layout === undefined) {
+    mkdirSync(dataDir, { recursive: true })
+    writeFileSync(file, JSON.stringify({ workers }))
+  } else if (layout.workers !== workers) {
+    throw new Error(
+      `Data directory ${dataDir} is partitioned for ${String(layout.workers)} workers, not ${workers}`
+    )
+  }
+}
+
+/**
+ * Read the fork placements of a file-backed data directory and rewrite the
+ * file with only those not released since. A line cut short by a crash is
+ * ignored: its fork was never confirmed to a client.
+ */
+function loadPlacements(dataDir: string): Map<string, number> {
+  const file = path.join(dataDir, CLUSTER_PLACEMENTS_FILE)
+  let text: string
+  try {
+    text = readFileSync(file, `utf8`)
+  } catch (err) {
+    if ((err as { code?: unknown }).code === `ENOENT`) return new Map()
+    throw err
+  }
+
+  const placements = new Map<string, number>()
+  for (const line of text.split(`\n`)) {
+    if (line === ``) continue
+    let record: [string, number | null]
+    try {
+      record = JSON.parse(line) as [string, number | null]
+    } catch {
+      serverLog.warn(`[cluster] ignoring truncated placement record`)
+      continue
+    }
+    if (record[1] === null) {
+      placements.delete(record[0])
+    } else {
+      placements.set(record[0], record[1])
+    }
+  }
+
+  const compacted = Array.from(
+    placements,
+    (placement) => `${JSON.stringify(placement)}\n`
+  ).join(``)
+  writeFileSync(`${file}.tmp`, compacted)
+  renameSync(`${file}.tmp`, file)
+  return placements
+}
+
+// ============================================================================
+// Server
+// ============================================================================
+
+/**
+ * Durable streams server running one worker process per core.
+ *
+ * Construct and start it in the program's entry script: the primary process
+ * forks workers that re-run the same script, and start() in a worker runs
+ * that worker's partition. Workers that exit unexpectedly are restarted.
+ *
+ * File-backed workers store their partitions in `dataDir/worker-<n>`, and
+ * the primary the placements of forks in `dataDir/placements.jsonl`. A
+ * placement is released once its fork's data is gone (a fork deleted while
+ * it has forks of its own is kept until they are gone too), and the file
+ * is compacted on start.
+ */
+export class ClusteredDurableStreamServer {
+  private readonly options: ClusteredServerOptions
+  private readonly workerCount: number
+  private _url: string | null = null
+
+  // Primary state
+  private workers: Array<Worker | null> = []
+  private stopping = false
+  private placementLog: WriteStream | null = null
+
+  // Worker state
+  private local: DurableStreamTestServer | null = null
+  private router: ClusterRouter | null = null
+  private front: Server | null = null
+  private onPrimaryMessage: ((message: ClusterMessage) => void) | null = null
+
+  constructor(options: ClusteredServerOptions = {}) {
+    this.options = options
+    this.workerCount = options.workers ?? availableParallelism()
+    if (!Number.isInteger(this.workerCount) || this.workerCount < 1) {
+      throw new Error(`workers must be a positive integer`)
+    }
+  }
+
+  /**
+   * Whether this is the primary process. Useful for logging once per
+   * cluster rather than once per worker.
+   */
+  get isPrimary(): boolean {
+    return cluster.isPrimary
+  }
+
+  /**
+   * Start the cluster (in the primary) or this worker's partition (in a
+   * worker). Resolves with the public URL once every worker is listening.
+   */
+  async start(): Promise<string> {
+    if (this._url) {
+      throw new Error(`Server already started`)
+    }
+    this._url = cluster.isPrimary
+      ? await this.startPrimary()
+      : await this.startWorker()
+    return this._url
+  }
+
+  /**
+   * Stop the cluster (in the primary) or this worker's partition (in a
+   * worker).
+   */
+  async stop(): Promise<void> {
+    if (!this._url) {
+      return
+    }
+    if (cluster.isPrimary) {
+      await this.stopPrimary()
+    } else {
+      await this.stopWorker()
+    }
+    this._url = null
+  }
+
+  /**
+   * Get the public server URL.
+   */
+  get url(): string {
+    if (!this._url) {
+      throw new Error(`Server not started`)
+    }
+    return this._url
+  }
+
+  // ============================================================================
+  // Primary
+  // ============================================================================
+
+  private startPrimary(): Promise<string> {
+    const { dataDir } = this.options
+    if (dataDir) {
+      checkClusterLayout(dataDir, this.workerCount)
+    }
+
+    const peers: Array<string | null> = Array.from(
+      { length: this.workerCount },
+      () => null
+    )
+    const listening = new Set<number>()
+    this.workers = Array.from({ length: this.workerCount }, () => null)
+    this.stopping = false
+
+    const placements = dataDir ? loadPlacements(dataDir) : undefined
+    const log = dataDir
+      ? createWriteStream(path.join(dataDir, CLUSTER_PLACEMENTS_FILE), {
+          flags: `a`,
+        })
+      : null
+    log?.on(`error`, (err) => {
+      serverLog.error(`[cluster] failed to write placements:`, err)
+    })
+    this.placementLog = log
+    const record = (streamPath: string, partition: number | null) =>
+      new Promise<void>((resolve, reject) => {
+        log!.write(`${JSON.stringify([streamPath, partition])}\n`, (err) =>
+          err ? reject(err) : resolve()
+        )
+      })
+
+    const coordinator = new ClusterCoordinator({
+      send: (index, message) => {
+        const worker = this.workers[index]
+        if (worker?.isConnected()) worker.send(message)
+      },
+      placements,
+      onPlace: log ? record : undefined,
+      onRelease: log
+        ? (streamPath) => {
+            // A failed write is logged by the stream's error handler
+            record(streamPath, null).catch(() => {})
+          }
+        : undefined,
+    })
+
+    return new Promise((resolve, reject) => {
+      let started = false
+
+      const fork = (index: number): void => {
+        const worker = cluster.fork({ [WORKER_INDEX_ENV]: String(index) })
+        this.workers[index] = worker
+
+        worker.on(`message`, (message: ClusterMessage) => {
+          if (message.type === `ready`) {
+            coordinator.join(index)
+            peers[index] = message.url
+            if (peers.every((peer) => peer !== null)) {
+              this.broadcast({ type: `peers`, peers: peers as Array<string> })
+            }
+          } else if (message.type === `listening`) {
+            listening.add(index)
+            if (!started && listening.size === this.workerCount) {
+              started = true
+              resolve(message.url)
+            }
+          } else {
+            coordinator.receive(index, message as ChannelMessage)
+          }
+        })
+
+        worker.on(`exit`, (code, signal) => {
+          if (this.workers[index] !== worker) return
+          this.workers[index] = null
+          coordinator.leave(index)
+          if (this.stopping) return
+
+          peers[index] = null
+          if (!started) {
+            this.stopping = true
+            this.broadcast({ type: `stop` })
+            this.placementLog?.end()
+            this.placementLog = null
+            reject(
+              new Error(
+                `Cluster worker ${index} exited during startup (${signal ?? code})`
+              )
+            )
+            return
+          }
+          serverLog.warn(
+            `[cluster] worker ${index} exited (${signal ?? code}), restarting`
+          )
+          fork(index)
+        })
+      }
+
+      for (let index = 0; index < this.workerCount; index++) {
+        fork(index)
+      }
+    })
+  }
+
+  private broadcast(message: ClusterMessage): void {
+    for (const worker of this.workers) {
+      if (worker?.isConnected()) worker.send(message)
+    }
+  }
+
+  private async stopPrimary(): Promise<void> {
+    this.stopping = true
+    const exits = this.workers
+      .filter((worker): worker is Worker => worker !== null)
+      .map(
+        (worker) =>
+          new Promise<void>((resolve) => {
+            if (worker.isDead()) {
+              resolve()
+              return
+            }
+            worker.once(`exit`, () => resolve())
+          })
+      )
+    this.broadcast({ type: `stop` })
+    await Promise.all(exits)
+    this.workers = []
+    const log = this.placementLog
+    this.placementLog = null
+    if (log) {
+      await new Promise<void>((resolve) => log.end(() => resolve()))
+    }
+  }
+
+  // ============================================================================
+  // Worker
+  // ============================================================================
+
+  private async startWorker(): Promise<string> {
+    const index = Number(process.env[WORKER_INDEX_ENV])
+    if (!Number.isInteger(index) || index < 0 || index >= this.workerCount) {
+      throw new Error(`Not a clustered server worker`)
+    }
+
+    const { workers: _workers, port, host, dataDir, ...options } = this.options
+    const local = new DurableStreamTestServer({
+      ...options,
+      port: 0,
+      host: `127.0.0.1`,
+      exclusive: true,
+      dataDir: dataDir ? path.join(dataDir, `worker-${index}`) : undefined,
+    })
+    this.local = local
+    const internalUrl = await local.start()
+
+    const channel = new ClusterChannel((message) => process.send!(message))
+    const router = new ClusterRouter({ index, local, peers: [], channel })
+    this.router = router
+
+    const peersKnown = new Promise<void>((resolve) => {
+      this.onPrimaryMessage = (message) => {
+        if (message.type === `peers`) {
+          router.setPeers(message.peers)
+          resolve()
+        } else if (message.type === `stop`) {
+          this.stop()
+            .catch((err) => serverLog.error(`[cluster] stop failed:`, err))
+            .finally(() => process.exit(0))
+        } else {
+          channel.receive(message as ChannelMessage)
+        }
+      }
+      process.on(`message`, this.onPrimaryMessage)
+    })
+    // Workers of a primary that died have no one to route for
+    process.once(`disconnect`, () => {
+      this.stop().finally(() => process.exit(0))
+    })
+    process.send!({ type: `ready`, index, url: internalUrl })
+    await peersKnown
+
+    const bindHost = host ?? `127.0.0.1`
+    const front = createServer((req, res) => router.handle(req, res))
+    this.front = front
+    await new Promise<void>((resolve, reject) => {
+      front.once(`error`, reject)
+      front.listen(port ?? 4437, bindHost, () => resolve())
+    })
+
+    const addr = front.address()
+    const url =
+      typeof addr === `string` || !addr
+        ? String(addr)
+        : `http://${bindHost}:${addr.port}`
+    router.serveSubscriptions(url)
+    process.send!({ type: `listening`, index, url })
+    return url
+  }
+
+  private async stopWorker(): Promise<void> {
+    if (this.onPrimaryMessage) {
+      process.off(`message`, this.onPrimaryMessage)
+      this.onPrimaryMessage = null
+    }
+    if (this.front) {
+      const front = this.front
+      this.front = null
+      await new Promise<void>((resolve) => {
+        front.close(() => resolve())
+        front.closeAllConnections()
+      })
+    }
+    this.router?.close()
+    this.router = null
+    await this.local?.stop()
+    this.local = null
+  }
+}
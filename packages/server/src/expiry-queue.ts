@@ -0,0 +1,122 @@
+/**
+ * Expiry index for stream TTL and Expires-At.
+ *
+ * A min-heap of expiry deadlines, so expired streams are found in
+ * O(expired · log n) instead of by scanning every stream. Deadlines are
+ * hints: the sliding TTL window can move a stream's deadline later without
+ * updating the heap, so stores check a due entry against the stream's current
+ * state and reschedule it if it was accessed in the meantime. Each entry
+ * carries a token identifying the stream instance it was scheduled for, so
+ * entries of deleted or recreated streams are discarded when they come due.
+ */
+
+/**
+ * Number of due streams handled per expiry batch.
+ */
+export const EXPIRY_BATCH_SIZE = 256
+
+interface ExpiryEntry<T> {
+  deadline: number
+  path: string
+  token: T
+}
+
+/**
+ * Compute when a stream expires, in epoch milliseconds, or undefined if it
+ * never does. Invalid Expires-At dates are due immediately (fail closed).
+ */
+export function expiryDeadline(meta: {
+  expiresAt?: string
+  ttlSeconds?: number
+  lastAccessedAt?: number
+  createdAt: number
+}): number | undefined {
+  let deadline: number | undefined
+  if (meta.expiresAt) {
+    const expiryTime = new Date(meta.expiresAt).getTime()
+    deadline = Number.isFinite(expiryTime) ? expiryTime : -Infinity
+  }
+  if (meta.ttlSeconds !== undefined) {
+    const lastAccessed = meta.lastAccessedAt ?? meta.createdAt
+    const ttlDeadline = lastAccessed + meta.ttlSeconds * 1000
+    deadline =
+      deadline === undefined ? ttlDeadline : Math.min(deadline, ttlDeadline)
+  }
+  return deadline
+}
+
+export class ExpiryQueue<T> {
+  private heap: Array<ExpiryEntry<T>> = []
+
+  /**
+   * Schedule an expiry check of the stream at path at deadline.
+   */
+  schedule(path: string, token: T, deadline: number | undefined): void {
+    if (deadline === undefined) return
+    this.heap.push({ deadline, path, token })
+    this.siftUp(this.heap.length - 1)
+  }
+
+  /**
+   * Remove and return up to max entries whose deadline has been reached.
+   */
+  popDue(
+    now: number,
+    max: number = EXPIRY_BATCH_SIZE
+  ): Array<{ path: string; token: T }> {
+    const due: Array<{ path: string; token: T }> = []
+    while (due.length < max && this.heap.length > 0) {
+      const top = this.heap[0]!
+      if (top.deadline > now) break
+      const last = this.heap.pop()!
+      if (this.heap.length > 0) {
+        this.heap[0] = last
+        this.siftDown(0)
+      }
+      due.push({ path: top.path, token: top.token })
+    }
+    return due
+  }
+
+  get size(): number {
+    return this.heap.length
+  }
+
+  clear(): void {
+    this.heap = []
+  }
+
+  private siftUp(i: number): void {
+    const heap = this.heap
+    while (i > 0) {
+      const parent = (i - 1) >> 1
+      if (heap[parent]!.deadline <= heap[i]!.deadline) break
+      ;[heap[parent], heap[i]] = [heap[i]!, heap[parent]!]
+      i = parent
+    }
+  }
+
+  private siftDown(i: number): void {
+    const heap = this.heap
+    for (;;) {
+      const left = 2 * i + 1
+      const right = left + 1
+      let smallest = i
+      if (
+        left < heap.length &&
+        heap[left]!.deadline < heap[smallest]!.deadline
+      ) {
+        smallest = left
+      }
+      if (
+        right < heap.length &&
+        heap[right]!.deadline < heap[smallest]!.deadline
+      ) {
+        smallest = right
+      }
+      if (smallest === i) return
+      ;[heap[smallest], heap[i]] = [heap[i]!, heap[smallest]!]
+      i = smallest
+    }
+  }
+}
@@ -10,6 +10,7 @@ import { open as openLMDB } from "lmdb"
 import { SieveCache } from "@neophi/sieve-cache"
 import { serverLog } from "./log"
 import { encodeStreamPath } from "./path-encoding"
+import { ExpiryQueue, expiryDeadline } from "./expiry-queue"
 import {
   formatJsonMessages,
   normalizeContentType,
@@ -288,6 +289,16 @@ export class FileBackedStreamStore {
    * Key: streamPath
    */
   private streamAppendLocks = new Map<string, Promise<unknown>>()
+  /**
+   * Expiry deadlines of streams with a TTL or Expires-At, keyed to the
+   * directoryName of the stream instance they were scheduled for.
+   */
+  private expiry = new ExpiryQueue<string>()
+  /**
+   * Called with the path of each stream whose data is removed: on its
+   * delete or expiry, or once the last fork of a soft-deleted stream goes.
+   */
+  onStreamRemoved: ((path: string) => void) | null = null
 
   constructor(options: FileBackedStreamStoreOptions) {
     this.dataDir = options.dataDir
@@ -352,21 +363,32 @@ export class FileBackedStreamStore {
           continue
         }
 
-        // Scan file to compute true offset
-        // For forks, physical file bytes need to be added to forkOffset base
-        const physicalOffset = this.scanFileForTrueOffset(segmentPath)
-        const physicalBytes = Number(physicalOffset.split(`_`)[1] ?? 0)
-
-        let trueOffset: string
-        if (streamMeta.forkOffset) {
-          // Fork: logical offset = forkOffset base + physical bytes in own file
-          const forkBaseByte = Number(streamMeta.forkOffset.split(`_`)[1] ?? 0)
-          const logicalBytes = forkBaseByte + physicalBytes
-          trueOffset = `${String(0).padStart(16, `0`)}_${String(logicalBytes).padStart(16, `0`)}`
-        } else {
-          trueOffset = physicalOffset
+        // Fork: logical offset = forkOffset base + physical bytes in own file
+        const forkBaseByte = streamMeta.forkOffset
+          ? Number(streamMeta.forkOffset.split(`_`)[1] ?? 0)
+          : 0
+        const recordedBytes =
+          Number(streamMeta.currentOffset.split(`_`)[1] ?? 0) - forkBaseByte
+
+        // Fast path: a file whose size matches the recorded tail is intact.
+        // Only a mismatch (crash between the file write and the LMDB update,
+        // or a torn write) needs a scan.
+        const { size } = fs.statSync(segmentPath)
+        if (size === recordedBytes) {
+          this.expiry.schedule(
+            streamPath,
+            streamMeta.directoryName,
+            expiryDeadline(streamMeta)
+          )
+          recovered++
+          continue
         }
 
+        const physicalBytes = this.scanFileForTrueOffset(segmentPath)
+        const trueOffset = streamMeta.forkOffset
+          ? `${String(0).padStart(16, `0`)}_${String(forkBaseByte + physicalBytes).padStart(16, `0`)}`
+          : `0000000000000000_${String(physicalBytes).padStart(16, `0`)}`
+
         // Check if offset matches
         if (trueOffset !== streamMeta.currentOffset) {
           serverLog.warn(
@@ -383,6 +405,11 @@ export class FileBackedStreamStore {
           reconciled++
         }
 
+        this.expiry.schedule(
+          streamPath,
+          streamMeta.directoryName,
+          expiryDeadline(streamMeta)
+        )
         recovered++
       } catch (err) {
         serverLog.error(`[FileBackedStreamStore] Error recovering stream:`, err)
@@ -397,33 +424,38 @@ export class FileBackedStreamStore {
   }
 
   /**
-   * Scan a segment file to compute the true last offset.
-   * Handles partial/truncated messages at the end.
+   * Scan a segment file to compute the byte length of its complete frames.
+   * Handles partial/truncated messages at the end. Only frame headers are
+   * read, so the scan does not load the file into memory.
    */
-  private scanFileForTrueOffset(segmentPath: string): string {
+  private scanFileForTrueOffset(segmentPath: string): number {
+    let fd: number | undefined
     try {
-      const fileContent = fs.readFileSync(segmentPath)
+      fd = fs.openSync(segmentPath, `r`)
+      const { size } = fs.fstatSync(fd)
+      const header = Buffer.alloc(4)
       let filePos = 0
 
-      while (filePos < fileContent.length) {
-        if (filePos + 4 > fileContent.length) break
-
-        const messageLength = fileContent.readUInt32BE(filePos)
+      while (filePos + 4 <= size) {
+        fs.readSync(fd, header, 0, 4, filePos)
+        const messageLength = header.readUInt32BE(0)
         const frameEnd = filePos + 4 + messageLength + 1
 
-        if (frameEnd > fileContent.length) break
+        if (frameEnd > size) break
 
         filePos = frameEnd
       }
 
-      return `0000000000000000_${String(filePos).padStart(16, `0`)}`
+      return filePos
     } catch (err) {
       serverLog.error(
         `[FileBackedStreamStore] Error scanning file ${segmentPath}:`,
         err
       )
-      // Return empty offset on error
-      return `0000000000000000_0000000000000000`
+      // Treat as empty on error
+      return 0
+    } finally {
+      if (fd !== undefined) fs.closeSync(fd)
     }
   }
 
@@ -679,6 +711,27 @@ export class FileBackedStreamStore {
     return meta
   }
 
+  /**
+   * Reclaim a batch of streams whose expiry deadline has passed, so expired
+   * streams nobody reads again do not accumulate. Entries whose stream was
+   * deleted or recreated are dropped; streams touched since they were
+   * scheduled are rescheduled at their new deadline.
+   */
+  private expireDue(): void {
+    const due = this.expiry.popDue(Date.now())
+    for (const { path: streamPath, token } of due) {
+      const meta = this.db.get(`stream:${streamPath}`) as
+        | StreamMetadata
+        | undefined
+      if (!meta || meta.directoryName !== token || meta.softDeleted) continue
+      if (!this.isExpired(meta)) {
+        this.expiry.schedule(streamPath, token, expiryDeadline(meta))
+        continue
+      }
+      this.getMetaIfNotExpired(streamPath)
+    }
+  }
+
   /**
    * Resolve fork expiry per the decision table.
    * Forks have independent lifetimes — no capping at source expiry.
@@ -735,6 +788,8 @@ export class FileBackedStreamStore {
       forkSubOffset?: number
     } = {}
   ): Promise<Stream> {
+    this.expireDue()
+
     // Use getMetaIfNotExpired to treat expired streams as non-existent
     const existingRaw = this.db.get(`stream:${streamPath}`) as
       | StreamMetadata
@@ -960,6 +1015,11 @@ export class FileBackedStreamStore {
         streamMeta.forkSubOffset = options.forkSubOffset
       }
       await this.db.put(key, streamMeta)
+      this.expiry.schedule(
+        streamPath,
+        streamMeta.directoryName,
+        expiryDeadline(streamMeta)
+      )
     } catch (err) {
       // Rollback source refcount on failure
       if (isFork && sourceMeta) {
@@ -1104,6 +1164,7 @@ export class FileBackedStreamStore {
 
     // Delete from LMDB
     this.db.removeSync(key)
+    this.onStreamRemoved?.(streamPath)
 
     // Close handle then delete file (chained to avoid EBUSY on Windows)
     this.fileHandlePool
@@ -1542,6 +1603,8 @@ export class FileBackedStreamStore {
 
   /**
    * Read messages from a specific segment file.
+   * Offsets count whole frames, so only the physical range between startByte
+   * and capByte is read from disk.
    * @param segmentPath - Path to the segment file
    * @param startByte - Start byte offset (skip messages at or before this offset)
    * @param baseByteOffset - Base byte offset to add to physical offsets (for fork stitching)
@@ -1560,20 +1623,39 @@ export class FileBackedStreamStore {
       return messages
     }
 
+    let fd: number | undefined
     try {
-      const fileContent = fs.readFileSync(segmentPath)
+      fd = fs.openSync(segmentPath, `r`)
+      const fileSize = fs.fstatSync(fd).size
+      const rangeStart = Math.max(0, startByte - baseByteOffset)
+      const rangeEnd =
+        capByte === undefined
+          ? fileSize
+          : Math.min(fileSize, capByte - baseByteOffset)
+      if (rangeEnd <= rangeStart) {
+        return messages
+      }
+
+      const fileContent = Buffer.allocUnsafe(rangeEnd - rangeStart)
+      const bytesRead = fs.readSync(
+        fd,
+        fileContent,
+        0,
+        fileContent.length,
+        rangeStart
+      )
       let filePos = 0
-      let physicalDataOffset = 0
+      let physicalDataOffset = rangeStart
 
-      while (filePos < fileContent.length) {
+      while (filePos < bytesRead) {
         // Read message length (4 bytes)
-        if (filePos + 4 > fileContent.length) break
+        if (filePos + 4 > bytesRead) break
 
         const messageLength = fileContent.readUInt32BE(filePos)
         filePos += 4
 
         // Read message data
-        if (filePos + messageLength > fileContent.length) break
+        if (filePos + messageLength > bytesRead) break
 
         const messageData = fileContent.subarray(
           filePos,
@@ -1609,11 +1691,68 @@ export class FileBackedStreamStore {
         `[FileBackedStreamStore] Error reading segment file:`,
         err
       )
+    } finally {
+      if (fd !== undefined) {
+        fs.closeSync(fd)
+      }
     }
 
     return messages
   }
 
+  /**
+   * Read the first message after startByte across a fork chain, reading only
+   * that message's frame. Walks up to the ancestor whose own data holds
+   * startByte instead of reading every ancestor through to its tail.
+   */
+  private readFirstForkedMessage(
+    sourcePath: string,
+    startByte: number,
+    capByte: number
+  ): StreamMessage | undefined {
+    let meta = this.db.get(`stream:${sourcePath}`) as StreamMetadata | undefined
+    while (meta) {
+      const baseByte = meta.forkOffset
+        ? Number(meta.forkOffset.split(`_`)[1] ?? 0)
+        : 0
+      if (meta.forkedFrom && startByte < baseByte) {
+        // Appends to the ancestor after the fork are not visible
+        capByte = Math.min(capByte, baseByte)
+        meta = this.db.get(`stream:${meta.forkedFrom}`) as
+          | StreamMetadata
+          | undefined
+        continue
+      }
+
+      const segmentPath = segmentFile(this.dataDir, meta.directoryName)
+      let fd: number | undefined
+      try {
+        fd = fs.openSync(segmentPath, `r`)
+        const header = Buffer.alloc(4)
+        const position = startByte - baseByte
+        if (fs.readSync(fd, header, 0, 4, position) < 4) return undefined
+        const data = Buffer.allocUnsafe(header.readUInt32BE(0))
+        if (fs.readSync(fd, data, 0, data.length, position + 4) < data.length) {
+          return undefined
+        }
+        const endByte = startByte + data.length + 5
+        if (endByte > capByte) return undefined
+        return {
+          data: new Uint8Array(data),
+          offset: `${String(0).padStart(16, `0`)}_${String(endByte).padStart(16, `0`)}`,
+          timestamp: 0,
+        }
+      } catch {
+        return undefined
+      } finally {
+        if (fd !== undefined) {
+          fs.closeSync(fd)
+        }
+      }
+    }
+    return undefined
+  }
+
   /**
    * Recursively read messages from a fork's source chain.
    * Reads from source (and its sources if also forked), capped at capByte.
@@ -1682,8 +1821,7 @@ export class FileBackedStreamStore {
     isJSON: boolean
   ): Uint8Array {
     const forkByte = Number(forkOffset.split(`_`)[1] ?? 0)
-    // Read source past forkOffset (cap at source's currentOffset by passing
-    // a large cap; we only care about the first message past forkOffset).
+    // Only the first message past forkOffset matters
     const sourceMeta = this.db.get(`stream:${sourcePath}`) as
       | StreamMetadata
       | undefined
@@ -1691,11 +1829,10 @@ export class FileBackedStreamStore {
       throw new Error(`Source stream not found: ${sourcePath}`)
     }
     const currentByte = Number(sourceMeta.currentOffset.split(`_`)[1] ?? 0)
-    const messages = this.readForkedMessages(sourcePath, forkByte, currentByte)
-    if (messages.length === 0) {
+    const first = this.readFirstForkedMessage(sourcePath, forkByte, currentByte)
+    if (!first) {
       throw new Error(`Invalid fork sub-offset: no data past forkOffset`)
     }
-    const first = messages[0]!
     if (isJSON) {
       const text = new TextDecoder().decode(first.data)
       const trimmed = text.endsWith(`,`) ? text.slice(0, -1) : text
@@ -1906,6 +2043,7 @@ export class FileBackedStreamStore {
       pending.resolve([])
     }
     this.pendingLongPolls = []
+    this.expiry.clear()
 
     // Clear all streams from LMDB
     const range = this.db.getRange({
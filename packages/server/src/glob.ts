@@ -68,3 +68,136 @@ function matchParts(
 
   return pi === pattern.length && si === path.length
 }
+
+interface GlobNode<T> {
+  /** Decoded literal segment -> child */
+  literals: Map<string, GlobNode<T>>
+  /** Child for a `*` segment */
+  star?: GlobNode<T>
+  /** Child for a `**` segment */
+  globstar?: GlobNode<T>
+  /** Values whose pattern ends here */
+  values: Set<T>
+}
+
+function newNode<T>(): GlobNode<T> {
+  return { literals: new Map(), values: new Set() }
+}
+
+function isEmpty<T>(node: GlobNode<T>): boolean {
+  return (
+    node.literals.size === 0 &&
+    !node.star &&
+    !node.globstar &&
+    node.values.size === 0
+  )
+}
+
+function decodeLiteral(seg: string): string {
+  return seg.replace(/%2[Aa]/g, `*`)
+}
+
+/**
+ * Path-segment trie over glob patterns. Matching a path walks only the
+ * branches its segments can take, so its cost depends on path depth rather
+ * than on the number of patterns. Matches exactly what globMatch does.
+ */
+export class GlobIndex<T> {
+  private root: GlobNode<T> = newNode()
+
+  add(pattern: string, value: T): void {
+    let node = this.root
+    for (const seg of splitPath(pattern)) {
+      if (seg === `**`) {
+        if (!node.globstar) node.globstar = newNode()
+        node = node.globstar
+      } else if (seg === `*`) {
+        if (!node.star) node.star = newNode()
+        node = node.star
+      } else {
+        const literal = decodeLiteral(seg)
+        let child = node.literals.get(literal)
+        if (!child) {
+          child = newNode()
+          node.literals.set(literal, child)
+        }
+        node = child
+      }
+    }
+    node.values.add(value)
+  }
+
+  remove(pattern: string, value: T): void {
+    removeFrom(this.root, splitPath(pattern), 0, value)
+  }
+
+  /**
+   * Values whose pattern matches path, each once.
+   */
+  match(path: string): Set<T> {
+    const result = new Set<T>()
+    collectMatches(this.root, splitPath(path), 0, result)
+    return result
+  }
+
+  clear(): void {
+    this.root = newNode()
+  }
+}
+
+/**
+ * Remove value below node, pruning emptied children. Returns whether node is
+ * now empty.
+ */
+function removeFrom<T>(
+  node: GlobNode<T>,
+  parts: Array<string>,
+  i: number,
+  value: T
+): boolean {
+  if (i === parts.length) {
+    node.values.delete(value)
+    return isEmpty(node)
+  }
+
+  const seg = parts[i]!
+  if (seg === `**`) {
+    if (node.globstar && removeFrom(node.globstar, parts, i + 1, value)) {
+      node.globstar = undefined
+    }
+  } else if (seg === `*`) {
+    if (node.star && removeFrom(node.star, parts, i + 1, value)) {
+      node.star = undefined
+    }
+  } else {
+    const literal = decodeLiteral(seg)
+    const child = node.literals.get(literal)
+    if (child && removeFrom(child, parts, i + 1, value)) {
+      node.literals.delete(literal)
+    }
+  }
+  return isEmpty(node)
+}
+
+function collectMatches<T>(
+  node: GlobNode<T>,
+  path: Array<string>,
+  i: number,
+  result: Set<T>
+): void {
+  if (node.globstar) {
+    // ** matches zero or more segments
+    for (let j = i; j <= path.length; j++) {
+      collectMatches(node.globstar, path, j, result)
+    }
+  }
+
+  if (i === path.length) {
+    for (const value of node.values) result.add(value)
+    return
+  }
+
+  const child = node.literals.get(path[i]!)
+  if (child) collectMatches(child, path, i + 1, result)
+  if (node.star) collectMatches(node.star, path, i + 1, result)
+}
@@ -5,6 +5,16 @@
  */
 
 export { DurableStreamTestServer } from "./server"
+export {
+  ClusteredDurableStreamServer,
+  ClusterChannel,
+  ClusterCoordinator,
+  ClusterRouter,
+  streamPartition,
+  type ChannelMessage,
+  type ClusteredServerOptions,
+  type PeerMessage,
+} from "./cluster"
 export { StreamStore } from "./store"
 export { FileBackedStreamStore } from "./file-store"
 export { encodeStreamPath, decodeStreamPath } from "./path-encoding"
@@ -22,10 +32,16 @@ export type {
   StreamMessage,
   TestServerOptions,
   PendingLongPoll,
+  StreamChange,
+  StreamChangeListener,
   StreamLifecycleEvent,
   StreamLifecycleHook,
 } from "./types"
-export { SubscriptionManager, validateWebhookUrl } from "./subscription-manager"
+export {
+  SubscriptionManager,
+  validateWebhookUrl,
+  type SubscriptionStreamStore,
+} from "./subscription-manager"
 export { SubscriptionRoutes } from "./subscription-routes"
 export type {
   SubscriptionCallbackRequest,
@@ -3,7 +3,7 @@
  */
 
 import { createServer } from "node:http"
-import { deflateSync, gzipSync } from "node:zlib"
+import { deflateSync, gunzipSync, gzipSync } from "node:zlib"
 import {
   CURSOR_QUERY_PARAM,
   LIVE_QUERY_PARAM,
@@ -31,8 +31,14 @@ import { SubscriptionManager } from "./subscription-manager"
 import { SubscriptionRoutes } from "./subscription-routes"
 import { serverLog } from "./log"
 import type { CursorOptions } from "./cursor"
+import type { SubscriptionStreamStore } from "./subscription-manager"
 import type { IncomingMessage, Server, ServerResponse } from "node:http"
-import type { StreamLifecycleEvent, TestServerOptions } from "./types"
+import type {
+  StreamChange,
+  StreamChangeListener,
+  StreamLifecycleEvent,
+  TestServerOptions,
+} from "./types"
 
 const STREAM_SSE_DATA_ENCODING_HEADER = `Stream-SSE-Data-Encoding`
 
@@ -44,6 +50,9 @@ const STREAM_FORKED_FROM_HEADER = `Stream-Forked-From`
 const STREAM_FORK_OFFSET_HEADER = `Stream-Fork-Offset`
 const STREAM_FORK_SUB_OFFSET_HEADER = `Stream-Fork-Sub-Offset`
 
+// Upper bound for a compressed append body once inflated
+const MAX_INFLATED_BODY_BYTES = 64 * 1024 * 1024
+
 /**
  * Encode data for SSE format.
  * Per SSE spec, each line in the payload needs its own "data:" prefix.
@@ -68,6 +77,11 @@ function encodeSSEData(payload: string): string {
  */
 const COMPRESSION_THRESHOLD = 1024
 
+/**
+ * Memory budget for compressed read responses kept for reuse.
+ */
+const COMPRESSED_CACHE_BYTES = 32 * 1024 * 1024
+
 /**
  * Determine the best compression encoding from Accept-Encoding header.
  * Returns 'gzip', 'deflate', or null if no compression should be used.
@@ -177,6 +191,15 @@ export class DurableStreamTestServer {
   private injectedFaults = new Map<string, InjectedFault>()
   private subscriptionManager: SubscriptionManager | null = null
   private subscriptionRoutes: SubscriptionRoutes | null = null
+  private streamChangeListeners = new Set<StreamChangeListener>()
+  /** Compressed read bodies by encoding, stream and range, in LRU order */
+  private compressedResponses = new Map<
+    string,
+    { path: string; body: Uint8Array }
+  >()
+  /** Keys of compressedResponses by stream path */
+  private compressedResponseKeys = new Map<string, Set<string>>()
+  private compressedResponseBytes = 0
 
   constructor(options: TestServerOptions = {}) {
     // Choose store based on dataDir option
@@ -187,6 +210,8 @@ export class DurableStreamTestServer {
     } else {
       this.store = new StreamStore()
     }
+    this.store.onStreamRemoved = (path) =>
+      this.emitStreamChange(path, `removed`)
 
     this.options = {
       port: options.port ?? 4437,
@@ -201,6 +226,7 @@ export class DurableStreamTestServer {
         epoch: options.cursorEpoch,
       },
       webhooks: options.webhooks ?? false,
+      exclusive: options.exclusive ?? false,
     }
   }
 
@@ -213,19 +239,16 @@ export class DurableStreamTestServer {
     }
 
     return new Promise((resolve, reject) => {
-      this.server = createServer((req, res) => {
-        this.handleRequest(req, res).catch((err) => {
-          serverLog.error(`Request error:`, err)
-          if (!res.headersSent) {
-            res.writeHead(500, { "content-type": `text/plain` })
-            res.end(`Internal server error`)
-          }
-        })
-      })
+      this.server = createServer((req, res) => this.handle(req, res))
 
       this.server.on(`error`, reject)
 
-      this.server.listen(this.options.port, this.options.host, () => {
+      const listenOptions = {
+        port: this.options.port,
+        host: this.options.host,
+        exclusive: this.options.exclusive,
+      }
+      this.server.listen(listenOptions, () => {
         const addr = this.server!.address()
         if (typeof addr === `string`) {
           this._url = addr
@@ -298,6 +321,21 @@ export class DurableStreamTestServer {
     })
   }
 
+  /**
+   * Handle a request as if it had arrived on this server's own listener.
+   * Cluster workers use this to serve requests for the streams they own
+   * from the shared public port. The server must be started.
+   */
+  handle(req: IncomingMessage, res: ServerResponse): void {
+    this.handleRequest(req, res).catch((err) => {
+      serverLog.error(`Request error:`, err)
+      if (!res.headersSent) {
+        res.writeHead(500, { "content-type": `text/plain` })
+        res.end(`Internal server error`)
+      }
+    })
+  }
+
   /**
    * Get the server URL.
    */
@@ -315,6 +353,54 @@ export class DurableStreamTestServer {
     this.store.clear()
   }
 
+  /**
+   * Serve subscriptions over `streams` rather than this server's own store,
+   * addressing callbacks to `callbackBaseUrl`. A clustered worker uses this
+   * so the subscriptions it serves see the streams of every worker; the
+   * returned manager must then be told of appends to and deletes of streams
+   * this server does not hold. Subscriptions held so far are dropped. The
+   * server must be started.
+   */
+  serveSubscriptions(
+    streams: SubscriptionStreamStore,
+    callbackBaseUrl: string
+  ): SubscriptionManager {
+    if (!this.server) {
+      throw new Error(`Server not started`)
+    }
+    this.subscriptionManager?.shutdown()
+    const manager = new SubscriptionManager({
+      callbackBaseUrl,
+      streamStore: streams,
+      webhooksEnabled: this.options.webhooks,
+    })
+    this.subscriptionManager = manager
+    this.subscriptionRoutes = new SubscriptionRoutes(manager)
+    return manager
+  }
+
+  /**
+   * Call `listener` after every change to a stream of this server, e.g. to
+   * drive subscriptions served by another process.
+   * Returns a function that removes the listener.
+   */
+  onStreamChange(listener: StreamChangeListener): () => void {
+    this.streamChangeListeners.add(listener)
+    return () => {
+      this.streamChangeListeners.delete(listener)
+    }
+  }
+
+  private emitStreamChange(path: string, change: StreamChange): void {
+    for (const listener of this.streamChangeListeners) {
+      try {
+        listener(path, change)
+      } catch (err) {
+        serverLog.error(`[server] stream change listener failed:`, err)
+      }
+    }
+  }
+
   /**
    * Inject an error to be returned on the next N requests to a path.
    * Used for testing retry/resilience behavior.
@@ -450,7 +536,7 @@ export class DurableStreamTestServer {
     )
     res.setHeader(
       `access-control-allow-headers`,
-      `content-type, authorization, Stream-Seq, Stream-TTL, Stream-Expires-At, Stream-Closed, Producer-Id, Producer-Epoch, Producer-Seq, Stream-Forked-From, Stream-Fork-Offset, Stream-Fork-Sub-Offset`
+      `content-type, content-encoding, authorization, Stream-Seq, Stream-TTL, Stream-Expires-At, Stream-Closed, Producer-Id, Producer-Epoch, Producer-Seq, Stream-Forked-From, Stream-Fork-Offset, Stream-Fork-Sub-Offset`
     )
     res.setHeader(
       `access-control-expose-headers`,
@@ -749,6 +835,10 @@ export class DurableStreamTestServer {
     const resolvedContentType =
       stream.contentType ?? contentType ?? `application/octet-stream`
 
+    if (isNew) {
+      this.emitStreamChange(path, `created`)
+    }
+
     // Call lifecycle hook for new streams
     if (isNew && this.options.onStreamCreated) {
       await Promise.resolve(
@@ -1073,22 +1163,41 @@ export class DurableStreamTestServer {
       return
     }
 
-    // Format response (wraps JSON in array brackets)
-    const responseData = this.store.formatResponse(path, messages)
+    // The messages between two offsets never change, so a compressed body
+    // is reused by every later read of the same range
+    const compressionEncoding = this.options.compression
+      ? getCompressionEncoding(req.headers[`accept-encoding`])
+      : null
+    const cacheKey = `${compressionEncoding}:${stream.createdAt}:${path}:${startOffset}:${responseOffset}`
+    let finalData: Uint8Array
+    const cached =
+      compressionEncoding && messages.length > 0
+        ? this.compressedResponses.get(cacheKey)
+        : undefined
+    if (cached) {
+      // Re-insert to mark as most recently used
+      this.compressedResponses.delete(cacheKey)
+      this.compressedResponses.set(cacheKey, cached)
+      finalData = cached.body
+      headers[`content-encoding`] = compressionEncoding!
+      headers[`vary`] = `accept-encoding`
+    } else {
+      // Format response (wraps JSON in array brackets)
+      const responseData = this.store.formatResponse(path, messages)
+      finalData = responseData
 
-    // Apply compression if enabled and response is large enough
-    let finalData: Uint8Array = responseData
-    if (
-      this.options.compression &&
-      responseData.length >= COMPRESSION_THRESHOLD
-    ) {
-      const acceptEncoding = req.headers[`accept-encoding`]
-      const compressionEncoding = getCompressionEncoding(acceptEncoding)
-      if (compressionEncoding) {
+      // Apply compression if enabled and response is large enough
+      if (
+        compressionEncoding &&
+        responseData.length >= COMPRESSION_THRESHOLD
+      ) {
         finalData = compressData(responseData, compressionEncoding)
         headers[`content-encoding`] = compressionEncoding
         // Add Vary header to indicate response varies by Accept-Encoding
         headers[`vary`] = `accept-encoding`
+        if (messages.length > 0) {
+          this.cacheCompressedResponse(path, cacheKey, finalData)
+        }
       }
     }
 
@@ -1099,6 +1208,53 @@ export class DurableStreamTestServer {
     res.end(Buffer.from(finalData))
   }
 
+  /**
+   * Cache a compressed response body, evicting the least recently used
+   * bodies beyond COMPRESSED_CACHE_BYTES.
+   */
+  private cacheCompressedResponse(
+    path: string,
+    key: string,
+    body: Uint8Array
+  ): void {
+    if (body.length > COMPRESSED_CACHE_BYTES) return
+    this.evictCompressedResponse(key)
+    this.compressedResponses.set(key, { path, body })
+    this.compressedResponseBytes += body.length
+    let keys = this.compressedResponseKeys.get(path)
+    if (!keys) {
+      keys = new Set()
+      this.compressedResponseKeys.set(path, keys)
+    }
+    keys.add(key)
+    for (const oldKey of this.compressedResponses.keys()) {
+      if (this.compressedResponseBytes <= COMPRESSED_CACHE_BYTES) break
+      this.evictCompressedResponse(oldKey)
+    }
+  }
+
+  /**
+   * Remove one cached compressed response, if present.
+   */
+  private evictCompressedResponse(key: string): void {
+    const entry = this.compressedResponses.get(key)
+    if (!entry) return
+    this.compressedResponses.delete(key)
+    this.compressedResponseBytes -= entry.body.length
+    const keys = this.compressedResponseKeys.get(entry.path)
+    keys?.delete(key)
+    if (keys?.size === 0) this.compressedResponseKeys.delete(entry.path)
+  }
+
+  /**
+   * Drop the cached compressed responses of a deleted stream.
+   */
+  private dropCompressedResponses(path: string): void {
+    const keys = this.compressedResponseKeys.get(path)
+    if (!keys) return
+    for (const key of keys) this.evictCompressedResponse(key)
+  }
+
   /**
    * Handle SSE (Server-Sent Events) mode
    */
@@ -1388,7 +1544,34 @@ export class DurableStreamTestServer {
       }
     }
 
-    const body = await this.readBody(req)
+    // Producers may gzip append bodies (Content-Encoding: gzip)
+    const contentEncoding = (req.headers[`content-encoding`] ?? ``)
+      .trim()
+      .toLowerCase()
+    const gzipped = contentEncoding === `gzip` || contentEncoding === `x-gzip`
+    if (!gzipped && contentEncoding !== `` && contentEncoding !== `identity`) {
+      res.writeHead(415, {
+        "content-type": `text/plain`,
+        "accept-encoding": `gzip`,
+      })
+      res.end(`Unsupported Content-Encoding: only gzip is accepted`)
+      return
+    }
+
+    let body = await this.readBody(req)
+    if (gzipped) {
+      try {
+        body = new Uint8Array(
+          gunzipSync(body, { maxOutputLength: MAX_INFLATED_BODY_BYTES })
+        )
+      } catch (err) {
+        // maxOutputLength overruns surface as RangeError
+        const tooLarge = err instanceof RangeError
+        res.writeHead(tooLarge ? 413 : 400, { "content-type": `text/plain` })
+        res.end(tooLarge ? `Inflated body too large` : `Invalid gzip body`)
+        return
+      }
+    }
 
     // Handle close-only request (empty body with Stream-Closed: true)
     // Note: Content-Type validation is skipped for close-only requests per protocol Section 5.2
@@ -1650,6 +1833,7 @@ export class DurableStreamTestServer {
   }
 
   private async notifyStreamAppend(path: string): Promise<void> {
+    this.emitStreamChange(path, `appended`)
     if (!this.subscriptionManager) return
     try {
       await this.subscriptionManager.onStreamAppend(path)
@@ -1671,12 +1855,15 @@ export class DurableStreamTestServer {
     }
 
     const deleted = this.store.delete(path)
+    this.dropCompressedResponses(path)
     if (!deleted) {
       res.writeHead(404, { "content-type": `text/plain` })
       res.end(`Stream not found`)
       return
     }
 
+    this.emitStreamChange(path, `deleted`)
+
     // Call lifecycle hook
     if (this.options.onStreamDeleted) {
       await Promise.resolve(
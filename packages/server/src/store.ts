@@ -8,12 +8,16 @@ import type {
   Stream,
   StreamMessage,
 } from "./types"
+import { ExpiryQueue, expiryDeadline } from "./expiry-queue"
 
 /**
  * TTL for in-memory producer state cleanup (7 days).
  */
 const PRODUCER_STATE_TTL_MS = 7 * 24 * 60 * 60 * 1000
 
+const textDecoder = new TextDecoder()
+const textEncoder = new TextEncoder()
+
 /**
  * Normalize content-type by extracting the media type (before any semicolon).
  * Handles cases like "application/json; charset=utf-8".
@@ -35,7 +39,7 @@ export function processJsonAppend(
   data: Uint8Array,
   isInitialCreate = false
 ): Uint8Array {
-  const text = new TextDecoder().decode(data)
+  const text = textDecoder.decode(data)
 
   // Validate JSON
   let parsed: unknown
@@ -56,14 +60,16 @@ export function processJsonAppend(
       }
       throw new Error(`Empty arrays are not allowed`)
     }
-    const elements = parsed.map((item) => JSON.stringify(item))
-    result = elements.join(`,`) + `,`
+    // Serializing the whole array once yields the elements already joined
+    // with commas; only the brackets need replacing
+    const serialized = JSON.stringify(parsed)
+    result = serialized.slice(1, -1) + `,`
   } else {
     // Single value - re-serialize to normalize whitespace (single-line JSON)
     result = JSON.stringify(parsed) + `,`
   }
 
-  return new TextEncoder().encode(result)
+  return textEncoder.encode(result)
 }
 
 /**
@@ -130,6 +136,11 @@ export function formatJsonMessages(messages: Array<StreamMessage>): Uint8Array {
 
   const items = messages.flatMap((message) => {
     const rawFragment = decodeStoredJsonMessage(message.data)
+    // Only state-protocol values (objects with headers) are enriched; any
+    // other fragment is already serialized and goes out as stored
+    if (!rawFragment.includes(`"headers"`)) {
+      return rawFragment === `` ? [] : [rawFragment]
+    }
     const parsed = JSON.parse(`[${rawFragment}]`) as Array<unknown>
     return parsed.map((value) =>
       enrichJsonValueWithOffset(value, message.offset)
@@ -166,11 +177,21 @@ export interface AppendResult {
 export class StreamStore {
   private streams = new Map<string, Stream>()
   private pendingLongPolls: Array<PendingLongPoll> = []
+  /**
+   * Expiry deadlines of streams with a TTL or Expires-At, keyed to the
+   * Stream instance they were scheduled for.
+   */
+  private expiry = new ExpiryQueue<Stream>()
   /**
    * Per-producer locks for serializing validation+append operations.
    * Key: "{streamPath}:{producerId}"
    */
   private producerLocks = new Map<string, Promise<unknown>>()
+  /**
+   * Called with the path of each stream whose data is removed: on its
+   * delete or expiry, or once the last fork of a soft-deleted stream goes.
+   */
+  onStreamRemoved: ((path: string) => void) | null = null
 
   /**
    * Check if a stream is expired based on TTL or Expires-At.
@@ -221,6 +242,24 @@ export class StreamStore {
     return stream
   }
 
+  /**
+   * Reclaim a batch of streams whose expiry deadline has passed, so expired
+   * streams nobody reads again do not accumulate. Entries whose stream was
+   * deleted or recreated are dropped; streams touched since they were
+   * scheduled are rescheduled at their new deadline.
+   */
+  private expireDue(): void {
+    for (const { path, token } of this.expiry.popDue(Date.now())) {
+      const stream = this.streams.get(path)
+      if (stream !== token || stream.softDeleted) continue
+      if (!this.isExpired(stream)) {
+        this.expiry.schedule(path, stream, expiryDeadline(stream))
+        continue
+      }
+      this.getIfNotExpired(path)
+    }
+  }
+
   /**
    * Update lastAccessedAt to now. Called on reads and appends (not HEAD).
    */
@@ -250,6 +289,8 @@ export class StreamStore {
       forkSubOffset?: number
     } = {}
   ): Stream {
+    this.expireDue()
+
     // Check if stream already exists
     const existingRaw = this.streams.get(path)
     if (existingRaw) {
@@ -439,6 +480,7 @@ export class StreamStore {
     }
 
     this.streams.set(path, stream)
+    this.expiry.schedule(path, stream, expiryDeadline(stream))
     return stream
   }
 
@@ -544,6 +586,7 @@ export class StreamStore {
     // Delete this stream's data
     this.streams.delete(path)
     this.cancelLongPollsForStream(path)
+    this.onStreamRemoved?.(path)
 
     // If this stream is a fork, decrement the source's refcount
     if (forkedFrom) {
@@ -1261,6 +1304,7 @@ export class StreamStore {
     }
     this.pendingLongPolls = []
     this.streams.clear()
+    this.expiry.clear()
   }
 
   /**
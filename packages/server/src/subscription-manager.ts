@@ -8,7 +8,7 @@ import {
   signWebhookPayload,
   validateCallbackToken,
 } from "./crypto"
-import { globMatch } from "./glob"
+import { GlobIndex, globMatch } from "./glob"
 import { serverLog } from "./log"
 import type {
   SubscriptionCallbackRequest,
@@ -26,12 +26,14 @@ const ZERO_OFFSET = `0000000000000000_0000000000000000`
 const BEFORE_FIRST_OFFSET = `-1`
 const MAX_RETRY_DELAY_MS = 60_000
 
-interface StreamLike {
+/** What a SubscriptionManager reads of a stream */
+export interface StreamLike {
   currentOffset: string
   softDeleted?: boolean
 }
 
-interface SubscriptionStreamStore {
+/** The streams a SubscriptionManager links and wakes subscriptions for */
+export interface SubscriptionStreamStore {
   has: (path: string) => boolean
   get: (path: string) => StreamLike | undefined
   list: () => Array<string>
@@ -143,6 +145,10 @@ export function validateWebhookUrl(
 
 export class SubscriptionManager {
   private readonly subscriptions = new Map<string, SubscriptionRecord>()
+  /** Subscriptions with a pattern, indexed by it */
+  private readonly patternIndex = new GlobIndex<SubscriptionRecord>()
+  /** Stream path -> subscriptions linked to it */
+  private readonly streamLinks = new Map<string, Set<SubscriptionRecord>>()
   private readonly streamStore: SubscriptionStreamStore
   private readonly callbackBaseUrl: string
   private readonly webhooksEnabled: boolean
@@ -258,6 +264,7 @@ export class SubscriptionManager {
     }
 
     this.subscriptions.set(id, subscription)
+    if (input.pattern) this.patternIndex.add(input.pattern, subscription)
     return { subscription, created: true }
   }
 
@@ -271,6 +278,12 @@ export class SubscriptionManager {
     this.clearLease(subscription)
     if (subscription.retry_timer) clearTimeout(subscription.retry_timer)
     this.subscriptions.delete(id)
+    if (subscription.pattern) {
+      this.patternIndex.remove(subscription.pattern, subscription)
+    }
+    for (const streamPath of subscription.streams.keys()) {
+      this.unlinkStream(subscription, streamPath)
+    }
     return true
   }
 
@@ -296,25 +309,31 @@ export class SubscriptionManager {
     if (!link) return true
     link.link_types.delete(`explicit`)
     if (link.link_types.size === 0) {
-      subscription.streams.delete(normalized)
+      this.unlinkStream(subscription, normalized)
     }
     return true
   }
 
   async onStreamAppend(absolutePath: string): Promise<void> {
     if (this.isShuttingDown) return
-    for (const subscription of this.subscriptions.values()) {
-      const relative = toStreamRelativePath(absolutePath)
-      if (!relative) continue
-      if (subscription.pattern && globMatch(subscription.pattern, relative)) {
-        const existing = subscription.streams.get(relative)
-        this.linkStream(
-          subscription,
-          relative,
-          `glob`,
-          existing?.acked_offset ?? BEFORE_FIRST_OFFSET
-        )
-      }
+    const relative = toStreamRelativePath(absolutePath)
+    if (!relative) return
+
+    for (const subscription of this.patternIndex.match(relative)) {
+      const existing = subscription.streams.get(relative)
+      this.linkStream(
+        subscription,
+        relative,
+        `glob`,
+        existing?.acked_offset ?? BEFORE_FIRST_OFFSET
+      )
+    }
+
+    const linked = this.streamLinks.get(relative)
+    if (!linked) return
+    // Snapshot: waking awaits, during which links can change
+    for (const subscription of Array.from(linked)) {
+      if (this.subscriptions.get(subscription.id) !== subscription) continue
       if (subscription.streams.has(relative)) {
         await this.maybeWake(subscription, relative)
       }
@@ -322,10 +341,12 @@ export class SubscriptionManager {
   }
 
   onStreamDeleted(absolutePath: string): void {
-    for (const subscription of this.subscriptions.values()) {
-      const relative = toStreamRelativePath(absolutePath)
-      if (relative) subscription.streams.delete(relative)
-    }
+    const relative = toStreamRelativePath(absolutePath)
+    if (!relative) return
+    const linked = this.streamLinks.get(relative)
+    if (!linked) return
+    for (const subscription of linked) subscription.streams.delete(relative)
+    this.streamLinks.delete(relative)
   }
 
   async handleWebhookCallback(
@@ -529,6 +550,8 @@ export class SubscriptionManager {
       if (subscription.retry_timer) clearTimeout(subscription.retry_timer)
     }
     this.subscriptions.clear()
+    this.patternIndex.clear()
+    this.streamLinks.clear()
   }
 
   private async maybeWake(
@@ -801,9 +824,26 @@ export class SubscriptionManager {
       acked_offset: ackedOffset,
     }
     subscription.streams.set(normalized, link)
+    let linked = this.streamLinks.get(normalized)
+    if (!linked) {
+      linked = new Set()
+      this.streamLinks.set(normalized, linked)
+    }
+    linked.add(subscription)
     return link
   }
 
+  private unlinkStream(
+    subscription: SubscriptionRecord,
+    streamPath: string
+  ): void {
+    subscription.streams.delete(streamPath)
+    const linked = this.streamLinks.get(streamPath)
+    if (!linked) return
+    linked.delete(subscription)
+    if (linked.size === 0) this.streamLinks.delete(streamPath)
+  }
+
   private listStreams(): Array<string> {
     return this.streamStore
       .list()
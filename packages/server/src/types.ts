@@ -159,6 +159,18 @@ export type StreamLifecycleHook = (
   event: StreamLifecycleEvent
 ) => void | Promise<void>
 
+/**
+ * A change to a stream on a server. A deleted stream that still has forks
+ * is only soft-deleted; it is `removed` once its data is gone, which also
+ * happens when it expires or its last fork is removed.
+ */
+export type StreamChange = `created` | `appended` | `deleted` | `removed`
+
+/**
+ * Listener called after a stream on a server changes.
+ */
+export type StreamChangeListener = (path: string, change: StreamChange) => void
+
 /**
  * Options for creating the test server.
  */
@@ -222,6 +234,13 @@ export interface TestServerOptions {
    * Default: false.
    */
   webhooks?: boolean
+
+  /**
+   * Bind the port exclusively in a node:cluster worker instead of sharing
+   * it with the other workers.
+   * Default: false.
+   */
+  exclusive?: boolean
 }
 
 /**
@@ -0,0 +1,415 @@
+/**
+ * Tests for clustered-mode request routing. Each "worker" here is an
+ * in-process server and router pair, so routing and proxying are covered
+ * without forking processes.
+ */
+
+import { createServer } from "node:http"
+import { afterEach, beforeEach, describe, expect, test } from "vitest"
+import {
+  ClusterChannel,
+  ClusterCoordinator,
+  ClusterRouter,
+  DurableStreamTestServer,
+  streamPartition,
+} from "@durable-streams/server"
+import type { Server } from "node:http"
+
+const WORKERS = 2
+
+let locals: Array<DurableStreamTestServer>
+let channels: Array<ClusterChannel>
+let routers: Array<ClusterRouter>
+let fronts: Array<Server>
+let urls: Array<string>
+
+beforeEach(async () => {
+  locals = Array.from(
+    { length: WORKERS },
+    () => new DurableStreamTestServer({ port: 0, webhooks: true })
+  )
+  const peers = await Promise.all(locals.map((local) => local.start()))
+
+  // Deliver channel messages asynchronously, like IPC through a primary
+  const coordinator = new ClusterCoordinator({
+    send: (index, message) =>
+      setImmediate(() => channels[index]!.receive(message)),
+  })
+  channels = locals.map(
+    (_local, index) =>
+      new ClusterChannel((message) =>
+        setImmediate(() => coordinator.receive(index, message))
+      )
+  )
+  routers = locals.map(
+    (local, index) =>
+      new ClusterRouter({ index, local, peers, channel: channels[index]! })
+  )
+  channels.forEach((_channel, index) => coordinator.join(index))
+  fronts = routers.map((router) =>
+    createServer((req, res) => router.handle(req, res))
+  )
+  urls = await Promise.all(
+    fronts.map(
+      (front) =>
+        new Promise<string>((resolve) => {
+          front.listen(0, `127.0.0.1`, () => {
+            const addr = front.address() as { port: number }
+            resolve(`http://127.0.0.1:${addr.port}`)
+          })
+        })
+    )
+  )
+  for (const router of routers) {
+    router.serveSubscriptions(urls[0]!)
+  }
+})
+
+afterEach(async () => {
+  for (const front of fronts) {
+    front.closeAllConnections()
+    front.close()
+  }
+  for (const router of routers) {
+    router.close()
+  }
+  await Promise.all(locals.map((local) => local.stop()))
+})
+
+/** Poll `check` until it returns true */
+async function waitFor(check: () => Promise<boolean>): Promise<void> {
+  for (let attempt = 0; attempt < 100; attempt++) {
+    if (await check()) return
+    await new Promise((resolve) => setTimeout(resolve, 20))
+  }
+  throw new Error(`Timed out`)
+}
+
+/** Find a stream path owned by `partition` */
+function pathOwnedBy(partition: number, prefix = `/cluster`): string {
+  for (let i = 0; ; i++) {
+    const path = `${prefix}-${i}`
+    if (streamPartition(path, WORKERS) === partition) return path
+  }
+}
+
+describe(`streamPartition`, () => {
+  test(`should be stable and in range`, () => {
+    for (let i = 0; i < 100; i++) {
+      const partition = streamPartition(`/stream-${i}`, 4)
+      expect(partition).toBeGreaterThanOrEqual(0)
+      expect(partition).toBeLessThan(4)
+      expect(streamPartition(`/stream-${i}`, 4)).toBe(partition)
+    }
+  })
+
+  test(`should spread streams across partitions`, () => {
+    const counts = [0, 0, 0, 0]
+    for (let i = 0; i < 1000; i++) {
+      counts[streamPartition(`/stream-${i}`, 4)]!++
+    }
+    for (const count of counts) {
+      expect(count).toBeGreaterThan(150)
+    }
+  })
+})
+
+describe(`ClusterRouter`, () => {
+  test(`should store streams on the owning worker only`, async () => {
+    const path = pathOwnedBy(1)
+
+    const create = await fetch(`${urls[0]}${path}`, {
+      method: `PUT`,
+      headers: { "content-type": `text/plain` },
+    })
+    expect(create.status).toBe(201)
+    expect(locals[1]!.store.has(path)).toBe(true)
+    expect(locals[0]!.store.has(path)).toBe(false)
+
+    const append = await fetch(`${urls[1]}${path}`, {
+      method: `POST`,
+      headers: { "content-type": `text/plain` },
+      body: `hello`,
+    })
+    expect(append.status).toBe(204)
+
+    const read = await fetch(`${urls[0]}${path}?offset=-1`)
+    expect(read.status).toBe(200)
+    expect(await read.text()).toBe(`hello`)
+    expect(read.headers.get(`stream-next-offset`)).toBe(
+      append.headers.get(`stream-next-offset`)
+    )
+  })
+
+  test(`should wake a proxied long-poll on a remote append`, async () => {
+    const path = pathOwnedBy(1)
+    await fetch(`${urls[1]}${path}`, {
+      method: `PUT`,
+      headers: { "content-type": `text/plain` },
+    })
+
+    const poll = fetch(`${urls[0]}${path}?offset=now&live=long-poll`)
+    await new Promise((resolve) => setTimeout(resolve, 50))
+    await fetch(`${urls[1]}${path}`, {
+      method: `POST`,
+      headers: { "content-type": `text/plain` },
+      body: `woken`,
+    })
+
+    const response = await poll
+    expect(response.status).toBe(200)
+    expect(await response.text()).toBe(`woken`)
+  })
+
+  test(`should stream proxied SSE events as they are written`, async () => {
+    const path = pathOwnedBy(0)
+    await fetch(`${urls[0]}${path}`, {
+      method: `PUT`,
+      headers: { "content-type": `text/plain` },
+      body: `first`,
+    })
+
+    const controller = new AbortController()
+    const response = await fetch(`${urls[1]}${path}?offset=-1&live=sse`, {
+      signal: controller.signal,
+    })
+    expect(response.status).toBe(200)
+    expect(response.headers.get(`content-type`)).toContain(`text/event-stream`)
+
+    const reader = response.body!.getReader()
+    const { value } = await reader.read()
+    expect(new TextDecoder().decode(value)).toContain(`data:first`)
+    controller.abort()
+  })
+
+  test(`should route injected faults to the faulted path's owner`, async () => {
+    const path = pathOwnedBy(1)
+    await fetch(`${urls[1]}${path}`, {
+      method: `PUT`,
+      headers: { "content-type": `text/plain` },
+    })
+
+    const inject = await fetch(`${urls[0]}/_test/inject-error`, {
+      method: `POST`,
+      body: JSON.stringify({ path, status: 503 }),
+    })
+    expect(inject.status).toBe(200)
+
+    const faulted = await fetch(`${urls[0]}${path}?offset=-1`)
+    expect(faulted.status).toBe(503)
+    const recovered = await fetch(`${urls[0]}${path}?offset=-1`)
+    expect(recovered.status).toBe(200)
+  })
+
+  test(`should create forks owned by their source's worker`, async () => {
+    const source = pathOwnedBy(1)
+    await fetch(`${urls[0]}${source}`, {
+      method: `PUT`,
+      headers: { "content-type": `text/plain` },
+      body: `inherited`,
+    })
+
+    const fork = pathOwnedBy(1, `/fork`)
+    const create = await fetch(`${urls[0]}${fork}`, {
+      method: `PUT`,
+      headers: { "stream-forked-from": source },
+    })
+    expect(create.status).toBe(201)
+    const read = await fetch(`${urls[0]}${fork}?offset=-1`)
+    expect(await read.text()).toBe(`inherited`)
+  })
+
+  test(`should place forks of another worker's stream with their source`, async () => {
+    const source = pathOwnedBy(1)
+    await fetch(`${urls[1]}${source}`, {
+      method: `PUT`,
+      headers: { "content-type": `text/plain` },
+      body: `inherited`,
+    })
+
+    // Hashes to worker 0, but must live with its source on worker 1
+    const fork = pathOwnedBy(0, `/fork`)
+    const create = await fetch(`${urls[0]}${fork}`, {
+      method: `PUT`,
+      headers: { "stream-forked-from": source },
+    })
+    expect(create.status).toBe(201)
+    expect(locals[1]!.store.has(fork)).toBe(true)
+    expect(locals[0]!.store.has(fork)).toBe(false)
+    for (const channel of channels) {
+      expect(channel.placement(fork)).toBe(1)
+    }
+
+    const append = await fetch(`${urls[0]}${fork}`, {
+      method: `POST`,
+      headers: { "content-type": `text/plain` },
+      body: `+own`,
+    })
+    expect(append.status).toBe(204)
+    for (const url of urls) {
+      const read = await fetch(`${url}${fork}?offset=-1`)
+      expect(await read.text()).toBe(`inherited+own`)
+    }
+
+    // A fork of the fork follows the root of the chain
+    const grandchild = pathOwnedBy(0, `/grandchild`)
+    const nested = await fetch(`${urls[1]}${grandchild}`, {
+      method: `PUT`,
+      headers: { "stream-forked-from": fork },
+    })
+    expect(nested.status).toBe(201)
+    expect(locals[1]!.store.has(grandchild)).toBe(true)
+    const read = await fetch(`${urls[0]}${grandchild}?offset=-1`)
+    expect(await read.text()).toBe(`inherited+own`)
+  })
+
+  test(`should release a fork's placement once its data is gone`, async () => {
+    const source = pathOwnedBy(1)
+    await fetch(`${urls[1]}${source}`, {
+      method: `PUT`,
+      headers: { "content-type": `text/plain` },
+      body: `inherited`,
+    })
+    const fork = pathOwnedBy(0, `/fork`)
+    const createFork = () =>
+      fetch(`${urls[0]}${fork}`, {
+        method: `PUT`,
+        headers: { "stream-forked-from": source },
+      })
+    const released = () =>
+      waitFor(() =>
+        Promise.resolve(
+          channels.every((channel) => channel.placement(fork) === undefined)
+        )
+      )
+
+    expect((await createFork()).status).toBe(201)
+
+    // Soft-deleted while a fork of its own still reads through it
+    const grandchild = pathOwnedBy(0, `/grandchild`)
+    await fetch(`${urls[0]}${grandchild}`, {
+      method: `PUT`,
+      headers: { "stream-forked-from": fork },
+    })
+    const softDelete = await fetch(`${urls[0]}${fork}`, { method: `DELETE` })
+    expect(softDelete.status).toBe(204)
+    await new Promise((resolve) => setTimeout(resolve, 50))
+    for (const channel of channels) {
+      expect(channel.placement(fork)).toBe(1)
+    }
+
+    // Deleting the last fork removes both
+    await fetch(`${urls[1]}${grandchild}`, { method: `DELETE` })
+    await released()
+    for (const channel of channels) {
+      expect(channel.placement(grandchild)).toBeUndefined()
+    }
+
+    // Recreated as a fork, the path is placed with its source again
+    expect((await createFork()).status).toBe(201)
+    expect(locals[1]!.store.has(fork)).toBe(true)
+    const read = await fetch(`${urls[0]}${fork}?offset=-1`)
+    expect(await read.text()).toBe(`inherited`)
+
+    // Recreated as a plain stream, it goes back to its hash partition
+    await fetch(`${urls[0]}${fork}`, { method: `DELETE` })
+    await released()
+    const create = await fetch(`${urls[1]}${fork}`, {
+      method: `PUT`,
+      headers: { "content-type": `text/plain` },
+    })
+    expect(create.status).toBe(201)
+    expect(locals[0]!.store.has(fork)).toBe(true)
+    expect(locals[1]!.store.has(fork)).toBe(false)
+  })
+
+  test(`should wake webhook subscriptions on every worker's streams`, async () => {
+    const deliveries: Array<{ streams: Array<{ path: string }> }> = []
+    const receiver = createServer((req, res) => {
+      const chunks: Array<Buffer> = []
+      req.on(`data`, (chunk: Buffer) => chunks.push(chunk))
+      req.on(`end`, () => {
+        deliveries.push(JSON.parse(Buffer.concat(chunks).toString(`utf8`)))
+        res.writeHead(200, { "content-type": `application/json` })
+        res.end(JSON.stringify({ done: true }))
+      })
+    })
+    const receiverUrl = await new Promise<string>((resolve) => {
+      receiver.listen(0, `127.0.0.1`, () => {
+        const addr = receiver.address() as { port: number }
+        resolve(`http://127.0.0.1:${addr.port}/webhook`)
+      })
+    })
+
+    try {
+      // Registered through worker 1, served by worker 0
+      const subscribe = await fetch(
+        `${urls[1]}/v1/stream/__ds/subscriptions/sub-1`,
+        {
+          method: `PUT`,
+          headers: { "content-type": `application/json` },
+          body: JSON.stringify({
+            type: `webhook`,
+            pattern: `jobs/*`,
+            webhook: { url: receiverUrl },
+          }),
+        }
+      )
+      expect(subscribe.status).toBe(201)
+
+      const stream = pathOwnedBy(1, `/v1/stream/jobs/job`)
+      await fetch(`${urls[0]}${stream}`, {
+        method: `PUT`,
+        headers: { "content-type": `text/plain` },
+      })
+      await fetch(`${urls[0]}${stream}`, {
+        method: `POST`,
+        headers: { "content-type": `text/plain` },
+        body: `work`,
+      })
+
+      await waitFor(() => Promise.resolve(deliveries.length > 0))
+      expect(deliveries[0]!.streams.map((s) => s.path)).toEqual([
+        stream.slice(`/v1/stream/`.length),
+      ])
+    } finally {
+      receiver.close()
+    }
+  })
+
+  test(`should write pull-wake events to another worker's wake stream`, async () => {
+    const wakeStream = pathOwnedBy(1, `/v1/stream/wakes`)
+    await fetch(`${urls[0]}${wakeStream}`, {
+      method: `PUT`,
+      headers: { "content-type": `application/json` },
+    })
+    const subscribe = await fetch(
+      `${urls[0]}/v1/stream/__ds/subscriptions/sub-2`,
+      {
+        method: `PUT`,
+        headers: { "content-type": `application/json` },
+        body: JSON.stringify({
+          type: `pull-wake`,
+          pattern: `tasks/*`,
+          wake_stream: wakeStream.slice(`/v1/stream/`.length),
+        }),
+      }
+    )
+    expect(subscribe.status).toBe(201)
+
+    const stream = pathOwnedBy(1, `/v1/stream/tasks/task`)
+    await fetch(`${urls[1]}${stream}`, {
+      method: `PUT`,
+      headers: { "content-type": `text/plain` },
+      body: `work`,
+    })
+
+    let events: Array<{ type: string; subscription_id: string }> = []
+    await waitFor(async () => {
+      const read = await fetch(`${urls[0]}${wakeStream}?offset=-1`)
+      events = (await read.json()) as typeof events
+      return events.length > 0
+    })
+    expect(events[0]).toMatchObject({ type: `wake`, subscription_id: `sub-2` })
+  })
+})
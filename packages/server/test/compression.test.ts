@@ -3,7 +3,7 @@
  */
 
 import { request as httpRequest } from "node:http"
-import { gunzipSync, inflateSync } from "node:zlib"
+import { gunzipSync, gzipSync, inflateSync } from "node:zlib"
 import { afterAll, beforeAll, beforeEach, describe, expect, it } from "vitest"
 import { DurableStreamTestServer } from "../src/server"
 
@@ -16,7 +16,7 @@ function rawRequest(
   options: {
     method?: string
     headers?: Record<string, string>
-    body?: string
+    body?: string | Buffer
   } = {}
 ): Promise<{
   status: number
@@ -275,4 +275,52 @@ describe(`Response Compression`, () => {
       expect(response.headers[`content-encoding`]).toBe(`gzip`)
     })
   })
+
+  describe(`request body decompression`, () => {
+    it(`should inflate gzip-encoded append bodies`, async () => {
+      await rawRequest(`${baseUrl}/test-gzip-append`, {
+        method: `PUT`,
+        headers: { "content-type": `text/plain` },
+      })
+
+      const append = await rawRequest(`${baseUrl}/test-gzip-append`, {
+        method: `POST`,
+        headers: { "content-type": `text/plain`, "content-encoding": `gzip` },
+        body: gzipSync(`hello `.repeat(500)),
+      })
+      expect(append.status).toBe(204)
+
+      const response = await rawRequest(`${baseUrl}/test-gzip-append`)
+      expect(response.body.toString()).toBe(`hello `.repeat(500))
+    })
+
+    it(`should reject unsupported content encodings`, async () => {
+      await rawRequest(`${baseUrl}/test-br-append`, {
+        method: `PUT`,
+        headers: { "content-type": `text/plain` },
+      })
+
+      const append = await rawRequest(`${baseUrl}/test-br-append`, {
+        method: `POST`,
+        headers: { "content-type": `text/plain`, "content-encoding": `br` },
+        body: `data`,
+      })
+      expect(append.status).toBe(415)
+      expect(append.headers[`accept-encoding`]).toBe(`gzip`)
+    })
+
+    it(`should reject corrupt gzip bodies`, async () => {
+      await rawRequest(`${baseUrl}/test-bad-gzip`, {
+        method: `PUT`,
+        headers: { "content-type": `text/plain` },
+      })
+
+      const append = await rawRequest(`${baseUrl}/test-bad-gzip`, {
+        method: `POST`,
+        headers: { "content-type": `text/plain`, "content-encoding": `gzip` },
+        body: `not gzip`,
+      })
+      expect(append.status).toBe(400)
+    })
+  })
 })
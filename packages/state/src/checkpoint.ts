@@ -0,0 +1,145 @@
+// ============================================================================
+// StreamDB Checkpoints
+//
+// A checkpoint is the synced content of every StreamDB collection, tagged
+// with the stream offset it was materialized up to. StreamDB loads the latest
+// checkpoint and reads only the tail of the stream after it, rather than
+// replaying every change event from the start.
+//
+// This module is free of any @tanstack/db dependency; stores can be used and
+// tested on their own.
+// ============================================================================
+
+/**
+ * Materialized StreamDB state at a stream offset.
+ */
+export interface StreamDBCheckpoint {
+  /** Checkpoint format version */
+  version: 1
+  /** Stream offset the rows were materialized up to; loading resumes here */
+  offset: string
+  /**
+   * Fingerprint of the collection types and primary keys. A checkpoint taken
+   * under a different state definition is ignored.
+   */
+  schema: string
+  /** Synced rows by event type */
+  rows: Record<string, Array<object>>
+}
+
+/**
+ * Persistent storage for StreamDB checkpoints, one per key.
+ */
+export interface CheckpointStore {
+  /** Load the checkpoint saved under `key`, if any */
+  load: (key: string) => Promise<StreamDBCheckpoint | undefined>
+  /** Save a checkpoint under `key`, replacing the previous one */
+  save: (key: string, checkpoint: StreamDBCheckpoint) => Promise<void>
+}
+
+/**
+ * Create a checkpoint store that keeps checkpoints in memory. Useful for
+ * tests and for sharing a checkpoint between StreamDBs in one process.
+ */
+export function createMemoryCheckpointStore(): CheckpointStore {
+  const checkpoints = new Map<string, StreamDBCheckpoint>()
+  return {
+    load: (key) => Promise.resolve(checkpoints.get(key)),
+    save: (key, checkpoint) => {
+      checkpoints.set(key, checkpoint)
+      return Promise.resolve()
+    },
+  }
+}
+
+const IDB_STORE_NAME = `checkpoints`
+
+function idbRequest<T>(request: IDBRequest<T>): Promise<T> {
+  return new Promise((resolve, reject) => {
+    request.onsuccess = () => resolve(request.result)
+    request.onerror = () => reject(request.error)
+  })
+}
+
+/**
+ * Create a checkpoint store backed by IndexedDB, for browsers and workers.
+ * Checkpoints are stored as structured clones, without JSON encoding.
+ *
+ * @param databaseName IndexedDB database to use
+ */
+export function createIndexedDBCheckpointStore(
+  databaseName: string = `durable-streams-state`
+): CheckpointStore {
+  let database: Promise<IDBDatabase> | undefined
+
+  const open = (): Promise<IDBDatabase> => {
+    database ??= new Promise((resolve, reject) => {
+      const request = indexedDB.open(databaseName, 1)
+      request.onupgradeneeded = () => {
+        request.result.createObjectStore(IDB_STORE_NAME)
+      }
+      request.onsuccess = () => resolve(request.result)
+      request.onerror = () => reject(request.error)
+    })
+    return database
+  }
+
+  return {
+    load: async (key) => {
+      const db = await open()
+      const store = db
+        .transaction(IDB_STORE_NAME, `readonly`)
+        .objectStore(IDB_STORE_NAME)
+      return (await idbRequest(store.get(key))) as
+        | StreamDBCheckpoint
+        | undefined
+    },
+    save: async (key, checkpoint) => {
+      const db = await open()
+      const transaction = db.transaction(IDB_STORE_NAME, `readwrite`)
+      transaction.objectStore(IDB_STORE_NAME).put(checkpoint, key)
+      await new Promise<void>((resolve, reject) => {
+        transaction.oncomplete = () => resolve()
+        transaction.onerror = () => reject(transaction.error)
+        transaction.onabort = () => reject(transaction.error)
+      })
+    },
+  }
+}
+
+/**
+ * Create a checkpoint store that writes one JSON file per key into
+ * `directory`, for Node.js. Files are replaced atomically, so a crash while
+ * saving leaves the previous checkpoint intact.
+ *
+ * @param directory Directory for checkpoint files, created on first save
+ */
+export function createFileCheckpointStore(directory: string): CheckpointStore {
+  // Imported lazily so that browser bundles of this package never load it
+  const fs = (): Promise<typeof import("node:fs/promises")> =>
+    import(`node:fs/promises`)
+  const fileFor = (key: string): string =>
+    `${directory}/${encodeURIComponent(key)}.json`
+
+  return {
+    load: async (key) => {
+      const { readFile } = await fs()
+      try {
+        return JSON.parse(
+          await readFile(fileFor(key), `utf8`)
+        ) as StreamDBCheckpoint
+      } catch (err) {
+        if ((err as { code?: unknown }).code === `ENOENT`) return undefined
+        throw err
+      }
+    },
+    save: async (key, checkpoint) => {
+      const { mkdir, rename, writeFile } = await fs()
+      const file = fileFor(key)
+      const temp = `${file}.${Date.now()}.tmp`
+      await mkdir(directory, { recursive: true })
+      await writeFile(temp, JSON.stringify(checkpoint))
+      await rename(temp, file)
+    },
+  }
+}
@@ -12,6 +12,7 @@ export * from "./index"
 export { createStreamDB, getStreamDBCollectionId } from "./stream-db"
 export type {
   CreateStreamDBOptions,
+  StreamDBCheckpointOptions,
   StreamDB,
   StreamDBMethods,
   StreamDBUtils,
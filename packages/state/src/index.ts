@@ -22,6 +22,14 @@ export { isChangeEvent, isControlEvent } from "./types"
 // In-memory materialization
 export { MaterializedState } from "./materialized-state"
 
+// Checkpoint stores for StreamDB
+export {
+  createMemoryCheckpointStore,
+  createIndexedDBCheckpointStore,
+  createFileCheckpointStore,
+} from "./checkpoint"
+export type { CheckpointStore, StreamDBCheckpoint } from "./checkpoint"
+
 // Schema definition + event construction (producer side)
 export { createStateSchema } from "./schema"
 export type {
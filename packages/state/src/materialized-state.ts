@@ -1,16 +1,34 @@
 import type { ChangeEvent } from "./types"
+import type { StreamStateDefinition } from "./schema"
 
 /**
  * MaterializedState maintains an in-memory view of state from change events.
  *
  * It organizes data by type, where each type contains a map of key -> value.
  * This supports multi-type streams where different entity types can coexist.
+ *
+ * When constructed with a state definition, the `indexes` of each collection
+ * are maintained as events apply, so lookup() answers field equality queries
+ * without scanning the type.
  */
 export class MaterializedState {
   private data: Map<string, Map<string, unknown>>
 
-  constructor() {
+  /** type -> field -> field value -> keys */
+  private indexes: Map<string, Map<string, Map<unknown, Set<string>>>>
+
+  constructor(state?: StreamStateDefinition) {
     this.data = new Map()
+    this.indexes = new Map()
+
+    for (const definition of Object.values(state ?? {})) {
+      if (!definition.indexes?.length) continue
+      const fields = new Map<string, Map<unknown, Set<string>>>()
+      for (const field of definition.indexes) {
+        fields.set(field, new Map())
+      }
+      this.indexes.set(definition.type, fields)
+    }
   }
 
   /**
@@ -26,6 +44,11 @@ export class MaterializedState {
       this.data.set(type, typeMap)
     }
 
+    const fields = this.indexes.get(type)
+    if (fields) {
+      this.unindex(fields, key, typeMap.get(key))
+    }
+
     // Apply the operation
     switch (headers.operation) {
       case `insert`:
@@ -41,6 +64,10 @@ export class MaterializedState {
         typeMap.delete(key)
         break
     }
+
+    if (fields && headers.operation !== `delete`) {
+      this.index(fields, key, value)
+    }
   }
 
   /**
@@ -63,6 +90,23 @@ export class MaterializedState {
     return typeMap.get(key) as T | undefined
   }
 
+  /**
+   * Get the values of a type whose indexed field equals `value`.
+   * Throws if the field is not in the collection's `indexes`.
+   */
+  lookup<T = unknown>(type: string, field: string, value: unknown): Array<T> {
+    const index = this.indexes.get(type)?.get(field)
+    if (!index) {
+      throw new Error(`No index on field "${field}" for type "${type}"`)
+    }
+    const typeMap = this.data.get(type)
+    const keys = index.get(value)
+    if (!typeMap || !keys) {
+      return []
+    }
+    return Array.from(keys, (key) => typeMap.get(key) as T)
+  }
+
   /**
    * Get all entries for a specific type
    */
@@ -75,6 +119,11 @@ export class MaterializedState {
    */
   clear(): void {
     this.data.clear()
+    for (const fields of this.indexes.values()) {
+      for (const index of fields.values()) {
+        index.clear()
+      }
+    }
   }
 
   /**
@@ -90,4 +139,38 @@ export class MaterializedState {
   get types(): Array<string> {
     return Array.from(this.data.keys())
   }
+
+  private index(
+    fields: Map<string, Map<unknown, Set<string>>>,
+    key: string,
+    value: unknown
+  ): void {
+    if (typeof value !== `object` || value === null) return
+    for (const [field, index] of fields) {
+      const fieldValue = (value as Record<string, unknown>)[field]
+      let keys = index.get(fieldValue)
+      if (!keys) {
+        keys = new Set()
+        index.set(fieldValue, keys)
+      }
+      keys.add(key)
+    }
+  }
+
+  private unindex(
+    fields: Map<string, Map<unknown, Set<string>>>,
+    key: string,
+    value: unknown
+  ): void {
+    if (typeof value !== `object` || value === null) return
+    for (const [field, index] of fields) {
+      const fieldValue = (value as Record<string, unknown>)[field]
+      const keys = index.get(fieldValue)
+      if (!keys) continue
+      keys.delete(key)
+      if (keys.size === 0) {
+        index.delete(fieldValue)
+      }
+    }
+  }
 }
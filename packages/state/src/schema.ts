@@ -20,6 +20,12 @@ export interface CollectionDefinition<T = unknown> {
   type: string
   /** The property name in T that serves as the primary key */
   primaryKey: string
+  /**
+   * Properties in T to index for equality lookups. Indexes are maintained
+   * incrementally as change events apply; StreamDB builds them as TanStack
+   * DB collection indexes and MaterializedState serves them via lookup().
+   */
+  indexes?: Array<string>
 }
 
 /**
@@ -16,6 +16,7 @@ import type {
   StreamResponse,
 } from "@durable-streams/client"
 import type { CollectionDefinition, StreamStateDefinition } from "./schema"
+import type { CheckpointStore, StreamDBCheckpoint } from "./checkpoint"
 
 // Schema definitions and event construction are db-free and live in ./schema.
 // Re-export them here so the TanStack-backed `@durable-streams/state/db`
@@ -57,6 +58,22 @@ export type ActionMap<TActions extends Record<string, ActionDefinition<any>>> =
     [K in keyof TActions]: ReturnType<typeof createOptimisticAction<any>>
   }
 
+/**
+ * Checkpoint options for a stream DB
+ */
+export interface StreamDBCheckpointOptions {
+  /** Where checkpoints are persisted */
+  store: CheckpointStore
+  /** Key the checkpoint is saved under. Defaults to the stream URL. */
+  key?: string
+  /**
+   * Save a checkpoint once this many change events have applied since the
+   * last one. Checkpoints are only taken when up-to-date and outside a
+   * snapshot-start/snapshot-end span. Defaults to 10000.
+   */
+  everyEvents?: number
+}
+
 /**
  * Options for creating a stream DB
  */
@@ -90,6 +107,13 @@ export interface CreateStreamDBOptions<
    * Useful for tracking safe offsets for external ack/lease protocols.
    */
   onBatch?: (batch: JsonBatch<StateEvent>) => void
+  /**
+   * Persist materialized checkpoints and resume from the latest one on
+   * preload, reading only the stream tail after it. Events restored from a
+   * checkpoint are not passed to onEvent, and their txids are not tracked
+   * by awaitTxId.
+   */
+  checkpoint?: StreamDBCheckpointOptions
 }
 
 /**
@@ -133,6 +157,13 @@ export interface StreamDBUtils {
    * @returns Promise that resolves when the txid is synced
    */
   awaitTxId: (txid: string, timeout?: number) => Promise<void>
+
+  /**
+   * Save a checkpoint now, e.g. before the page unloads. Resolves without
+   * saving if checkpoints are not configured or the state is not
+   * checkpointable yet.
+   */
+  checkpoint: () => Promise<void>
 }
 
 /**
@@ -233,12 +264,18 @@ class EventDispatcher {
     }>
   >()
 
-  /** Track existing keys per collection for upsert logic */
-  private existingKeys = new Map<string, Set<string>>()
+  /** Synced rows per collection, for upsert logic and checkpoints */
+  private syncedRows = new Map<string, Map<string, object>>()
 
   /** Global sequence counter for insertion ordering */
   private seq = 0
 
+  /** Whether a snapshot-start was seen without its snapshot-end */
+  private inSnapshot = false
+
+  /** Change events applied since the last checkpoint */
+  eventsSinceCheckpoint = 0
+
   private comparableRow(row: object): Record<string, unknown> {
     const clone = { ...(row as Record<string, unknown>) }
     delete clone._seq
@@ -250,9 +287,9 @@ class EventDispatcher {
    */
   registerHandler(eventType: string, handler: CollectionSyncHandler): void {
     this.handlers.set(eventType, handler)
-    // Initialize key tracking for upsert logic
-    if (!this.existingKeys.has(eventType)) {
-      this.existingKeys.set(eventType, new Set())
+    // Initialize row tracking for upsert logic
+    if (!this.syncedRows.has(eventType)) {
+      this.syncedRows.set(eventType, new Map())
     }
   }
 
@@ -275,6 +312,7 @@ class EventDispatcher {
       // Unknown event type - ignore silently
       return
     }
+    this.eventsSinceCheckpoint++
 
     let operation = event.headers.operation
 
@@ -307,17 +345,16 @@ class EventDispatcher {
 
     // Handle upsert by converting to insert or update
     if (operation === `upsert`) {
-      const keys = this.existingKeys.get(event.type)
-      const existing = keys?.has(event.key)
+      const existing = this.syncedRows.get(event.type)?.has(event.key)
       operation = existing ? `update` : `insert`
     }
 
-    const keys = this.existingKeys.get(event.type)
+    const rows = this.syncedRows.get(event.type)
 
     // Live stream reconnects can replay an already-synced insert for the same
     // row. Normalize that case to update so observation replays remain
     // idempotent instead of tripping TanStack DB's duplicate-key path.
-    if (operation === `insert` && keys?.has(event.key)) {
+    if (operation === `insert` && rows?.has(event.key)) {
       operation = `update`
     } else if (operation === `insert` && typeof event.key === `string`) {
       const existingValue = handler.read(event.key)
@@ -329,12 +366,12 @@ class EventDispatcher {
       }
     }
 
-    // Track key existence for upsert logic
+    // Track synced rows for upsert logic and checkpoints
     if (operation === `insert` || operation === `update`) {
-      keys?.add(event.key)
+      rows?.set(event.key, value)
     } else {
       // Must be delete
-      keys?.delete(event.key)
+      rows?.delete(event.key)
     }
 
     try {
@@ -362,21 +399,73 @@ class EventDispatcher {
         for (const handler of this.handlers.values()) {
           handler.truncate()
         }
-        // Clear key tracking
-        for (const keys of this.existingKeys.values()) {
-          keys.clear()
+        // Clear row tracking
+        for (const rows of this.syncedRows.values()) {
+          rows.clear()
         }
         this.pendingHandlers.clear()
         this.isUpToDate = false
+        this.inSnapshot = false
         break
 
       case `snapshot-start`:
+        // State is incomplete until snapshot-end; don't checkpoint it
+        this.inSnapshot = true
+        break
+
       case `snapshot-end`:
-        // These are hints for snapshot boundaries
+        this.inSnapshot = false
         break
     }
   }
 
+  /**
+   * Whether the collections hold a consistent state to checkpoint: up to
+   * date, every write committed, and not partway through a snapshot
+   */
+  get checkpointable(): boolean {
+    return (
+      this.isUpToDate && this.pendingHandlers.size === 0 && !this.inSnapshot
+    )
+  }
+
+  /**
+   * Synced rows of every collection, by event type
+   */
+  checkpointRows(): Record<string, Array<object>> {
+    const rows: Record<string, Array<object>> = {}
+    for (const [type, typeRows] of this.syncedRows) {
+      rows[type] = Array.from(typeRows.values())
+    }
+    return rows
+  }
+
+  /**
+   * Seed collections with checkpointed rows. The writes are committed along
+   * with the stream tail read after the checkpoint, on the next up-to-date.
+   */
+  restore(rows: Record<string, Array<object>>): void {
+    for (const [type, values] of Object.entries(rows)) {
+      const handler = this.handlers.get(type)
+      const typeRows = this.syncedRows.get(type)
+      if (!handler || !typeRows) continue
+
+      if (!this.pendingHandlers.has(handler)) {
+        handler.begin()
+        this.pendingHandlers.add(handler)
+      }
+      for (const value of values) {
+        const row = value as Record<string, unknown>
+        // Keep checkpointed insertion order ahead of rows from the tail
+        if (typeof row._seq === `number` && row._seq >= this.seq) {
+          this.seq = row._seq + 1
+        }
+        typeRows.set(String(row[handler.primaryKey]), value)
+        handler.write(value, `insert`)
+      }
+    }
+  }
+
   /**
    * Commit all pending writes and handle up-to-date signal
    */
@@ -513,6 +602,23 @@ class EventDispatcher {
   }
 }
 
+// ============================================================================
+// Checkpoints
+// ============================================================================
+
+const DEFAULT_CHECKPOINT_EVERY_EVENTS = 10_000
+
+/**
+ * Fingerprint the parts of a state definition a checkpoint's rows depend on
+ */
+function checkpointFingerprint(state: StreamStateDefinition): string {
+  return JSON.stringify(
+    Object.values(state)
+      .map((definition) => [definition.type, definition.primaryKey])
+      .sort()
+  )
+}
+
 // ============================================================================
 // Sync Factory
 // ============================================================================
@@ -608,6 +714,7 @@ export function createStreamDB<
     onEvent,
     onBeforeBatch,
     onBatch,
+    checkpoint: checkpointOptions,
   } = options
 
   // Reuse provided stream or create a new one
@@ -647,6 +754,12 @@ export function createStreamDB<
       gcTime: 0,
     })
 
+    // Field indexes are maintained by TanStack DB as rows are written and
+    // serve eq() lookups in queries without scanning the collection
+    for (const field of definition.indexes ?? []) {
+      collection.createIndex((row: any) => row[field])
+    }
+
     collectionInstances[name] = collection
   }
 
@@ -669,6 +782,56 @@ export function createStreamDB<
     )
   }
 
+  const checkpointKey = checkpointOptions?.key ?? streamIdentity
+  const checkpointEveryEvents =
+    checkpointOptions?.everyEvents ?? DEFAULT_CHECKPOINT_EVERY_EVENTS
+  const schemaFingerprint = checkpointFingerprint(state)
+  let checkpointSaving: Promise<void> | null = null
+
+  /**
+   * Load the latest checkpoint, if it was taken under this state definition
+   */
+  const loadCheckpoint = async (): Promise<StreamDBCheckpoint | undefined> => {
+    if (!checkpointOptions) return undefined
+    try {
+      const checkpoint = await checkpointOptions.store.load(checkpointKey)
+      if (
+        checkpoint?.version === 1 &&
+        checkpoint.schema === schemaFingerprint
+      ) {
+        return checkpoint
+      }
+    } catch (error) {
+      console.warn(`[StreamDB] Failed to load checkpoint:`, error)
+    }
+    return undefined
+  }
+
+  /**
+   * Save a checkpoint of the synced rows at the last consumed offset. Only
+   * one save runs at a time.
+   */
+  const saveCheckpoint = (): Promise<void> => {
+    if (!checkpointOptions || !dispatcher.checkpointable) {
+      return Promise.resolve()
+    }
+    if (checkpointSaving) return checkpointSaving
+
+    const checkpoint: StreamDBCheckpoint = {
+      version: 1,
+      offset: lastConsumedOffset,
+      schema: schemaFingerprint,
+      rows: dispatcher.checkpointRows(),
+    }
+    dispatcher.eventsSinceCheckpoint = 0
+    checkpointSaving = Promise.resolve()
+      .then(() => checkpointOptions.store.save(checkpointKey, checkpoint))
+      .finally(() => {
+        checkpointSaving = null
+      })
+    return checkpointSaving
+  }
+
   /**
    * Start the stream consumer (called lazily on first preload)
    */
@@ -677,11 +840,30 @@ export function createStreamDB<
     consumerStarted = true
 
     // Start streaming (this is where the connection actually happens)
-    streamResponse = await stream.stream<StateEvent>({
-      live,
-      json: true,
-      signal: abortController.signal,
-    })
+    const openStream = (offset?: string) =>
+      stream.stream<StateEvent>({
+        live,
+        json: true,
+        offset,
+        signal: abortController.signal,
+      })
+
+    // Resume from the latest checkpoint, reading only the tail after it. If
+    // the stream can't be read from there, fall back to reading it all.
+    const checkpoint = await loadCheckpoint()
+    if (checkpoint) {
+      try {
+        streamResponse = await openStream(checkpoint.offset)
+        dispatcher.restore(checkpoint.rows)
+      } catch (error) {
+        if (isAbortLikeError(error)) throw error
+        console.warn(
+          `[StreamDB] Cannot resume from checkpoint, reading from the start:`,
+          error
+        )
+      }
+    }
+    streamResponse ??= await openStream()
     // StreamDB consumes batches via subscribeJson(); it does not await the
     // session's closed promise. Swallow that terminal rejection so aborting
     // the live session during db.close() doesn't surface as an unhandled
@@ -717,6 +899,15 @@ export function createStreamDB<
         if (batch.upToDate || dispatcher.ready) {
           dispatcher.markUpToDate()
         }
+
+        if (
+          checkpointOptions &&
+          dispatcher.eventsSinceCheckpoint >= checkpointEveryEvents
+        ) {
+          saveCheckpoint().catch((error: unknown) => {
+            console.warn(`[StreamDB] Failed to save checkpoint:`, error)
+          })
+        }
       } catch (error) {
         console.error(`[StreamDB] Error processing batch:`, error)
         dispatcher.rejectAll(error as Error)
@@ -744,6 +935,7 @@ export function createStreamDB<
     utils: {
       awaitTxId: (txid: string, timeout?: number) =>
         dispatcher.awaitTxId(txid, timeout),
+      checkpoint: saveCheckpoint,
     },
   }
 
@@ -0,0 +1,55 @@
+import { mkdtemp, readdir, rm } from "node:fs/promises"
+import { tmpdir } from "node:os"
+import path from "node:path"
+import { afterEach, beforeEach, describe, expect, it } from "vitest"
+import {
+  createFileCheckpointStore,
+  createMemoryCheckpointStore,
+} from "../src/checkpoint"
+import type { StreamDBCheckpoint } from "../src/checkpoint"
+
+const checkpoint = (offset: string): StreamDBCheckpoint => ({
+  version: 1,
+  offset,
+  schema: `[["user","id"]]`,
+  rows: { user: [{ id: `1`, name: `Kyle`, _seq: 0 }] },
+})
+
+describe(`createMemoryCheckpointStore`, () => {
+  it(`should keep the latest checkpoint per key`, async () => {
+    const store = createMemoryCheckpointStore()
+    expect(await store.load(`a`)).toBeUndefined()
+
+    await store.save(`a`, checkpoint(`1`))
+    await store.save(`a`, checkpoint(`2`))
+    await store.save(`b`, checkpoint(`3`))
+
+    expect((await store.load(`a`))?.offset).toBe(`2`)
+    expect((await store.load(`b`))?.offset).toBe(`3`)
+  })
+})
+
+describe(`createFileCheckpointStore`, () => {
+  let directory: string
+
+  beforeEach(async () => {
+    directory = await mkdtemp(path.join(tmpdir(), `state-checkpoints-`))
+  })
+
+  afterEach(async () => {
+    await rm(directory, { recursive: true, force: true })
+  })
+
+  it(`should round-trip checkpoints through files`, async () => {
+    const store = createFileCheckpointStore(path.join(directory, `nested`))
+    const key = `https://example.com/streams/a?b=c`
+    expect(await store.load(key)).toBeUndefined()
+
+    await store.save(key, checkpoint(`1`))
+    await store.save(key, checkpoint(`2`))
+
+    expect(await store.load(key)).toEqual(checkpoint(`2`))
+    // One file per key, with no temporary files left behind
+    expect(await readdir(path.join(directory, `nested`))).toHaveLength(1)
+  })
+})
@@ -154,5 +154,53 @@ describe(`Key-Value Store`, () => {
 
       expect(state.get(`config`, `theme`)).toBe(`light`)
     })
+
+    it(`should maintain field indexes as events apply`, () => {
+      const state = new MaterializedState({
+        users: {
+          schema: {
+            "~standard": {
+              version: 1,
+              vendor: `test`,
+              validate: (value) => ({ value }),
+            },
+          },
+          type: `user`,
+          primaryKey: `id`,
+          indexes: [`team`],
+        },
+      })
+
+      state.applyBatch([
+        {
+          type: `user`,
+          key: `1`,
+          value: { id: `1`, team: `a` },
+          headers: { operation: `insert` },
+        },
+        {
+          type: `user`,
+          key: `2`,
+          value: { id: `2`, team: `a` },
+          headers: { operation: `insert` },
+        },
+        {
+          type: `user`,
+          key: `2`,
+          value: { id: `2`, team: `b` },
+          headers: { operation: `update` },
+        },
+        { type: `user`, key: `1`, headers: { operation: `delete` } },
+      ])
+
+      expect(state.lookup(`user`, `team`, `a`)).toEqual([])
+      expect(state.lookup(`user`, `team`, `b`)).toEqual([
+        { id: `2`, team: `b` },
+      ])
+      expect(() => state.lookup(`user`, `name`, `x`)).toThrow(`No index`)
+
+      state.clear()
+      expect(state.lookup(`user`, `team`, `b`)).toEqual([])
+    })
   })
 })
@@ -2,6 +2,7 @@ import { afterAll, beforeAll, describe, expect, it, vi } from "vitest"
 import { DurableStreamTestServer } from "@durable-streams/server"
 import { DurableStream } from "@durable-streams/client"
 import { createStateSchema, createStreamDB } from "../src/stream-db"
+import { createMemoryCheckpointStore } from "../src/checkpoint"
 import type { StandardSchemaV1 } from "@standard-schema/spec"
 
 // Simple Standard Schema implementations for testing
@@ -2362,3 +2363,125 @@ describe(`Stream DB TxId Tracking`, () => {
     db.close()
   })
 })
+
+describe(`Stream DB Checkpoints`, () => {
+  let server: DurableStreamTestServer
+  let baseUrl: string
+
+  beforeAll(async () => {
+    server = new DurableStreamTestServer({ port: 0 })
+    await server.start()
+    baseUrl = server.url
+  })
+
+  afterAll(async () => {
+    await server.stop()
+  })
+
+  const streamState = createStateSchema({
+    users: {
+      schema: userSchema,
+      type: `user`,
+      primaryKey: `id`,
+      indexes: [`email`],
+    },
+  })
+
+  it(`should resume from the latest checkpoint and read only the tail`, async () => {
+    const streamUrl = `${baseUrl}/db/checkpoint-${Date.now()}`
+    const stream = await DurableStream.create({
+      url: streamUrl,
+      contentType: `application/json`,
+    })
+    for (const id of [`1`, `2`, `3`]) {
+      await stream.append(
+        JSON.stringify(
+          streamState.users.insert({
+            value: { id, name: `User ${id}`, email: `${id}@example.com` },
+          })
+        )
+      )
+    }
+
+    const store = createMemoryCheckpointStore()
+    const first = createStreamDB({
+      streamOptions: { url: streamUrl, contentType: `application/json` },
+      state: streamState,
+      live: false,
+      checkpoint: { store, everyEvents: 1 },
+    })
+    await first.preload()
+    await first.utils.checkpoint()
+    first.close()
+
+    const checkpoint = await store.load(streamUrl)
+    expect(checkpoint?.offset).toBe(first.offset)
+    expect(checkpoint?.rows.user).toHaveLength(3)
+
+    await stream.append(
+      JSON.stringify(
+        streamState.users.update({
+          value: { id: `1`, name: `Renamed`, email: `1@example.com` },
+        })
+      )
+    )
+    await stream.append(JSON.stringify(streamState.users.delete({ key: `2` })))
+
+    const onEvent = vi.fn()
+    const second = createStreamDB({
+      streamOptions: { url: streamUrl, contentType: `application/json` },
+      state: streamState,
+      live: false,
+      checkpoint: { store },
+      onEvent,
+    })
+    await second.preload()
+
+    expect(onEvent).toHaveBeenCalledTimes(2)
+    expect(second.collections.users.size).toBe(2)
+    expect(second.collections.users.get(`1`)?.name).toBe(`Renamed`)
+    expect(second.collections.users.get(`2`)).toBeUndefined()
+    expect(second.collections.users.get(`3`)?.name).toBe(`User 3`)
+
+    second.close()
+  })
+
+  it(`should ignore checkpoints taken under a different state definition`, async () => {
+    const streamUrl = `${baseUrl}/db/checkpoint-schema-${Date.now()}`
+    const stream = await DurableStream.create({
+      url: streamUrl,
+      contentType: `application/json`,
+    })
+    await stream.append(
+      JSON.stringify(
+        streamState.users.insert({
+          value: { id: `1`, name: `Kyle`, email: `kyle@example.com` },
+        })
+      )
+    )
+
+    const store = createMemoryCheckpointStore()
+    await store.save(streamUrl, {
+      version: 1,
+      offset: `-1`,
+      schema: `stale`,
+      rows: { user: [{ id: `stale`, name: `Stale`, email: `` }] },
+    })
+
+    const onEvent = vi.fn()
+    const db = createStreamDB({
+      streamOptions: { url: streamUrl, contentType: `application/json` },
+      state: streamState,
+      live: false,
+      checkpoint: { store },
+      onEvent,
+    })
+    await db.preload()
+
+    expect(onEvent).toHaveBeenCalledTimes(1)
+    expect(db.collections.users.get(`stale`)).toBeUndefined()
+    expect(db.collections.users.get(`1`)?.name).toBe(`Kyle`)
+
+    db.close()
+  })
+})
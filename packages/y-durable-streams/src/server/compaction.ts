@@ -4,6 +4,11 @@
  * Compaction creates a snapshot from the current document state.
  * Snapshots are stored with offset-based keys ({offset}_snapshot).
  * New clients load snapshot + updates after that offset.
+ *
+ * Compaction is incremental: the updates since the last snapshot are merged
+ * into it as binary Yjs updates, without loading the document into a Y.Doc.
+ * Every FULL_COMPACTION_INTERVAL compactions the document is rebuilt in a
+ * Y.Doc instead, so deleted content is garbage collected from the snapshot.
  */
 
 import * as Y from "yjs"
@@ -17,6 +22,29 @@ import {
 import { YjsStreamPaths } from "./types"
 import type { CompactionResult, YjsDocumentState, YjsIndexEntry } from "./types"
 
+/**
+ * Rebuild the snapshot in a Y.Doc, garbage collecting deleted content, after
+ * this many incremental compactions.
+ */
+const FULL_COMPACTION_INTERVAL = 16
+
+/**
+ * Default number of documents compacted at once.
+ */
+const DEFAULT_COMPACTION_CONCURRENCY = 2
+
+/**
+ * Options for the Compactor.
+ */
+export interface CompactorOptions {
+  /**
+   * Maximum number of documents compacted at once. Further documents wait
+   * in a queue.
+   * @default 2
+   */
+  concurrency?: number
+}
+
 /**
  * Interface for the server that the Compactor works with.
  */
@@ -58,13 +86,54 @@ function isNotFoundError(err: unknown): boolean {
  */
 export class Compactor {
   private readonly server: CompactorServer
+  private readonly concurrency: number
+
+  /** Documents waiting for a compaction slot, marked compacting */
+  private readonly queue: Array<{ service: string; docPath: string }> = []
+  private running = 0
 
-  constructor(server: CompactorServer) {
+  constructor(server: CompactorServer, options: CompactorOptions = {}) {
     this.server = server
+    this.concurrency = Math.max(
+      1,
+      options.concurrency ?? DEFAULT_COMPACTION_CONCURRENCY
+    )
   }
 
   /**
-   * Trigger compaction for a document.
+   * Queue compaction for a document, off the request path. At most
+   * `concurrency` documents compact at once; a document already compacting
+   * or queued is not queued again.
+   */
+  scheduleCompaction(service: string, docPath: string): void {
+    if (!this.server.tryStartCompaction(service, docPath)) {
+      return
+    }
+    this.queue.push({ service, docPath })
+    this.drainQueue()
+  }
+
+  private drainQueue(): void {
+    while (this.running < this.concurrency && this.queue.length > 0) {
+      const { service, docPath } = this.queue.shift()!
+      this.running++
+      this.performCompaction(service, docPath)
+        .catch((err) => {
+          console.error(
+            `[Compactor] Compaction error for ${service}/${docPath}:`,
+            err
+          )
+        })
+        .finally(() => {
+          this.server.setCompacting(service, docPath, false)
+          this.running--
+          this.drainQueue()
+        })
+    }
+  }
+
+  /**
+   * Trigger compaction for a document and wait for it, bypassing the queue.
    * Uses atomic check-and-set to prevent concurrent compactions.
    */
   async triggerCompaction(service: string, docPath: string): Promise<void> {
@@ -81,6 +150,27 @@ export class Compactor {
     }
   }
 
+  /**
+   * Build a new client's initial state: the snapshot at `snapshotOffset`
+   * merged with every update after it, as one Yjs update. Returns null if
+   * the snapshot does not exist.
+   */
+  async buildInitialState(
+    service: string,
+    docPath: string,
+    snapshotOffset: string
+  ): Promise<{ update: Uint8Array; offset: string } | null> {
+    const snapshot = await this.readSnapshot(service, docPath, snapshotOffset)
+    if (!snapshot) return null
+
+    const { updates, offset } = await this.readUpdates(
+      service,
+      docPath,
+      snapshotOffset
+    )
+    return { update: mergeUpdates(snapshot, updates), offset }
+  }
+
   /**
    * Perform the actual compaction.
    */
@@ -96,132 +186,132 @@ export class Compactor {
     const dsServerUrl = this.server.getDsServerUrl()
     const dsHeaders = this.server.getDsServerHeaders()
 
-    // Create a Y.Doc and load current state
-    const doc = new Y.Doc()
-
-    try {
-      // Load existing snapshot if any
-      if (state.snapshotOffset) {
-        const snapshotKey = YjsStreamPaths.snapshotKey(state.snapshotOffset)
-        const snapshotUrl = `${dsServerUrl}${YjsStreamPaths.snapshotStream(service, docPath, snapshotKey)}`
-        const stream = new DurableStream({
-          url: snapshotUrl,
-          headers: dsHeaders,
-          contentType: `application/octet-stream`,
-        })
-
-        try {
-          const response = await stream.stream({ offset: `-1` })
-          const snapshot = await response.body()
-          if (snapshot.length > 0) {
-            Y.applyUpdate(doc, snapshot)
-          }
-        } catch (err) {
-          if (!isNotFoundError(err)) {
-            throw err
-          }
-        }
-      }
-
-      // Load updates since the current snapshot (or from start if none)
-      // This avoids reapplying full history on each compaction.
-      // When a snapshot exists, read from the offset after the snapshot
-      // (snapshot was built from data up to and including snapshotOffset).
-      const updatesUrl = `${dsServerUrl}${YjsStreamPaths.dsStream(service, docPath)}`
-      const updatesStream = new DurableStream({
-        url: updatesUrl,
-        headers: dsHeaders,
-        contentType: `application/octet-stream`,
-      })
-
-      const updatesOffset = state.snapshotOffset
-        ? incrementOffset(state.snapshotOffset)
-        : `-1`
-      let currentEndOffset = state.snapshotOffset ?? `-1`
-
-      try {
-        const response = await updatesStream.stream({
-          offset: updatesOffset,
-        })
-        const updatesData = await response.body()
-
-        if (updatesData.length > 0) {
-          // Updates are stored with lib0 framing
-          const decoder = decoding.createDecoder(updatesData)
-          while (decoding.hasContent(decoder)) {
-            const update = decoding.readVarUint8Array(decoder)
-            Y.applyUpdate(doc, update)
-          }
-        }
-
-        // Store the full offset string from the server
-        currentEndOffset = response.offset
-      } catch (err) {
-        if (isNotFoundError(err)) {
+    // Load the existing snapshot if any, and the updates since it (or from
+    // the start if none). The snapshot was built from data up to and
+    // including snapshotOffset.
+    const snapshot = state.snapshotOffset
+      ? await this.readSnapshot(service, docPath, state.snapshotOffset)
+      : null
+    const { updates, offset: currentEndOffset } = await this.readUpdates(
+      service,
+      docPath,
+      snapshot ? state.snapshotOffset : null
+    )
+
+    // Merge the new updates into the snapshot, or rebuild it in a Y.Doc
+    // periodically to garbage collect deleted content
+    const full =
+      !snapshot || state.incrementalCompactions >= FULL_COMPACTION_INTERVAL
+    const newSnapshot = full
+      ? rebuildSnapshot(snapshot, updates)
+      : mergeUpdates(snapshot, updates)
+
+    // Create new snapshot storage with offset-based key
+    const snapshotKey = YjsStreamPaths.snapshotKey(currentEndOffset)
+    const newSnapshotUrl = `${dsServerUrl}${YjsStreamPaths.snapshotStream(service, docPath, snapshotKey)}`
+
+    const snapshotStream = await DurableStream.create({
+      url: newSnapshotUrl,
+      headers: dsHeaders,
+      contentType: `application/octet-stream`,
+    })
+    await snapshotStream.append(newSnapshot, {
+      contentType: `application/octet-stream`,
+    })
+
+    const oldSnapshotOffset = state.snapshotOffset
+
+    // Write to internal index stream to persist the snapshot offset
+    await this.writeIndexEntry(service, docPath, currentEndOffset)
+
+    // Update in-memory snapshot offset
+    this.server.updateSnapshotOffset(service, docPath, currentEndOffset)
+    state.incrementalCompactions = full ? 0 : state.incrementalCompactions + 1
+
+    // Reset counters
+    this.server.resetUpdateCounters(service, docPath)
+
+    // Delete old snapshot if any
+    if (oldSnapshotOffset) {
+      this.deleteOldSnapshot(service, docPath, oldSnapshotOffset).catch(
+        (err) => {
           console.error(
-            `[Compactor] Updates stream not found for ${service}/${docPath} during compaction`
+            `[Compactor] Error deleting old snapshot for ${service}/${docPath}:`,
+            err
           )
         }
-        throw err
-      }
+      )
+    }
 
-      // Encode the current state as a snapshot
-      const newSnapshot = Y.encodeStateAsUpdate(doc)
-
-      // Create new snapshot storage with offset-based key
-      const snapshotKey = YjsStreamPaths.snapshotKey(currentEndOffset)
-      const newSnapshotUrl = `${dsServerUrl}${YjsStreamPaths.snapshotStream(service, docPath, snapshotKey)}`
-
-      const snapshotStream = await DurableStream.create({
-        url: newSnapshotUrl,
-        headers: dsHeaders,
-        contentType: `application/octet-stream`,
-      })
-      await snapshotStream.append(newSnapshot, {
-        contentType: `application/octet-stream`,
-      })
-
-      const oldSnapshotOffset = state.snapshotOffset
-
-      // Write to internal index stream to persist the snapshot offset
-      await this.writeIndexEntry(service, docPath, currentEndOffset)
-
-      // Update in-memory snapshot offset
-      this.server.updateSnapshotOffset(service, docPath, currentEndOffset)
-
-      // Reset counters
-      this.server.resetUpdateCounters(service, docPath)
-
-      // Delete old snapshot if any
-      if (oldSnapshotOffset) {
-        this.deleteOldSnapshot(service, docPath, oldSnapshotOffset).catch(
-          (err) => {
-            console.error(
-              `[Compactor] Error deleting old snapshot for ${service}/${docPath}:`,
-              err
-            )
-          }
-        )
-      }
+    const result: CompactionResult = {
+      snapshotOffset: currentEndOffset,
+      snapshotSizeBytes: newSnapshot.length,
+      oldSnapshotOffset,
+    }
 
-      const result: CompactionResult = {
-        snapshotOffset: currentEndOffset,
-        snapshotSizeBytes: newSnapshot.length,
-        oldSnapshotOffset,
-      }
+    console.log(
+      `[Compactor] Compacted ${service}/${docPath} ` +
+        `(${full ? `full` : `incremental`}): ` +
+        `snapshot=${newSnapshot.length} bytes, ` +
+        `updates=${updates.length}, ` +
+        `offset=${currentEndOffset}`
+    )
 
-      console.log(
-        `[Compactor] Compacted ${service}/${docPath}: ` +
-          `snapshot=${newSnapshot.length} bytes, ` +
-          `offset=${currentEndOffset}`
-      )
+    return result
+  }
 
-      return result
-    } finally {
-      doc.destroy()
+  /**
+   * Read the snapshot stored at `snapshotOffset`, or null if it does not
+   * exist.
+   */
+  private async readSnapshot(
+    service: string,
+    docPath: string,
+    snapshotOffset: string
+  ): Promise<Uint8Array | null> {
+    const snapshotKey = YjsStreamPaths.snapshotKey(snapshotOffset)
+    const stream = new DurableStream({
+      url: `${this.server.getDsServerUrl()}${YjsStreamPaths.snapshotStream(service, docPath, snapshotKey)}`,
+      headers: this.server.getDsServerHeaders(),
+      contentType: `application/octet-stream`,
+    })
+
+    try {
+      const response = await stream.stream({ offset: `-1`, live: false })
+      return await response.body()
+    } catch (err) {
+      if (isNotFoundError(err)) {
+        return null
+      }
+      throw err
     }
   }
 
+  /**
+   * Read the updates after `snapshotOffset` (or from the start if null) up to
+   * the current end of the updates stream.
+   */
+  private async readUpdates(
+    service: string,
+    docPath: string,
+    snapshotOffset: string | null
+  ): Promise<{ updates: Array<Uint8Array>; offset: string }> {
+    const stream = new DurableStream({
+      url: `${this.server.getDsServerUrl()}${YjsStreamPaths.dsStream(service, docPath)}`,
+      headers: this.server.getDsServerHeaders(),
+      contentType: `application/octet-stream`,
+    })
+
+    const response = await stream.stream({
+      offset: snapshotOffset ? incrementOffset(snapshotOffset) : `-1`,
+      live: false,
+    })
+    // Updates are stored with lib0 framing
+    const updates = decodeUpdates(await response.body())
+    // Store the full offset string from the server
+    return { updates, offset: response.offset }
+  }
+
   /**
    * Write a new entry to the internal index stream.
    * This persists the snapshot offset so it survives server restarts.
@@ -261,6 +351,57 @@ export class Compactor {
   }
 }
 
+/**
+ * Merge a snapshot and the updates after it into one update, without
+ * loading them into a Y.Doc.
+ */
+function mergeUpdates(
+  snapshot: Uint8Array | null,
+  updates: Array<Uint8Array>
+): Uint8Array {
+  const parts =
+    snapshot && snapshot.length > 0 ? [snapshot, ...updates] : updates
+  if (parts.length === 0) return new Uint8Array(0)
+  if (parts.length === 1) return parts[0]!
+  return Y.mergeUpdates(parts)
+}
+
+/**
+ * Apply a snapshot and the updates after it to a Y.Doc and encode its
+ * state, dropping deleted content.
+ */
+function rebuildSnapshot(
+  snapshot: Uint8Array | null,
+  updates: Array<Uint8Array>
+): Uint8Array {
+  const doc = new Y.Doc()
+  try {
+    if (snapshot && snapshot.length > 0) {
+      Y.applyUpdate(doc, snapshot)
+    }
+    for (const update of updates) {
+      Y.applyUpdate(doc, update)
+    }
+    return Y.encodeStateAsUpdate(doc)
+  } finally {
+    doc.destroy()
+  }
+}
+
+/**
+ * Count lib0-framed updates without decoding them.
+ */
+export function countUpdates(data: Uint8Array): number {
+  let count = 0
+  const decoder = decoding.createDecoder(data)
+  while (decoding.hasContent(decoder)) {
+    const length = decoding.readVarUint(decoder)
+    decoder.pos += length
+    count++
+  }
+  return count
+}
+
 /**
  * Increment an offset string by 1 in the sequence portion.
  * Offsets are formatted as "{timestamp}_{sequence}" with zero-padded parts.
@@ -25,6 +25,20 @@ export interface YjsServerOptions {
    */
   compactionThreshold?: number
 
+  /**
+   * Number of updates since the last compaction that triggers compaction,
+   * whatever their size. Many small updates are costly for new clients to
+   * replay even when they add up to little.
+   * @default 1000
+   */
+  compactionUpdateThreshold?: number
+
+  /**
+   * Maximum number of documents compacted at once across the server.
+   * @default 2
+   */
+  compactionConcurrency?: number
+
   /**
    * Optional headers to send to the durable streams server.
    */
@@ -44,6 +58,12 @@ export interface YjsDocumentState {
   /** Cumulative size of updates since last compaction (bytes) */
   updatesSizeBytes: number
 
+  /** Number of updates since last compaction */
+  updatesCount: number
+
+  /** Incremental compactions since the snapshot was last fully rebuilt */
+  incrementalCompactions: number
+
   /** Whether compaction is currently in progress */
   compacting: boolean
 }
@@ -5,7 +5,8 @@
  * adding Yjs-specific logic:
  * - Single URL path per document with query parameters
  * - Snapshot discovery via offset=snapshot sentinel (307 redirects)
- * - Automatic compaction when updates exceed threshold
+ * - Automatic compaction when updates exceed a size or count threshold
+ * - Single-response initial loads (snapshot merged with later updates)
  * - Awareness via ?awareness=<name> query parameter
  *
  * Protocol: https://github.com/durable-streams/durable-streams/blob/main/packages/y-durable-streams/PROTOCOL.md
@@ -17,12 +18,20 @@ import {
   DurableStreamError,
   FetchError,
 } from "@durable-streams/client"
-import { Compactor } from "./compaction"
+import { Compactor, countUpdates } from "./compaction"
 import { PathUtils, YJS_HEADERS, YjsStreamPaths } from "./types"
 import type { IncomingMessage, Server, ServerResponse } from "node:http"
 import type { YjsDocumentState, YjsIndexEntry, YjsServerOptions } from "./types"
 
 const DEFAULT_COMPACTION_THRESHOLD = 1024 * 1024 // 1MB
+const DEFAULT_COMPACTION_UPDATE_THRESHOLD = 1000
+
+/**
+ * Cache lifetime of initial-load responses. Any cached response is a valid
+ * starting point (clients continue from its Stream-Next-Offset), so the
+ * lifetime only bounds how much a client catches up on afterwards.
+ */
+const INITIAL_LOAD_MAX_AGE_SECONDS = 60
 
 /**
  * Check if an error is a 404 Not Found error.
@@ -67,6 +76,7 @@ export class YjsServer {
   private readonly dsServerUrl: string
   private readonly dsServerHeaders: Record<string, string>
   private readonly compactionThreshold: number
+  private readonly compactionUpdateThreshold: number
   private readonly port: number
   private readonly host: string
 
@@ -85,10 +95,14 @@ export class YjsServer {
     this.dsServerHeaders = options.dsServerHeaders ?? {}
     this.compactionThreshold =
       options.compactionThreshold ?? DEFAULT_COMPACTION_THRESHOLD
+    this.compactionUpdateThreshold =
+      options.compactionUpdateThreshold ?? DEFAULT_COMPACTION_UPDATE_THRESHOLD
     this.port = options.port ?? 0
     this.host = options.host ?? `127.0.0.1`
 
-    this.compactor = new Compactor(this)
+    this.compactor = new Compactor(this, {
+      concurrency: options.compactionConcurrency,
+    })
   }
 
   async start(): Promise<string> {
@@ -428,11 +442,13 @@ export class YjsServer {
     // Check if the document stream exists
     const dsPath = YjsStreamPaths.dsStream(route.service, route.docPath)
     const headUrl = `${this.dsServerUrl}${dsPath}`
+    let tailOffset: string | null = null
     try {
       const headResponse = await fetch(headUrl, {
         method: `HEAD`,
         headers: this.dsServerHeaders,
       })
+      tailOffset = headResponse.headers.get(YJS_HEADERS.STREAM_NEXT_OFFSET)
       if (headResponse.status === 404) {
         res.writeHead(404, { "content-type": `application/json` })
         res.end(
@@ -466,11 +482,16 @@ export class YjsServer {
     const redirectUrl = new URL(originalUrl.href)
 
     if (state.snapshotOffset) {
-      // Snapshot exists - redirect to snapshot URL
+      // Snapshot exists - redirect to snapshot URL. With the current tail,
+      // the URL names an initial load of the snapshot merged with the
+      // updates after it, which changes only as the document does.
       redirectUrl.searchParams.set(
         `offset`,
         YjsStreamPaths.snapshotKey(state.snapshotOffset)
       )
+      if (tailOffset) {
+        redirectUrl.searchParams.set(`through`, tailOffset)
+      }
     } else {
       // No snapshot - redirect to beginning of stream
       redirectUrl.searchParams.set(`offset`, `-1`)
@@ -565,7 +586,7 @@ export class YjsServer {
     res: ServerResponse,
     route: RouteMatch,
     offset: string,
-    _url: URL
+    url: URL
   ): Promise<void> {
     const snapshotOffset = YjsStreamPaths.parseSnapshotOffset(offset)
     if (!snapshotOffset) {
@@ -581,6 +602,11 @@ export class YjsServer {
       return
     }
 
+    if (url.searchParams.has(`through`)) {
+      await this.handleInitialLoad(res, route, snapshotOffset)
+      return
+    }
+
     // Build DS URL for snapshot storage
     const dsPath = YjsStreamPaths.snapshotStream(
       route.service,
@@ -655,6 +681,53 @@ export class YjsServer {
     }
   }
 
+  /**
+   * Serve a new client's initial load as one response: the snapshot merged
+   * with every update after it, so the client applies a single update
+   * instead of replaying each one.
+   *
+   * `through` is the tail offset at discovery time. The response covers at
+   * least that far, and any response for the URL is a valid starting point,
+   * so it is publicly cacheable; the URL changes as the document does.
+   */
+  private async handleInitialLoad(
+    res: ServerResponse,
+    route: RouteMatch,
+    snapshotOffset: string
+  ): Promise<void> {
+    let initial: { update: Uint8Array; offset: string } | null
+    try {
+      initial = await this.compactor.buildInitialState(
+        route.service,
+        route.docPath,
+        snapshotOffset
+      )
+    } catch (err) {
+      if (!isNotFoundError(err)) throw err
+      initial = null
+    }
+
+    if (!initial) {
+      res.writeHead(404, { "content-type": `application/json` })
+      res.end(
+        JSON.stringify({
+          error: {
+            code: `SNAPSHOT_NOT_FOUND`,
+            message: `Snapshot not found`,
+          },
+        })
+      )
+      return
+    }
+
+    res.writeHead(200, {
+      "content-type": `application/octet-stream`,
+      "cache-control": `public, max-age=${INITIAL_LOAD_MAX_AGE_SECONDS}`,
+      [YJS_HEADERS.STREAM_NEXT_OFFSET]: initial.offset,
+    })
+    res.end(initial.update)
+  }
+
   /**
    * Increment an offset string for the next read position.
    * Offsets are formatted as "{timestamp}_{sequence}" padded strings.
@@ -777,8 +850,6 @@ export class YjsServer {
     res: ServerResponse,
     route: RouteMatch
   ): Promise<void> {
-    const stateKey = this.stateKey(route.service, route.docPath)
-
     // Client sends lib0-framed updates - pass through directly
     // (Client frames each update before batching to handle IdempotentProducer concatenation)
     const body = await this.readBody(req)
@@ -812,23 +883,18 @@ export class YjsServer {
 
     // Track for compaction on success
     if (dsResponse.status >= 200 && dsResponse.status < 300) {
-      if (!this.documentStates.has(stateKey)) {
-        this.documentStates.set(stateKey, {
-          snapshotOffset: null,
-          updatesSizeBytes: 0,
-          compacting: false,
-        })
-      }
-      const state = this.documentStates.get(stateKey)!
+      const state = this.getOrCreateDocumentState(route.service, route.docPath)
       state.updatesSizeBytes += body.length
+      try {
+        state.updatesCount += countUpdates(body)
+      } catch {
+        // Malformed framing: count the request as one update
+        state.updatesCount += 1
+      }
 
-      // Trigger compaction if thresholds met
+      // Queue compaction if thresholds met
       if (this.shouldTriggerCompaction(state)) {
-        this.compactor
-          .triggerCompaction(route.service, route.docPath)
-          .catch((err) => {
-            console.error(`[YjsServer] Compaction error:`, err)
-          })
+        this.compactor.scheduleCompaction(route.service, route.docPath)
       }
     }
   }
@@ -1296,6 +1362,8 @@ export class YjsServer {
       state = {
         snapshotOffset: null,
         updatesSizeBytes: 0,
+        updatesCount: 0,
+        incrementalCompactions: 0,
         compacting: false,
       }
       this.documentStates.set(stateKey, state)
@@ -1307,7 +1375,9 @@ export class YjsServer {
 
   shouldTriggerCompaction(state: YjsDocumentState): boolean {
     return (
-      !state.compacting && state.updatesSizeBytes >= this.compactionThreshold
+      !state.compacting &&
+      (state.updatesSizeBytes >= this.compactionThreshold ||
+        state.updatesCount >= this.compactionUpdateThreshold)
     )
   }
 
@@ -1342,6 +1412,7 @@ export class YjsServer {
     const state = this.documentStates.get(this.stateKey(service, docPath))
     if (state) {
       state.updatesSizeBytes = 0
+      state.updatesCount = 0
     }
   }
 
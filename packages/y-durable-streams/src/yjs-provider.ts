@@ -421,8 +421,13 @@ export class YjsProvider extends ObservableV2<YjsProviderEvents> {
         const offset = redirectUrl.searchParams.get(`offset`)
         if (offset) {
           if (offset.endsWith(`_snapshot`)) {
-            // Snapshot exists - load it
-            await this.loadSnapshot(ctx, offset)
+            // Snapshot exists - load it, merged with the updates after it
+            // when the server offers that
+            await this.loadSnapshot(
+              ctx,
+              offset,
+              redirectUrl.searchParams.get(`through`)
+            )
           } else {
             // No snapshot - start from the indicated offset
             ctx.startOffset = offset
@@ -437,13 +442,19 @@ export class YjsProvider extends ObservableV2<YjsProviderEvents> {
   }
 
   /**
-   * Load a snapshot from the server.
+   * Load a snapshot from the server. With `through`, the response also
+   * includes the updates after the snapshot, and Stream-Next-Offset points
+   * past them.
    */
   private async loadSnapshot(
     ctx: ConnectionContext,
-    snapshotOffset: string
+    snapshotOffset: string,
+    through: string | null = null
   ): Promise<void> {
-    const url = `${this.docUrl()}?offset=${encodeURIComponent(snapshotOffset)}`
+    let url = `${this.docUrl()}?offset=${encodeURIComponent(snapshotOffset)}`
+    if (through) {
+      url += `&through=${encodeURIComponent(through)}`
+    }
 
     try {
       const response = await fetch(url, {
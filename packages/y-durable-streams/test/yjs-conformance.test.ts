@@ -1682,6 +1682,42 @@ describe(`Yjs Durable Streams Protocol`, () => {
       })
     })
 
+    describe(`compaction.initial-load`, () => {
+      it(`should serve the snapshot and later updates as one cacheable response`, async () => {
+        const docId = `initial-load-${Date.now()}`
+
+        const doc1 = new Y.Doc()
+        const provider1 = await createProviderWithDoc(docId, { doc: doc1 })
+        await waitForSync(provider1)
+
+        const text = doc1.getText(`content`)
+        await appendWithSync(provider1, text, `X`.repeat(200), 10)
+        await waitForSnapshot(baseUrl, docId)
+        await appendWithSync(provider1, text, `Y`, 3)
+
+        const discovery = await fetch(
+          `${baseUrl}/docs/${docId}?offset=snapshot`,
+          { method: `GET`, redirect: `manual` }
+        )
+        expect(discovery.status).toBe(307)
+        const location = new URL(
+          discovery.headers.get(`location`)!,
+          `${baseUrl}/`
+        )
+        const through = location.searchParams.get(`through`)
+        expect(through).toBeTruthy()
+
+        const response = await fetch(location, { method: `GET` })
+        expect(response.status).toBe(200)
+        expect(response.headers.get(`cache-control`)).toMatch(/^public/)
+        expect(response.headers.get(`stream-next-offset`)).toBe(through)
+
+        const doc2 = new Y.Doc()
+        Y.applyUpdate(doc2, new Uint8Array(await response.arrayBuffer()))
+        expect(doc2.getText(`content`).toString()).toBe(text.toString())
+      })
+    })
+
     describe(`compaction.stale-client-resume`, () => {
       it(`should sync correctly when client resumes from pre-snapshot offset`, async () => {
         const docId = `stale-resume-${Date.now()}`
@@ -1887,6 +1923,52 @@ describe(`Yjs Durable Streams Protocol`, () => {
     })
   })
 
+  // Custom compaction settings require local servers - skip when using external URL
+  describe.skipIf(!!externalServerUrl)(`Compaction Scheduling`, () => {
+    it(`should compact after the update count threshold`, async () => {
+      const docId = `update-count-${Date.now()}`
+      const service = `update-count`
+
+      const server = new YjsServer({
+        port: 0,
+        dsServerUrl: dsServer!.url,
+        compactionUpdateThreshold: 5,
+        compactionConcurrency: 1,
+      })
+      await server.start()
+      const serverBaseUrl = `${server.url}/v1/yjs/${service}`
+
+      const doc = new Y.Doc()
+      const provider = new YjsProvider({
+        doc,
+        baseUrl: serverBaseUrl,
+        docId,
+      })
+
+      try {
+        await waitForSync(provider)
+
+        // Far below the default size threshold
+        const text = doc.getText(`content`)
+        await appendWithSync(provider, text, `a`, 6)
+        await waitForSnapshot(serverBaseUrl, docId)
+
+        const doc2 = new Y.Doc()
+        const provider2 = new YjsProvider({
+          doc: doc2,
+          baseUrl: serverBaseUrl,
+          docId,
+        })
+        await waitForSync(provider2)
+        await waitForDocText(doc2, `content`, `aaaaaa`)
+        provider2.destroy()
+      } finally {
+        provider.destroy()
+        await server.stop()
+      }
+    })
+  })
+
   // Server restart test requires local servers - skip when using external URL
   describe.skipIf(!!externalServerUrl)(`Server Restart`, () => {
     it(
@@ -0,0 +1,82 @@
+/**
+ * Server-side load benchmark runner.
+ *
+ * Runs the load scenarios from @durable-streams/benchmarks against a server
+ * and writes a JSON report (throughput, p50/p99/p999 latency, RSS over time).
+ * Without BENCH_URL an in-process file-backed Node server is started; point
+ * BENCH_URL at a running Caddy server (and BENCH_SERVER_PID at its process to
+ * sample its RSS) to compare the two.
+ *
+ * Usage:
+ *   pnpm exec tsx scripts/bench-load.ts
+ *   BENCH_URL=http://localhost:4437 BENCH_SERVER_PID=1234 \
+ *     BENCH_SCENARIOS=fan-out,catch-up pnpm exec tsx scripts/bench-load.ts
+ */
+import { mkdirSync, rmSync } from "node:fs"
+import path from "node:path"
+import { fileURLToPath } from "node:url"
+import { DurableStreamTestServer } from "@durable-streams/server"
+import {
+  defaultLoadScenarios,
+  runLoadBenchmarks,
+} from "../packages/benchmarks/src/load"
+
+const SCRIPT_DIR = path.dirname(fileURLToPath(import.meta.url))
+const REPO_ROOT = path.resolve(SCRIPT_DIR, `..`)
+
+const SELECTED = process.env.BENCH_SCENARIOS?.split(`,`).map((s) => s.trim())
+const scenarios = defaultLoadScenarios.filter(
+  (scenario) => !SELECTED || SELECTED.includes(scenario.type)
+)
+
+let baseUrl = process.env.BENCH_URL
+let serverPid = process.env.BENCH_SERVER_PID
+  ? Number(process.env.BENCH_SERVER_PID)
+  : undefined
+let environment = process.env.BENCH_ENV ?? `external`
+let stop = async (): Promise<void> => {}
+
+if (!baseUrl) {
+  const dataDir = path.resolve(
+    REPO_ROOT,
+    `.streams-dev`,
+    `bench-load-${Date.now()}`
+  )
+  mkdirSync(dataDir, { recursive: true })
+  const server = new DurableStreamTestServer({
+    port: 0,
+    host: `127.0.0.1`,
+    dataDir,
+    webhooks: false,
+  })
+  baseUrl = await server.start()
+  // The server shares this process, so its RSS is the client's too
+  serverPid = process.pid
+  environment = process.env.BENCH_ENV ?? `node-in-process`
+  stop = async () => {
+    await server.stop()
+    rmSync(dataDir, { recursive: true, force: true })
+  }
+}
+
+console.log(`[bench-load] server=${baseUrl}`)
+console.log(
+  `[bench-load] scenarios=${scenarios.map((s) => s.type).join(`,`)}`
+)
+
+try {
+  const report = await runLoadBenchmarks({
+    baseUrl,
+    environment,
+    serverPid,
+    outputFile: process.env.BENCH_OUTPUT,
+    scenarios,
+  })
+  for (const scenario of report.scenarios) {
+    console.log(`\n=== ${scenario.name} (${scenario.errors} errors) ===`)
+    console.table(scenario.latency)
+    console.table(scenario.throughput)
+  }
+} finally {
+  await stop()
+}